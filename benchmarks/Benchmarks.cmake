@@ -0,0 +1,71 @@
+# This adds all benchmarks in the benchmarks directory.
+# Benchmarks are only built if LF_BENCHMARKS is set, and they are not run by ctest.
+set(BENCHMARK_DIR ${CMAKE_CURRENT_SOURCE_DIR}/benchmarks)
+set(BENCHMARK_SUFFIX _bench.c)  # Files that are benchmarks must have names ending with BENCHMARK_SUFFIX.
+set(LF_ROOT ${CMAKE_CURRENT_LIST_DIR}/..)
+
+include(${LF_ROOT}/core/lf_utils.cmake)
+
+# Add the benchmark files found in DIR to BENCHMARK_FILES.
+function(add_benchmark_dir DIR)
+    file(
+        GLOB_RECURSE BENCHMARK_FILES_FOR_DIR
+        LIST_DIRECTORIES false
+        RELATIVE ${BENCHMARK_DIR}
+        ${DIR}/*${BENCHMARK_SUFFIX}
+    )
+    list(APPEND BENCHMARK_FILES ${BENCHMARK_FILES_FOR_DIR})
+    set(BENCHMARK_FILES ${BENCHMARK_FILES} PARENT_SCOPE)
+endfunction()
+
+# Benchmarks in the threaded directory are programs that use the threaded runtime.
+# So are the benchmarks in the suite directory, which report their results as JSON with suite/report.c
+# (see benchmarks/compare_builds.sh).
+if(NOT DEFINED LF_SINGLE_THREADED)
+    add_benchmark_dir(${BENCHMARK_DIR}/threaded)
+    add_benchmark_dir(${BENCHMARK_DIR}/suite)
+endif()
+
+# Benchmarks in the modal_models directory need the runtime to be built with modal reactors.
+if(DEFINED MODAL_REACTORS)
+    add_benchmark_dir(${BENCHMARK_DIR}/modal_models)
+endif()
+
+# Benchmarks in the general directory measure parts of the runtime on their own, as the tests in
+# test/general check them. Like the tests, they are built with the stubs of generated code and the
+# random numbers in test/.
+add_benchmark_dir(${BENCHMARK_DIR}/general)
+
+# Benchmarks in the util directory measure the utilities in util/, which are not part of the runtime.
+# The benchmark util/X_bench.c is built with util/X.c.
+add_benchmark_dir(${BENCHMARK_DIR}/util)
+
+# Create an executable for each benchmark, all of which the benchmarks target builds.
+add_custom_target(benchmarks)
+foreach(FILE ${BENCHMARK_FILES})
+    string(REGEX REPLACE "[./]" "_" NAME ${FILE})
+    add_executable(${NAME} ${BENCHMARK_DIR}/${FILE})
+    target_link_libraries(${NAME} PRIVATE lf::low-level-platform-impl)
+    target_link_libraries(
+        ${NAME} PRIVATE
+        ${CoreLib} ${Lib}
+    )
+    # The platform library calls the logging functions of the runtime, so benchmarks that use nothing
+    # else that logs need the runtime again after it.
+    target_link_libraries(${NAME} PRIVATE lf::low-level-platform-impl ${CoreLib})
+    if(FILE MATCHES "^util/")
+        string(REGEX REPLACE "^util/(.*)${BENCHMARK_SUFFIX}$" "\\1" UTIL ${FILE})
+        target_sources(${NAME} PRIVATE ${LF_ROOT}/util/${UTIL}.c)
+        target_include_directories(${NAME} PRIVATE ${LF_ROOT}/util)
+    endif()
+    if(FILE MATCHES "^general/")
+        target_sources(${NAME} PRIVATE ${LF_ROOT}/test/src_gen_stub.c ${LF_ROOT}/test/rand_utils.c)
+        target_include_directories(${NAME} PRIVATE ${LF_ROOT}/test)
+    endif()
+    if(FILE MATCHES "^suite/")
+        target_sources(${NAME} PRIVATE ${BENCHMARK_DIR}/suite/report.c)
+        target_include_directories(${NAME} PRIVATE ${BENCHMARK_DIR}/suite)
+    endif()
+    add_dependencies(benchmarks ${NAME})
+    lf_enable_compiler_warnings(${NAME})
+endforeach(FILE ${BENCHMARK_FILES})
@@ -0,0 +1,71 @@
+#!/bin/bash
+# Run the benchmarks in suite/ from two builds and report regressions of the second against the first.
+#
+# Usage: benchmarks/compare_builds.sh <build-a> <build-b>
+#
+# Each argument is a build directory configured with -DLF_BENCHMARKS=ON, for example from two
+# checkouts or with different options; the script builds the benchmarks target in each.
+# Each benchmark runs REPEAT times (default 5) with WORKERS workers (default $(nproc)) and the
+# runtime options in BENCH_ARGS (default "-f true -o 1 sec"). The script compares the medians
+# of events_per_sec and latency_p99_ns and exits with status 1 if build b is worse than
+# build a in either by more than THRESHOLD percent (default 5).
+set -e
+
+if [ $# -ne 2 ]; then
+    echo "Usage: $0 <build-a> <build-b>" >&2
+    exit 2
+fi
+BUILD_A=$1
+BUILD_B=$2
+REPEAT=${REPEAT:-5}
+WORKERS=${WORKERS:-$(nproc)}
+BENCH_ARGS=${BENCH_ARGS:-"-f true -o 1 sec"}
+THRESHOLD=${THRESHOLD:-5}
+
+cmake --build "$BUILD_A" --target benchmarks > /dev/null
+cmake --build "$BUILD_B" --target benchmarks > /dev/null
+
+# Print the median of a field of the JSON lines that the benchmark prints over REPEAT runs.
+median() {
+    local field=$1 file=$2
+    grep '^{' "$file" | sed -n "s/.*\"$field\": \([0-9.]*\).*/\1/p" | sort -n |
+        awk '{ v[NR] = $1 } END { if (NR % 2) print v[(NR + 1) / 2]; else print (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+REGRESSIONS=0
+RESULTS=$(mktemp -d)
+trap 'rm -rf "$RESULTS"' EXIT
+printf "%-28s %16s %16s %14s %14s\n" benchmark "events/s a" "events/s b" "p99 ns a" "p99 ns b"
+for BENCH in "$BUILD_A"/suite_*_bench_c; do
+    NAME=$(basename "$BENCH")
+    if [ ! -x "$BUILD_B/$NAME" ]; then
+        echo "$NAME: missing from $BUILD_B, skipped" >&2
+        continue
+    fi
+    for BUILD in a b; do
+        if [ $BUILD = a ]; then DIR=$BUILD_A; else DIR=$BUILD_B; fi
+        for _ in $(seq "$REPEAT"); do
+            # shellcheck disable=SC2086
+            "$DIR/$NAME" -w "$WORKERS" $BENCH_ARGS >> "$RESULTS/$NAME.$BUILD"
+        done
+    done
+    RATE_A=$(median events_per_sec "$RESULTS/$NAME.a")
+    RATE_B=$(median events_per_sec "$RESULTS/$NAME.b")
+    P99_A=$(median latency_p99_ns "$RESULTS/$NAME.a")
+    P99_B=$(median latency_p99_ns "$RESULTS/$NAME.b")
+    VERDICT=$(awk -v ra="$RATE_A" -v rb="$RATE_B" -v la="$P99_A" -v lb="$P99_B" -v t="$THRESHOLD" 'BEGIN {
+        v = ""
+        if (rb < ra * (1 - t / 100)) v = v " throughput"
+        if (lb > la * (1 + t / 100)) v = v " latency"
+        print v }')
+    printf "%-28s %16s %16s %14s %14s%s\n" "$NAME" "$RATE_A" "$RATE_B" "$P99_A" "$P99_B" \
+        "${VERDICT:+  REGRESSION:$VERDICT}"
+    if [ -n "$VERDICT" ]; then
+        REGRESSIONS=$((REGRESSIONS + 1))
+    fi
+done
+
+if [ $REGRESSIONS -gt 0 ]; then
+    echo "$REGRESSIONS benchmark(s) regressed by more than $THRESHOLD%."
+    exit 1
+fi
@@ -0,0 +1,31 @@
+#!/bin/bash
+# Build a benchmark in threaded/ with each scheduler and run it with each number of workers.
+#
+# Usage: benchmarks/compare_schedulers.sh [<workers> ...]
+#
+# The schedulers default to "SCHED_GEDF_NP SCHED_GEDF_MQ" and can be changed with the
+# SCHEDULERS environment variable. BENCH_ARGS holds the runtime options passed to
+# each run and defaults to "-f true -o 2 sec", which measures throughput.
+# Leave out "-f true" to run in real time and count deadline misses instead.
+# BENCHMARK selects threaded/${BENCHMARK}_bench.c and defaults to "scheduler".
+# CMAKE_ARGS holds extra options for configuring each build, such as "-DLF_PIPELINED_TAGS=1".
+set -e
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD_DIR=${BUILD_DIR:-$ROOT/build/benchmarks}
+SCHEDULERS=${SCHEDULERS:-"SCHED_GEDF_NP SCHED_GEDF_MQ"}
+BENCH_ARGS=${BENCH_ARGS:-"-f true -o 2 sec"}
+WORKERS=${*:-"1 2 4 $(nproc)"}
+BENCHMARK=${BENCHMARK:-scheduler}
+CMAKE_ARGS=${CMAKE_ARGS:-}
+
+for SCHEDULER in $SCHEDULERS; do
+    # shellcheck disable=SC2086
+    cmake -S "$ROOT" -B "$BUILD_DIR/$SCHEDULER" -DCMAKE_BUILD_TYPE=Release -DLF_BENCHMARKS=ON \
+        -DSCHEDULER="$SCHEDULER" $CMAKE_ARGS > /dev/null
+    cmake --build "$BUILD_DIR/$SCHEDULER" --target "threaded_${BENCHMARK}_bench_c" > /dev/null
+    for W in $WORKERS; do
+        # shellcheck disable=SC2086
+        "$BUILD_DIR/$SCHEDULER/threaded_${BENCHMARK}_bench_c" -w "$W" $BENCH_ARGS | grep '^scheduler='
+    done
+done
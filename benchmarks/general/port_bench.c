@@ -0,0 +1,92 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the iteration over the present channels of a sparse multiport.
+ *
+ * A multiport of WIDTH channels is set up as the code generator does, and about 3% of its
+ * channels are made present with lf_set_present(). The program then iterates over the
+ * present channels ROUNDS times with the bitmap of the sparse record, and ROUNDS times
+ * with the fallback that scans every channel, and checks that both visit the same channels.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "port.h"
+#include "rand_utils.h"
+#include "reactor.h"
+#include "reactor_common.h"
+
+#ifndef WIDTH
+#define WIDTH 4096
+#endif
+#ifndef ROUNDS
+#define ROUNDS 2000
+#endif
+
+/** Return the sum of the present channels. */
+static long iterate(lf_port_base_t** ports) {
+  long sum = 0;
+  lf_multiport_iterator_t i = _lf_multiport_iterator_impl(ports, WIDTH);
+  for (int channel = lf_multiport_next(&i); channel >= 0; channel = lf_multiport_next(&i)) {
+    sum += channel;
+  }
+  return sum;
+}
+
+int main(void) {
+  static environment_t env;
+  static self_base_t self;
+  static lf_sparse_io_record_t record;
+  static lf_port_base_t channels[WIDTH];
+  static lf_port_base_t* ports[WIDTH];
+  environment_init(&env, "main", 0, 1, 0, 0, 0, 0, WIDTH, 0, 0, 0, NULL);
+  self.environment = &env;
+  // As in generated code, the environment knows the record and every channel, and the runtime allocates the bitmap.
+  record.capacity = WIDTH / LF_SPARSE_CAPACITY_DIVIDER;
+  env.sparse_io_record_sizes = vector_new(1);
+  vector_push(&env.sparse_io_record_sizes, &record.size);
+  for (int i = 0; i < WIDTH; i++) {
+    channels[i].sparse_record = &record;
+    channels[i].destination_channel = i;
+    channels[i].source_reactor = &self;
+    env.is_present_fields[i] = &channels[i].is_present;
+    ports[i] = &channels[i];
+  }
+  _lf_initialize_sparse_io_records(&env);
+
+  long expected = 0;
+  uint32_t state = 1830;
+  for (int i = 0; i < WIDTH; i++) {
+    if (next_random(&state) % 32 == 0) {
+      lf_set_present(&channels[i]);
+      expected += i;
+    }
+  }
+  int size = record.size;
+  long by_bitmap = 0;
+  instant_t start = lf_time_physical();
+  for (int round = 0; round < ROUNDS; round++) {
+    by_bitmap += iterate(ports);
+  }
+  interval_t bitmap_time = lf_time_physical() - start;
+
+  // A record that has overflowed makes the iterator scan every channel.
+  record.size = -1;
+  long by_scan = 0;
+  start = lf_time_physical();
+  for (int round = 0; round < ROUNDS; round++) {
+    by_scan += iterate(ports);
+  }
+  interval_t scan_time = lf_time_physical() - start;
+
+  if (by_bitmap != expected * ROUNDS || by_scan != by_bitmap) {
+    fprintf(stderr, "The iterations visited different channels.\n");
+    return 1;
+  }
+  printf("%d of %d channels present. Bitmap: %.1f ns per iteration. Scan: %.1f ns per iteration.\n", size, WIDTH,
+         (double)bitmap_time / ROUNDS, (double)scan_time / ROUNDS);
+  environment_free(&env);
+  return 0;
+}
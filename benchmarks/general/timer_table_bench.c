@@ -0,0 +1,95 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the timer table against one event per timer on a tag queue.
+ *
+ * NUMBER_OF_TIMERS timers fall into NUMBER_OF_PERIODS periods and, within each period, into
+ * NUMBER_OF_PHASES offsets that are spread over one millisecond, so the table has about
+ * NUMBER_OF_PERIODS * NUMBER_OF_PHASES groups. The program fires all timers up to END as the
+ * runtime does, once with the timer table and once with a tag queue that holds one element per
+ * timer, as the event queue does without LF_TIMER_TABLE, and checks that both fire as often.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "low_level_platform.h"
+#include "pqueue_tag.h"
+#include "timer_table.h"
+
+#ifndef NUMBER_OF_TIMERS
+#define NUMBER_OF_TIMERS 4096
+#endif
+#ifndef NUMBER_OF_PERIODS
+#define NUMBER_OF_PERIODS 4
+#endif
+#ifndef NUMBER_OF_PHASES
+#define NUMBER_OF_PHASES 256
+#endif
+#ifndef END
+#define END MSEC(200)
+#endif
+
+/** The next firing of a timer on the tag queue. */
+typedef struct {
+  pqueue_tag_element_t base;
+  trigger_t* timer;
+} firing_t;
+
+int main(void) {
+  trigger_t* timers = (trigger_t*)calloc(NUMBER_OF_TIMERS, sizeof(trigger_t));
+  for (int i = 0; i < NUMBER_OF_TIMERS; i++) {
+    timers[i].period = MSEC(1) * (1 + i % NUMBER_OF_PERIODS);
+    timers[i].offset = ((i / NUMBER_OF_PERIODS) % NUMBER_OF_PHASES) * (MSEC(1) / NUMBER_OF_PHASES);
+  }
+
+  long long firings_by_queue = 0;
+  firing_t* firings = (firing_t*)calloc(NUMBER_OF_TIMERS, sizeof(firing_t));
+  pqueue_tag_t* q = pqueue_tag_init(NUMBER_OF_TIMERS);
+  instant_t start = lf_time_physical();
+  for (int i = 0; i < NUMBER_OF_TIMERS; i++) {
+    firings[i].base.tag = (tag_t){.time = timers[i].offset, .microstep = 0};
+    firings[i].timer = &timers[i];
+    pqueue_tag_insert(q, &firings[i].base);
+  }
+  firing_t* firing;
+  while ((firing = (firing_t*)pqueue_tag_peek(q)) != NULL && firing->base.tag.time < END) {
+    pqueue_tag_pop(q);
+    firings_by_queue++;
+    firing->base.tag.time += firing->timer->period;
+    pqueue_tag_insert(q, &firing->base);
+  }
+  interval_t queue_time = lf_time_physical() - start;
+  pqueue_tag_free(q);
+  free(firings);
+
+  long long firings_by_table = 0;
+  size_t number_of_groups = 0;
+  start = lf_time_physical();
+  lf_timer_table_t* table = lf_timer_table_new();
+  for (int i = 0; i < NUMBER_OF_TIMERS; i++) {
+    lf_timer_table_add(table, &timers[i], timers[i].offset);
+  }
+  number_of_groups = table->number_of_groups;
+  instant_t time;
+  while ((time = lf_timer_table_next_time(table)) < END) {
+    lf_timer_group_t* group;
+    while ((group = lf_timer_table_pop(table, time)) != NULL) {
+      firings_by_table += group->number_of_timers;
+      group->time += group->period;
+      lf_timer_table_push(table, group);
+    }
+  }
+  interval_t table_time = lf_time_physical() - start;
+  lf_timer_table_free(table);
+  free(timers);
+
+  if (firings_by_queue != firings_by_table) {
+    fprintf(stderr, "The tag queue fired %lld times, but the timer table fired %lld times.\n", firings_by_queue,
+            firings_by_table);
+    return 1;
+  }
+  printf("%d timers in %zu groups. Tag queue: %.1f ns per firing. Timer table: %.1f ns per firing.\n",
+         NUMBER_OF_TIMERS, number_of_groups, (double)queue_time / firings_by_queue,
+         (double)table_time / firings_by_table);
+  return 0;
+}
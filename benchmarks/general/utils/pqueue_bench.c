@@ -0,0 +1,186 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the priority queues of the runtime in a hold model.
+ *
+ * Each operation pops the least element of a queue that holds HOLD elements and inserts
+ * it again with a later priority. This compares the tag queue with the tag heap, the event
+ * queue comparing tags with lf_tag_compare() with the one using lf_tag_compare_inline(),
+ * and the reaction queue with the reaction heap. The program checks that each pair pops
+ * the same last element.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "core/utils/impl/reaction_heap.h"
+#include "core/utils/impl/tag_heap.h"
+#include "low_level_platform.h"
+#include "pqueue.h"
+#include "pqueue_tag.h"
+#include "rand_utils.h"
+#include "tag.h"
+#include "util.h"
+
+#ifndef HOLD
+#define HOLD 1000
+#endif
+#ifndef OPERATIONS
+#define OPERATIONS 200000
+#endif
+
+/** Return a random tag that is not before the given one. */
+static tag_t random_tag_after(tag_t tag, uint32_t* state) {
+  uint32_t r = next_random(state);
+  if (r % 4 == 0) {
+    return (tag_t){.time = tag.time, .microstep = tag.microstep + 1};
+  }
+  return (tag_t){.time = tag.time + (instant_t)(r % 1000), .microstep = 0};
+}
+
+static void benchmark_tag_queues(void) {
+  // Hold model: pop the least tag and insert an element with a later tag, with HOLD elements in the queue.
+  pqueue_tag_element_t* elements = (pqueue_tag_element_t*)calloc(HOLD, sizeof(pqueue_tag_element_t));
+  tag_t popped_by_queue = NEVER_TAG;
+  tag_t popped_by_heap = NEVER_TAG;
+
+  uint32_t state = 1830;
+  pqueue_tag_t* q = pqueue_tag_init(HOLD);
+  for (size_t i = 0; i < HOLD; i++) {
+    elements[i].tag = random_tag_after(NEVER_TAG, &state);
+    pqueue_tag_insert(q, &elements[i]);
+  }
+  instant_t start = lf_time_physical();
+  for (size_t i = 0; i < OPERATIONS; i++) {
+    pqueue_tag_element_t* e = pqueue_tag_pop(q);
+    popped_by_queue = e->tag;
+    e->tag = random_tag_after(e->tag, &state);
+    pqueue_tag_insert(q, e);
+  }
+  interval_t queue_time = lf_time_physical() - start;
+  pqueue_tag_free(q);
+
+  state = 1830;
+  tag_heap_t h;
+  tag_heap_initialize(&h, HOLD);
+  for (size_t i = 0; i < HOLD; i++) {
+    elements[i].tag = random_tag_after(NEVER_TAG, &state);
+    tag_heap_insert(&h, elements[i].tag, &elements[i]);
+  }
+  start = lf_time_physical();
+  for (size_t i = 0; i < OPERATIONS; i++) {
+    pqueue_tag_element_t* e = tag_heap_pop(&h);
+    popped_by_heap = e->tag;
+    e->tag = random_tag_after(e->tag, &state);
+    tag_heap_insert(&h, e->tag, e);
+  }
+  interval_t heap_time = lf_time_physical() - start;
+  tag_heap_free(&h);
+
+  LF_TEST(lf_tag_compare(popped_by_queue, popped_by_heap) == 0,
+          "The tag queue popped " PRINTF_TAG " last, and the tag heap " PRINTF_TAG ".", popped_by_queue.time,
+          popped_by_queue.microstep, popped_by_heap.time, popped_by_heap.microstep);
+  printf("Tag queue: %.1f ns per pop and insert. Tag heap: %.1f ns per pop and insert.\n",
+         (double)queue_time / OPERATIONS, (double)heap_time / OPERATIONS);
+  free(elements);
+}
+
+static pqueue_pri_t tag_element_priority(void* element) { return (pqueue_pri_t)(uintptr_t)element; }
+
+static size_t tag_element_position(void* element) { return ((pqueue_tag_element_t*)element)->pos; }
+
+static void set_tag_element_position(void* element, size_t pos) { ((pqueue_tag_element_t*)element)->pos = pos; }
+
+/** The comparison that pqueue_tag_compare() made before it used tag_inline.h: a call to lf_tag_compare(). */
+static int compare_out_of_line(pqueue_pri_t priority1, pqueue_pri_t priority2) {
+  return lf_tag_compare(((pqueue_tag_element_t*)(uintptr_t)priority1)->tag,
+                        ((pqueue_tag_element_t*)(uintptr_t)priority2)->tag);
+}
+
+/** Run the hold model on an event queue with the given comparison, and return the time it took. */
+static interval_t time_event_queue(pqueue_cmp_pri_f compare, tag_t* last_popped) {
+  pqueue_tag_element_t* elements = (pqueue_tag_element_t*)calloc(HOLD, sizeof(pqueue_tag_element_t));
+  uint32_t state = 1830;
+  pqueue_t* q = pqueue_init(HOLD, compare, tag_element_priority, tag_element_position, set_tag_element_position,
+                            NULL, NULL);
+  for (size_t i = 0; i < HOLD; i++) {
+    elements[i].tag = random_tag_after(NEVER_TAG, &state);
+    pqueue_insert(q, &elements[i]);
+  }
+  instant_t start = lf_time_physical();
+  for (size_t i = 0; i < OPERATIONS; i++) {
+    pqueue_tag_element_t* e = (pqueue_tag_element_t*)pqueue_pop(q);
+    *last_popped = e->tag;
+    e->tag = random_tag_after(e->tag, &state);
+    pqueue_insert(q, e);
+  }
+  interval_t time = lf_time_physical() - start;
+  pqueue_free(q);
+  free(elements);
+  return time;
+}
+
+static void benchmark_tag_compare(void) {
+  tag_t popped_out_of_line;
+  tag_t popped_inline;
+  interval_t out_of_line_time = time_event_queue(compare_out_of_line, &popped_out_of_line);
+  interval_t inline_time = time_event_queue(pqueue_tag_compare, &popped_inline);
+  LF_TEST(lf_tag_compare(popped_out_of_line, popped_inline) == 0,
+          "With lf_tag_compare, the event queue popped " PRINTF_TAG " last, and with lf_tag_compare_inline " PRINTF_TAG,
+          popped_out_of_line.time, popped_out_of_line.microstep, popped_inline.time, popped_inline.microstep);
+  printf("Event queue with lf_tag_compare: %.1f ns per pop and insert. With lf_tag_compare_inline: %.1f ns.\n",
+         (double)out_of_line_time / OPERATIONS, (double)inline_time / OPERATIONS);
+}
+
+static void benchmark_reaction_queues(void) {
+  // Same hold model as above, but with reactions sorted by index.
+  reaction_t* reactions = (reaction_t*)calloc(HOLD, sizeof(reaction_t));
+  index_t popped_by_queue = 0;
+  index_t popped_by_heap = 0;
+
+  uint32_t state = 1830;
+  pqueue_t* q = pqueue_init(HOLD, in_reverse_order, get_reaction_index, get_reaction_position, set_reaction_position,
+                            reaction_matches, print_reaction);
+  for (size_t i = 0; i < HOLD; i++) {
+    reactions[i].index = next_random(&state) % 1000;
+    pqueue_insert(q, &reactions[i]);
+  }
+  instant_t start = lf_time_physical();
+  for (size_t i = 0; i < OPERATIONS; i++) {
+    reaction_t* r = (reaction_t*)pqueue_pop(q);
+    popped_by_queue = r->index;
+    r->index += next_random(&state) % 1000;
+    pqueue_insert(q, r);
+  }
+  interval_t queue_time = lf_time_physical() - start;
+  pqueue_free(q);
+
+  state = 1830;
+  reaction_heap_t h;
+  reaction_heap_initialize(&h, HOLD);
+  for (size_t i = 0; i < HOLD; i++) {
+    reactions[i].index = next_random(&state) % 1000;
+    reaction_heap_insert(&h, reactions[i].index, &reactions[i]);
+  }
+  start = lf_time_physical();
+  for (size_t i = 0; i < OPERATIONS; i++) {
+    reaction_t* r = reaction_heap_pop(&h);
+    popped_by_heap = r->index;
+    r->index += next_random(&state) % 1000;
+    reaction_heap_insert(&h, r->index, r);
+  }
+  interval_t heap_time = lf_time_physical() - start;
+  reaction_heap_free(&h);
+
+  LF_TEST(popped_by_queue == popped_by_heap, "The reaction queue popped index %llu last, and the reaction heap %llu.",
+          (unsigned long long)popped_by_queue, (unsigned long long)popped_by_heap);
+  printf("Reaction queue: %.1f ns per pop and insert. Reaction heap: %.1f ns per pop and insert.\n",
+         (double)queue_time / OPERATIONS, (double)heap_time / OPERATIONS);
+  free(reactions);
+}
+
+int main(void) {
+  benchmark_tag_queues();
+  benchmark_tag_compare();
+  benchmark_reaction_queues();
+  return 0;
+}
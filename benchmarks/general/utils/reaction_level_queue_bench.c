@@ -0,0 +1,74 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the reaction level queue against the reaction priority queue.
+ *
+ * Each round triggers REACTIONS reactions at random levels and then pops them in order,
+ * as a step of the runtime does. The program checks that both queues pop the same levels.
+ */
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "low_level_platform.h"
+#include "pqueue.h"
+#include "rand_utils.h"
+#include "reaction_level_queue.h"
+#include "util.h"
+
+#ifndef REACTIONS
+#define REACTIONS 1000
+#endif
+#ifndef ROUNDS
+#define ROUNDS 200
+#endif
+
+/** The index of a reaction with no deadline at the given level. */
+#define NO_DEADLINE(level) ((((ULLONG_MAX >> 16) << 16)) | (index_t)(level))
+
+int main(void) {
+  reaction_t* reactions = (reaction_t*)calloc(REACTIONS, sizeof(reaction_t));
+  uint32_t state = 1830;
+  for (size_t i = 0; i < REACTIONS; i++) {
+    reactions[i].index = NO_DEADLINE(next_random(&state) % 50);
+  }
+  index_t sum_by_pqueue = 0;
+  index_t sum_by_level_queue = 0;
+
+  pqueue_reaction_t* p = pqueue_reaction_init(REACTIONS);
+  instant_t start = lf_time_physical();
+  for (size_t round = 0; round < ROUNDS; round++) {
+    for (size_t i = 0; i < REACTIONS; i++) {
+      pqueue_reaction_insert(p, &reactions[i]);
+    }
+    reaction_t* r;
+    while ((r = (reaction_t*)pqueue_reaction_pop(p)) != NULL) {
+      sum_by_pqueue += LF_LEVEL(r->index);
+    }
+  }
+  interval_t pqueue_time = lf_time_physical() - start;
+  pqueue_reaction_free(p);
+
+  reaction_level_queue_t* q = reaction_level_queue_init(REACTIONS);
+  start = lf_time_physical();
+  for (size_t round = 0; round < ROUNDS; round++) {
+    for (size_t i = 0; i < REACTIONS; i++) {
+      reaction_level_queue_insert(q, &reactions[i]);
+    }
+    reaction_t* r;
+    while ((r = reaction_level_queue_pop(q)) != NULL) {
+      sum_by_level_queue += LF_LEVEL(r->index);
+    }
+  }
+  interval_t level_queue_time = lf_time_physical() - start;
+  reaction_level_queue_free(q);
+  free(reactions);
+
+  if (sum_by_pqueue != sum_by_level_queue) {
+    fprintf(stderr, "The queues popped different levels.\n");
+    return 1;
+  }
+  printf("Reaction pqueue: %.1f ns per insert and pop. Reaction level queue: %.1f ns per insert and pop.\n",
+         (double)pqueue_time / (REACTIONS * ROUNDS), (double)level_queue_time / (REACTIONS * ROUNDS));
+  return 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the Swiss tables of the runtime against the hash sets and maps they replace.
+ *
+ * The sets add HOLD pointers, look each of them up, and remove them again, as the runtime does
+ * with token templates, and take any pointer out and put it back, as it does with its token
+ * recycling bin. The maps put HOLD pointers and get each of them.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "core/utils/impl/pointer_hashmap.h"
+#include "core/utils/impl/pointer_set.h"
+#include "core/utils/util.h"
+#include "hashset/hashset.h"
+#include "hashset/hashset_itr.h"
+#include "low_level_platform.h"
+
+// A map from pointers to integers.
+#define SWISS_TABLE(token) int_map##_##token
+#define K void*
+#define V int
+#define HASH_OF(key) swiss_table_hash_pointer(key)
+#define KEY_EQUAL(a, b) ((a) == (b))
+#include "core/utils/impl/swiss_table.h"
+#undef SWISS_TABLE
+#undef K
+#undef V
+#undef HASH_OF
+#undef KEY_EQUAL
+
+#ifndef HOLD
+#define HOLD 512
+#endif
+#ifndef ROUNDS
+#define ROUNDS 2000
+#endif
+
+/** Return a distinct pointer for each index. */
+static void* key_of(size_t i) { return (void*)(uintptr_t)(i * 16); }
+
+static void benchmark_sets(void) {
+  // Add HOLD pointers, look each of them up, and remove them again, as the runtime does with token templates.
+  hashset_t hashset = hashset_create(4);
+  size_t found = 0;
+  instant_t start = lf_time_physical();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (size_t i = 1; i <= HOLD; i++)
+      hashset_add(hashset, key_of(i));
+    for (size_t i = 1; i <= HOLD; i++)
+      found += hashset_is_member(hashset, key_of(i));
+    for (size_t i = 1; i <= HOLD; i++)
+      hashset_remove(hashset, key_of(i));
+  }
+  interval_t hashset_time = lf_time_physical() - start;
+
+  pointer_set_t set = {0};
+  start = lf_time_physical();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (size_t i = 1; i <= HOLD; i++)
+      pointer_set_add(&set, key_of(i));
+    for (size_t i = 1; i <= HOLD; i++)
+      found += pointer_set_contains(&set, key_of(i));
+    for (size_t i = 1; i <= HOLD; i++)
+      pointer_set_remove(&set, key_of(i));
+  }
+  interval_t set_time = lf_time_physical() - start;
+  pointer_set_free(&set);
+
+  // Take any pointer out and put it back, as the runtime does with its token recycling bin.
+  for (size_t i = 1; i <= HOLD; i++)
+    hashset_add(hashset, key_of(i));
+  start = lf_time_physical();
+  for (int r = 0; r < ROUNDS * HOLD; r++) {
+    hashset_itr_t it = hashset_iterator(hashset);
+    found += hashset_iterator_next(it) >= 0;
+    void* taken = (void*)hashset_iterator_value(it);
+    hashset_remove(hashset, taken);
+    free(it);
+    hashset_add(hashset, taken);
+  }
+  interval_t hashset_recycle_time = lf_time_physical() - start;
+  hashset_destroy(hashset);
+
+  for (size_t i = 1; i <= HOLD; i++)
+    pointer_set_add(&set, key_of(i));
+  start = lf_time_physical();
+  for (int r = 0; r < ROUNDS * HOLD; r++) {
+    void* taken = NULL;
+    found += pointer_set_remove_any(&set, &taken);
+    pointer_set_add(&set, taken);
+  }
+  interval_t set_recycle_time = lf_time_physical() - start;
+  pointer_set_free(&set);
+
+  LF_TEST(found == (size_t)4 * ROUNDS * HOLD, "The sets found %zu of the %zu pointers that were added.", found,
+          (size_t)4 * ROUNDS * HOLD);
+  double operations = (double)ROUNDS * HOLD * 3;
+  printf("Hashset: %.1f ns per add, lookup, or remove. Pointer set: %.1f ns per add, lookup, or remove.\n",
+         (double)hashset_time / operations, (double)set_time / operations);
+  printf("Hashset: %.1f ns per take and return. Pointer set: %.1f ns per take and return.\n",
+         (double)hashset_recycle_time / (ROUNDS * HOLD), (double)set_recycle_time / (ROUNDS * HOLD));
+}
+
+static void benchmark_maps(void) {
+  // The fixed-capacity hashmap cannot remove keys, so only put and get are compared.
+  int sum_of_hashmap = 0;
+  int sum_of_map = 0;
+  instant_t start = lf_time_physical();
+  for (int r = 0; r < ROUNDS; r++) {
+    hashmap_object2int_t* hashmap = hashmap_object2int_new(2 * HOLD, NULL);
+    for (size_t i = 1; i <= HOLD; i++)
+      hashmap_object2int_put(hashmap, key_of(i), (int)i);
+    for (size_t i = 1; i <= HOLD; i++)
+      sum_of_hashmap += hashmap_object2int_get(hashmap, key_of(i));
+    hashmap_object2int_free(hashmap);
+  }
+  interval_t hashmap_time = lf_time_physical() - start;
+
+  start = lf_time_physical();
+  for (int r = 0; r < ROUNDS; r++) {
+    int_map_t map;
+    int_map_initialize(&map, HOLD);
+    for (size_t i = 1; i <= HOLD; i++)
+      int_map_put(&map, key_of(i), (int)i);
+    for (size_t i = 1; i <= HOLD; i++)
+      sum_of_map += *int_map_get(&map, key_of(i));
+    int_map_free(&map);
+  }
+  interval_t map_time = lf_time_physical() - start;
+
+  LF_TEST(sum_of_hashmap == sum_of_map, "The hashmap values add up to %d, and the pointer map values to %d.",
+          sum_of_hashmap, sum_of_map);
+  double operations = (double)ROUNDS * HOLD * 2;
+  printf("Hashmap: %.1f ns per put or get. Pointer map: %.1f ns per put or get.\n",
+         (double)hashmap_time / operations, (double)map_time / operations);
+}
+
+int main(void) {
+  benchmark_sets();
+  benchmark_maps();
+  return 0;
+}
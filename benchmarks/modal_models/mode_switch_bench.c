@@ -0,0 +1,155 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of mode transitions in a modal reactor with many suspended timers.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for a modal reactor with two modes, Idle and Busy. Busy contains TIMERS timers
+ * whose offset is so large that they never fire, so they stay pending for the whole run.
+ * A reaction outside of the modes switches between the two modes with a history transition
+ * every PERIOD_NS, so that every other transition suspends all timer events of Busy and the
+ * next one resumes them. The program stops after TOGGLES transitions.
+ *
+ * Run with `-f true` to measure the cost of the transitions rather than the period.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "modes.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#if !defined(LF_SINGLE_THREADED)
+#include "scheduler.h"
+#endif
+
+#ifndef TIMERS
+#define TIMERS 10000
+#endif
+#ifndef TOGGLES
+#define TOGGLES 1000
+#endif
+#ifndef PERIOD_NS
+#define PERIOD_NS 1000000
+#endif
+
+/** A modal reactor with a toggling reaction and TIMERS timers in its Busy mode. */
+typedef struct {
+  self_base_t base;
+  int toggles;
+  reactor_mode_t modes[2];
+  trigger_t toggle_timer;
+  reaction_t* toggle_timer_reactions[1];
+  reaction_t toggle;
+  trigger_t timers[TIMERS];
+  reaction_t* timer_reactions[1];
+  reaction_t busy;
+} switch_t;
+
+static environment_t envs[1];
+static switch_t* self_switch;
+static int busy_count = 0;
+
+static void toggle_function(void* arg) {
+  switch_t* self = (switch_t*)arg;
+  reactor_mode_t* idle = &self->modes[0];
+  reactor_mode_t* busy = &self->modes[1];
+  _LF_SET_MODE_WITH_TYPE(self->base._lf__mode_state.current_mode == idle ? busy : idle, history_transition);
+  if (++self->toggles == TOGGLES) {
+    lf_request_stop();
+  }
+}
+
+static void busy_function(void* arg) {
+  (void)arg;
+  busy_count++;
+}
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, TIMERS + 1, 0, 0, 0, 0, 1, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  switch_t* self = (switch_t*)lf_new_reactor(sizeof(switch_t));
+  self_switch = self;
+  self->base.environment = env;
+  self->base.name = "switch";
+
+  self->modes[0].state = &self->base._lf__mode_state;
+  self->modes[0].name = "Idle";
+  self->modes[1].state = &self->base._lf__mode_state;
+  self->modes[1].name = "Busy";
+  self->base._lf__mode_state.parent_mode = NULL;
+  self->base._lf__mode_state.initial_mode = &self->modes[0];
+  self->base._lf__mode_state.current_mode = &self->modes[0];
+  self->base._lf__mode_state.next_mode = NULL;
+  self->base._lf__mode_state.mode_change = no_transition;
+  env->modes->modal_reactor_states[0] = &self->base._lf__mode_state;
+
+  self->toggle.function = toggle_function;
+  self->toggle.self = self;
+  self->toggle.deadline = -1;
+  self->toggle.index = 0;
+  self->toggle.name = "switch.toggle";
+  self->toggle_timer.is_timer = true;
+  self->toggle_timer.offset = PERIOD_NS;
+  self->toggle_timer.period = PERIOD_NS;
+  self->toggle_timer.reactions = self->toggle_timer_reactions;
+  self->toggle_timer_reactions[0] = &self->toggle;
+  self->toggle_timer.number_of_reactions = 1;
+  env->timer_triggers[0] = &self->toggle_timer;
+
+  self->busy.function = busy_function;
+  self->busy.self = self;
+  self->busy.deadline = -1;
+  self->busy.index = 1;
+  self->busy.name = "switch.busy";
+  self->busy.mode = &self->modes[1];
+  self->timer_reactions[0] = &self->busy;
+  for (int i = 0; i < TIMERS; i++) {
+    trigger_t* timer = &self->timers[i];
+    timer->is_timer = true;
+    // Far enough in the future to never fire, and distinct so that no two events share a tag.
+    timer->offset = SEC(3600) + i;
+    timer->period = SEC(3600);
+    timer->reactions = self->timer_reactions;
+    timer->number_of_reactions = 1;
+    timer->mode = &self->modes[1];
+    env->timer_triggers[i + 1] = timer;
+  }
+
+#if !defined(LF_SINGLE_THREADED)
+  size_t reactions_per_level[2] = {1, 1};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level, .num_reactions_per_level_size = 2};
+  lf_sched_init(env, env->num_workers, &params);
+#endif
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  if (busy_count != 0) {
+    lf_print_error_and_exit("Timers in mode Busy fired %d times, but they should never fire.", busy_count);
+  }
+  printf("timers=%d toggles=%d elapsed_ns=%lld ns_per_toggle=%.0f\n", TIMERS, self_switch->toggles,
+         (long long)elapsed, elapsed / (double)self_switch->toggles);
+  return result;
+}
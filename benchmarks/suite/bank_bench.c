@@ -0,0 +1,257 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of a big bank connected through multiports, few of which are present.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for a program in which a periodic timer triggers a source whose output multiport
+ * of width BANK is connected to a bank of BANK members, whose outputs are connected to a
+ * `@sparse` input multiport of a collector. At each tag, the source sends to a pseudo-random
+ * ACTIVE_PERCENT percent of the members, which forward to the collector. The collector reads
+ * its input with lf_multiport_iterator(). Every message carries the physical time at which
+ * it was sent, from which its receiver records the latency.
+ *
+ * Run with `-f true -o <duration> <units>`. Standard runtime options such as `-w` apply.
+ * Like other programs with sparse multiports, this cannot run with LF_PIPELINED_TAGS.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "port.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "report.h"
+#include "scheduler.h"
+
+#ifndef BANK
+#define BANK 4096
+#endif
+#ifndef ACTIVE_PERCENT
+#define ACTIVE_PERCENT 3
+#endif
+
+typedef struct {
+  token_template_t tmplt;
+  bool is_present;
+  lf_port_internal_t _base;
+  instant_t value;
+} time_port_t;
+
+/** The source, with an output multiport. */
+typedef struct {
+  self_base_t base;
+  int count;
+  int sent;
+  uint32_t random_state;
+  time_port_t out[BANK];
+  bool* out_produced[BANK];
+  int triggered_sizes[BANK];
+  trigger_t** triggers[BANK];
+  trigger_t* out_triggers[BANK][1];
+  reaction_t reaction;
+} source_t;
+
+/** A member of the bank, with one input, one output, and one reaction. */
+typedef struct {
+  self_base_t base;
+  int count;
+  time_port_t* in;
+  time_port_t out;
+  bool* out_produced[1];
+  int triggered_sizes[1];
+  trigger_t** triggers[1];
+  trigger_t* out_triggers[1];
+  reaction_t reaction;
+  trigger_t in_trigger;
+  reaction_t* in_trigger_reactions[1];
+} member_t;
+
+/** The collector, with a sparse input multiport. */
+typedef struct {
+  self_base_t base;
+  int count;
+  int received;
+  time_port_t* _lf_in[BANK];
+  int _lf_in_width;
+  lf_sparse_io_record_t* _lf_in__sparse;
+  reaction_t reaction;
+  trigger_t in_triggers[BANK];
+  reaction_t* in_trigger_reactions[1];
+} collector_t;
+
+static environment_t envs[1];
+static source_t* source;
+static member_t* members[BANK];
+static collector_t* collector;
+static reaction_t* reactions[BANK + 2];
+static trigger_t timer;
+static reaction_t* timer_reactions[1];
+
+static void source_function(void* arg) {
+  source_t* self = (source_t*)arg;
+  self->count++;
+  instant_t now = lf_time_physical();
+  for (int i = 0; i < BANK * ACTIVE_PERCENT / 100; i++) {
+    // A xorshift generator picks the channels, some of them more than once.
+    self->random_state ^= self->random_state << 13;
+    self->random_state ^= self->random_state >> 17;
+    self->random_state ^= self->random_state << 5;
+    int channel = (int)(self->random_state % BANK);
+    if (!self->out[channel].is_present) {
+      self->sent++;
+    }
+    self->out[channel].value = now;
+    lf_set_present((lf_port_base_t*)&self->out[channel]);
+  }
+}
+
+static void member_function(void* arg) {
+  member_t* self = (member_t*)arg;
+  bench_record_latency(self->in->value);
+  self->count++;
+  self->out.value = lf_time_physical();
+  lf_set_present((lf_port_base_t*)&self->out);
+}
+
+static void collector_function(void* arg) {
+  collector_t* self = (collector_t*)arg;
+  self->count++;
+  lf_multiport_iterator_t i = lf_multiport_iterator(in);
+  int channel = lf_multiport_next(&i);
+  while (channel >= 0) {
+    bench_record_latency(self->_lf_in[channel]->value);
+    self->received++;
+    channel = lf_multiport_next(&i);
+  }
+}
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, 1, 0, 0, 0, 2 * BANK, 0, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+/** Initialize a reaction of the given reactor at the given level. */
+static void init_reaction(reaction_t* reaction, void* self, reaction_function_t function, int level) {
+  reaction->function = function;
+  reaction->self = self;
+  reaction->deadline = NEVER;
+  reaction->index = (index_t)level;
+  reaction->name = "reaction";
+}
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  timer.is_timer = true;
+  timer.offset = 0;
+  timer.period = MSEC(1);
+  timer.reactions = timer_reactions;
+  timer.number_of_reactions = 1;
+  env->timer_triggers[0] = &timer;
+
+  source = (source_t*)lf_new_reactor(sizeof(source_t));
+  source->base.environment = env;
+  source->base.name = "source";
+  source->random_state = 1830;
+  init_reaction(&source->reaction, source, source_function, 0);
+  source->reaction.num_outputs = BANK;
+  source->reaction.output_produced = source->out_produced;
+  source->reaction.triggered_sizes = source->triggered_sizes;
+  source->reaction.triggers = source->triggers;
+  timer_reactions[0] = &source->reaction;
+  reactions[0] = &source->reaction;
+
+  collector = (collector_t*)lf_new_reactor(sizeof(collector_t));
+  collector->base.environment = env;
+  collector->base.name = "collector";
+  init_reaction(&collector->reaction, collector, collector_function, 2);
+  collector->in_trigger_reactions[0] = &collector->reaction;
+  collector->_lf_in_width = BANK;
+  reactions[BANK + 1] = &collector->reaction;
+  // As the code generator does for a sparse multiport.
+  collector->_lf_in__sparse = (lf_sparse_io_record_t*)lf_allocate(1, sizeof(lf_sparse_io_record_t),
+                                                                  &collector->base.allocations);
+  collector->_lf_in__sparse->capacity = BANK / LF_SPARSE_CAPACITY_DIVIDER;
+  if (env->sparse_io_record_sizes.start == NULL) {
+    env->sparse_io_record_sizes = vector_new(1);
+  }
+  vector_push(&env->sparse_io_record_sizes, (void*)&collector->_lf_in__sparse->size);
+
+  for (int i = 0; i < BANK; i++) {
+    member_t* self = (member_t*)lf_new_reactor(sizeof(member_t));
+    members[i] = self;
+    self->base.environment = env;
+    self->base.name = "member";
+    init_reaction(&self->reaction, self, member_function, 1);
+    self->reaction.num_outputs = 1;
+    self->out_produced[0] = &self->out.is_present;
+    self->reaction.output_produced = self->out_produced;
+    self->triggered_sizes[0] = 1;
+    self->reaction.triggered_sizes = self->triggered_sizes;
+    self->triggers[0] = self->out_triggers;
+    self->reaction.triggers = self->triggers;
+    self->in_trigger.reactions = self->in_trigger_reactions;
+    self->in_trigger.number_of_reactions = 1;
+    self->in_trigger_reactions[0] = &self->reaction;
+    reactions[i + 1] = &self->reaction;
+
+    // Connect source.out[i] to the member.
+    source->out[i]._base.source_reactor = &source->base;
+    source->out[i]._base.destination_channel = -1;
+    source->out_produced[i] = &source->out[i].is_present;
+    source->triggered_sizes[i] = 1;
+    source->triggers[i] = source->out_triggers[i];
+    source->out_triggers[i][0] = &self->in_trigger;
+    self->in = &source->out[i];
+    env->is_present_fields[i] = &source->out[i].is_present;
+
+    // Connect the member to collector.in[i].
+    self->out._base.source_reactor = &self->base;
+    self->out._base.destination_channel = i;
+    self->out._base.sparse_record = collector->_lf_in__sparse;
+    collector->in_triggers[i].reactions = collector->in_trigger_reactions;
+    collector->in_triggers[i].number_of_reactions = 1;
+    self->out_triggers[0] = &collector->in_triggers[i];
+    collector->_lf_in[i] = &self->out;
+    env->is_present_fields[BANK + i] = &self->out.is_present;
+  }
+
+  size_t reactions_per_level[3] = {1, BANK, 1};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = 3,
+                           .reactions = reactions,
+                           .num_reactions = BANK + 2};
+  lf_sched_init(env, env->num_workers, &params);
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  long long events = source->count + collector->count;
+  for (int i = 0; i < BANK; i++) {
+    events += members[i]->count;
+  }
+  if (events - source->count - collector->count != source->sent || collector->received != source->sent) {
+    lf_print_error_and_exit("The source sent %d messages, but the members executed %lld times and the collector "
+                            "received %d messages.",
+                            source->sent, events - source->count - collector->count, collector->received);
+  }
+  bench_report("bank", events, elapsed);
+  return result;
+}
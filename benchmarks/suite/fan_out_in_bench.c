@@ -0,0 +1,233 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of a wide fan-out followed by a fan-in.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for a program in which a periodic timer triggers a source whose output multiport
+ * of width WIDTH is connected to a bank of WIDTH workers, whose outputs are connected to an
+ * input multiport of a sink. Each worker busy-waits for WORK_NS nanoseconds. Every message
+ * carries the physical time at which it was sent, from which its receiver records the latency.
+ *
+ * Run with `-f true -o <duration> <units>`. Standard runtime options such as `-w` apply.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "report.h"
+#include "scheduler.h"
+
+#ifndef WIDTH
+#define WIDTH 64
+#endif
+#ifndef WORK_NS
+#define WORK_NS 5000
+#endif
+
+typedef struct {
+  token_template_t tmplt;
+  bool is_present;
+  lf_port_internal_t _base;
+  instant_t value;
+} time_port_t;
+
+/** The source, with an output multiport. */
+typedef struct {
+  self_base_t base;
+  int count;
+  time_port_t out[WIDTH];
+  bool* out_produced[WIDTH];
+  int triggered_sizes[WIDTH];
+  trigger_t** triggers[WIDTH];
+  trigger_t* out_triggers[WIDTH][1];
+  reaction_t reaction;
+} source_t;
+
+/** A worker of the bank, with one input, one output, and one reaction. */
+typedef struct {
+  self_base_t base;
+  int count;
+  time_port_t* in;
+  time_port_t out;
+  bool* out_produced[1];
+  int triggered_sizes[1];
+  trigger_t** triggers[1];
+  trigger_t* out_triggers[1];
+  reaction_t reaction;
+  trigger_t in_trigger;
+  reaction_t* in_trigger_reactions[1];
+} worker_t;
+
+/** The sink, with an input multiport. */
+typedef struct {
+  self_base_t base;
+  int count;
+  time_port_t* in[WIDTH];
+  reaction_t reaction;
+  trigger_t in_triggers[WIDTH];
+  reaction_t* in_trigger_reactions[1];
+} sink_t;
+
+static environment_t envs[1];
+static source_t* source;
+static worker_t* workers[WIDTH];
+static sink_t* sink;
+static reaction_t* reactions[WIDTH + 2];
+static trigger_t timer;
+static reaction_t* timer_reactions[1];
+
+static void source_function(void* arg) {
+  source_t* self = (source_t*)arg;
+  self->count++;
+  instant_t now = lf_time_physical();
+  for (int i = 0; i < WIDTH; i++) {
+    self->out[i].value = now;
+    lf_set_present((lf_port_base_t*)&self->out[i]);
+  }
+}
+
+static void worker_function(void* arg) {
+  worker_t* self = (worker_t*)arg;
+  bench_record_latency(self->in->value);
+  instant_t end = lf_time_physical() + WORK_NS;
+  while (lf_time_physical() < end)
+    ;
+  self->count++;
+  self->out.value = lf_time_physical();
+  lf_set_present((lf_port_base_t*)&self->out);
+}
+
+static void sink_function(void* arg) {
+  sink_t* self = (sink_t*)arg;
+  self->count++;
+  for (int i = 0; i < WIDTH; i++) {
+    if (self->in[i]->is_present) {
+      bench_record_latency(self->in[i]->value);
+    }
+  }
+}
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, 1, 0, 0, 0, 2 * WIDTH, 0, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+/** Initialize a reaction of the given reactor at the given level. */
+static void init_reaction(reaction_t* reaction, void* self, reaction_function_t function, int level) {
+  reaction->function = function;
+  reaction->self = self;
+  reaction->deadline = NEVER;
+  reaction->index = (index_t)level;
+  reaction->name = "reaction";
+}
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  timer.is_timer = true;
+  timer.offset = 0;
+  timer.period = MSEC(1);
+  timer.reactions = timer_reactions;
+  timer.number_of_reactions = 1;
+  env->timer_triggers[0] = &timer;
+
+  source = (source_t*)lf_new_reactor(sizeof(source_t));
+  source->base.environment = env;
+  source->base.name = "source";
+  init_reaction(&source->reaction, source, source_function, 0);
+  source->reaction.num_outputs = WIDTH;
+  source->reaction.output_produced = source->out_produced;
+  source->reaction.triggered_sizes = source->triggered_sizes;
+  source->reaction.triggers = source->triggers;
+  timer_reactions[0] = &source->reaction;
+  reactions[0] = &source->reaction;
+
+  sink = (sink_t*)lf_new_reactor(sizeof(sink_t));
+  sink->base.environment = env;
+  sink->base.name = "sink";
+  init_reaction(&sink->reaction, sink, sink_function, 2);
+  sink->in_trigger_reactions[0] = &sink->reaction;
+  reactions[WIDTH + 1] = &sink->reaction;
+
+  for (int i = 0; i < WIDTH; i++) {
+    worker_t* self = (worker_t*)lf_new_reactor(sizeof(worker_t));
+    workers[i] = self;
+    self->base.environment = env;
+    self->base.name = "worker";
+    init_reaction(&self->reaction, self, worker_function, 1);
+    self->reaction.num_outputs = 1;
+    self->out_produced[0] = &self->out.is_present;
+    self->reaction.output_produced = self->out_produced;
+    self->triggered_sizes[0] = 1;
+    self->reaction.triggered_sizes = self->triggered_sizes;
+    self->triggers[0] = self->out_triggers;
+    self->reaction.triggers = self->triggers;
+    self->in_trigger.reactions = self->in_trigger_reactions;
+    self->in_trigger.number_of_reactions = 1;
+    self->in_trigger_reactions[0] = &self->reaction;
+    reactions[i + 1] = &self->reaction;
+
+    // Connect source.out[i] to the worker.
+    source->out[i]._base.source_reactor = &source->base;
+    source->out[i]._base.destination_channel = -1;
+    source->out_produced[i] = &source->out[i].is_present;
+    source->triggered_sizes[i] = 1;
+    source->triggers[i] = source->out_triggers[i];
+    source->out_triggers[i][0] = &self->in_trigger;
+    self->in = &source->out[i];
+    env->is_present_fields[i] = &source->out[i].is_present;
+
+    // Connect the worker to sink.in[i].
+    self->out._base.source_reactor = &self->base;
+    self->out._base.destination_channel = i;
+    sink->in_triggers[i].reactions = sink->in_trigger_reactions;
+    sink->in_triggers[i].number_of_reactions = 1;
+    self->out_triggers[0] = &sink->in_triggers[i];
+    sink->in[i] = &self->out;
+    env->is_present_fields[WIDTH + i] = &self->out.is_present;
+  }
+
+  size_t reactions_per_level[3] = {1, WIDTH, 1};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = 3,
+                           .reactions = reactions,
+                           .num_reactions = WIDTH + 2};
+  lf_sched_init(env, env->num_workers, &params);
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  long long events = source->count + sink->count;
+  for (int i = 0; i < WIDTH; i++) {
+    if (workers[i]->count != source->count) {
+      lf_print_error_and_exit("Worker %d executed %d times, but the source executed %d times.", i, workers[i]->count,
+                              source->count);
+    }
+    events += workers[i]->count;
+  }
+  if (sink->count != source->count) {
+    lf_print_error_and_exit("The sink executed %d times, but the source executed %d times.", sink->count,
+                            source->count);
+  }
+  bench_report("fan_out_in", events, elapsed);
+  return result;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of a ping-pong exchange between two reactors.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for the Savina ping-pong program. Ping sends a ping to Pong, Pong replies, and
+ * Ping then schedules a logical action with no delay to send the next ping one microstep
+ * later, until it has sent PINGS pings. Every message carries the physical time at which
+ * it was sent, from which its receiver records the latency.
+ *
+ * Run with `-f true`. Standard runtime options such as `-w` apply.
+ * The reaction of Ping to the reply schedules the action and requests to stop, so it is
+ * listed in the `scheduling_reactions` of `sched_params_t` for LF_PIPELINED_TAGS.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "api/schedule.h"
+#include "environment.h"
+#include "low_level_platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "report.h"
+#include "scheduler.h"
+
+#ifndef PINGS
+#define PINGS 100000
+#endif
+
+typedef struct {
+  token_template_t tmplt;
+  bool is_present;
+  lf_port_internal_t _base;
+  instant_t value;
+} time_port_t;
+
+/** Ping, with a logical action and a reaction to it and a reaction to the reply. */
+typedef struct {
+  self_base_t base;
+  int pings;
+  int replies;
+  time_port_t out;
+  time_port_t* in;
+  lf_action_base_t serve;
+  trigger_t serve_trigger;
+  reaction_t* serve_reactions[1];
+  bool* out_produced[1];
+  int triggered_sizes[1];
+  trigger_t** triggers[1];
+  trigger_t* out_triggers[1];
+  reaction_t send_reaction;
+  reaction_t receive_reaction;
+  trigger_t in_trigger;
+  reaction_t* in_trigger_reactions[1];
+} ping_t;
+
+/** Pong, with one reaction that replies to each ping. */
+typedef struct {
+  self_base_t base;
+  int count;
+  time_port_t out;
+  time_port_t* in;
+  bool* out_produced[1];
+  int triggered_sizes[1];
+  trigger_t** triggers[1];
+  trigger_t* out_triggers[1];
+  reaction_t reaction;
+  trigger_t in_trigger;
+  reaction_t* in_trigger_reactions[1];
+} pong_t;
+
+static environment_t envs[1];
+static ping_t* ping;
+static pong_t* pong;
+static reaction_t* reactions[3];
+static trigger_t start;
+static reaction_t* start_reactions[1];
+
+static void ping_send(void* arg) {
+  ping_t* self = (ping_t*)arg;
+  self->pings++;
+  self->out.value = lf_time_physical();
+  lf_set_present((lf_port_base_t*)&self->out);
+}
+
+static void ping_receive(void* arg) {
+  ping_t* self = (ping_t*)arg;
+  bench_record_latency(self->in->value);
+  self->replies++;
+  if (self->pings < PINGS) {
+    lf_schedule(&self->serve, 0);
+  } else {
+    lf_request_stop();
+  }
+}
+
+static void pong_reply(void* arg) {
+  pong_t* self = (pong_t*)arg;
+  bench_record_latency(self->in->value);
+  self->count++;
+  self->out.value = lf_time_physical();
+  lf_set_present((lf_port_base_t*)&self->out);
+}
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, 1, 0, 0, 0, 3, 0, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+/** Initialize a reaction of the given reactor at the given level. */
+static void init_reaction(reaction_t* reaction, void* self, reaction_function_t function, int level) {
+  reaction->function = function;
+  reaction->self = self;
+  reaction->deadline = NEVER;
+  reaction->index = (index_t)level;
+  reaction->name = "reaction";
+}
+
+/** Initialize the output of a reaction, which triggers the given input trigger. */
+static void init_output(reaction_t* reaction, self_base_t* self, time_port_t* out, bool** out_produced,
+                        int* triggered_sizes, trigger_t*** triggers, trigger_t** out_triggers, trigger_t* in_trigger) {
+  reaction->num_outputs = 1;
+  out_produced[0] = &out->is_present;
+  reaction->output_produced = out_produced;
+  triggered_sizes[0] = 1;
+  reaction->triggered_sizes = triggered_sizes;
+  triggers[0] = out_triggers;
+  reaction->triggers = triggers;
+  out_triggers[0] = in_trigger;
+  out->_base.source_reactor = self;
+  out->_base.destination_channel = -1;
+}
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  ping = (ping_t*)lf_new_reactor(sizeof(ping_t));
+  pong = (pong_t*)lf_new_reactor(sizeof(pong_t));
+  ping->base.environment = env;
+  ping->base.name = "ping";
+  pong->base.environment = env;
+  pong->base.name = "pong";
+
+  // Ping sends its first ping in reaction to a timer that fires once, at the start.
+  start.is_timer = true;
+  start.offset = 0;
+  start.period = 0;
+  start.reactions = start_reactions;
+  start.number_of_reactions = 1;
+  env->timer_triggers[0] = &start;
+  start_reactions[0] = &ping->send_reaction;
+
+  ping->serve_trigger.reactions = ping->serve_reactions;
+  ping->serve_trigger.number_of_reactions = 1;
+  ping->serve_trigger.last_tag = NEVER_TAG;
+  // The action has no minimum spacing.
+  ping->serve_trigger.period = -1;
+  ping->serve_reactions[0] = &ping->send_reaction;
+  ping->serve.trigger = &ping->serve_trigger;
+  ping->serve.parent = &ping->base;
+  env->is_present_fields[2] = &ping->serve.is_present;
+
+  init_reaction(&ping->send_reaction, ping, ping_send, 0);
+  init_reaction(&pong->reaction, pong, pong_reply, 1);
+  init_reaction(&ping->receive_reaction, ping, ping_receive, 2);
+  ping->receive_reaction.number = 1;
+
+  init_output(&ping->send_reaction, &ping->base, &ping->out, ping->out_produced, ping->triggered_sizes,
+              ping->triggers, ping->out_triggers, &pong->in_trigger);
+  pong->in_trigger.reactions = pong->in_trigger_reactions;
+  pong->in_trigger.number_of_reactions = 1;
+  pong->in_trigger_reactions[0] = &pong->reaction;
+  pong->in = &ping->out;
+  env->is_present_fields[0] = &ping->out.is_present;
+
+  init_output(&pong->reaction, &pong->base, &pong->out, pong->out_produced, pong->triggered_sizes, pong->triggers,
+              pong->out_triggers, &ping->in_trigger);
+  ping->in_trigger.reactions = ping->in_trigger_reactions;
+  ping->in_trigger.number_of_reactions = 1;
+  ping->in_trigger_reactions[0] = &ping->receive_reaction;
+  ping->in = &pong->out;
+  env->is_present_fields[1] = &pong->out.is_present;
+
+  reactions[0] = &ping->send_reaction;
+  reactions[1] = &pong->reaction;
+  reactions[2] = &ping->receive_reaction;
+  size_t reactions_per_level[3] = {1, 1, 1};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = 3,
+                           .reactions = reactions,
+                           .num_reactions = 3,
+                           .scheduling_reactions = &reactions[2],
+                           .num_scheduling_reactions = 1};
+  lf_sched_init(env, env->num_workers, &params);
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start_time = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start_time;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  if (ping->replies != ping->pings || pong->count != ping->pings) {
+    lf_print_error_and_exit("Ping sent %d pings and received %d replies, but Pong replied %d times.", ping->pings,
+                            ping->replies, pong->count);
+  }
+  bench_report("ping_pong", (long long)ping->pings + ping->replies + pong->count, elapsed);
+  return result;
+}
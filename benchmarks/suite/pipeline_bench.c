@@ -0,0 +1,158 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of a pipeline.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for a program in which a periodic timer triggers the first of STAGES reactors
+ * connected in a chain. Each reaction busy-waits for WORK_NS nanoseconds and then sends
+ * the physical time to the next stage, which records the latency from that time.
+ *
+ * Run with `-f true -o <duration> <units>`. Standard runtime options such as `-w` apply.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "report.h"
+#include "scheduler.h"
+
+#ifndef STAGES
+#define STAGES 8
+#endif
+#ifndef WORK_NS
+#define WORK_NS 1000
+#endif
+
+typedef struct {
+  token_template_t tmplt;
+  bool is_present;
+  lf_port_internal_t _base;
+  instant_t value;
+} time_port_t;
+
+/** A reactor with one input, one output, and one reaction. */
+typedef struct {
+  self_base_t base;
+  int count;
+  time_port_t out;
+  time_port_t* in;
+  bool* out_produced[1];
+  int triggered_sizes[1];
+  trigger_t** triggers[1];
+  trigger_t* out_triggers[1];
+  reaction_t reaction;
+  trigger_t in_trigger;
+  reaction_t* in_trigger_reactions[1];
+} stage_t;
+
+static environment_t envs[1];
+static stage_t* stages[STAGES];
+static reaction_t* reactions[STAGES];
+static trigger_t timer;
+static reaction_t* timer_reactions[1];
+
+static void stage_function(void* arg) {
+  stage_t* self = (stage_t*)arg;
+  if (self->in != NULL) {
+    bench_record_latency(self->in->value);
+  }
+  instant_t end = lf_time_physical() + WORK_NS;
+  while (lf_time_physical() < end)
+    ;
+  self->count++;
+  if (self->out_triggers[0] != NULL) {
+    self->out.value = lf_time_physical();
+    lf_set_present((lf_port_base_t*)&self->out);
+  }
+}
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, 1, 0, 0, 0, STAGES, 0, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  timer.is_timer = true;
+  timer.offset = 0;
+  timer.period = MSEC(1);
+  timer.reactions = timer_reactions;
+  timer.number_of_reactions = 1;
+  env->timer_triggers[0] = &timer;
+
+  for (int level = 0; level < STAGES; level++) {
+    stage_t* self = (stage_t*)lf_new_reactor(sizeof(stage_t));
+    stages[level] = self;
+    reactions[level] = &self->reaction;
+    self->base.environment = env;
+    self->base.name = "stage";
+    self->reaction.function = stage_function;
+    self->reaction.self = self;
+    self->reaction.deadline = NEVER;
+    self->reaction.index = (index_t)level;
+    self->reaction.name = "stage.reaction";
+    self->reaction.num_outputs = 1;
+    self->out_produced[0] = &self->out.is_present;
+    self->reaction.output_produced = self->out_produced;
+    self->triggered_sizes[0] = 1;
+    self->reaction.triggered_sizes = self->triggered_sizes;
+    self->triggers[0] = self->out_triggers;
+    self->reaction.triggers = self->triggers;
+    self->out._base.source_reactor = &self->base;
+    self->out._base.destination_channel = -1;
+    self->in_trigger.reactions = self->in_trigger_reactions;
+    self->in_trigger.number_of_reactions = 1;
+    self->in_trigger_reactions[0] = &self->reaction;
+    env->is_present_fields[level] = &self->out.is_present;
+    if (level == 0) {
+      timer_reactions[0] = &self->reaction;
+    } else {
+      stages[level - 1]->out_triggers[0] = &self->in_trigger;
+      self->in = &stages[level - 1]->out;
+    }
+  }
+
+  size_t reactions_per_level[STAGES];
+  for (int level = 0; level < STAGES; level++) {
+    reactions_per_level[level] = 1;
+  }
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = STAGES,
+                           .reactions = reactions,
+                           .num_reactions = STAGES};
+  lf_sched_init(env, env->num_workers, &params);
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  long long events = 0;
+  for (int i = 0; i < STAGES; i++) {
+    if (stages[i]->count != stages[0]->count) {
+      lf_print_error_and_exit("Stage %d executed %d times, but stage 0 executed %d times.", i, stages[i]->count,
+                              stages[0]->count);
+    }
+    events += stages[i]->count;
+  }
+  bench_report("pipeline", events, elapsed);
+  return result;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file
+ *
+ * @brief Measurements shared by the benchmarks in the suite directory. See report.h.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include "low_level_platform.h"
+#include "reactor_common.h"
+#include "report.h"
+
+/** The number of latency samples kept, a power of two. */
+#define LATENCY_SAMPLES (1 << 20)
+
+#if SCHEDULER == SCHED_ADAPTIVE
+#define SCHEDULER_NAME "ADAPTIVE"
+#elif SCHEDULER == SCHED_GEDF_NP
+#define SCHEDULER_NAME "GEDF_NP"
+#elif SCHEDULER == SCHED_GEDF_MQ
+#define SCHEDULER_NAME "GEDF_MQ"
+#elif SCHEDULER == SCHED_DATAFLOW
+#define SCHEDULER_NAME "DATAFLOW"
+#else
+#define SCHEDULER_NAME "NP"
+#endif
+
+static interval_t latencies[LATENCY_SAMPLES];
+static int number_of_latencies = 0;
+
+void bench_record_latency(instant_t produced_at) {
+  interval_t latency = lf_time_physical() - produced_at;
+  int i = lf_atomic_fetch_add(&number_of_latencies, 1);
+  latencies[i & (LATENCY_SAMPLES - 1)] = latency > 0 ? latency : 0;
+}
+
+static int compare_latencies(const void* a, const void* b) {
+  interval_t x = *(const interval_t*)a;
+  interval_t y = *(const interval_t*)b;
+  return (x > y) - (x < y);
+}
+
+/** Return the given percentile of the sorted latencies. */
+static interval_t percentile(size_t n, int p) { return n > 0 ? latencies[(n - 1) * (size_t)p / 100] : 0; }
+
+void bench_report(const char* name, long long events, interval_t elapsed) {
+  size_t n = number_of_latencies < LATENCY_SAMPLES ? (size_t)number_of_latencies : LATENCY_SAMPLES;
+  qsort(latencies, n, sizeof(interval_t), compare_latencies);
+  struct rusage usage;
+  long max_rss_kb = -1;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+    max_rss_kb = usage.ru_maxrss / 1024;
+#else
+    max_rss_kb = usage.ru_maxrss;
+#endif
+  }
+  printf("{\"benchmark\": \"%s\", \"scheduler\": \"%s\", \"workers\": %u, \"events\": %lld, \"elapsed_ns\": %lld, "
+         "\"events_per_sec\": %.0f, \"latency_p50_ns\": %lld, \"latency_p99_ns\": %lld, \"max_rss_kb\": %ld}\n",
+         name, SCHEDULER_NAME, _lf_number_of_workers, events, (long long)elapsed,
+         elapsed > 0 ? events * 1e9 / (double)elapsed : 0.0, (long long)percentile(n, 50),
+         (long long)percentile(n, 99), max_rss_kb);
+}
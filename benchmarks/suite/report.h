@@ -0,0 +1,36 @@
+/**
+ * @file
+ *
+ * @brief Measurements shared by the benchmarks in the suite directory.
+ *
+ * Each benchmark in the suite is a hand-written equivalent of the code that the Lingua Franca
+ * code generator produces for some program. It records the latency of its reactions with
+ * bench_record_latency() and ends by printing a line of JSON with bench_report(), which
+ * benchmarks/compare_builds.sh reads.
+ */
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include "tag.h"
+
+/**
+ * @brief Record the latency of a reaction that starts now and was triggered by an event
+ * produced at the given physical time.
+ *
+ * This may be called by any worker. Only the latest samples are kept if there are many.
+ * @param produced_at The physical time at which the triggering event was produced.
+ */
+void bench_record_latency(instant_t produced_at);
+
+/**
+ * @brief Print a line of JSON with the results of the benchmark.
+ *
+ * The line gives the number of events (reactions executed) per second, the median and
+ * 99th percentile of the recorded latencies, and the peak resident set size of the process.
+ * @param name The name of the benchmark.
+ * @param events The number of reactions executed.
+ * @param elapsed The physical time that the program took.
+ */
+void bench_report(const char* name, long long events, interval_t elapsed);
+
+#endif // BENCH_REPORT_H
@@ -0,0 +1,115 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of many timers with different periods and offsets.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for a program with NUMBER_OF_TIMERS reactors, each with a periodic timer that
+ * triggers a reaction that counts. Timer i has an offset of 100 * (i % 10) microseconds and a
+ * period of 1 + i % 8 milliseconds, so the firings of the timers are spread over many
+ * tags. Each reaction records as its latency how far physical time is behind logical time,
+ * which is zero when the program runs faster than real time.
+ *
+ * Run with `-o <duration> <units>`, with or without `-f true`. Standard runtime options such
+ * as `-w` apply.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "report.h"
+#include "scheduler.h"
+
+#ifndef NUMBER_OF_TIMERS
+#define NUMBER_OF_TIMERS 1024
+#endif
+
+/** A reactor with one timer and one reaction. */
+typedef struct {
+  self_base_t base;
+  int count;
+  trigger_t timer;
+  reaction_t reaction;
+  reaction_t* timer_reactions[1];
+} ticker_t;
+
+static environment_t envs[1];
+static ticker_t* tickers[NUMBER_OF_TIMERS];
+static reaction_t* reactions[NUMBER_OF_TIMERS];
+
+static void tick(void* arg) {
+  ticker_t* self = (ticker_t*)arg;
+  bench_record_latency(lf_time_logical(self->base.environment));
+  self->count++;
+}
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, NUMBER_OF_TIMERS, 0, 0, 0, 0, 0, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  for (int i = 0; i < NUMBER_OF_TIMERS; i++) {
+    ticker_t* self = (ticker_t*)lf_new_reactor(sizeof(ticker_t));
+    tickers[i] = self;
+    reactions[i] = &self->reaction;
+    self->base.environment = env;
+    self->base.name = "ticker";
+    self->reaction.function = tick;
+    self->reaction.self = self;
+    self->reaction.deadline = NEVER;
+    self->reaction.name = "ticker.reaction";
+    self->timer.is_timer = true;
+    self->timer.offset = USEC(100) * (i % 10);
+    self->timer.period = MSEC(1) * (1 + i % 8);
+    self->timer.reactions = self->timer_reactions;
+    self->timer.number_of_reactions = 1;
+    self->timer_reactions[0] = &self->reaction;
+    env->timer_triggers[i] = &self->timer;
+  }
+
+  size_t reactions_per_level[1] = {NUMBER_OF_TIMERS};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = 1,
+                           .reactions = reactions,
+                           .num_reactions = NUMBER_OF_TIMERS};
+  lf_sched_init(env, env->num_workers, &params);
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  // Every timer fires at its offset and then once per period up to and including the stop time.
+  interval_t duration = envs[0].current_tag.time - envs[0].start_tag.time;
+  long long firings = 0;
+  for (int i = 0; i < NUMBER_OF_TIMERS; i++) {
+    trigger_t* timer = &tickers[i]->timer;
+    long long expected = duration >= timer->offset ? (duration - timer->offset) / timer->period + 1 : 0;
+    if (tickers[i]->count != expected) {
+      lf_print_error_and_exit("Timer %d fired %d times, but should have fired %lld times.", i, tickers[i]->count,
+                              expected);
+    }
+    firings += tickers[i]->count;
+  }
+  bench_report("timer_storm", firings, elapsed);
+  return result;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of passing arrays between reactors in tokens.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for a program in which a periodic timer triggers a source that sends a newly
+ * allocated array of LENGTH integers with `lf_set_array()` to READERS readers. Each reader
+ * modifies the array after getting its own copy with `lf_writable_copy()`, so every tag
+ * allocates, copies, and frees READERS + 1 arrays. Each reader records the latency from the
+ * physical time at which the source sent the array.
+ *
+ * Run with `-f true -o <duration> <units>`. Standard runtime options such as `-w` apply.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "report.h"
+#include "scheduler.h"
+
+#ifndef READERS
+#define READERS 16
+#endif
+#ifndef LENGTH
+#define LENGTH 1024
+#endif
+
+/** A port that carries an array of integers in a token. */
+typedef struct {
+  token_type_t type;
+  lf_token_t* token;
+  size_t length;
+  bool is_present;
+  lf_port_internal_t _base;
+  int* value;
+} int_array_port_t;
+
+/** The source, with one output that is connected to every reader. */
+typedef struct {
+  self_base_t base;
+  int count;
+  instant_t sent_at;
+  int_array_port_t out;
+  bool* out_produced[1];
+  int triggered_sizes[1];
+  trigger_t** triggers[1];
+  trigger_t* out_triggers[READERS];
+  reaction_t reaction;
+} source_t;
+
+/** A reader, with one input and one reaction. */
+typedef struct {
+  self_base_t base;
+  int count;
+  long long sum;
+  int_array_port_t* in;
+  reaction_t reaction;
+  trigger_t in_trigger;
+  reaction_t* in_trigger_reactions[1];
+} reader_t;
+
+static environment_t envs[1];
+static source_t* source;
+static reader_t* readers[READERS];
+static reaction_t* reactions[1 + READERS];
+static trigger_t timer;
+static reaction_t* timer_reactions[1];
+
+static void send(void* arg) {
+  source_t* self = (source_t*)arg;
+  int* array = (int*)malloc(LENGTH * sizeof(int));
+  LF_ASSERT_NON_NULL(array);
+  for (int i = 0; i < LENGTH; i++) {
+    array[i] = self->count;
+  }
+  self->count++;
+  self->sent_at = lf_time_physical();
+  // What lf_set_array(out, array, LENGTH) expands to.
+  lf_set_present((lf_port_base_t*)&self->out);
+  lf_token_t* token = _lf_initialize_token_with_value((token_template_t*)&self->out, array, LENGTH);
+  self->out.token = token;
+  self->out.value = (int*)token->value;
+  self->out.length = LENGTH;
+}
+
+static void receive(void* arg) {
+  reader_t* self = (reader_t*)arg;
+  bench_record_latency(source->sent_at);
+  lf_token_t* copy = lf_writable_copy((lf_port_base_t*)self->in);
+  int* array = (int*)copy->value;
+  for (size_t i = 0; i < copy->length; i++) {
+    array[i] += (int)i;
+    self->sum += array[i];
+  }
+  self->count++;
+}
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, 1, 0, 0, 0, 1, 0, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  source = (source_t*)lf_new_reactor(sizeof(source_t));
+  source->base.environment = env;
+  source->base.name = "source";
+  source->reaction.function = send;
+  source->reaction.self = source;
+  source->reaction.deadline = NEVER;
+  source->reaction.index = 0;
+  source->reaction.name = "source.reaction";
+  source->reaction.num_outputs = 1;
+  source->out_produced[0] = &source->out.is_present;
+  source->reaction.output_produced = source->out_produced;
+  source->triggered_sizes[0] = READERS;
+  source->reaction.triggered_sizes = source->triggered_sizes;
+  source->triggers[0] = source->out_triggers;
+  source->reaction.triggers = source->triggers;
+  _lf_initialize_template((token_template_t*)&source->out, sizeof(int));
+  source->out._base.source_reactor = &source->base;
+  source->out._base.destination_channel = -1;
+  source->out._base.num_destinations = READERS;
+  env->is_present_fields[0] = &source->out.is_present;
+  reactions[0] = &source->reaction;
+
+  timer.is_timer = true;
+  timer.offset = 0;
+  timer.period = MSEC(1);
+  timer.reactions = timer_reactions;
+  timer.number_of_reactions = 1;
+  timer_reactions[0] = &source->reaction;
+  env->timer_triggers[0] = &timer;
+
+  for (int i = 0; i < READERS; i++) {
+    reader_t* self = (reader_t*)lf_new_reactor(sizeof(reader_t));
+    readers[i] = self;
+    reactions[1 + i] = &self->reaction;
+    self->base.environment = env;
+    self->base.name = "reader";
+    self->reaction.function = receive;
+    self->reaction.self = self;
+    self->reaction.deadline = NEVER;
+    self->reaction.index = 1;
+    self->reaction.name = "reader.reaction";
+    self->in = &source->out;
+    self->in_trigger.reactions = self->in_trigger_reactions;
+    self->in_trigger.number_of_reactions = 1;
+    self->in_trigger_reactions[0] = &self->reaction;
+    source->out_triggers[i] = &self->in_trigger;
+  }
+
+  size_t reactions_per_level[2] = {1, READERS};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = 2,
+                           .reactions = reactions,
+                           .num_reactions = 1 + READERS};
+  lf_sched_init(env, env->num_workers, &params);
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  // Reading the array that the source sent at step k adds k * LENGTH + LENGTH * (LENGTH - 1) / 2 to the sum.
+  long long n = source->count;
+  long long expected = LENGTH * (n * (n - 1) / 2) + n * ((long long)LENGTH * (LENGTH - 1) / 2);
+  long long events = source->count;
+  for (int i = 0; i < READERS; i++) {
+    if (readers[i]->count != source->count || readers[i]->sum != expected) {
+      lf_print_error_and_exit("Reader %d read %d arrays with sum %lld, but the source sent %d arrays with sum %lld.",
+                              i, readers[i]->count, readers[i]->sum, source->count, expected);
+    }
+    events += readers[i]->count;
+  }
+  bench_report("token", events, elapsed);
+  return result;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the threaded schedulers on a program whose critical path is short.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for a program in which a periodic timer triggers WIDTH independent chains
+ * of DEPTH reactions. In each chain, a single reaction is slow and takes SLOW_NS nanoseconds,
+ * while the others take FAST_NS. The slow reaction of chain i is at level i % DEPTH, so every
+ * level has a slow reaction but no chain has more than one. Reactions busy-wait by default.
+ * Define SLEEP to have them sleep instead, as reactions that block on I/O do, which lets the
+ * benchmark show the difference between schedulers on a machine with few cores.
+ *
+ * A scheduler that waits for all reactions of a level before starting the next level
+ * takes about DEPTH * SLOW_NS per tag, however many workers it has. With at least
+ * WIDTH workers, a scheduler that starts each reaction as soon as its own upstream
+ * reaction is done takes about SLOW_NS + (DEPTH - 1) * FAST_NS.
+ *
+ * With -DWIDTH=1 -DDEPTH=10 -DSLOW_NS=100000 -DFAST_NS=100000 -DSLEEP, the program is a uniform
+ * pipeline, whose throughput only improves with more workers if tags are pipelined
+ * (SCHEDULER=SCHED_DATAFLOW with LF_PIPELINED_TAGS).
+ *
+ * Compare schedulers with `BENCHMARK=critical_path benchmarks/compare_schedulers.sh`.
+ * Standard runtime options such as `-w` and `-o` apply.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+
+#ifndef WIDTH
+#define WIDTH 4
+#endif
+#ifndef DEPTH
+#define DEPTH 4
+#endif
+#ifndef SLOW_NS
+#define SLOW_NS 200000
+#endif
+#ifndef FAST_NS
+#define FAST_NS 1000
+#endif
+
+#define NUMBER_OF_STAGES (WIDTH * DEPTH)
+
+#if SCHEDULER == SCHED_ADAPTIVE
+#define SCHEDULER_NAME "ADAPTIVE"
+#elif SCHEDULER == SCHED_GEDF_NP
+#define SCHEDULER_NAME "GEDF_NP"
+#elif SCHEDULER == SCHED_GEDF_MQ
+#define SCHEDULER_NAME "GEDF_MQ"
+#elif SCHEDULER == SCHED_DATAFLOW
+#define SCHEDULER_NAME "DATAFLOW"
+#else
+#define SCHEDULER_NAME "NP"
+#endif
+
+typedef struct {
+  token_template_t tmplt;
+  bool is_present;
+  lf_port_internal_t _base;
+  int value;
+} int_port_t;
+
+/** A reactor with one input, one output, and one reaction. */
+typedef struct {
+  self_base_t base;
+  int count;
+  interval_t work_ns;
+  int_port_t out;
+  int_port_t* in;
+  bool* out_produced[1];
+  int triggered_sizes[1];
+  trigger_t** triggers[1];
+  trigger_t* out_triggers[1];
+  reaction_t reaction;
+  trigger_t in_trigger;
+  reaction_t* in_trigger_reactions[1];
+} stage_t;
+
+static environment_t envs[1];
+static stage_t* stages[NUMBER_OF_STAGES];
+static reaction_t* reactions[NUMBER_OF_STAGES];
+static trigger_t timer;
+static reaction_t* timer_reactions[WIDTH];
+
+static void stage_function(void* arg) {
+  stage_t* self = (stage_t*)arg;
+  int value = self->in != NULL ? self->in->value : 0;
+#ifdef SLEEP
+  lf_sleep(self->work_ns);
+#else
+  instant_t end = lf_time_physical() + self->work_ns;
+  while (lf_time_physical() < end)
+    ;
+#endif
+  self->count++;
+  if (self->out_triggers[0] != NULL) {
+    self->out.value = value + 1;
+    lf_set_present((lf_port_base_t*)&self->out);
+  }
+}
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, 1, 0, 0, 0, NUMBER_OF_STAGES, 0, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  timer.is_timer = true;
+  timer.offset = 0;
+  // Logical time does not matter, since the benchmark runs with the fast option.
+  timer.period = MSEC(1);
+  timer.reactions = timer_reactions;
+  timer.number_of_reactions = WIDTH;
+  env->timer_triggers[0] = &timer;
+
+  for (int chain = 0; chain < WIDTH; chain++) {
+    for (int level = 0; level < DEPTH; level++) {
+      stage_t* self = (stage_t*)lf_new_reactor(sizeof(stage_t));
+      stages[chain * DEPTH + level] = self;
+      reactions[chain * DEPTH + level] = &self->reaction;
+      self->base.environment = env;
+      self->base.name = "stage";
+      self->work_ns = level == chain % DEPTH ? SLOW_NS : FAST_NS;
+      self->reaction.function = stage_function;
+      self->reaction.self = self;
+      self->reaction.deadline = NEVER;
+      self->reaction.index = (index_t)level;
+      self->reaction.name = "stage.reaction";
+      self->reaction.num_outputs = 1;
+      self->out_produced[0] = &self->out.is_present;
+      self->reaction.output_produced = self->out_produced;
+      self->triggered_sizes[0] = 1;
+      self->reaction.triggered_sizes = self->triggered_sizes;
+      self->triggers[0] = self->out_triggers;
+      self->reaction.triggers = self->triggers;
+      self->out._base.source_reactor = &self->base;
+      self->out._base.destination_channel = -1;
+      self->in_trigger.reactions = self->in_trigger_reactions;
+      self->in_trigger.number_of_reactions = 1;
+      self->in_trigger_reactions[0] = &self->reaction;
+      env->is_present_fields[chain * DEPTH + level] = &self->out.is_present;
+      if (level == 0) {
+        timer_reactions[chain] = &self->reaction;
+      } else {
+        stage_t* upstream = stages[chain * DEPTH + level - 1];
+        upstream->out_triggers[0] = &self->in_trigger;
+        self->in = &upstream->out;
+      }
+    }
+  }
+
+  size_t reactions_per_level[DEPTH];
+  for (int level = 0; level < DEPTH; level++) {
+    reactions_per_level[level] = WIDTH;
+  }
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = DEPTH,
+                           .reactions = reactions,
+                           .num_reactions = NUMBER_OF_STAGES};
+  lf_sched_init(env, env->num_workers, &params);
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  for (int i = 0; i < NUMBER_OF_STAGES; i++) {
+    if (stages[i]->count != stages[0]->count) {
+      lf_print_error_and_exit("Stage %d executed %d times, but stage 0 executed %d times.", i, stages[i]->count,
+                              stages[0]->count);
+    }
+  }
+  int tags = stages[0]->count;
+  printf("scheduler=%s workers=%d width=%d depth=%d slow_ns=%d fast_ns=%d tags=%d elapsed_ns=%lld ns_per_tag=%.0f\n",
+         SCHEDULER_NAME, _lf_number_of_workers, WIDTH, DEPTH, SLOW_NS, FAST_NS, tags, (long long)elapsed,
+         tags > 0 ? (double)elapsed / tags : 0.0);
+  return result;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the threaded schedulers on a program with deadlines.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for a program in which a periodic timer triggers WIDTH independent chains
+ * of DEPTH reactions. Each reaction busy-waits for WORK_NS nanoseconds and passes an
+ * integer to the next reaction in its chain. The reactions of chain i have a deadline
+ * that grows with i, so that deadline-based schedulers have a choice to make at every level.
+ *
+ * The benchmark runs with whatever scheduler the runtime was built with, so compare
+ * schedulers by building it more than once, e.g., with benchmarks/compare_schedulers.sh.
+ * Run with `-f true` to measure throughput and without it to count deadline misses.
+ * Standard runtime options such as `-w` and `-o` apply.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+
+#ifndef WIDTH
+#define WIDTH 16
+#endif
+#ifndef DEPTH
+#define DEPTH 4
+#endif
+#ifndef WORK_NS
+#define WORK_NS 10000
+#endif
+#ifndef PERIOD_NS
+#define PERIOD_NS 1000000
+#endif
+
+#define NUMBER_OF_STAGES (WIDTH * DEPTH)
+
+#if SCHEDULER == SCHED_ADAPTIVE
+#define SCHEDULER_NAME "ADAPTIVE"
+#elif SCHEDULER == SCHED_GEDF_NP
+#define SCHEDULER_NAME "GEDF_NP"
+#elif SCHEDULER == SCHED_GEDF_MQ
+#define SCHEDULER_NAME "GEDF_MQ"
+#elif SCHEDULER == SCHED_DATAFLOW
+#define SCHEDULER_NAME "DATAFLOW"
+#else
+#define SCHEDULER_NAME "NP"
+#endif
+
+typedef struct {
+  token_template_t tmplt;
+  bool is_present;
+  lf_port_internal_t _base;
+  int value;
+} int_port_t;
+
+/** A reactor with one input, one output, and one reaction. */
+typedef struct {
+  self_base_t base;
+  int count;
+  int_port_t out;
+  int_port_t* in;
+  bool* out_produced[1];
+  int triggered_sizes[1];
+  trigger_t** triggers[1];
+  trigger_t* out_triggers[1];
+  reaction_t reaction;
+  trigger_t in_trigger;
+  reaction_t* in_trigger_reactions[1];
+} stage_t;
+
+static environment_t envs[1];
+static stage_t* stages[NUMBER_OF_STAGES];
+static reaction_t* reactions[NUMBER_OF_STAGES];
+static trigger_t timer;
+static reaction_t* timer_reactions[WIDTH];
+static int deadline_misses = 0;
+
+/** Busy-wait for WORK_NS of physical time. */
+static void work(void) {
+  instant_t end = lf_time_physical() + WORK_NS;
+  while (lf_time_physical() < end)
+    ;
+}
+
+static void stage_function(void* arg) {
+  stage_t* self = (stage_t*)arg;
+  int value = self->in != NULL ? self->in->value : 0;
+  work();
+  self->count++;
+  if (self->out_triggers[0] != NULL) {
+    self->out.value = value + 1;
+    lf_set_present((lf_port_base_t*)&self->out);
+  }
+}
+
+static void stage_deadline_violation(void* arg) {
+  lf_atomic_fetch_add(&deadline_misses, 1);
+  stage_function(arg);
+}
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, 1, 0, 0, 0, NUMBER_OF_STAGES, 0, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  timer.is_timer = true;
+  timer.offset = 0;
+  timer.period = PERIOD_NS;
+  timer.reactions = timer_reactions;
+  timer.number_of_reactions = WIDTH;
+  env->timer_triggers[0] = &timer;
+
+  for (int chain = 0; chain < WIDTH; chain++) {
+    // Deadlines range from half the period to almost the full period.
+    interval_t deadline = PERIOD_NS / 2 + chain * (PERIOD_NS / 2) / WIDTH;
+    for (int level = 0; level < DEPTH; level++) {
+      stage_t* self = (stage_t*)lf_new_reactor(sizeof(stage_t));
+      stages[chain * DEPTH + level] = self;
+      self->base.environment = env;
+      self->base.name = "stage";
+      self->reaction.function = stage_function;
+      self->reaction.self = self;
+      self->reaction.deadline = deadline;
+      self->reaction.deadline_violation_handler = stage_deadline_violation;
+      self->reaction.index = ((index_t)deadline << 16) | (index_t)level;
+      self->reaction.name = "stage.reaction";
+      self->reaction.num_outputs = 1;
+      self->out_produced[0] = &self->out.is_present;
+      self->reaction.output_produced = self->out_produced;
+      self->triggered_sizes[0] = 1;
+      self->reaction.triggered_sizes = self->triggered_sizes;
+      self->triggers[0] = self->out_triggers;
+      self->reaction.triggers = self->triggers;
+      self->out._base.source_reactor = &self->base;
+      self->out._base.destination_channel = -1;
+      self->in_trigger.reactions = self->in_trigger_reactions;
+      self->in_trigger.number_of_reactions = 1;
+      self->in_trigger_reactions[0] = &self->reaction;
+      env->is_present_fields[chain * DEPTH + level] = &self->out.is_present;
+      reactions[chain * DEPTH + level] = &self->reaction;
+      if (level == 0) {
+        timer_reactions[chain] = &self->reaction;
+      } else {
+        stage_t* upstream = stages[chain * DEPTH + level - 1];
+        upstream->out_triggers[0] = &self->in_trigger;
+        self->in = &upstream->out;
+      }
+    }
+  }
+
+  size_t reactions_per_level[DEPTH];
+  for (int level = 0; level < DEPTH; level++) {
+    reactions_per_level[level] = WIDTH;
+  }
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = DEPTH,
+                           .reactions = reactions,
+                           .num_reactions = NUMBER_OF_STAGES};
+  lf_sched_init(env, env->num_workers, &params);
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  long long executed = 0;
+  for (int i = 0; i < NUMBER_OF_STAGES; i++) {
+    if (stages[i]->count != stages[0]->count) {
+      lf_print_error_and_exit("Stage %d executed %d times, but stage 0 executed %d times.", i, stages[i]->count,
+                              stages[0]->count);
+    }
+    executed += stages[i]->count;
+  }
+  printf("scheduler=%s workers=%d width=%d depth=%d work_ns=%d tags=%d reactions=%lld deadline_misses=%d "
+         "elapsed_ns=%lld reactions_per_sec=%.0f\n",
+         SCHEDULER_NAME, _lf_number_of_workers, WIDTH, DEPTH, WORK_NS, stages[0]->count, executed, deadline_misses,
+         (long long)elapsed, executed * 1e9 / (double)elapsed);
+  return result;
+}
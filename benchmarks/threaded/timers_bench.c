@@ -0,0 +1,138 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the handling of many periodic timers.
+ *
+ * This is a hand-written equivalent of the code that the Lingua Franca code generator
+ * produces for a program with NUMBER_OF_TIMERS periodic timers, each of which triggers
+ * a reaction that does nothing but count. Timer i has a period of 1 + i % NUMBER_OF_PERIODS
+ * milliseconds and one of NUMBER_OF_PHASES offsets that are spread over one millisecond, so the
+ * timers fall into NUMBER_OF_PERIODS * NUMBER_OF_PHASES groups. Most of the time of the
+ * runtime thus goes to moving the timers to their next firing, which shows the difference
+ * between keeping them on the event queue and building the runtime with LF_TIMER_TABLE.
+ *
+ * Run with `-f true` and compare, e.g., with
+ * `BENCHMARK=timers SCHEDULERS=SCHED_NP CMAKE_ARGS=-DLF_TIMER_TABLE=1 benchmarks/compare_schedulers.sh 1`.
+ * Standard runtime options such as `-w` and `-o` apply.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "low_level_platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+
+#ifndef NUMBER_OF_TIMERS
+#define NUMBER_OF_TIMERS 4096
+#endif
+#ifndef NUMBER_OF_PERIODS
+#define NUMBER_OF_PERIODS 4
+#endif
+#ifndef NUMBER_OF_PHASES
+#define NUMBER_OF_PHASES 1
+#endif
+
+/** The number of timers that differ in period or offset. */
+#define NUMBER_OF_GROUPS (NUMBER_OF_PERIODS * NUMBER_OF_PHASES)
+
+#if SCHEDULER == SCHED_ADAPTIVE
+#define SCHEDULER_NAME "ADAPTIVE"
+#elif SCHEDULER == SCHED_GEDF_NP
+#define SCHEDULER_NAME "GEDF_NP"
+#elif SCHEDULER == SCHED_GEDF_MQ
+#define SCHEDULER_NAME "GEDF_MQ"
+#elif SCHEDULER == SCHED_DATAFLOW
+#define SCHEDULER_NAME "DATAFLOW"
+#else
+#define SCHEDULER_NAME "NP"
+#endif
+
+#ifdef LF_TIMER_TABLE
+#define TIMERS_NAME "table"
+#else
+#define TIMERS_NAME "events"
+#endif
+
+/** A reactor with one timer and one reaction. */
+typedef struct {
+  self_base_t base;
+  int count;
+  trigger_t timer;
+  reaction_t reaction;
+  reaction_t* timer_reactions[1];
+} ticker_t;
+
+static environment_t envs[1];
+static ticker_t* tickers[NUMBER_OF_TIMERS];
+static reaction_t* reactions[NUMBER_OF_TIMERS];
+
+static void tick(void* arg) { ((ticker_t*)arg)->count++; }
+
+void lf_create_environments(void) {
+  environment_init(&envs[0], "main", 0, _lf_number_of_workers, NUMBER_OF_TIMERS, 0, 0, 0, 0, 0, 0, 0, NULL);
+}
+
+int _lf_get_environments(environment_t** result) {
+  *result = envs;
+  return 1;
+}
+
+void lf_set_default_command_line_options(void) {}
+void lf_terminate_execution(environment_t* env) { (void)env; }
+void logical_tag_complete(tag_t tag) { (void)tag; }
+
+void _lf_initialize_trigger_objects(void) {
+  environment_t* env = &envs[0];
+  for (int i = 0; i < NUMBER_OF_TIMERS; i++) {
+    ticker_t* self = (ticker_t*)lf_new_reactor(sizeof(ticker_t));
+    tickers[i] = self;
+    reactions[i] = &self->reaction;
+    self->base.environment = env;
+    self->base.name = "ticker";
+    self->reaction.function = tick;
+    self->reaction.self = self;
+    self->reaction.deadline = NEVER;
+    self->reaction.name = "ticker.reaction";
+    self->timer.is_timer = true;
+    self->timer.offset = ((i / NUMBER_OF_PERIODS) % NUMBER_OF_PHASES) * (MSEC(1) / NUMBER_OF_PHASES);
+    self->timer.period = MSEC(1) * (1 + i % NUMBER_OF_PERIODS);
+    self->timer.reactions = self->timer_reactions;
+    self->timer.number_of_reactions = 1;
+    self->timer_reactions[0] = &self->reaction;
+    env->timer_triggers[i] = &self->timer;
+  }
+
+  size_t reactions_per_level[1] = {NUMBER_OF_TIMERS};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = 1,
+                           .reactions = reactions,
+                           .num_reactions = NUMBER_OF_TIMERS};
+  lf_sched_init(env, env->num_workers, &params);
+}
+
+// Defined by the runtime and, as in generated code, not declared in any header.
+int lf_reactor_c_main(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+  instant_t start = lf_time_physical();
+  int result = lf_reactor_c_main(argc, argv);
+  interval_t elapsed = lf_time_physical() - start;
+  if (!_lf_normal_termination) {
+    return result;
+  }
+  long long firings = 0;
+  for (int i = 0; i < NUMBER_OF_TIMERS; i++) {
+    if (tickers[i]->count != tickers[i % NUMBER_OF_GROUPS]->count) {
+      lf_print_error_and_exit("Timer %d fired %d times, but timer %d fired %d times.", i, tickers[i]->count,
+                              i % NUMBER_OF_GROUPS, tickers[i % NUMBER_OF_GROUPS]->count);
+    }
+    firings += tickers[i]->count;
+  }
+  printf("scheduler=%s timers=%s workers=%d number_of_timers=%d periods=%d phases=%d firings=%lld "
+         "elapsed_ns=%lld ns_per_firing=%.1f\n",
+         SCHEDULER_NAME, TIMERS_NAME, _lf_number_of_workers, NUMBER_OF_TIMERS, NUMBER_OF_PERIODS, NUMBER_OF_PHASES,
+         firings, (long long)elapsed, firings > 0 ? (double)elapsed / firings : 0.0);
+  return result;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the deque in util/deque.c against a deque that allocates a node per value.
+ *
+ * The node-per-value deque is the implementation that util/deque.c had before it was
+ * changed to a ring buffer. Both are used as a work buffer that holds about DEPTH values:
+ * each round pushes BATCH values to the back and pops BATCH values from the front.
+ * The ring buffer is measured both with single pushes and pops and with deque_push_back_n()
+ * and deque_pop_front_n(). The program checks that all variants pop the same values.
+ *
+ * Like the utilities in util/, this does not use the runtime, so time is read with timespec_get().
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "deque.h"
+
+#ifndef DEPTH
+#define DEPTH 1000
+#endif
+#ifndef BATCH
+#define BATCH 64
+#endif
+#ifndef ROUNDS
+#define ROUNDS 100000
+#endif
+
+/** A node of the node-per-value deque. */
+typedef struct list_node_t {
+  struct list_node_t* next;
+  struct list_node_t* prev;
+  void* value;
+} list_node_t;
+
+/** The node-per-value deque. */
+typedef struct {
+  list_node_t* front;
+  list_node_t* back;
+  size_t size;
+} list_deque_t;
+
+static void list_push_back(list_deque_t* d, void* value) {
+  list_node_t* n = (list_node_t*)calloc(1, sizeof(list_node_t));
+  n->value = value;
+  if (d->back == NULL) {
+    d->back = d->front = n;
+  } else {
+    d->back->next = n;
+    n->prev = d->back;
+    d->back = n;
+  }
+  d->size++;
+}
+
+static void* list_pop_front(list_deque_t* d) {
+  if (d->front == NULL) {
+    return NULL;
+  }
+  list_node_t* n = d->front;
+  void* value = n->value;
+  d->front = n->next;
+  if (d->front == NULL) {
+    d->back = NULL;
+  } else {
+    d->front->prev = NULL;
+  }
+  free(n);
+  d->size--;
+  return value;
+}
+
+/** Return the value pushed in the given position, which is never NULL. */
+static void* value_of(uintptr_t i) { return (void*)(i + 1); }
+
+static uintptr_t run_list(void) {
+  list_deque_t d = {NULL, NULL, 0};
+  uintptr_t pushed = 0, checksum = 0;
+  for (int i = 0; i < DEPTH; i++) {
+    list_push_back(&d, value_of(pushed++));
+  }
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < BATCH; i++) {
+      list_push_back(&d, value_of(pushed++));
+    }
+    for (int i = 0; i < BATCH; i++) {
+      checksum = checksum * 31 + (uintptr_t)list_pop_front(&d);
+    }
+  }
+  while (d.size > 0) {
+    list_pop_front(&d);
+  }
+  return checksum;
+}
+
+static uintptr_t run_ring(void) {
+  deque_t d;
+  deque_initialize(&d);
+  uintptr_t pushed = 0, checksum = 0;
+  for (int i = 0; i < DEPTH; i++) {
+    deque_push_back(&d, value_of(pushed++));
+  }
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < BATCH; i++) {
+      deque_push_back(&d, value_of(pushed++));
+    }
+    for (int i = 0; i < BATCH; i++) {
+      checksum = checksum * 31 + (uintptr_t)deque_pop_front(&d);
+    }
+  }
+  deque_free(&d);
+  return checksum;
+}
+
+static uintptr_t run_ring_bulk(void) {
+  deque_t d;
+  deque_initialize(&d);
+  void* batch[BATCH];
+  uintptr_t pushed = 0, checksum = 0;
+  for (int i = 0; i < DEPTH; i++) {
+    deque_push_back(&d, value_of(pushed++));
+  }
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < BATCH; i++) {
+      batch[i] = value_of(pushed++);
+    }
+    deque_push_back_n(&d, batch, BATCH);
+    size_t popped = deque_pop_front_n(&d, batch, BATCH);
+    for (size_t i = 0; i < popped; i++) {
+      checksum = checksum * 31 + (uintptr_t)batch[i];
+    }
+  }
+  deque_free(&d);
+  return checksum;
+}
+
+/** Return the current time in nanoseconds. */
+static int64_t now(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/** Run the given variant and return the elapsed time in nanoseconds. */
+static int64_t measure(uintptr_t (*run)(void), uintptr_t* checksum) {
+  int64_t start = now();
+  *checksum = run();
+  return now() - start;
+}
+
+int main(void) {
+  uintptr_t list_sum, ring_sum, bulk_sum;
+  int64_t list_ns = measure(run_list, &list_sum);
+  int64_t ring_ns = measure(run_ring, &ring_sum);
+  int64_t bulk_ns = measure(run_ring_bulk, &bulk_sum);
+  if (ring_sum != list_sum || bulk_sum != list_sum) {
+    fprintf(stderr, "The deques popped different values.\n");
+    return 1;
+  }
+  double values = (double)ROUNDS * BATCH;
+  printf("depth=%d batch=%d values=%.0f list_ns_per_value=%.2f ring_ns_per_value=%.2f bulk_ns_per_value=%.2f\n", DEPTH,
+         BATCH, values, list_ns / values, ring_ns / values, bulk_ns / values);
+  return 0;
+}
@@ -12,8 +12,10 @@
 #include "lf_types.h"
 #include <string.h>
 #include "tracepoint.h"
+#include "timer_table.h"
 #if !defined(LF_SINGLE_THREADED)
 #include "scheduler.h"
+#include "reactor_threaded.h"
 #endif
 
 //////////////////
@@ -49,6 +51,17 @@ static void environment_init_threaded(environment_t* env, int num_workers) {
   env->num_workers = num_workers;
   env->thread_ids = (lf_thread_t*)calloc(num_workers, sizeof(lf_thread_t));
   LF_ASSERT_NON_NULL(env->thread_ids);
+  env->worker_cpus = NULL;
+  // Set by lf_sched_init(), which does nothing if it is already set.
+  env->scheduler = NULL;
+  env->spin_wait_margin = lf_spin_wait_margin;
+  env->event_q_notified = 0;
+  env->wait_lag_count = 0;
+  env->wait_lag_sum = 0;
+  env->wait_lag_max = 0;
+  env->schedule_inbox = NULL;
+  env->schedule_inbox_size = 0;
+  env->schedule_inbox_waiting = 0;
   env->barrier.requestors = 0;
   env->barrier.horizon = FOREVER_TAG;
 
@@ -70,8 +83,8 @@ static void environment_init_single_threaded(environment_t* env) {
   // Reaction queue ordered first by deadline, then by level.
   // The index of the reaction holds the deadline in the 48 most significant bits,
   // the level in the 16 least significant bits.
-  env->reaction_q = pqueue_init(INITIAL_REACT_QUEUE_SIZE, in_reverse_order, get_reaction_index, get_reaction_position,
-                                set_reaction_position, reaction_matches, print_reaction);
+  env->reaction_q = reaction_level_queue_init(INITIAL_REACT_QUEUE_SIZE);
+  LF_ASSERT_NON_NULL(env->reaction_q);
 
 #else
   (void)env;
@@ -90,6 +103,8 @@ static void environment_init_modes(environment_t* env, int num_modes, int num_st
     LF_ASSERT_NON_NULL(modes->modal_reactor_states);
     modes->modal_reactor_states_size = num_modes;
     modes->triggered_reactions_request = 0;
+    modes->suspended_modes = vector_new(num_modes);
+    modes->suspended_events_size = 0;
 
     modes->state_resets_size = num_state_resets;
     if (modes->state_resets_size > 0) {
@@ -137,7 +152,10 @@ static void environment_init_federated(environment_t* env, int num_is_present_fi
 static void environment_free_threaded(environment_t* env) {
 #if !defined(LF_SINGLE_THREADED)
   free(env->thread_ids);
-  lf_sched_free(env->scheduler);
+  free(env->worker_cpus);
+  if (env->scheduler != NULL) {
+    lf_sched_free(env->scheduler);
+  }
 #else
   (void)env;
 #endif
@@ -145,7 +163,7 @@ static void environment_free_threaded(environment_t* env) {
 
 static void environment_free_single_threaded(environment_t* env) {
 #ifdef LF_SINGLE_THREADED
-  pqueue_free(env->reaction_q);
+  reaction_level_queue_free(env->reaction_q);
 #else
   (void)env;
 #endif
@@ -156,6 +174,7 @@ static void environment_free_modes(environment_t* env) {
   if (env->modes) {
     free(env->modes->modal_reactor_states);
     free(env->modes->state_resets);
+    vector_free(&env->modes->suspended_modes);
     free(env->modes);
   }
 #else
@@ -175,7 +194,6 @@ static void environment_free_federated(environment_t* env) {
 // Functions defined in environment.h.
 
 void environment_free(environment_t* env) {
-  free(env->name);
   free(env->timer_triggers);
   free(env->startup_reactions);
   free(env->shutdown_reactions);
@@ -190,11 +208,19 @@ void environment_free(environment_t* env) {
     free(event);
   }
   pqueue_tag_free(env->recycle_q);
+  lf_timer_table_free(env->timer_table);
+  free(env->sparse_io_present_bits);
+  if (env->sparse_io_record_sizes.start != NULL) {
+    vector_free(&env->sparse_io_record_sizes);
+  }
+  free(env->watchdogs);
 
   environment_free_threaded(env);
   environment_free_single_threaded(env);
   environment_free_modes(env);
   environment_free_federated(env);
+  // Free the name last, since the scheduler may use it when it is freed.
+  free(env->name);
 }
 
 void environment_init_tags(environment_t* env, instant_t start_time, interval_t duration) {
@@ -277,9 +303,12 @@ int environment_init(environment_t* env, const char* name, int id, int num_worke
   }
 
   env->watchdogs_size = num_watchdogs;
+  env->watchdog_wheel = NULL;
   if (env->watchdogs_size > 0) {
     env->watchdogs = (watchdog_t**)calloc(env->watchdogs_size, sizeof(watchdog_t*));
     LF_ASSERT(env->watchdogs, "Out of memory");
+  } else {
+    env->watchdogs = NULL;
   }
 
   env->_lf_handle = 1;
@@ -288,6 +317,10 @@ int environment_init(environment_t* env, const char* name, int id, int num_worke
   env->event_q = pqueue_tag_init_customize(INITIAL_EVENT_QUEUE_SIZE, pqueue_tag_compare, event_matches, print_event);
   env->recycle_q =
       pqueue_tag_init_customize(INITIAL_EVENT_QUEUE_SIZE, in_no_particular_order, event_matches, print_event);
+  env->timer_table = NULL;
+  env->sparse_io_present_bits = NULL;
+  // Filled in by generated code for sparse multiports.
+  env->sparse_io_record_sizes = (vector_t){0};
 
   // Initialize functionality depending on target properties.
   environment_init_threaded(env, num_workers);
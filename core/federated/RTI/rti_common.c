@@ -9,6 +9,7 @@
  */
 #if defined STANDALONE_RTI || defined LF_ENCLAVES
 #include "rti_common.h"
+#include "tag_inline.h"
 
 /**
  * Local reference to rti_common_t instance.
@@ -98,11 +99,11 @@ tag_t earliest_future_incoming_message_tag(scheduling_node_t* e) {
   tag_t t_d = FOREVER_TAG;
   int n = rti_common->number_of_scheduling_nodes;
   for (int i = 0; i < n; i++) {
-    if (lf_tag_compare(rti_common->min_delays[i * n + e->id], FOREVER_TAG) != 0) {
+    if (lf_tag_compare_inline(rti_common->min_delays[i * n + e->id], FOREVER_TAG) != 0) {
       // Node i is upstream of e with min delay rti_common->min_delays[i * n + e->id]
       scheduling_node_t* upstream = rti_common->scheduling_nodes[i];
       // If we haven't heard from the upstream node, then assume it can send an event at the start time.
-      if (lf_tag_compare(upstream->next_event, NEVER_TAG) == 0) {
+      if (lf_tag_compare_inline(upstream->next_event, NEVER_TAG) == 0) {
         tag_t start_tag = {.time = start_time, .microstep = 0};
         upstream->next_event = start_tag;
       }
@@ -111,7 +112,7 @@ tag_t earliest_future_incoming_message_tag(scheduling_node_t* e) {
       // by (0,1). If the time part of the delay is greater than 0, then we want to ignore
       // the microstep in upstream->next_event because that microstep will have been lost.
       // Otherwise, we want preserve it and add to it. This is handled by lf_tag_add().
-      tag_t earliest_tag_from_upstream = lf_tag_add(upstream->next_event, rti_common->min_delays[i * n + e->id]);
+      tag_t earliest_tag_from_upstream = lf_tag_add_inline(upstream->next_event, rti_common->min_delays[i * n + e->id]);
 
       /* Following debug message is too verbose for normal use:
       LF_PRINT_DEBUG("RTI: Earliest next event upstream of fed/encl %d at fed/encl %d has tag " PRINTF_TAG ".",
@@ -119,7 +120,7 @@ tag_t earliest_future_incoming_message_tag(scheduling_node_t* e) {
               upstream->id,
               earliest_tag_from_upstream.time - start_time, earliest_tag_from_upstream.microstep);
       */
-      if (lf_tag_compare(earliest_tag_from_upstream, t_d) < 0) {
+      if (lf_tag_compare_inline(earliest_tag_from_upstream, t_d) < 0) {
         t_d = earliest_tag_from_upstream;
       }
     }
@@ -139,7 +140,7 @@ tag_t eimt_strict(scheduling_node_t* e) {
     if (is_in_zero_delay_cycle(upstream))
       continue;
     // If we haven't heard from the upstream node, then assume it can send an event at the start time.
-    if (lf_tag_compare(upstream->next_event, NEVER_TAG) == 0) {
+    if (lf_tag_compare_inline(upstream->next_event, NEVER_TAG) == 0) {
       tag_t start_tag = {.time = start_time, .microstep = 0};
       upstream->next_event = start_tag;
     }
@@ -147,13 +148,13 @@ tag_t eimt_strict(scheduling_node_t* e) {
     // nodes may send messages to the upstream node.
     tag_t earliest = earliest_future_incoming_message_tag(upstream);
     // If the next event of the upstream node is earlier, then use that.
-    if (lf_tag_compare(upstream->next_event, earliest) < 0) {
+    if (lf_tag_compare_inline(upstream->next_event, earliest) < 0) {
       earliest = upstream->next_event;
     }
-    tag_t earliest_tag_from_upstream = lf_delay_tag(earliest, e->immediate_upstream_delays[i]);
+    tag_t earliest_tag_from_upstream = lf_delay_tag_inline(earliest, e->immediate_upstream_delays[i]);
     LF_PRINT_DEBUG("RTI: Strict EIMT of fed/encl %d at fed/encl %d has tag " PRINTF_TAG ".", e->id, upstream->id,
                    earliest_tag_from_upstream.time - start_time, earliest_tag_from_upstream.microstep);
-    if (lf_tag_compare(earliest_tag_from_upstream, t_d) < 0) {
+    if (lf_tag_compare_inline(earliest_tag_from_upstream, t_d) < 0) {
       t_d = earliest_tag_from_upstream;
     }
   }
@@ -178,14 +179,14 @@ tag_advance_grant_t tag_advance_grant_if_safe(scheduling_node_t* e) {
     // whereas one microstep delay is encoded as 0LL.
     tag_t candidate = lf_delay_strict(upstream->completed, e->immediate_upstream_delays[j]);
 
-    if (lf_tag_compare(candidate, min_upstream_completed) < 0) {
+    if (lf_tag_compare_inline(candidate, min_upstream_completed) < 0) {
       min_upstream_completed = candidate;
     }
   }
   LF_PRINT_LOG("RTI: Minimum upstream LTC for federate/enclave %d is " PRINTF_TAG "(adjusted by after delay).", e->id,
                min_upstream_completed.time - start_time, min_upstream_completed.microstep);
-  if (lf_tag_compare(min_upstream_completed, e->last_granted) > 0 &&
-      lf_tag_compare(min_upstream_completed, e->next_event) >= 0 // The enclave has to advance its tag
+  if (lf_tag_compare_inline(min_upstream_completed, e->last_granted) > 0 &&
+      lf_tag_compare_inline(min_upstream_completed, e->next_event) >= 0 // The enclave has to advance its tag
   ) {
     result.tag = min_upstream_completed;
     return result;
@@ -211,13 +212,13 @@ tag_advance_grant_t tag_advance_grant_if_safe(scheduling_node_t* e) {
   //     and the federate is part of a zero-delay cycle (ZDC).  Grant a PTAG.
   //  3) Otherwise, grant nothing and wait for further updates.
 
-  if (                                                           // Scenario (1) above
-      lf_tag_compare(t_d, e->next_event) > 0                     // EIMT greater than NET
-      && lf_tag_compare(e->next_event, NEVER_TAG) > 0            // NET is not NEVER_TAG
-      && lf_tag_compare(t_d, e->last_provisionally_granted) >= 0 // The grant is not redundant
-                                                                 // (equal is important to override any previous
-                                                                 // PTAGs).
-      && lf_tag_compare(t_d, e->last_granted) > 0                // The grant is not redundant.
+  if (                                                                  // Scenario (1) above
+      lf_tag_compare_inline(t_d, e->next_event) > 0                     // EIMT greater than NET
+      && lf_tag_compare_inline(e->next_event, NEVER_TAG) > 0            // NET is not NEVER_TAG
+      && lf_tag_compare_inline(t_d, e->last_provisionally_granted) >= 0 // The grant is not redundant
+                                                                        // (equal is important to override any previous
+                                                                        // PTAGs).
+      && lf_tag_compare_inline(t_d, e->last_granted) > 0                // The grant is not redundant.
   ) {
     // No upstream node can send events that will be received with a tag less than or equal to
     // e->next_event, so it is safe to send a TAG.
@@ -226,12 +227,12 @@ tag_advance_grant_t tag_advance_grant_if_safe(scheduling_node_t* e) {
                  e->id, t_d.time - lf_time_start(), t_d.microstep, e->next_event.time - lf_time_start(),
                  e->next_event.microstep);
     result.tag = lf_tag_latest_earlier(t_d);
-  } else if (                                                   // Scenario (2) above
-      lf_tag_compare(t_d, e->next_event) == 0                   // EIMT equal to NET
-      && is_in_zero_delay_cycle(e)                              // The node is part of a ZDC
-      && lf_tag_compare(t_d_strict, e->next_event) > 0          // The strict EIMT is greater than the NET
-      && lf_tag_compare(t_d, e->last_provisionally_granted) > 0 // The grant is not redundant
-      && lf_tag_compare(t_d, e->last_granted) > 0               // The grant is not redundant.
+  } else if (                                                          // Scenario (2) above
+      lf_tag_compare_inline(t_d, e->next_event) == 0                   // EIMT equal to NET
+      && is_in_zero_delay_cycle(e)                                     // The node is part of a ZDC
+      && lf_tag_compare_inline(t_d_strict, e->next_event) > 0          // The strict EIMT is greater than the NET
+      && lf_tag_compare_inline(t_d, e->last_provisionally_granted) > 0 // The grant is not redundant
+      && lf_tag_compare_inline(t_d, e->last_granted) > 0               // The grant is not redundant.
   ) {
     // Some upstream node may send an event that has the same tag as this node's next event,
     // so we can only grant a PTAG.
@@ -276,7 +277,7 @@ void update_scheduling_node_next_event_tag_locked(scheduling_node_t* e, tag_t ne
   // Check downstream scheduling_nodes to see whether they should now be granted a TAG.
   int n = rti_common->number_of_scheduling_nodes;
   for (int j = 0; j < n; j++) {
-    if (lf_tag_compare(rti_common->min_delays[e->id * n + j], FOREVER_TAG) != 0) {
+    if (lf_tag_compare_inline(rti_common->min_delays[e->id * n + j], FOREVER_TAG) != 0) {
       // The node j is a downstream node of e.
       scheduling_node_t* downstream = rti_common->scheduling_nodes[j];
       notify_advance_grant_if_safe(downstream);
@@ -286,11 +287,12 @@ void update_scheduling_node_next_event_tag_locked(scheduling_node_t* e, tag_t ne
   if (!rti_common->dnet_disabled) {
     // Send DNET to the node e's upstream federates if needed
     for (int i = 0; i < n; i++) {
-      if (lf_tag_compare(rti_common->min_delays[i * n + e->id], FOREVER_TAG) != 0 && i != e->id) {
+      if (lf_tag_compare_inline(rti_common->min_delays[i * n + e->id], FOREVER_TAG) != 0 && i != e->id) {
         // The node i is an upstream node of e.
         scheduling_node_t* upstream = rti_common->scheduling_nodes[i];
         tag_t dnet = downstream_next_event_tag(upstream, e->id);
-        if (lf_tag_compare(upstream->last_DNET, dnet) != 0 && lf_tag_compare(upstream->next_event, dnet) <= 0) {
+        if (lf_tag_compare_inline(upstream->last_DNET, dnet) != 0 &&
+            lf_tag_compare_inline(upstream->next_event, dnet) <= 0) {
           notify_downstream_next_event_tag(upstream, dnet);
         }
       }
@@ -300,7 +302,7 @@ void update_scheduling_node_next_event_tag_locked(scheduling_node_t* e, tag_t ne
 
 void notify_advance_grant_if_safe(scheduling_node_t* e) {
   tag_advance_grant_t grant = tag_advance_grant_if_safe(e);
-  if (lf_tag_compare(grant.tag, NEVER_TAG) != 0) {
+  if (lf_tag_compare_inline(grant.tag, NEVER_TAG) != 0) {
     if (grant.is_provisional) {
       notify_provisional_tag_advance_grant(e, grant.tag);
     } else {
@@ -337,10 +339,10 @@ static void _update_min_delays_upstream(scheduling_node_t* end, scheduling_node_
     // NOT delay_from_intermediate_so_far + intermediate->upstream_delay[i].
     // Before calculating path delay, convert intermediate->upstream_delay[i] to a tag
     // cause there is no function that adds a tag to an interval.
-    tag_t connection_delay = lf_delay_tag(ZERO_TAG, intermediate->immediate_upstream_delays[i]);
-    tag_t path_delay = lf_tag_add(connection_delay, delay_from_intermediate_so_far);
+    tag_t connection_delay = lf_delay_tag_inline(ZERO_TAG, intermediate->immediate_upstream_delays[i]);
+    tag_t path_delay = lf_tag_add_inline(connection_delay, delay_from_intermediate_so_far);
     // If the path delay is less than the so-far recorded path delay from upstream, update upstream.
-    if (lf_tag_compare(path_delay, path_delays[intermediate->immediate_upstreams[i]]) < 0) {
+    if (lf_tag_compare_inline(path_delay, path_delays[intermediate->immediate_upstreams[i]]) < 0) {
       if (path_delays[intermediate->immediate_upstreams[i]].time == FOREVER) {
         // Found a finite path.
         *count = *count + 1;
@@ -356,7 +358,7 @@ static void _update_min_delays_upstream(scheduling_node_t* end, scheduling_node_
         // Found a cycle.
         end->flags = end->flags | IS_IN_CYCLE;
         // Is it a zero-delay cycle?
-        if (lf_tag_compare(path_delay, ZERO_TAG) == 0 && intermediate->immediate_upstream_delays[i] < 0) {
+        if (lf_tag_compare_inline(path_delay, ZERO_TAG) == 0 && intermediate->immediate_upstream_delays[i] < 0) {
           end->flags = end->flags | IS_IN_ZERO_DELAY_CYCLE;
         } else {
           // Clear the flag.
@@ -421,7 +423,7 @@ tag_t get_dnet_candidate(tag_t next_event_tag, tag_t minimum_delay) {
   //     ii)  If A.t >= B.t > 0 and A.m >= B.m return (A.t - B.t, UINT_MAX)
   //     iii) If A.t >= B.t > 0 and A.m < B.m return (A.t - B.t - 1, UINT_MAX)
 
-  if (next_event_tag.time == NEVER || lf_tag_compare(next_event_tag, minimum_delay) < 0)
+  if (next_event_tag.time == NEVER || lf_tag_compare_inline(next_event_tag, minimum_delay) < 0)
     return NEVER_TAG;
   if (next_event_tag.time == FOREVER)
     return FOREVER_TAG;
@@ -455,7 +457,7 @@ tag_t downstream_next_event_tag(scheduling_node_t* target_node, uint16_t node_se
   int index = target_node->id * n + node_sending_new_NET_id;
   tag_t candidate = get_dnet_candidate(node_sending_new_NET->next_event, rti_common->min_delays[index]);
 
-  if (lf_tag_compare(target_node->last_DNET, candidate) >= 0) {
+  if (lf_tag_compare_inline(target_node->last_DNET, candidate) >= 0) {
     // This function is called because a downstream node of target_node sent a new NET.
     // If the candidate computed by that downstream node is earlier than or equal to the last DNET,
     // this candidate must be the minimum among every candidate.
@@ -464,7 +466,8 @@ tag_t downstream_next_event_tag(scheduling_node_t* target_node, uint16_t node_se
     result = candidate;
   } else {
     for (int j = 0; j < n; j++) {
-      if (target_node->id != j && (lf_tag_compare(rti_common->min_delays[target_node->id * n + j], FOREVER_TAG) != 0)) {
+      if (target_node->id != j &&
+          (lf_tag_compare_inline(rti_common->min_delays[target_node->id * n + j], FOREVER_TAG) != 0)) {
         // The node j is a downstream node and not the target node itself.
         scheduling_node_t* target_dowstream = rti_common->scheduling_nodes[j];
         // if (is_in_zero_delay_cycle(target_dowstream)) {
@@ -476,7 +479,7 @@ tag_t downstream_next_event_tag(scheduling_node_t* target_node, uint16_t node_se
         tag_t delay = rti_common->min_delays[target_node->id * n + j];
         candidate = get_dnet_candidate(target_dowstream->next_event, delay);
 
-        if (lf_tag_compare(result, candidate) > 0) {
+        if (lf_tag_compare_inline(result, candidate) > 0) {
           result = candidate;
         }
       }
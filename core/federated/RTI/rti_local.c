@@ -17,6 +17,12 @@
  * 3) If the coordination logic might block. We unlock the enclave mutex while
  *  blocking, using a condition variable to unblock.
  * 4) When blocking on the coordination logic, never hold the RTI mutex.
+ *
+ * With LF_LOCAL_RTI_LOCK_FREE, the RTI mutex is not used. Instead, the following rules apply:
+ * 1) The published tags of an enclave are only written while holding its environment mutex,
+ *  so there is at most one writer of each sequence lock.
+ * 2) The next_event_mutex of an enclave is never held while acquiring another mutex.
+ * 3) An enclave waiting for a TAG holds neither its environment mutex nor the RTI mutex.
  */
 
 #ifdef LF_ENCLAVES
@@ -62,6 +68,10 @@ void initialize_local_rti(environment_t* envs, int num_envs) {
 
     enclave_info->base.state = GRANTED;
   }
+#ifdef LF_LOCAL_RTI_LOCK_FREE
+  // Compute the minimum delays between enclaves now so that they are read-only afterwards.
+  update_min_delays();
+#endif
 }
 
 void free_local_rti() {
@@ -75,10 +85,242 @@ void initialize_enclave_info(enclave_info_t* enclave, int idx, environment_t* en
   env->enclave_info = enclave;
   enclave->env = env;
 
+#ifdef LF_LOCAL_RTI_LOCK_FREE
+  LF_MUTEX_INIT(&enclave->next_event_mutex);
+  LF_COND_INIT(&enclave->next_event_condition, &enclave->next_event_mutex);
+  enclave->sequence = 0;
+  enclave->published_next_event = NEVER_TAG;
+  enclave->published_completed = NEVER_TAG;
+  enclave->waiting = 0;
+  int n = rti_local->base.number_of_scheduling_nodes;
+  enclave->snapshot_sequences = (int*)calloc(n, sizeof(int));
+  enclave->snapshot_next_events = (tag_t*)calloc(n, sizeof(tag_t));
+  enclave->snapshot_completed = (tag_t*)calloc(n, sizeof(tag_t));
+  LF_ASSERT_NON_NULL(enclave->snapshot_sequences);
+  LF_ASSERT_NON_NULL(enclave->snapshot_next_events);
+  LF_ASSERT_NON_NULL(enclave->snapshot_completed);
+#else
   // Initialize the next event condition variable.
   LF_COND_INIT(&enclave->next_event_condition, &rti_mutex);
+#endif
+}
+
+#ifdef LF_LOCAL_RTI_LOCK_FREE
+
+/**
+ * @brief Publish a tag of the enclave.
+ * The caller must hold the environment mutex of the enclave.
+ * @param enclave The enclave.
+ * @param field Either published_next_event or published_completed of the enclave.
+ * @param tag The tag to publish.
+ */
+static void publish_tag(enclave_info_t* enclave, tag_t* field, tag_t tag) {
+  lf_atomic_fetch_add(&enclave->sequence, 1);
+  *(volatile tag_t*)field = tag;
+  lf_atomic_fetch_add(&enclave->sequence, 1);
+}
+
+/**
+ * @brief Read the published tags of an enclave.
+ * @param enclave The enclave.
+ * @param next_event Where to store the published next event tag.
+ * @param completed Where to store the published latest tag complete.
+ * @return The sequence number of the published tags that were read.
+ */
+static int read_published_tags(enclave_info_t* enclave, tag_t* next_event, tag_t* completed) {
+  while (true) {
+    int sequence = lf_atomic_fetch_add(&enclave->sequence, 0);
+    if (sequence % 2 != 0) {
+      // A write is in progress.
+      continue;
+    }
+    *next_event = *(volatile tag_t*)&enclave->published_next_event;
+    *completed = *(volatile tag_t*)&enclave->published_completed;
+    if (lf_atomic_fetch_add(&enclave->sequence, 0) == sequence) {
+      return sequence;
+    }
+  }
+}
+
+/**
+ * @brief Take a consistent snapshot of the published tags of all enclaves.
+ *
+ * The published tags of all enclaves are read twice. If no sequence number changed in
+ * between, the tags read the first time were all published at the time of the second read
+ * of the first sequence number. This matters because the NET of an enclave may be lowered
+ * by an upstream enclave that then advances its own NET.
+ * @param enclave The enclave taking the snapshot, which stores it in its snapshot arrays.
+ */
+static void take_snapshot(enclave_info_t* enclave) {
+  int n = rti_local->base.number_of_scheduling_nodes;
+  bool consistent = false;
+  while (!consistent) {
+    for (int i = 0; i < n; i++) {
+      enclave->snapshot_sequences[i] =
+          read_published_tags((enclave_info_t*)rti_local->base.scheduling_nodes[i], &enclave->snapshot_next_events[i],
+                              &enclave->snapshot_completed[i]);
+    }
+    consistent = true;
+    for (int i = 0; i < n && consistent; i++) {
+      enclave_info_t* other = (enclave_info_t*)rti_local->base.scheduling_nodes[i];
+      consistent = lf_atomic_fetch_add(&other->sequence, 0) == enclave->snapshot_sequences[i];
+    }
+  }
+}
+
+/**
+ * @brief Compute a TAG for the enclave from its last snapshot.
+ *
+ * This is the part of tag_advance_grant_if_safe that applies to enclaves, which
+ * do not use PTAGs.
+ * @param e The enclave.
+ * @return The tag to grant, or NEVER_TAG if no new tag can be granted.
+ */
+static tag_t grant_from_snapshot(enclave_info_t* e) {
+  int n = rti_local->base.number_of_scheduling_nodes;
+  tag_t next_event = e->snapshot_next_events[e->base.id];
+
+  tag_t min_upstream_completed = FOREVER_TAG;
+  for (int j = 0; j < e->base.num_immediate_upstreams; j++) {
+    tag_t completed = e->snapshot_completed[e->base.immediate_upstreams[j]];
+    tag_t candidate = lf_delay_strict(completed, e->base.immediate_upstream_delays[j]);
+    if (lf_tag_compare(candidate, min_upstream_completed) < 0) {
+      min_upstream_completed = candidate;
+    }
+  }
+  if (lf_tag_compare(min_upstream_completed, e->base.last_granted) > 0 &&
+      lf_tag_compare(min_upstream_completed, next_event) >= 0) {
+    return min_upstream_completed;
+  }
+
+  // Find the earliest tag at which a message from any upstream enclave may arrive.
+  tag_t t_d = FOREVER_TAG;
+  for (int i = 0; i < n; i++) {
+    tag_t min_delay = rti_local->base.min_delays[i * n + e->base.id];
+    if (lf_tag_compare(min_delay, FOREVER_TAG) == 0) {
+      continue;
+    }
+    tag_t upstream_next_event = e->snapshot_next_events[i];
+    if (lf_tag_compare(upstream_next_event, NEVER_TAG) == 0) {
+      upstream_next_event = (tag_t){.time = lf_time_start(), .microstep = 0};
+    }
+    tag_t candidate = lf_tag_add(upstream_next_event, min_delay);
+    if (lf_tag_compare(candidate, t_d) < 0) {
+      t_d = candidate;
+    }
+  }
+  if (lf_tag_compare(t_d, next_event) > 0 && lf_tag_compare(next_event, NEVER_TAG) > 0 &&
+      lf_tag_compare(t_d, e->base.last_granted) > 0) {
+    return lf_tag_latest_earlier(t_d);
+  }
+  return NEVER_TAG;
+}
+
+/**
+ * @brief Wake up the enclave if it is waiting for a TAG.
+ * @param enclave The enclave.
+ */
+static void wake_enclave(enclave_info_t* enclave) {
+  // The enclave sets waiting before taking its snapshot, and the caller has published a tag
+  // before reading waiting, so either the snapshot contains the tag or the enclave is signaled.
+  if (*(volatile int*)&enclave->waiting) {
+    LF_MUTEX_LOCK(&enclave->next_event_mutex);
+    LF_ASSERT(lf_cond_signal(&enclave->next_event_condition) == 0, "Could not signal cond var");
+    LF_MUTEX_UNLOCK(&enclave->next_event_mutex);
+  }
+}
+
+/**
+ * @brief Wake up the enclaves downstream of the enclave that are waiting for a TAG.
+ * @param enclave The enclave that has published a tag.
+ */
+static void wake_downstream_enclaves(enclave_info_t* enclave) {
+  int n = rti_local->base.number_of_scheduling_nodes;
+  for (int j = 0; j < n; j++) {
+    tag_t min_delay = rti_local->base.min_delays[enclave->base.id * n + j];
+    if (j != enclave->base.id && lf_tag_compare(min_delay, FOREVER_TAG) != 0) {
+      wake_enclave((enclave_info_t*)rti_local->base.scheduling_nodes[j]);
+    }
+  }
+}
+
+tag_t rti_next_event_tag_locked(enclave_info_t* e, tag_t next_event_tag) {
+  LF_PRINT_LOG("RTI: enclave %u sends NET of " PRINTF_TAG " ", e->base.id, next_event_tag.time - lf_time_start(),
+               next_event_tag.microstep);
+
+  // Return early if there are only a single enclave in the program.
+  if (rti_local->base.number_of_scheduling_nodes == 1) {
+    return next_event_tag;
+  }
+  tracepoint_federate_to_rti(send_NET, e->base.id, &next_event_tag);
+  publish_tag(e, &e->published_next_event, next_event_tag);
+  wake_downstream_enclaves(e);
+
+  // If this enclave has no upstream, then we give a TAG until forever straight away.
+  if (e->base.num_immediate_upstreams == 0) {
+    LF_PRINT_LOG("RTI: enclave %u has no upstream. Giving it a TAG to FOREVER", e->base.id);
+    e->base.last_granted = FOREVER_TAG;
+  }
+
+  // Return early if we already have been granted past the NET.
+  if (lf_tag_compare(e->base.last_granted, next_event_tag) >= 0) {
+    LF_PRINT_LOG("RTI: enclave %u has already been granted a TAG to " PRINTF_TAG, e->base.id,
+                 e->base.last_granted.time - lf_time_start(), e->base.last_granted.microstep);
+    tracepoint_federate_from_rti(receive_TAG, e->base.id, &e->base.last_granted);
+    return e->base.last_granted;
+  }
+
+  // Leave the critical section of the enclave while waiting for the TAG.
+  LF_MUTEX_UNLOCK(&e->env->mutex);
+  LF_MUTEX_LOCK(&e->next_event_mutex);
+  lf_atomic_fetch_add(&e->waiting, 1);
+  tag_t granted;
+  while (true) {
+    take_snapshot(e);
+    granted = grant_from_snapshot(e);
+    if (lf_tag_compare(granted, NEVER_TAG) != 0) {
+      break;
+    }
+    LF_PRINT_LOG("RTI: enclave %u sleeps waiting for TAG to " PRINTF_TAG " ", e->base.id,
+                 next_event_tag.time - lf_time_start(), next_event_tag.microstep);
+    LF_ASSERT(lf_cond_wait(&e->next_event_condition) == 0, "Could not wait for cond var");
+  }
+  lf_atomic_fetch_add(&e->waiting, -1);
+  LF_MUTEX_UNLOCK(&e->next_event_mutex);
+  e->base.last_granted = granted;
+
+  LF_PRINT_LOG("RTI: enclave %u returns with TAG to " PRINTF_TAG " ", e->base.id, granted.time - lf_time_start(),
+               granted.microstep);
+  tracepoint_federate_from_rti(receive_TAG, e->base.id, &granted);
+  LF_MUTEX_LOCK(&e->env->mutex);
+  return granted;
+}
+
+void rti_logical_tag_complete_locked(enclave_info_t* enclave, tag_t completed) {
+  if (rti_local->base.number_of_scheduling_nodes == 1) {
+    return;
+  }
+  tracepoint_federate_to_rti(send_LTC, enclave->base.id, &completed);
+  LF_PRINT_LOG("RTI received from enclave %d the latest tag confirmed (LTC) " PRINTF_TAG ".", enclave->base.id,
+               completed.time - lf_time_start(), completed.microstep);
+  publish_tag(enclave, &enclave->published_completed, completed);
+  wake_downstream_enclaves(enclave);
 }
 
+void rti_update_other_net_locked(enclave_info_t* src, enclave_info_t* target, tag_t net) {
+  tracepoint_federate_to_federate(send_TAGGED_MSG, src->base.id, target->base.id, &net);
+
+  // If our proposed NET is less than the current NET, update it.
+  // The caller holds the environment mutex of the target, so no other thread writes its published tags.
+  if (lf_tag_compare(net, target->published_next_event) < 0) {
+    publish_tag(target, &target->published_next_event, net);
+    // A lower NET can only enable a TAG for the target itself.
+    wake_enclave(target);
+  }
+}
+
+#else // LF_LOCAL_RTI_LOCK_FREE
+
 tag_t rti_next_event_tag_locked(enclave_info_t* e, tag_t next_event_tag) {
   LF_PRINT_LOG("RTI: enclave %u sends NET of " PRINTF_TAG " ", e->base.id, next_event_tag.time - lf_time_start(),
                next_event_tag.microstep);
@@ -169,6 +411,8 @@ void rti_update_other_net_locked(enclave_info_t* src, enclave_info_t* target, ta
   LF_MUTEX_UNLOCK(rti_local->base.mutex);
 }
 
+#endif // LF_LOCAL_RTI_LOCK_FREE
+
 ///////////////////////////////////////////////////////////////////////////////
 // The local RTIs implementation of the notify functions
 ///////////////////////////////////////////////////////////////////////////////
@@ -200,9 +444,18 @@ void notify_downstream_next_event_tag(scheduling_node_t* e, tag_t tag) {
 }
 
 void free_scheduling_nodes(scheduling_node_t** scheduling_nodes, uint16_t number_of_scheduling_nodes) {
+#ifdef LF_LOCAL_RTI_LOCK_FREE
+  for (uint16_t i = 0; i < number_of_scheduling_nodes; i++) {
+    enclave_info_t* enclave = (enclave_info_t*)scheduling_nodes[i];
+    free(enclave->snapshot_sequences);
+    free(enclave->snapshot_next_events);
+    free(enclave->snapshot_completed);
+  }
+#else
   // Nothing to do here.
   SUPPRESS_UNUSED_WARNING(scheduling_nodes);
   SUPPRESS_UNUSED_WARNING(number_of_scheduling_nodes);
+#endif
 }
 
 #endif // LF_ENCLAVES
@@ -11,6 +11,15 @@
  * A scheduling enclave is portion of the runtime system that maintains its own event
  * and reaction queues and has its own scheduler. It uses a local runtime infrastructure (RTI)
  * to coordinate the advancement of tags across enclaves.
+ *
+ * By default, every next event tag (NET) and latest tag complete (LTC) of every enclave is
+ * processed while holding the single mutex of the local RTI. When compiled with
+ * `LF_LOCAL_RTI_LOCK_FREE`, each enclave instead publishes its NET and LTC in a sequence lock,
+ * and an enclave waiting for a tag advance grant (TAG) computes the grant itself from a
+ * consistent snapshot of the published tags of all enclaves. Publishing a tag only wakes up
+ * enclaves downstream that are waiting, and the mutex of the local RTI is not used.
+ * As PTAGs are not used with enclaves, zero-delay cycles between enclaves are not supported
+ * in this mode.
  */
 
 #ifndef RTI_LOCAL_H
@@ -35,6 +44,24 @@ typedef struct enclave_info_t {
   /** @brief Condition variable used by scheduling_nodes to notify an enclave that its call to next_event_tag() should
    * unblock. */
   lf_cond_t next_event_condition;
+#ifdef LF_LOCAL_RTI_LOCK_FREE
+  /** @brief Mutex of next_event_condition, which is never held while acquiring another mutex. */
+  lf_mutex_t next_event_mutex;
+  /** @brief Sequence number of the published tags, which is odd while they are being written. */
+  int sequence;
+  /** @brief The published next event tag. Only written while holding the environment mutex of the enclave. */
+  tag_t published_next_event;
+  /** @brief The published latest tag complete. Only written while holding the environment mutex of the enclave. */
+  tag_t published_completed;
+  /** @brief Nonzero while the enclave waits on next_event_condition for a TAG. */
+  int waiting;
+  /** @brief Sequence numbers of all enclaves in the last snapshot taken by this enclave. */
+  int* snapshot_sequences;
+  /** @brief Next event tags of all enclaves in the last snapshot taken by this enclave. */
+  tag_t* snapshot_next_events;
+  /** @brief Latest tags complete of all enclaves in the last snapshot taken by this enclave. */
+  tag_t* snapshot_completed;
+#endif // LF_LOCAL_RTI_LOCK_FREE
 } enclave_info_t;
 
 /**
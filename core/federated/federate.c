@@ -213,7 +213,7 @@ static void update_last_known_status_on_input_ports(tag_t tag, environment_t* en
     // Notify network input reactions
     lf_cond_broadcast(&lf_port_status_changed);
     // Could be blocked waiting for physical time to advance to the STA, so unblock that too.
-    lf_cond_broadcast(&env->event_q_changed);
+    lf_notify_of_event(env);
   }
 }
 
@@ -267,7 +267,7 @@ static void update_last_known_status_on_input_port(environment_t* env, tag_t tag
     // federate that is far ahead of other upstream federates in logical time.
     lf_update_max_level(_fed.last_TAG, _fed.is_last_TAG_provisional);
     lf_cond_broadcast(&lf_port_status_changed);
-    lf_cond_broadcast(&env->event_q_changed);
+    lf_notify_of_event(env);
   } else if (warn) {
     // Message arrivals should be monotonic, so this should not occur.
     lf_print_warning("Attempt to update the last known status tag " PRINTF_TAG
@@ -386,7 +386,7 @@ static trigger_handle_t schedule_message_received_from_network_locked(environmen
   trigger->intended_tag = previous_intended_tag;
   // Notify the main thread in case it is waiting for physical time to elapse.
   LF_PRINT_DEBUG("Broadcasting notification that event queue changed.");
-  lf_cond_broadcast(&env->event_q_changed);
+  lf_notify_of_event(env);
   return return_value;
 }
 
@@ -1005,7 +1005,7 @@ static void handle_tag_advance_grant(void) {
     return;
   }
   // Notify everything that is blocked.
-  lf_cond_broadcast(&env->event_q_changed);
+  lf_notify_of_event(env);
 
   LF_MUTEX_UNLOCK(&env->mutex);
 }
@@ -1251,7 +1251,7 @@ static void handle_provisional_tag_advance_grant() {
 
   // Even if we don't modify the event queue, we need to broadcast a change
   // because we do not need to continue to wait for a TAG.
-  lf_cond_broadcast(&env->event_q_changed);
+  lf_notify_of_event(env);
   // Notify level advance thread which is blocked.
   lf_update_max_level(_fed.last_TAG, _fed.is_last_TAG_provisional);
   lf_cond_broadcast(&lf_port_status_changed);
@@ -1343,7 +1343,7 @@ static void handle_stop_granted_message() {
 
     if (env[i].barrier.requestors)
       _lf_decrement_tag_barrier_locked(&env[i]);
-    lf_cond_broadcast(&env[i].event_q_changed);
+    lf_notify_of_event(&env[i]);
     LF_MUTEX_UNLOCK(&env[i].mutex);
   }
 }
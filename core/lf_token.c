@@ -22,7 +22,7 @@ int _lf_count_token_allocations;
 #include "lf_token.h"
 #include "environment.h"
 #include "lf_types.h"
-#include "hashset/hashset_itr.h"
+#include "impl/pointer_set.h"
 #include "util.h"
 #include "platform.h" // Enter/exit critical sections
 #include "port.h"     // Defines lf_port_base_t.
@@ -48,8 +48,9 @@ static lf_token_t* _lf_tokens_allocated_in_reactions = NULL;
 /**
  * Tokens always have the same size in memory so they are easily recycled.
  * When a token is freed, it is inserted into this recycling bin.
+ * A zero-initialized set is empty and allocates its storage on the first insertion.
  */
-static hashset_t _lf_token_recycling_bin = NULL;
+static pointer_set_t _lf_token_recycling_bin;
 
 /**
  * To allow a system to recover from burst of activity, the token recycling
@@ -62,7 +63,7 @@ static hashset_t _lf_token_recycling_bin = NULL;
  * have been initialized. This is used to free their tokens at
  * the end of program execution.
  */
-static hashset_t _lf_token_templates = NULL;
+static pointer_set_t _lf_token_templates;
 
 // Forward declarations
 static lf_token_t* _lf_writable_copy_locked(lf_port_base_t* port);
@@ -132,8 +133,15 @@ static lf_token_t* _lf_writable_copy_locked(lf_port_base_t* port) {
   result->ref_count = 1;
   // Arrange for the token to be released (and possibly freed) at
   // the start of the next time step.
+#ifdef LF_PIPELINED_TAGS
+  // The scheduler takes the copies without holding the mutex of the environment.
+  LF_CRITICAL_SECTION_ENTER(GLOBAL_ENVIRONMENT);
+#endif
   result->next = _lf_tokens_allocated_in_reactions;
   _lf_tokens_allocated_in_reactions = result;
+#ifdef LF_PIPELINED_TAGS
+  LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
+#endif
 
   return result;
 }
@@ -175,17 +183,14 @@ token_freed _lf_free_token(lf_token_t* token) {
   // output ports or actions persist until they are overwritten.
   // Need to acquire a mutex to access the recycle bin.
   LF_CRITICAL_SECTION_ENTER(GLOBAL_ENVIRONMENT);
-  if (_lf_token_recycling_bin == NULL) {
-    _lf_token_recycling_bin = hashset_create(4); // Initial size is 16.
-    if (_lf_token_recycling_bin == NULL) {
-      LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
-      lf_print_error_and_exit("Out of memory: failed to setup _lf_token_recycling_bin");
-    }
-  }
-  if (hashset_num_items(_lf_token_recycling_bin) < _LF_TOKEN_RECYCLING_BIN_SIZE_LIMIT) {
+  if (pointer_set_size(&_lf_token_recycling_bin) < _LF_TOKEN_RECYCLING_BIN_SIZE_LIMIT) {
     // Recycle instead of freeing.
     LF_PRINT_DEBUG("_lf_free_token: Putting token on the recycling bin: %p", (void*)token);
-    if (!hashset_add(_lf_token_recycling_bin, token)) {
+    int added = pointer_set_add(&_lf_token_recycling_bin, token);
+    if (added < 0) {
+      LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
+      lf_print_error_and_exit("Out of memory: failed to grow _lf_token_recycling_bin");
+    } else if (added == 0) {
       lf_print_warning("Putting token %p on the recycling bin, but it is already there!", (void*)token);
     }
   } else {
@@ -206,16 +211,12 @@ token_freed _lf_free_token(lf_token_t* token) {
 static lf_token_t* _lf_new_token_locked(token_type_t* type, void* value, size_t length) {
   lf_token_t* result = NULL;
   // Check the recycling bin.
-  if (_lf_token_recycling_bin != NULL) {
-    hashset_itr_t iterator = hashset_iterator(_lf_token_recycling_bin);
-    if (hashset_iterator_next(iterator) >= 0) {
-      result = hashset_iterator_value(iterator);
-      hashset_remove(_lf_token_recycling_bin, result);
-      // Make sure there isn't a previous value.
-      result->value = NULL;
-      LF_PRINT_DEBUG("_lf_new_token: Retrieved token from the recycling bin: %p", (void*)result);
-    }
-    free(iterator);
+  void* recycled;
+  if (pointer_set_remove_any(&_lf_token_recycling_bin, &recycled)) {
+    result = (lf_token_t*)recycled;
+    // Make sure there isn't a previous value.
+    result->value = NULL;
+    LF_PRINT_DEBUG("_lf_new_token: Retrieved token from the recycling bin: %p", (void*)result);
   }
 
 // Count the token allocation to catch memory leaks.
@@ -272,10 +273,10 @@ lf_token_t* _lf_get_token(token_template_t* tmplt) {
 void _lf_initialize_template(token_template_t* tmplt, size_t element_size) {
   assert(tmplt != NULL);
   LF_CRITICAL_SECTION_ENTER(GLOBAL_ENVIRONMENT);
-  if (_lf_token_templates == NULL) {
-    _lf_token_templates = hashset_create(4); // Initial size is 16.
+  if (pointer_set_add(&_lf_token_templates, tmplt) < 0) {
+    LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
+    lf_print_error_and_exit("Out of memory: failed to grow _lf_token_templates");
   }
-  hashset_add(_lf_token_templates, tmplt);
   LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
   if (tmplt->token != NULL) {
     if (tmplt->token->ref_count == 1 && tmplt->token->type->element_size == element_size) {
@@ -311,6 +312,18 @@ lf_token_t* _lf_initialize_token_with_value(token_template_t* tmplt, void* value
   return result;
 }
 
+lf_token_t* _lf_new_token_with_value(token_template_t* tmplt, void* value, size_t length) {
+  assert(tmplt != NULL);
+  lf_token_t* result = _lf_new_token((token_type_t*)tmplt, value, length);
+// Count allocations to issue a warning if this is never freed.
+#if !defined NDEBUG
+  LF_CRITICAL_SECTION_ENTER(GLOBAL_ENVIRONMENT);
+  _lf_count_payload_allocations++;
+  LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
+#endif
+  return result;
+}
+
 lf_token_t* _lf_initialize_token(token_template_t* tmplt, size_t length) {
   assert(tmplt != NULL);
   // Allocate memory for storing the array.
@@ -327,29 +340,22 @@ void _lf_free_all_tokens() {
   LF_CRITICAL_SECTION_ENTER(GLOBAL_ENVIRONMENT);
   // It is possible for a token to be a template token for more than one port
   // or action because the same token may be sent to multiple output ports.
-  if (_lf_token_templates != NULL) {
-    hashset_itr_t iterator = hashset_iterator(_lf_token_templates);
-    while (hashset_iterator_next(iterator) >= 0) {
-      token_template_t* tmplt = (token_template_t*)hashset_iterator_value(iterator);
-      _lf_done_using(tmplt->token);
-      tmplt->token = NULL;
-    }
-    free(iterator);
-    hashset_destroy(_lf_token_templates);
-    _lf_token_templates = NULL;
+  pointer_set_iterator_t iterator = pointer_set_iterator(&_lf_token_templates);
+  void* tmplt;
+  while (pointer_set_iterator_next(&iterator, &tmplt)) {
+    _lf_done_using(((token_template_t*)tmplt)->token);
+    ((token_template_t*)tmplt)->token = NULL;
   }
-  if (_lf_token_recycling_bin != NULL) {
-    hashset_itr_t iterator = hashset_iterator(_lf_token_recycling_bin);
-    while (hashset_iterator_next(iterator) >= 0) {
-      void* token = hashset_iterator_value(iterator);
-      LF_PRINT_DEBUG("Freeing token from _lf_token_recycling_bin: %p", token);
-      // Payload should already be freed, so we just free the token:
-      free(token);
-    }
-    free(iterator);
-    hashset_destroy(_lf_token_recycling_bin);
-    _lf_token_recycling_bin = NULL;
+  pointer_set_free(&_lf_token_templates);
+  // Tokens that _lf_done_using just recycled are in the bin now, so empty it afterwards.
+  iterator = pointer_set_iterator(&_lf_token_recycling_bin);
+  void* token;
+  while (pointer_set_iterator_next(&iterator, &token)) {
+    LF_PRINT_DEBUG("Freeing token from _lf_token_recycling_bin: %p", token);
+    // Payload should already be freed, so we just free the token:
+    free(token);
   }
+  pointer_set_free(&_lf_token_recycling_bin);
   LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
 }
 
@@ -382,10 +388,24 @@ token_freed _lf_done_using(lf_token_t* token) {
   return _lf_free_token(token);
 }
 
-void _lf_free_token_copies() {
-  while (_lf_tokens_allocated_in_reactions != NULL) {
-    lf_token_t* current = _lf_tokens_allocated_in_reactions;
-    _lf_tokens_allocated_in_reactions = _lf_tokens_allocated_in_reactions->next;
+void _lf_free_token_copies() { _lf_free_token_list(_lf_take_token_copies()); }
+
+lf_token_t* _lf_take_token_copies(void) {
+#ifdef LF_PIPELINED_TAGS
+  LF_CRITICAL_SECTION_ENTER(GLOBAL_ENVIRONMENT);
+#endif
+  lf_token_t* list = _lf_tokens_allocated_in_reactions;
+  _lf_tokens_allocated_in_reactions = NULL;
+#ifdef LF_PIPELINED_TAGS
+  LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
+#endif
+  return list;
+}
+
+void _lf_free_token_list(lf_token_t* list) {
+  while (list != NULL) {
+    lf_token_t* current = list;
+    list = list->next;
     _lf_done_using(current);
   }
 }
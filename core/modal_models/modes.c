@@ -22,6 +22,7 @@
 #include "reactor.h"
 #include "reactor_common.h"
 #include "api/schedule.h"
+#include "tracepoint.h"
 
 // Bit masks for the internally used flags on modes
 #define _LF_MODE_FLAG_MASK_ACTIVE (1 << 0)
@@ -37,69 +38,109 @@ event_t* _lf_create_dummy_events(environment_t* env, tag_t tag);
 
 // ----------------------------------------------------------------------------
 
-// Linked list element for suspended events in inactive modes
-typedef struct _lf_suspended_event {
-  struct _lf_suspended_event* next;
-  event_t* event;
-} _lf_suspended_event_t;
-_lf_suspended_event_t* _lf_suspended_events_head =
-    NULL;                         // Start of linked collection of suspended events (managed automatically!)
-int _lf_suspended_events_num = 0; // Number of suspended events (managed automatically!)
-_lf_suspended_event_t* _lf_unsused_suspended_events_head =
-    NULL; // Internal collection of reusable list elements (managed automatically!)
-
 /**
- * Save the given event as suspended.
+ * Save the given event as suspended in the mode of its trigger.
  */
-void _lf_add_suspended_event(event_t* event) {
-  _lf_suspended_event_t* new_suspended_event;
-  if (_lf_unsused_suspended_events_head != NULL) {
-    new_suspended_event = _lf_unsused_suspended_events_head;
-    _lf_unsused_suspended_events_head = _lf_unsused_suspended_events_head->next;
-  } else {
-    new_suspended_event = (_lf_suspended_event_t*)malloc(sizeof(_lf_suspended_event_t));
+void _lf_add_suspended_event(environment_t* env, event_t* event) {
+  assert(env->modes != NULL);
+  reactor_mode_t* mode = event->trigger->mode;
+  if (mode->suspended_events.start == NULL) {
+    // First suspension in this mode, register it for cleanup at termination.
+    mode->suspended_events = vector_new(8);
+    vector_push(&env->modes->suspended_modes, mode);
   }
+  vector_push(&mode->suspended_events, event);
+  env->modes->suspended_events_size++;
+}
 
-  new_suspended_event->event = event;
-  new_suspended_event->next = _lf_suspended_events_head; // prepend
-  _lf_suspended_events_num++;
+/**
+ * Compare suspended events by trigger and then by tag.
+ */
+static int _lf_compare_suspended_events(const void* a, const void* b) {
+  const event_t* e1 = *(event_t* const*)a;
+  const event_t* e2 = *(event_t* const*)b;
+  if (e1->trigger != e2->trigger) {
+    return (uintptr_t)e1->trigger < (uintptr_t)e2->trigger ? -1 : 1;
+  }
+  return lf_tag_compare(e1->base.tag, e2->base.tag);
+}
 
-  _lf_suspended_events_head = new_suspended_event;
+/**
+ * Return true if the event queue holds an event of a trigger in the given mode.
+ */
+static bool _lf_event_q_has_events_of_mode(environment_t* env, reactor_mode_t* mode) {
+  size_t q_size = pqueue_tag_size(env->event_q);
+  for (size_t i = 0; i < q_size; i++) {
+    event_t* event = (event_t*)pqueue_tag_element_at(env->event_q, i);
+    if (event != NULL && event->trigger != NULL && event->trigger->mode == mode) {
+      return true;
+    }
+  }
+  return false;
 }
 
 /**
- * Remove the given node from the list of suspended events and
- * Returns the next element in the list.
+ * Re-enqueue the given suspended events of a mode that is re-entered with history.
+ * Each event is rescheduled with the delay that remained when the mode was left.
+ *
+ * The suspended events are reused and inserted into the event queue in bulk.
+ * This is only valid if none of them collides with another event of the same
+ * trigger at the same tag, which is the common case because all events of an
+ * inactive mode are pulled from the event queue. Otherwise, each event goes
+ * through _lf_schedule_at_tag to apply the trigger's policy.
+ *
+ * @param env The environment.
+ * @param mode The mode that is re-entered.
+ * @param events The suspended events of the mode, which are reordered.
+ * @param events_size The number of events.
  */
-_lf_suspended_event_t* _lf_remove_suspended_event(_lf_suspended_event_t* event) {
-  _lf_suspended_event_t* next = event->next;
-
-  // Clear content
-  event->event = NULL;
-  event->next = NULL;
-  _lf_suspended_events_num--;
-
-  // Store for recycling
-  if (_lf_unsused_suspended_events_head == NULL) {
-    _lf_unsused_suspended_events_head = event;
-  } else {
-    event->next = _lf_unsused_suspended_events_head;
-    _lf_unsused_suspended_events_head = event;
+static void _lf_resume_suspended_events(environment_t* env, reactor_mode_t* mode, event_t** events,
+                                        size_t events_size) {
+  tag_t current_logical_tag = env->current_tag;
+  instant_t suspension_time = mode->deactivation_time != 0 ? mode->deactivation_time : lf_time_start();
+
+  for (size_t i = 0; i < events_size; i++) {
+    event_t* event = events[i];
+    // Remaining time that the event would have been waiting before mode was left
+    instant_t local_remaining_delay = event->base.tag.time - suspension_time;
+    LF_PRINT_DEBUG("Modes: Re-enqueuing event with a suspended delay of " PRINTF_TIME " (previous TTH: " PRINTF_TIME
+                   ", Mode suspended at: " PRINTF_TIME ").",
+                   local_remaining_delay, event->base.tag.time, mode->deactivation_time);
+    event->base.tag = (tag_t){.time = current_logical_tag.time + local_remaining_delay,
+                              .microstep = (local_remaining_delay == 0 ? current_logical_tag.microstep + 1 : 0)};
   }
 
-  if (_lf_suspended_events_head == event) {
-    _lf_suspended_events_head = next; // Adjust head
-  } else {
-    _lf_suspended_event_t* predecessor = _lf_suspended_events_head;
-    while (predecessor->next != event && predecessor != NULL) {
-      predecessor = predecessor->next;
+  bool collision = _lf_event_q_has_events_of_mode(env, mode);
+  if (!collision) {
+    qsort(events, events_size, sizeof(event_t*), _lf_compare_suspended_events);
+    for (size_t i = 1; i < events_size && !collision; i++) {
+      collision = _lf_compare_suspended_events(&events[i - 1], &events[i]) == 0;
     }
-    if (predecessor != NULL) {
-      predecessor->next = next; // Remove from linked list
+  }
+
+  if (collision) {
+    for (size_t i = 0; i < events_size; i++) {
+      _lf_schedule_at_tag(env, events[i]->trigger, events[i]->base.tag, events[i]->token);
+      // A fresh event was created by schedule, hence, recycle old one
+      lf_recycle_event(env, events[i]);
     }
+    return;
   }
 
-  return next;
+  // Compact the events that are still due in place and insert them all at once.
+  size_t due = 0;
+  for (size_t i = 0; i < events_size; i++) {
+    event_t* event = events[i];
+    if (lf_is_tag_after_stop_tag(env, event->base.tag)) {
+      LF_PRINT_WARNING_RATELIMITED("_lf_schedule_at_tag: event time is past the timeout. Discarding event.");
+      _lf_done_using(event->token);
+      lf_recycle_event(env, event);
+    } else {
+      tracepoint_schedule(env, event->trigger, event->base.tag.time - current_logical_tag.time);
+      events[due++] = event;
+    }
+  }
+  pqueue_tag_insert_all(env->event_q, (pqueue_tag_element_t**)events, due);
 }
 
 // ----------------------------------------------------------------------------
@@ -357,45 +398,33 @@ void _lf_process_mode_changes(environment_t* env, reactor_mode_state_t* states[]
         }
 
         // Reset/Reactivate previously suspended events of next state
-        _lf_suspended_event_t* suspended_event = _lf_suspended_events_head;
-        while (suspended_event != NULL) {
-          event_t* event = suspended_event->event;
-          if (event != NULL && event->trigger != NULL && event->trigger->mode == state->next_mode) {
-            if (state->mode_change == reset_transition) { // Reset transition
-              if (event->trigger->is_timer) {             // Only reset timers
-                trigger_t* timer = event->trigger;
-
+        reactor_mode_t* mode = state->next_mode;
+        size_t suspended_size = vector_size(&mode->suspended_events);
+        if (suspended_size > 0) {
+          event_t** suspended = (event_t**)mode->suspended_events.start;
+          env->modes->suspended_events_size -= suspended_size;
+          if (state->mode_change == reset_transition) { // Reset transition
+            for (size_t j = 0; j < suspended_size; j++) {
+              event_t* event = suspended[j];
+              if (event->trigger->is_timer) { // Only reset timers
                 LF_PRINT_DEBUG("Modes: Re-enqueuing reset timer.");
                 // Reschedule the timer with no additional delay.
                 // This will take care of super dense time when offset is 0.
-                lf_schedule_trigger(env, timer, event->trigger->offset, NULL);
+                lf_schedule_trigger(env, event->trigger, event->trigger->offset, NULL);
               }
-              // No further processing; drops all events upon reset (timer event was recreated by schedule and original
-              // can be removed here)
-            } else if (state->next_mode != state->current_mode &&
-                       event->trigger != NULL) { // History transition to a different mode
-              // Remaining time that the event would have been waiting before mode was left
-              instant_t local_remaining_delay =
-                  event->base.tag.time -
-                  (state->next_mode->deactivation_time != 0 ? state->next_mode->deactivation_time : lf_time_start());
-              tag_t current_logical_tag = env->current_tag;
-
-              // Reschedule event with original local delay
-              LF_PRINT_DEBUG("Modes: Re-enqueuing event with a suspended delay of " PRINTF_TIME
-                             " (previous TTH: " PRINTF_TIME ", Mode suspended at: " PRINTF_TIME ").",
-                             local_remaining_delay, event->base.tag.time, state->next_mode->deactivation_time);
-              tag_t schedule_tag = {.time = current_logical_tag.time + local_remaining_delay,
-                                    .microstep = (local_remaining_delay == 0 ? current_logical_tag.microstep + 1 : 0)};
-              _lf_schedule_at_tag(env, event->trigger, schedule_tag, event->token);
+              // No further processing; drops all events upon reset (timer event was recreated by schedule and
+              // original can be removed here)
+              lf_recycle_event(env, event);
             }
-            // A fresh event was created by schedule, hence, recycle old one
-            lf_recycle_event(env, event);
-
-            // Remove suspended event and continue
-            suspended_event = _lf_remove_suspended_event(suspended_event);
+          } else if (state->next_mode != state->current_mode) { // History transition to a different mode
+            _lf_resume_suspended_events(env, mode, suspended, suspended_size);
           } else {
-            suspended_event = suspended_event->next;
+            for (size_t j = 0; j < suspended_size; j++) {
+              lf_recycle_event(env, suspended[j]);
+            }
           }
+          // Keep the allocation for the next time the mode is left.
+          mode->suspended_events.next = mode->suspended_events.start;
         }
       }
     }
@@ -462,17 +491,17 @@ void _lf_process_mode_changes(environment_t* env, reactor_mode_state_t* states[]
 
         // Find events
         for (size_t i = 0; i < q_size; i++) {
-          event_t* event = (event_t*)env->event_q->d[i + 1]; // internal queue data structure omits index 0
+          event_t* event = (event_t*)pqueue_tag_element_at(env->event_q, i);
           if (event != NULL && event->trigger != NULL && !_lf_mode_is_active(event->trigger->mode)) {
             delayed_removal[delayed_removal_count++] = event;
             // This will store the event including possibly those chained up in super dense time
-            _lf_add_suspended_event(event);
+            _lf_add_suspended_event(env, event);
           }
         }
 
         // Events are removed delayed in order to allow linear iteration over the queue
-        LF_PRINT_DEBUG("Modes: Pulling %zu events from the event queue to suspend them. %d events are now suspended.",
-                       delayed_removal_count, _lf_suspended_events_num);
+        LF_PRINT_DEBUG("Modes: Pulling %zu events from the event queue to suspend them. %zu events are now suspended.",
+                       delayed_removal_count, env->modes->suspended_events_size);
         for (size_t i = 0; i < delayed_removal_count; i++) {
           pqueue_tag_remove(env->event_q, (pqueue_tag_element_t*)(delayed_removal[i]));
         }
@@ -495,24 +524,19 @@ void _lf_process_mode_changes(environment_t* env, reactor_mode_state_t* states[]
  * - Frees all suspended events.
  */
 void _lf_terminate_modal_reactors(environment_t* env) {
-  _lf_suspended_event_t* suspended_event = _lf_suspended_events_head;
-  while (suspended_event != NULL) {
-    lf_recycle_event(env, suspended_event->event);
-    _lf_suspended_event_t* next = suspended_event->next;
-    free(suspended_event);
-    suspended_event = next;
+  if (env->modes == NULL) {
+    return;
   }
-  _lf_suspended_events_head = NULL;
-  _lf_suspended_events_num = 0;
-
-  // Also free suspended_event elements stored for recycling
-  suspended_event = _lf_unsused_suspended_events_head;
-  while (suspended_event != NULL) {
-    _lf_suspended_event_t* next = suspended_event->next;
-    free(suspended_event);
-    suspended_event = next;
+  for (size_t i = 0; i < vector_size(&env->modes->suspended_modes); i++) {
+    reactor_mode_t* mode = (reactor_mode_t*)*vector_at(&env->modes->suspended_modes, i);
+    for (size_t j = 0; j < vector_size(&mode->suspended_events); j++) {
+      lf_recycle_event(env, (event_t*)*vector_at(&mode->suspended_events, j));
+    }
+    vector_free(&mode->suspended_events);
+    mode->suspended_events = (vector_t){0};
   }
-  _lf_unsused_suspended_events_head = NULL;
+  env->modes->suspended_modes.next = env->modes->suspended_modes.start;
+  env->modes->suspended_events_size = 0;
 }
 void _lf_initialize_modes(environment_t* env) {
   assert(env != GLOBAL_ENVIRONMENT);
@@ -5,25 +5,55 @@
  * @brief Header file for macros, functions, and structs for optimized sparse I/O
  * through multiports.
  */
+#include <stdint.h>
 #include <stdio.h>
 
 #include "port.h"
 #include "vector.h"
 
 /**
- * Compare two non-negative integers pointed to. Return -1 if a < b, 0 if a == b,
- * and 1 if a > b.
- * @param a Pointer to the first integer.
- * @param b Pointer to the second integer.
+ * Return the position of the least significant set bit of a nonzero word.
+ * @param word The word.
  */
-int compare_sizes(const void* a, const void* b) {
-  if (*(size_t*)a < *(size_t*)b) {
+static inline int lowest_bit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll((unsigned long long)word);
+#else
+  int bit = 0;
+  while (!(word & 1)) {
+    word >>= 1;
+    bit++;
+  }
+  return bit;
+#endif
+}
+
+/**
+ * Return the first present channel of a sparse record that is at least the given
+ * channel, or -1 if there is none.
+ * @param record The sparse record.
+ * @param channel The channel to start from.
+ * @param width The width of the multiport.
+ */
+static int next_present_channel(lf_sparse_io_record_t* record, int channel, int width) {
+  size_t word = (size_t)channel / 64;
+  size_t end = ((size_t)width + 63) / 64;
+  if (end > record->number_of_words) {
+    end = record->number_of_words;
+  }
+  if (word >= end) {
     return -1;
-  } else if (*(size_t*)a > *(size_t*)b) {
-    return 1;
-  } else {
-    return 0;
   }
+  uint64_t bits = record->present_bits[word] & (~0ULL << (channel % 64));
+  while (bits == 0) {
+    if (++word >= end) {
+      return -1;
+    }
+    bits = record->present_bits[word];
+  }
+  // NOTE: Following cast is unsafe if there more than 2^31 channels.
+  int next = (int)(word * 64) + lowest_bit(bits);
+  return next < width ? next : -1;
 }
 
 /**
@@ -44,15 +74,9 @@ lf_multiport_iterator_t _lf_multiport_iterator_impl(lf_port_base_t** port, int w
   if (width <= 0)
     return result;
   if (port[0]->sparse_record && port[0]->sparse_record->size >= 0) {
-    // Sparse record is enabled and ready to use.
+    // Sparse record is enabled and ready to use. Its bitmap gives the channels in order.
     if (port[0]->sparse_record->size > 0) {
-      // Need to sort it first (if the length is greater than 1).
-      if (port[0]->sparse_record->size > 1) {
-        qsort(&port[0]->sparse_record->present_channels[0], (size_t)port[0]->sparse_record->size, sizeof(size_t),
-              &compare_sizes);
-      }
-      // NOTE: Following cast is unsafe if there more than 2^31 channels.
-      result.next = (int)port[0]->sparse_record->present_channels[0];
+      result.next = next_present_channel(port[0]->sparse_record, 0, width);
     }
     return result;
   }
@@ -83,17 +107,11 @@ int lf_multiport_next(lf_multiport_iterator_t* iterator) {
   if (iterator->next < 0 || iterator->width <= 0) {
     return -1;
   }
-  struct lf_sparse_io_record_t* sparse_record = iterator->port[iterator->idx]->sparse_record;
+  struct lf_sparse_io_record_t* sparse_record = iterator->port[0]->sparse_record;
   if (sparse_record && sparse_record->size >= 0) {
     // Sparse record is enabled and ready to use.
     iterator->idx++;
-    if (iterator->idx >= sparse_record->size) {
-      // No more present channels.
-      iterator->next = -1;
-    } else {
-      // NOTE: Following cast is unsafe if there more than 2^31 channels.
-      iterator->next = (int)sparse_record->present_channels[iterator->idx];
-    }
+    iterator->next = next_present_channel(sparse_record, iterator->next + 1, iterator->width);
     return iterator->next;
   } else {
     // Fall back to iterate over all port structs representing channels.
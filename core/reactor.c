@@ -17,6 +17,7 @@
 #include "low_level_platform.h"
 #include "reactor_common.h"
 #include "environment.h"
+#include "timer_table.h"
 
 // Embedded platforms with no command line interface shouldnt have signals
 #if !defined(NO_CLI)
@@ -56,13 +57,15 @@ void lf_set_present(lf_port_base_t* port) {
   *is_present_field = true;
 
   // Support for sparse destination multiports.
-  if (port->sparse_record && port->destination_channel >= 0 && port->sparse_record->size >= 0) {
-    size_t next = port->sparse_record->size++;
-    if (next >= port->sparse_record->capacity) {
-      // Buffer is full. Have to revert to the classic iteration.
-      port->sparse_record->size = -1;
-    } else {
-      port->sparse_record->present_channels[next] = port->destination_channel;
+  lf_sparse_io_record_t* record = port->sparse_record;
+  if (record && port->destination_channel >= 0 && record->size >= 0) {
+    size_t channel = (size_t)port->destination_channel;
+    if (channel / 64 >= record->number_of_words) {
+      // The channel is not in the bitmap. Have to revert to the classic iteration.
+      record->size = -1;
+    } else if (!(record->present_bits[channel / 64] & (1ULL << (channel % 64)))) {
+      record->present_bits[channel / 64] |= 1ULL << (channel % 64);
+      record->size++;
     }
   }
 }
@@ -86,7 +89,7 @@ int wait_until(environment_t* env, instant_t wakeup_time) {
 void lf_print_snapshot(environment_t* env) {
   if (LOG_LEVEL > LOG_LEVEL_LOG) {
     LF_PRINT_DEBUG(">>> START Snapshot");
-    pqueue_dump(env->reaction_q, env->reaction_q->prt);
+    reaction_level_queue_dump(env->reaction_q);
     LF_PRINT_DEBUG(">>> END Snapshot");
   }
 }
@@ -114,7 +117,7 @@ void _lf_trigger_reaction(environment_t* env, reaction_t* reaction, int worker_n
     LF_PRINT_DEBUG("Enqueueing downstream reaction %s, which has level %lld.", reaction->name,
                    reaction->index & 0xffffLL);
     reaction->status = queued;
-    if (pqueue_insert(env->reaction_q, reaction) != 0) {
+    if (reaction_level_queue_insert(env->reaction_q, reaction) != 0) {
       lf_print_error_and_exit("Could not insert reaction into reaction_q");
     }
   }
@@ -131,9 +134,9 @@ int _lf_do_step(environment_t* env) {
   assert(env != GLOBAL_ENVIRONMENT);
 
   // Invoke reactions.
-  while (pqueue_size(env->reaction_q) > 0) {
+  reaction_t* reaction;
+  while ((reaction = reaction_level_queue_pop(env->reaction_q)) != NULL) {
     // lf_print_snapshot();
-    reaction_t* reaction = (reaction_t*)pqueue_pop(env->reaction_q);
     reaction->status = running;
 
     LF_PRINT_LOG("Invoking reaction %s at elapsed logical tag " PRINTF_TAG ".", reaction->name,
@@ -227,13 +230,13 @@ int next(environment_t* env) {
   // If there is no next event and -keepalive has been specified
   // on the command line, then we will wait the maximum time possible.
   tag_t next_tag = FOREVER_TAG_INITIALIZER;
-  if (event == NULL) {
-    // No event in the queue.
+  if (event == NULL && lf_timer_table_next_time(env->timer_table) == FOREVER) {
+    // No event in the queue and no timer in the timer table.
     if (!keepalive_specified) {
       lf_set_stop_tag(env, (tag_t){.time = env->current_tag.time, .microstep = env->current_tag.microstep + 1});
     }
   } else {
-    next_tag = event->base.tag;
+    next_tag = _lf_earliest_event_tag(env);
   }
 
   if (lf_is_tag_after_stop_tag(env, next_tag)) {
@@ -320,7 +323,9 @@ int lf_reactor_c_main(int argc, const char* argv[]) {
     signal(SIGINT, exit);
 #endif
     // Create and initialize the environment
+    instant_t phase_start = lf_time_physical();
     lf_create_environments(); // code-generated function
+    lf_startup_profile_phase(NULL, "environments", &phase_start);
     environment_t* env;
     int num_environments = _lf_get_environments(&env);
     LF_ASSERT(num_environments == 1, "Found %d environments. Only 1 can be used with the single-threaded runtime",
@@ -351,13 +356,16 @@ int lf_reactor_c_main(int argc, const char* argv[]) {
     LF_PRINT_DEBUG("NOTE: FOREVER is displayed as " PRINTF_TAG " and NEVER as " PRINTF_TAG,
                    FOREVER_TAG.time - start_time, FOREVER_TAG.microstep, NEVER_TAG.time - start_time, 0);
 
+    phase_start = lf_time_physical();
     environment_init_tags(env, start_time, duration);
 #ifdef MODAL_REACTORS
     // Set up modal infrastructure
     _lf_initialize_modes(env);
 #endif
+    lf_startup_profile_phase(env, "tags and modes", &phase_start);
     _lf_trigger_startup_reactions(env);
     _lf_initialize_timers(env);
+    lf_startup_profile_phase(env, "startup reactions and timers", &phase_start);
     // If the stop_tag is (0,0), also insert the shutdown
     // reactions. This can only happen if the timeout time
     // was set to 0.
@@ -10,6 +10,8 @@
  * @brief Runtime infrastructure common to the threaded and single-threaded versions of the C runtime.
  */
 #include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -26,17 +28,21 @@
 #include "port.h"
 #include "pqueue.h"
 #include "reactor.h"
+#include "tag_inline.h"
 #include "tracepoint.h"
 #include "util.h"
 #include "vector.h"
 #include "lf_core_version.h"
-#include "hashset/hashset.h"
-#include "hashset/hashset_itr.h"
 #include "environment.h"
 #include "reactor_common.h"
+#include "timer_table.h"
 
 #if !defined(LF_SINGLE_THREADED)
+#include "lf_async_log.h"
+#include "reactor_threaded.h"
+#include "schedule_inbox.h"
 #include "watchdog.h"
+#include "worker_placement.h"
 #endif
 
 #ifdef LF_ENCLAVES
@@ -105,6 +111,12 @@ instant_t start_time_multiple = 0LL;
 /** Indicator of whether the keepalive command-line option was given. */
 bool keepalive_specified = false;
 
+/** Indicator of whether the startup-profile command-line option was given. */
+bool lf_startup_profile = false;
+
+/** Physical time at which the first profiled startup phase began. */
+static instant_t _lf_startup_profile_origin = NEVER;
+
 instant_t lf_align_to_start_time_multiple(instant_t time) {
   if (start_time_multiple > 0LL) {
     instant_t remainder = time % start_time_multiple;
@@ -115,18 +127,113 @@ instant_t lf_align_to_start_time_multiple(instant_t time) {
   return time;
 }
 
+void lf_startup_profile_phase(environment_t* env, const char* phase, instant_t* since) {
+  if (!lf_startup_profile) {
+    return;
+  }
+  instant_t now = lf_time_physical();
+  if (_lf_startup_profile_origin == NEVER) {
+    _lf_startup_profile_origin = *since;
+  }
+  lf_print("---- Startup profile: %s: %s took %.3f ms (%.3f ms since startup).", env == NULL ? "global" : env->name,
+           phase, (now - *since) / 1e6, (now - _lf_startup_profile_origin) / 1e6);
+  *since = now;
+}
+
+#ifdef LF_REACTOR_ARENA
+#ifndef LF_REACTOR_ARENA_CHUNK_SIZE
+#define LF_REACTOR_ARENA_CHUNK_SIZE (1 << 20)
+#endif
+
+/**
+ * A chunk of the arena from which self structs and the memory recorded on them are carved.
+ * Chunks are zeroed when created and memory is never handed out twice, so allocations
+ * from the arena have the same contents as those made with calloc.
+ */
+typedef struct arena_chunk_t {
+  struct arena_chunk_t* next;
+  size_t used;
+  size_t capacity;
+  max_align_t data[];
+} arena_chunk_t;
+
+/** List of arena chunks. The first chunk is the one currently being filled. */
+static arena_chunk_t* _lf_arena = NULL;
+
+/** Whether memory recorded on reactors comes from the arena, which is only the case during startup. */
+static bool _lf_arena_open = true;
+
+/**
+ * Return zeroed memory of the given size from the arena.
+ * Allocations that do not fit into the current chunk start a new one, except for those
+ * larger than a quarter of a chunk, which get a chunk of their own so that the space
+ * left in the current chunk is not wasted.
+ */
+static void* _lf_arena_allocate(size_t size) {
+  size_t alignment = _Alignof(max_align_t);
+  size = size == 0 ? alignment : (size + alignment - 1) & ~(alignment - 1);
+  LF_CRITICAL_SECTION_ENTER(GLOBAL_ENVIRONMENT);
+  arena_chunk_t* chunk = _lf_arena;
+  if (chunk == NULL || chunk->capacity - chunk->used < size) {
+    size_t capacity = size > LF_REACTOR_ARENA_CHUNK_SIZE / 4 ? size : LF_REACTOR_ARENA_CHUNK_SIZE;
+    chunk = (arena_chunk_t*)calloc(1, sizeof(arena_chunk_t) + capacity);
+    if (chunk == NULL)
+      lf_print_error_and_exit("Out of memory!");
+    chunk->capacity = capacity;
+    if (_lf_arena != NULL && capacity != LF_REACTOR_ARENA_CHUNK_SIZE) {
+      // Keep filling the current chunk.
+      chunk->next = _lf_arena->next;
+      _lf_arena->next = chunk;
+    } else {
+      chunk->next = _lf_arena;
+      _lf_arena = chunk;
+    }
+  }
+  void* mem = (char*)chunk->data + chunk->used;
+  chunk->used += size;
+  LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
+  return mem;
+}
+
+/** Free all chunks of the arena, and with them every allocation made from it. */
+static void _lf_arena_free(void) {
+  while (_lf_arena != NULL) {
+    arena_chunk_t* next = _lf_arena->next;
+    free(_lf_arena);
+    _lf_arena = next;
+  }
+  _lf_arena_open = true;
+}
+
+void _lf_close_reactor_arena(void) { _lf_arena_open = false; }
+#endif // LF_REACTOR_ARENA
+
+/** Record on the list with the given head that the memory is to be freed. */
+static void _lf_record_allocation(void* mem, struct allocation_record_t** head) {
+  struct allocation_record_t* record = (allocation_record_t*)calloc(1, sizeof(allocation_record_t));
+  if (record == NULL)
+    lf_print_error_and_exit("Out of memory!");
+  record->allocated = mem;
+  allocation_record_t* tmp = *head; // Previous head of the list or NULL.
+  *head = record;                   // New head of the list.
+  record->next = tmp;
+}
+
 void* lf_allocate(size_t count, size_t size, struct allocation_record_t** head) {
+#ifdef LF_REACTOR_ARENA
+  if (head != NULL && _lf_arena_open) {
+    // Memory with a recorded owner allocated during startup lives until lf_free_all_reactors(),
+    // so take it from the arena.
+    if (size != 0 && count > SIZE_MAX / size)
+      lf_print_error_and_exit("Out of memory!");
+    return _lf_arena_allocate(count * size);
+  }
+#endif
   void* mem = calloc(count, size);
   if (mem == NULL)
     lf_print_error_and_exit("Out of memory!");
   if (head != NULL) {
-    struct allocation_record_t* record = (allocation_record_t*)calloc(1, sizeof(allocation_record_t));
-    if (record == NULL)
-      lf_print_error_and_exit("Out of memory!");
-    record->allocated = mem;
-    allocation_record_t* tmp = *head; // Previous head of the list or NULL.
-    *head = record;                   // New head of the list.
-    record->next = tmp;
+    _lf_record_allocation(mem, head);
   }
   return mem;
 }
@@ -137,7 +244,17 @@ void* lf_allocate(size_t count, size_t size, struct allocation_record_t** head)
  */
 struct allocation_record_t* _lf_reactors_to_free = NULL;
 
-self_base_t* lf_new_reactor(size_t size) { return (self_base_t*)lf_allocate(1, size, &_lf_reactors_to_free); }
+self_base_t* lf_new_reactor(size_t size) {
+  self_base_t* self = (self_base_t*)lf_allocate(1, size, &_lf_reactors_to_free);
+#ifdef LF_REACTOR_ARENA
+  if (_lf_arena_open) {
+    // The arena records nothing, but the memory allocated on the reactor after startup must still be freed.
+    self->in_arena = true;
+    _lf_record_allocation(self, &_lf_reactors_to_free);
+  }
+#endif
+  return self;
+}
 
 void lf_free(struct allocation_record_t** head) {
   if (head == NULL)
@@ -156,6 +273,10 @@ void lf_free(struct allocation_record_t** head) {
 
 void lf_free_reactor(self_base_t* self) {
   lf_free(&self->allocations);
+#ifdef LF_REACTOR_ARENA
+  if (self->in_arena)
+    return;
+#endif
   free(self);
 }
 
@@ -168,11 +289,14 @@ void lf_free_all_reactors(void) {
     head = tmp;
   }
   _lf_reactors_to_free = NULL;
+#ifdef LF_REACTOR_ARENA
+  _lf_arena_free();
+#endif
 }
 
 void lf_set_stop_tag(environment_t* env, tag_t tag) {
   assert(env != GLOBAL_ENVIRONMENT);
-  if (lf_tag_compare(tag, env->stop_tag) < 0) {
+  if (lf_tag_compare_inline(tag, env->stop_tag) < 0) {
     env->stop_tag = tag;
   }
 }
@@ -225,6 +349,28 @@ void lf_set_fed_maxwait(interval_t offset) { lf_fed_STA_offset = offset; }
 
 #endif // FEDERATED_DECENTRALIZED
 
+void _lf_initialize_sparse_io_records(environment_t* env) {
+  size_t number_of_records = env->sparse_io_record_sizes.start != NULL ? vector_size(&env->sparse_io_record_sizes) : 0;
+  size_t number_of_words = 0;
+  for (size_t i = 0; i < number_of_records; i++) {
+    lf_sparse_io_record_t* record = *(lf_sparse_io_record_t**)vector_at(&env->sparse_io_record_sizes, i);
+    // The capacity is the width divided by LF_SPARSE_CAPACITY_DIVIDER, so this covers the width.
+    record->number_of_words = ((record->capacity + 1) * LF_SPARSE_CAPACITY_DIVIDER + 63) / 64;
+    number_of_words += record->number_of_words;
+  }
+  if (number_of_words == 0) {
+    return;
+  }
+  env->sparse_io_present_bits = (uint64_t*)calloc(number_of_words, sizeof(uint64_t));
+  LF_ASSERT_NON_NULL(env->sparse_io_present_bits);
+  uint64_t* bits = env->sparse_io_present_bits;
+  for (size_t i = 0; i < number_of_records; i++) {
+    lf_sparse_io_record_t* record = *(lf_sparse_io_record_t**)vector_at(&env->sparse_io_record_sizes, i);
+    record->present_bits = bits;
+    bits += record->number_of_words;
+  }
+}
+
 void _lf_start_time_step(environment_t* env) {
   assert(env != GLOBAL_ENVIRONMENT);
   if (!env->execution_started) {
@@ -234,9 +380,14 @@ void _lf_start_time_step(environment_t* env) {
   }
   LF_PRINT_LOG("--------- Env: %u Start time step at tag " PRINTF_TAG ".", env->id, env->current_tag.time - start_time,
                env->current_tag.microstep);
+#ifndef LF_PIPELINED_TAGS
   // Handle dynamically created tokens for mutable inputs.
+  // With pipelined tags, the scheduler frees them once no reaction of an earlier tag can use them.
   _lf_free_token_copies();
+#endif
 
+  // With pipelined tags, ports are not on this list because the scheduler marks them absent
+  // when the reactor that writes them starts a new tag. Only actions are.
   bool** is_present_fields = env->is_present_fields_abbreviated;
   int size = env->is_present_fields_abbreviated_size;
   if (env->is_present_fields_abbreviated_size > env->is_present_fields_size) {
@@ -246,15 +397,19 @@ void _lf_start_time_step(environment_t* env) {
   for (int i = 0; i < size; i++) {
     *is_present_fields[i] = false;
   }
-  // Reset sparse IO record sizes to 0, if any.
+  // Reset sparse IO records, if any.
   if (env->sparse_io_record_sizes.start != NULL) {
+#ifdef LF_PIPELINED_TAGS
+    lf_print_error_and_exit("Sparse multiports are not supported with pipelined tags.");
+#endif
     for (size_t i = 0; i < vector_size(&env->sparse_io_record_sizes); i++) {
       // NOTE: vector_at does not return the element at
       // the index, but rather returns a pointer to that element, which is
-      // itself a pointer.
-      int** sizep = (int**)vector_at(&env->sparse_io_record_sizes, i);
-      if (sizep != NULL && *sizep != NULL) {
-        **sizep = 0;
+      // itself a pointer to the size, the first field of the record.
+      lf_sparse_io_record_t** recordp = (lf_sparse_io_record_t**)vector_at(&env->sparse_io_record_sizes, i);
+      if (recordp != NULL && *recordp != NULL && (*recordp)->size != 0) {
+        memset((*recordp)->present_bits, 0, (*recordp)->number_of_words * sizeof(uint64_t));
+        (*recordp)->size = 0;
       }
     }
   }
@@ -287,7 +442,49 @@ void _lf_start_time_step(environment_t* env) {
 
 bool lf_is_tag_after_stop_tag(environment_t* env, tag_t tag) {
   assert(env != GLOBAL_ENVIRONMENT);
-  return (lf_tag_compare(tag, env->stop_tag) > 0);
+  return (lf_tag_compare_inline(tag, env->stop_tag) > 0);
+}
+
+tag_t _lf_earliest_event_tag(environment_t* env) {
+  assert(env != GLOBAL_ENVIRONMENT);
+  event_t* event = (event_t*)pqueue_tag_peek(env->event_q);
+  tag_t tag = event != NULL ? event->base.tag : FOREVER_TAG;
+  // Timers fire at microstep 0.
+  instant_t timer_time = lf_timer_table_next_time(env->timer_table);
+  if (timer_time != FOREVER && lf_tag_compare_inline((tag_t){.time = timer_time, .microstep = 0}, tag) < 0) {
+    tag = (tag_t){.time = timer_time, .microstep = 0};
+  }
+  return tag;
+}
+
+/**
+ * @brief Trigger the reactions of the timers in the timer table that fire at the current tag and
+ * move their groups to their next firing.
+ *
+ * A group whose next firing is after the stop tag is dropped, as the event of a timer would be.
+ */
+static void _lf_fire_timers(environment_t* env) {
+  if (env->current_tag.microstep != 0) {
+    return;
+  }
+  lf_timer_group_t* group;
+  while ((group = lf_timer_table_pop(env->timer_table, env->current_tag.time)) != NULL) {
+    for (size_t i = 0; i < group->number_of_timers; i++) {
+      trigger_t* timer = group->timers[i];
+      for (int j = 0; j < timer->number_of_reactions; j++) {
+        LF_PRINT_DEBUG("Timer triggers reaction %s.", timer->reactions[j]->name);
+        _lf_trigger_reaction(env, timer->reactions[j], -1);
+      }
+      timer->status = present;
+      tracepoint_schedule(env, timer, group->period); // Trace even though schedule is not called.
+    }
+    group->time = lf_time_add(group->time, group->period);
+    if (lf_is_tag_after_stop_tag(env, (tag_t){.time = group->time, .microstep = 0})) {
+      lf_timer_table_free_group(group);
+    } else {
+      lf_timer_table_push(env->timer_table, group);
+    }
+  }
 }
 
 void _lf_pop_events(environment_t* env) {
@@ -295,9 +492,10 @@ void _lf_pop_events(environment_t* env) {
 #ifdef MODAL_REACTORS
   _lf_handle_mode_triggered_reactions(env);
 #endif
+  _lf_fire_timers(env);
 
   event_t* event = (event_t*)pqueue_tag_peek(env->event_q);
-  while (event != NULL && lf_tag_compare(event->base.tag, env->current_tag) == 0) {
+  while (event != NULL && lf_tag_compare_inline(event->base.tag, env->current_tag) == 0) {
     event = (event_t*)pqueue_tag_pop(env->event_q);
 
     if (event->trigger == NULL) {
@@ -312,7 +510,7 @@ void _lf_pop_events(environment_t* env) {
     // If this event is associated with an inactive mode it should haven been suspended and no longer on the event
     // queue. NOTE: This should not be possible
     if (!_lf_mode_is_active(event->trigger->mode)) {
-      lf_print_warning(
+      LF_PRINT_WARNING_RATELIMITED(
           "Assumption violated. There is an event on the event queue that is associated to an inactive mode.");
     }
 #endif
@@ -322,8 +520,14 @@ void _lf_pop_events(environment_t* env) {
     // Put the corresponding reactions onto the reaction queue.
     for (int i = 0; i < event->trigger->number_of_reactions; i++) {
       reaction_t* reaction = event->trigger->reactions[i];
-      // Do not enqueue this reaction twice.
-      if (reaction->status == inactive) {
+      // Do not enqueue this reaction twice. With pipelined tags, the reaction may still be queued
+      // at an earlier tag, so leave this to the scheduler, which knows the tag of each trigger.
+#ifdef LF_PIPELINED_TAGS
+      bool enqueue = true;
+#else
+      bool enqueue = reaction->status == inactive;
+#endif
+      if (enqueue) {
 #ifdef FEDERATED_DECENTRALIZED
         // In federated execution, an intended tag that is not (NEVER, 0)
         // indicates that this particular event is triggered by a network message.
@@ -335,7 +539,7 @@ void _lf_pop_events(environment_t* env) {
           // the reaction can access the value.
           event->trigger->intended_tag = event->intended_tag;
           // And check if it is in the past compared to the current tag.
-          if (lf_tag_compare(event->intended_tag, env->current_tag) < 0) {
+          if (lf_tag_compare_inline(event->intended_tag, env->current_tag) < 0) {
             // Mark the triggered reaction with a STP violation
             reaction->is_STP_violated = true;
             LF_PRINT_LOG("Trigger %p has violated the reaction's STP offset. Intended tag: " PRINTF_TAG
@@ -346,7 +550,7 @@ void _lf_pop_events(environment_t* env) {
             // the MLAA could get stuck, causing the program to lock up.
             // This should not call update_last_known_status_on_input_port because we
             // are starting a new tag step execution, so there are no reactions blocked on this input.
-            if (lf_tag_compare(env->current_tag, event->trigger->last_known_status_tag) > 0) {
+            if (lf_tag_compare_inline(env->current_tag, event->trigger->last_known_status_tag) > 0) {
               event->trigger->last_known_status_tag = env->current_tag;
             }
           }
@@ -432,7 +636,7 @@ bool _lf_initialize_timer(environment_t* env, trigger_t* timer) {
     event_t* e = lf_get_new_event(env);
     e->trigger = timer;
     e->base.tag = (tag_t){.time = lf_time_logical(env) + timer->offset, .microstep = 0};
-    _lf_add_suspended_event(e);
+    _lf_add_suspended_event(env, e);
     return result;
   }
 #endif
@@ -458,6 +662,18 @@ bool _lf_initialize_timer(environment_t* env, trigger_t* timer) {
   tag_t next_tag = (tag_t){.time = lf_time_logical(env) + delay, .microstep = 0};
   // Do not schedule the next event if it is after the timeout.
   if (!lf_is_tag_after_stop_tag(env, next_tag)) {
+#ifdef LF_TIMER_TABLE
+    // Periodic timers outside of modes go to the timer table. Timers in modes stay on the event queue,
+    // where the mode handling suspends and resumes their events.
+    if (timer->period > 0 && timer->mode == NULL) {
+      if (env->timer_table == NULL) {
+        env->timer_table = lf_timer_table_new();
+      }
+      lf_timer_table_add(env->timer_table, timer, next_tag.time);
+      tracepoint_schedule(env, timer, delay); // Trace even though schedule is not called.
+      return result;
+    }
+#endif
     event_t* e = lf_get_new_event(env);
     e->trigger = timer;
     e->base.tag = next_tag;
@@ -558,8 +774,8 @@ trigger_handle_t _lf_schedule_at_tag(environment_t* env, trigger_t* trigger, tag
 
   LF_PRINT_DEBUG("_lf_schedule_at_tag() called with tag " PRINTF_TAG " at tag " PRINTF_TAG ".", tag.time - start_time,
                  tag.microstep, current_logical_tag.time - start_time, current_logical_tag.microstep);
-  if (lf_tag_compare(tag, current_logical_tag) <= 0 && env->execution_started) {
-    lf_print_warning("_lf_schedule_at_tag(): requested to schedule an event at the current or past tag.");
+  if (lf_tag_compare_inline(tag, current_logical_tag) <= 0 && env->execution_started) {
+    LF_PRINT_WARNING_RATELIMITED("_lf_schedule_at_tag(): requested to schedule an event at the current or past tag.");
     _lf_done_using(token);
     return -1;
   }
@@ -572,7 +788,7 @@ trigger_handle_t _lf_schedule_at_tag(environment_t* env, trigger_t* trigger, tag
 
   // Do not schedule events if the tag is after the stop tag
   if (lf_is_tag_after_stop_tag(env, tag)) {
-    lf_print_warning("_lf_schedule_at_tag: event time is past the timeout. Discarding event.");
+    LF_PRINT_WARNING_RATELIMITED("_lf_schedule_at_tag: event time is past the timeout. Discarding event.");
     _lf_done_using(token);
     return -1;
   }
@@ -635,6 +851,11 @@ trigger_handle_t _lf_schedule_at_tag(environment_t* env, trigger_t* trigger, tag
 }
 
 trigger_handle_t _lf_schedule_token(environment_t* env, void* action, interval_t extra_delay, lf_token_t* token) {
+#if defined(LF_SCHEDULE_INBOX) && !defined(LF_SINGLE_THREADED)
+  if (lf_schedule_inbox_push(env, ((lf_action_base_t*)action)->trigger, extra_delay, token)) {
+    return 1;
+  }
+#endif
   LF_CRITICAL_SECTION_ENTER(env);
   int return_value = lf_schedule_trigger(env, ((lf_action_base_t*)action)->trigger, extra_delay, token);
   // Notify the main thread in case it is waiting for physical time to elapse.
@@ -652,6 +873,15 @@ trigger_handle_t _lf_schedule_copy(environment_t* env, void* action, interval_t
     lf_print_error("schedule: Invalid element size.");
     return -1;
   }
+#if defined(LF_SCHEDULE_INBOX) && !defined(LF_SINGLE_THREADED)
+  if (((lf_action_base_t*)action)->trigger->is_physical) {
+    // Use a new token so that the environment mutex is not needed.
+    void* copy = malloc(template->type.element_size * length);
+    LF_ASSERT_NON_NULL(copy);
+    memcpy(copy, value, template->type.element_size * length);
+    return _lf_schedule_token(env, action, offset, _lf_new_token_with_value(template, copy, length));
+  }
+#endif
   LF_CRITICAL_SECTION_ENTER(env);
   // Initialize token with an array size of length and a reference count of 0.
   lf_token_t* token = _lf_initialize_token(template, length);
@@ -696,7 +926,7 @@ trigger_handle_t _lf_insert_reactions_for_trigger(environment_t* env, trigger_t*
   // Check if the trigger has violated the STP offset
   bool is_STP_violated = false;
 #ifdef FEDERATED
-  if (lf_tag_compare(trigger->intended_tag, env->current_tag) < 0) {
+  if (lf_tag_compare_inline(trigger->intended_tag, env->current_tag) < 0) {
     is_STP_violated = true;
   }
 #ifdef FEDERATED_CENTRALIZED
@@ -762,7 +992,7 @@ void _lf_advance_tag(environment_t* env, tag_t next_tag) {
 #ifndef NDEBUG
   event_t* next_event = (event_t*)pqueue_tag_peek(env->event_q);
   if (next_event != NULL) {
-    if (lf_tag_compare(next_tag, next_event->base.tag) > 0) {
+    if (lf_tag_compare_inline(next_tag, next_event->base.tag) > 0) {
       lf_print_error_and_exit("_lf_advance_tag(): Attempted to move tag to " PRINTF_TAG ", which is "
                               "past the head of the event queue, " PRINTF_TAG ".",
                               next_tag.time - start_time, next_tag.microstep, next_event->base.tag.time - start_time,
@@ -770,7 +1000,7 @@ void _lf_advance_tag(environment_t* env, tag_t next_tag) {
     }
   }
 #endif
-  if (lf_tag_compare(env->current_tag, next_tag) < 0) {
+  if (lf_tag_compare_inline(env->current_tag, next_tag) < 0) {
     env->current_tag = next_tag;
   } else {
     lf_print_error_and_exit("_lf_advance_tag(): Attempted to move (elapsed) tag to " PRINTF_TAG ", which is "
@@ -942,7 +1172,7 @@ void schedule_output_reactions(environment_t* env, reaction_t* reaction, int wor
       instant_t physical_time = lf_time_physical();
       // Check for deadline violation.
       if (downstream_to_execute_now->deadline == 0 ||
-          physical_time > lf_time_add(env->current_tag.time, downstream_to_execute_now->deadline)) {
+          physical_time > lf_time_add_inline(env->current_tag.time, downstream_to_execute_now->deadline)) {
         // Deadline violation has occurred.
         tracepoint_reaction_deadline_missed(env, downstream_to_execute_now, worker);
         violation = true;
@@ -1015,8 +1245,27 @@ void usage(int argc, const char* argv[]) {
   printf("      multiple of the specified time, where units are one of ns, us, ms, s, min, hour, day, or week.\n\n");
   printf("  -k, --keepalive <true|false>\n");
   printf("      Whether to continue execution even when there are no events to process.\n\n");
+  printf("  --startup-profile <true|false>\n");
+  printf("      Whether to report the physical time spent in each phase of startup.\n\n");
   printf("  -w, --workers <n>\n");
   printf("      Execute in <n> threads if possible (optional feature).\n\n");
+#if !defined(LF_SINGLE_THREADED)
+  printf("  --pin-workers <true|false>\n");
+  printf("      Whether to pin each worker thread to one CPU.\n\n");
+  printf("  --cpu-list <list>\n");
+  printf("      Pin worker threads to the CPUs in <list> (e.g., 0-3,8), handing out\n");
+  printf("      disjoint CPUs to scheduling enclaves as long as there are enough.\n\n");
+  printf("  --numa-node <n>\n");
+  printf("      Pin worker threads to the CPUs of NUMA node <n>.\n\n");
+  printf("  --rt-priority <n>\n");
+  printf("      Run worker threads with real-time (SCHED_FIFO) priority <n>, from 0 to 99.\n\n");
+  printf("  --spin-wait <duration> <units>\n");
+  printf("      When waiting for physical time to reach the next tag, sleep only until the specified\n");
+  printf("      duration before that time, then busy-wait. This reduces release jitter at the cost of CPU.\n\n");
+  printf("  --sched-profile <file>\n");
+  printf("      Load what the adaptive scheduler learned in earlier runs from <file>, if it exists,\n");
+  printf("      and save what it has learned to <file> at the end of the run.\n\n");
+#endif
   printf("  -h, --help\n");
   printf("      Display this help message.\n\n");
 #ifdef FEDERATED
@@ -1211,6 +1460,20 @@ int process_args(int argc, const char* argv[]) {
       } else {
         lf_print_error("Invalid value for --keepalive: %s", keep_spec);
       }
+    } else if (strcmp(arg, "--startup-profile") == 0) {
+      if (argc < i + 1) {
+        lf_print_error("--startup-profile needs a boolean.");
+        usage(argc, argv);
+        return 0;
+      }
+      const char* profile_spec = argv[i++];
+      if (strcmp(profile_spec, "true") == 0) {
+        lf_startup_profile = true;
+      } else if (strcmp(profile_spec, "false") == 0) {
+        lf_startup_profile = false;
+      } else {
+        lf_print_error("Invalid value for --startup-profile: %s", profile_spec);
+      }
     } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
       usage(argc, argv);
       return 0;
@@ -1228,6 +1491,95 @@ int process_args(int argc, const char* argv[]) {
       }
       _lf_number_of_workers = (unsigned int)num_workers;
     }
+#if !defined(LF_SINGLE_THREADED)
+    else if (strcmp(arg, "--pin-workers") == 0) {
+      if (argc < i + 1) {
+        lf_print_error("--pin-workers needs a boolean.");
+        usage(argc, argv);
+        return 0;
+      }
+      const char* pin_spec = argv[i++];
+      if (strcmp(pin_spec, "true") == 0) {
+        lf_pin_workers = true;
+      } else if (strcmp(pin_spec, "false") == 0) {
+        lf_pin_workers = false;
+      } else {
+        lf_print_error("Invalid value for --pin-workers: %s", pin_spec);
+      }
+    } else if (strcmp(arg, "--cpu-list") == 0) {
+      if (argc < i + 1) {
+        lf_print_error("--cpu-list needs a list of CPUs such as 0-3,8.");
+        usage(argc, argv);
+        return 0;
+      }
+      const char* cpu_spec = argv[i++];
+      if (!lf_worker_placement_set_cpu_list(cpu_spec)) {
+        lf_print_error("Invalid value for --cpu-list: %s", cpu_spec);
+        usage(argc, argv);
+        return 0;
+      }
+      lf_pin_workers = true;
+    } else if (strcmp(arg, "--numa-node") == 0) {
+      if (argc < i + 1) {
+        lf_print_error("--numa-node needs an integer argument.");
+        usage(argc, argv);
+        return 0;
+      }
+      const char* node_spec = argv[i++];
+      char* end;
+      long node = strtol(node_spec, &end, 10);
+      if (*end != '\0' || node < 0) {
+        lf_print_error("Invalid value for --numa-node: %s", node_spec);
+        usage(argc, argv);
+        return 0;
+      }
+      lf_numa_node = (int)node;
+      lf_pin_workers = true;
+    } else if (strcmp(arg, "--rt-priority") == 0) {
+      if (argc < i + 1) {
+        lf_print_error("--rt-priority needs an integer argument.");
+        usage(argc, argv);
+        return 0;
+      }
+      const char* priority_spec = argv[i++];
+      char* end;
+      long priority = strtol(priority_spec, &end, 10);
+      if (*end != '\0' || priority < LF_SCHED_MIN_PRIORITY || priority > LF_SCHED_MAX_PRIORITY) {
+        lf_print_error("Invalid value for --rt-priority: %s. Expected %d to %d.", priority_spec, LF_SCHED_MIN_PRIORITY,
+                       LF_SCHED_MAX_PRIORITY);
+        usage(argc, argv);
+        return 0;
+      }
+      lf_rt_priority = (int)priority;
+    } else if (strcmp(arg, "--spin-wait") == 0) {
+      if (argc < i + 2) {
+        lf_print_error("--spin-wait needs time and units.");
+        usage(argc, argv);
+        return 0;
+      }
+      const char* time_spec = argv[i++];
+      const char* units = argv[i++];
+      int parse_result = lf_time_parse(time_spec, units, &lf_spin_wait_margin);
+      if (parse_result != 0) {
+        lf_print_error(parse_result == -1 ? "Invalid time value: %s" : "Invalid time units: %s",
+                       parse_result == -1 ? time_spec : units);
+        usage(argc, argv);
+        return 0;
+      }
+      if (lf_spin_wait_margin < 0LL) {
+        lf_print_error("--spin-wait needs a non-negative time value.");
+        usage(argc, argv);
+        return 0;
+      }
+    } else if (strcmp(arg, "--sched-profile") == 0) {
+      if (argc < i + 1) {
+        lf_print_error("--sched-profile needs a file name.");
+        usage(argc, argv);
+        return 0;
+      }
+      lf_sched_profile = argv[i++];
+    }
+#endif
 #ifdef FEDERATED
     else if (strcmp(arg, "-i") == 0 || strcmp(arg, "--id") == 0) {
       if (argc < i + 1) {
@@ -1350,6 +1702,10 @@ static void check_version(const version_t* version) {
 #endif // LF_TRACE
 
 void initialize_global(void) {
+  instant_t phase_start = lf_time_physical();
+#if defined(LF_ASYNC_LOG) && !defined(LF_SINGLE_THREADED)
+  lf_async_log_start(-1, LF_ASYNC_LOG == 2 ? LF_ASYNC_LOG_DROP : LF_ASYNC_LOG_BLOCK);
+#endif
 #ifdef LF_TRACE
   check_version(lf_version_tracing());
 #endif
@@ -1375,9 +1731,21 @@ void initialize_global(void) {
 #else
   lf_tracing_global_init("main", NULL, 0, max_threads_tracing);
 #endif
+  lf_startup_profile_phase(NULL, "tracing setup", &phase_start);
   // Call the code-generated function to initialize all actions, timers, and ports
   // This is done for all environments/enclaves at the same time.
   _lf_initialize_trigger_objects();
+#ifdef LF_REACTOR_ARENA
+  _lf_close_reactor_arena();
+#endif
+  lf_startup_profile_phase(NULL, "trigger objects", &phase_start);
+#if defined(LF_SINGLE_THREADED)
+  environment_t* envs;
+  int num_envs = _lf_get_environments(&envs);
+#endif
+  for (int i = 0; i < num_envs; i++) {
+    _lf_initialize_sparse_io_records(&envs[i]);
+  }
 
 #if !defined(LF_SINGLE_THREADED) && !defined(NDEBUG)
   // If we are testing, verify that environment with pointers is correctly set up.
@@ -1500,6 +1868,10 @@ void termination(void) {
     free_local_rti();
 #endif
   }
+#if defined(LF_ASYNC_LOG) && !defined(LF_SINGLE_THREADED)
+  // Write out the remaining messages and free the buffers of the threads.
+  lf_async_log_stop();
+#endif
 }
 
 index_t lf_combine_deadline_and_level(interval_t deadline, int level) {
@@ -14,6 +14,7 @@
 #include <string.h>
 
 #include "tag.h"
+#include "tag_inline.h"
 #include "util.h"
 #include "low_level_platform.h"
 #include "environment.h"
@@ -32,31 +33,39 @@ typedef enum _lf_time_type { LF_LOGICAL, LF_PHYSICAL, LF_ELAPSED_LOGICAL, LF_ELA
 // Global variables declared in tag.h:
 instant_t start_time = NEVER;
 
+#ifdef LF_PIPELINED_TAGS
+/**
+ * With pipelined tags, the tag of the reaction that the calling worker is executing,
+ * which may be earlier than the current tag of the environment, or NEVER_TAG.
+ */
+static thread_local tag_t _lf_worker_tag = NEVER_TAG_INITIALIZER;
+
+/** With pipelined tags, whether the reaction that the calling worker is executing may schedule logical actions. */
+static thread_local bool _lf_worker_may_schedule = false;
+
+void _lf_set_worker_tag(tag_t tag, bool may_schedule) {
+  _lf_worker_tag = tag;
+  _lf_worker_may_schedule = may_schedule;
+}
+
+bool _lf_worker_in_reaction(void) { return _lf_worker_tag.time != NEVER; }
+
+bool _lf_worker_may_schedule_actions(void) { return _lf_worker_may_schedule; }
+#endif // LF_PIPELINED_TAGS
+
 ////////////////  Functions declared in tag.h
 
 tag_t lf_tag(void* env) {
   assert(env != GLOBAL_ENVIRONMENT);
+#ifdef LF_PIPELINED_TAGS
+  if (_lf_worker_tag.time != NEVER) {
+    return _lf_worker_tag;
+  }
+#endif
   return ((environment_t*)env)->current_tag;
 }
 
-instant_t lf_time_add(instant_t a, interval_t b) {
-  if (a == NEVER || b == NEVER) {
-    return NEVER;
-  }
-  if (a == FOREVER || b == FOREVER) {
-    return FOREVER;
-  }
-  instant_t res = a + b;
-  // Check for overflow
-  if (res < a && b > 0) {
-    return FOREVER;
-  }
-  // Check for underflow
-  if (res > a && b < 0) {
-    return NEVER;
-  }
-  return res;
-}
+instant_t lf_time_add(instant_t a, interval_t b) { return lf_time_add_inline(a, b); }
 
 instant_t lf_time_subtract(instant_t a, interval_t b) {
   if (a == NEVER || b == FOREVER) {
@@ -77,78 +86,15 @@ instant_t lf_time_subtract(instant_t a, interval_t b) {
   return res;
 }
 
-tag_t lf_tag_add(tag_t a, tag_t b) {
-  instant_t res = lf_time_add(a.time, b.time);
-  if (res == FOREVER) {
-    return FOREVER_TAG;
-  }
-  if (res == NEVER) {
-    return NEVER_TAG;
-  }
-
-  if (b.time > 0) {
-    // NOTE: The reason for handling this case is to "reset" the microstep counter at each after delay.
-    a.microstep = 0; // Ignore microstep of first arg if time of second is > 0.
-  }
-  tag_t result = {.time = res, .microstep = a.microstep + b.microstep};
-
-  // If microsteps overflows
-  // FIXME: What should be the resulting tag in case of microstep overflow.
-  //  see https://github.com/lf-lang/reactor-c/issues/430
-  if (result.microstep < a.microstep) {
-    return FOREVER_TAG;
-  }
-  return result;
-}
+tag_t lf_tag_add(tag_t a, tag_t b) { return lf_tag_add_inline(a, b); }
 
-int lf_tag_compare(tag_t tag1, tag_t tag2) {
-  if (tag1.time < tag2.time) {
-    return -1;
-  } else if (tag1.time > tag2.time) {
-    return 1;
-  } else if (tag1.microstep < tag2.microstep) {
-    return -1;
-  } else if (tag1.microstep > tag2.microstep) {
-    return 1;
-  } else {
-    return 0;
-  }
-}
+int lf_tag_compare(tag_t tag1, tag_t tag2) { return lf_tag_compare_inline(tag1, tag2); }
 
-tag_t lf_tag_max(tag_t tag1, tag_t tag2) {
-  if (lf_tag_compare(tag1, tag2) < 0) {
-    return tag2;
-  } else {
-    return tag1;
-  }
-}
+tag_t lf_tag_max(tag_t tag1, tag_t tag2) { return lf_tag_max_inline(tag1, tag2); }
 
-tag_t lf_tag_min(tag_t tag1, tag_t tag2) {
-  if (lf_tag_compare(tag1, tag2) < 0) {
-    return tag1;
-  } else {
-    return tag2;
-  }
-}
+tag_t lf_tag_min(tag_t tag1, tag_t tag2) { return lf_tag_min_inline(tag1, tag2); }
 
-tag_t lf_delay_tag(tag_t tag, interval_t interval) {
-  if (tag.time == NEVER || interval < 0LL)
-    return tag;
-  // Note that overflow in C is undefined for signed variables.
-  if (tag.time >= FOREVER - interval)
-    return FOREVER_TAG; // Overflow.
-  tag_t result = tag;
-  if (interval == 0LL) {
-    // Note that unsigned variables will wrap on overflow.
-    // This is probably the only reasonable thing to do with overflowing
-    // microsteps.
-    result.microstep++;
-  } else {
-    result.time += interval;
-    result.microstep = 0;
-  }
-  return result;
-}
+tag_t lf_delay_tag(tag_t tag, interval_t interval) { return lf_delay_tag_inline(tag, interval); }
 
 tag_t lf_delay_strict(tag_t tag, interval_t interval) {
   tag_t result = lf_delay_tag(tag, interval);
@@ -173,6 +119,11 @@ tag_t lf_tag_latest_earlier(tag_t tag) {
 
 instant_t lf_time_logical(void* env) {
   assert(env != GLOBAL_ENVIRONMENT);
+#ifdef LF_PIPELINED_TAGS
+  if (_lf_worker_tag.time != NEVER) {
+    return _lf_worker_tag.time;
+  }
+#endif
   return ((environment_t*)env)->current_tag.time;
 }
 
@@ -25,7 +25,10 @@
 #include "environment.h"
 #include "rti_local.h"
 #include "reactor_common.h"
+#include "timer_table.h"
 #include "watchdog.h"
+#include "worker_placement.h"
+#include "schedule_inbox.h"
 
 #ifdef FEDERATED
 #include "federate.h"
@@ -153,20 +156,29 @@ void lf_set_present(lf_port_base_t* port) {
     return;
   environment_t* env = port->source_reactor->environment;
   bool* is_present_field = &port->is_present;
+#ifdef LF_PIPELINED_TAGS
+  // The scheduler marks the port absent when the reactor that writes it starts a new tag.
+  (void)env;
+#else
   int ipfas = lf_atomic_fetch_add(&env->is_present_fields_abbreviated_size, 1);
   if (ipfas < env->is_present_fields_size) {
     env->is_present_fields_abbreviated[ipfas] = is_present_field;
   }
+#endif
   *is_present_field = true;
 
   // Support for sparse destination multiports.
-  if (port->sparse_record && port->destination_channel >= 0 && port->sparse_record->size >= 0) {
-    size_t next = (size_t)lf_atomic_fetch_add(&port->sparse_record->size, 1);
-    if (next >= port->sparse_record->capacity) {
-      // Buffer is full. Have to revert to the classic iteration.
-      port->sparse_record->size = -1;
+  lf_sparse_io_record_t* record = port->sparse_record;
+  if (record && port->destination_channel >= 0 && record->size >= 0) {
+    size_t channel = (size_t)port->destination_channel;
+    if (channel / 64 >= record->number_of_words) {
+      // The channel is not in the bitmap. Have to revert to the classic iteration.
+      record->size = -1;
     } else {
-      port->sparse_record->present_channels[next] = port->destination_channel;
+      uint64_t bit = 1ULL << (channel % 64);
+      if (!(lf_atomic_fetch_or64(&record->present_bits[channel / 64], bit) & bit)) {
+        lf_atomic_fetch_add(&record->size, 1);
+      }
     }
   }
 }
@@ -203,12 +215,147 @@ bool wait_until(instant_t wait_until_time, lf_cond_t* condition) {
   return true;
 }
 
+interval_t lf_spin_wait_margin = LF_SPIN_WAIT_MARGIN;
+
+const char* lf_sched_profile = NULL;
+
+void lf_set_spin_wait_margin(environment_t* env, interval_t margin) {
+  assert(env != GLOBAL_ENVIRONMENT);
+  env->spin_wait_margin = margin > 0 ? margin : 0;
+}
+
+/**
+ * @brief Record how late a wait for physical time returned.
+ * @param env The environment, whose mutex is held.
+ * @param wait_until_time The target time of the wait.
+ */
+static void record_wait_lag(environment_t* env, instant_t wait_until_time) {
+  interval_t lag = lf_time_physical() - wait_until_time;
+  env->wait_lag_count++;
+  env->wait_lag_sum += lag;
+  if (lag > env->wait_lag_max) {
+    env->wait_lag_max = lag;
+  }
+  LF_PRINT_DEBUG("-------- Released " PRINTF_TIME " ns after the target physical time.", lag);
+}
+
+/**
+ * @brief Version of wait_until that uses the precision wait of the environment, if it has one.
+ *
+ * With a spin_wait_margin of zero, this behaves like wait_until on the event_q_changed
+ * condition variable. Otherwise, it sleeps on the condition variable only until the margin
+ * before wait_until_time and then spins on the physical clock with the mutex released.
+ * A call to lf_notify_of_event during the spin interrupts the wait.
+ *
+ * @param env The environment, whose mutex is held.
+ * @param wait_until_time The time to wait until physical time matches it.
+ * @return false if the wait was interrupted and true if the full wait time was reached.
+ */
+static bool wait_for_physical_time_locked(environment_t* env, instant_t wait_until_time) {
+  if (fast || wait_until_time == FOREVER) {
+    return wait_until(wait_until_time, &env->event_q_changed);
+  }
+  interval_t margin = env->spin_wait_margin;
+  if (margin == 0) {
+    if (wait_until_time <= lf_time_physical()) {
+      return true;
+    }
+    if (!wait_until(wait_until_time, &env->event_q_changed)) {
+      return false;
+    }
+    record_wait_lag(env, wait_until_time);
+    return true;
+  }
+
+  instant_t now = lf_time_physical();
+  if (wait_until_time <= now) {
+    LF_PRINT_DEBUG("We have already passed " PRINTF_TIME ". Skipping wait.", wait_until_time);
+    return true;
+  }
+  LF_PRINT_DEBUG("-------- Waiting until physical time " PRINTF_TIME ", spinning for the last " PRINTF_TIME " ns.",
+                 wait_until_time - start_time, margin);
+  if (wait_until_time - now > margin &&
+      lf_clock_cond_timedwait(&env->event_q_changed, wait_until_time - margin) != LF_TIMEOUT) {
+    LF_PRINT_DEBUG("-------- wait_until interrupted before timeout.");
+    return false;
+  }
+
+  // Spin with the mutex released so that asynchronous calls to lf_schedule() are not blocked.
+  // Those calls set event_q_notified through lf_notify_of_event() while holding the mutex,
+  // so clearing it here cannot lose a notification.
+  env->event_q_notified = 0;
+  LF_MUTEX_UNLOCK(&env->mutex);
+  bool interrupted = false;
+  while (lf_time_physical() < wait_until_time) {
+    if (*(volatile int*)&env->event_q_notified) {
+      interrupted = true;
+      break;
+    }
+  }
+  LF_MUTEX_LOCK(&env->mutex);
+  if (interrupted) {
+    LF_PRINT_DEBUG("-------- wait_until interrupted while spinning.");
+    return false;
+  }
+  record_wait_lag(env, wait_until_time);
+  return true;
+}
+
+/**
+ * @brief Wait until physical time matches or exceeds the specified time, as wait_for_physical_time_locked does.
+ *
+ * If physical actions are scheduled through the schedule inbox, this first moves any pending
+ * requests onto the event queue, in which case it returns false without waiting because the
+ * next event may have changed, and it lets producers know that they have to notify the environment.
+ *
+ * @param env The environment, whose mutex is held.
+ * @param wait_until_time The time to wait until physical time matches it.
+ * @return false if the wait was interrupted and true if the full wait time was reached.
+ */
+static bool wait_until_locked(environment_t* env, instant_t wait_until_time) {
+#ifdef LF_SCHEDULE_INBOX
+  if (!lf_schedule_inbox_begin_wait_locked(env)) {
+    lf_schedule_inbox_drain_locked(env);
+    return false;
+  }
+  bool result = wait_for_physical_time_locked(env, wait_until_time);
+  lf_schedule_inbox_end_wait_locked(env);
+  return result;
+#else
+  return wait_for_physical_time_locked(env, wait_until_time);
+#endif
+}
+
+/**
+ * @brief Report the statistics collected by record_wait_lag.
+ * Environments that use the precision wait report at info level, others at log level.
+ * @param env The environment.
+ */
+static void report_wait_lag(environment_t* env) {
+  if (env->wait_lag_count == 0) {
+    return;
+  }
+  interval_t mean = env->wait_lag_sum / (interval_t)env->wait_lag_count;
+  if (env->spin_wait_margin > 0) {
+    lf_print_info("---- Env %u: %zu waits with a spin margin of " PRINTF_TIME " ns. Mean lag " PRINTF_TIME
+                  " ns, max lag " PRINTF_TIME " ns.",
+                  env->id, env->wait_lag_count, env->spin_wait_margin, mean, env->wait_lag_max);
+  } else {
+    LF_PRINT_LOG("---- Env %u: %zu waits. Mean lag " PRINTF_TIME " ns, max lag " PRINTF_TIME " ns.", env->id,
+                 env->wait_lag_count, mean, env->wait_lag_max);
+  }
+}
+
 tag_t get_next_event_tag(environment_t* env) {
   assert(env != GLOBAL_ENVIRONMENT);
 
+#ifdef LF_SCHEDULE_INBOX
+  // Move physical actions scheduled without the mutex onto the event queue.
+  lf_schedule_inbox_drain_locked(env);
+#endif
+
   // Peek at the earliest event in the event queue.
   event_t* event = (event_t*)pqueue_tag_peek(env->event_q);
-  tag_t next_tag = FOREVER_TAG;
   if (event != NULL) {
     // There is an event in the event queue.
     if (lf_tag_compare(event->base.tag, env->current_tag) < 0) {
@@ -217,9 +364,9 @@ tag_t get_next_event_tag(environment_t* env) {
                               event->base.tag.time - start_time, event->base.tag.microstep,
                               env->current_tag.time - start_time, env->current_tag.microstep);
     }
-
-    next_tag = event->base.tag;
   }
+  // Include the next firing of the timers that are not on the event queue.
+  tag_t next_tag = _lf_earliest_event_tag(env);
 
   // If a timeout tag was given, adjust the next_tag from the
   // event tag to that timeout tag.
@@ -302,7 +449,8 @@ void _lf_next_locked(environment_t* env) {
   // behavior with centralized coordination as with unfederated execution.
 
 #else // not FEDERATED_CENTRALIZED nor LF_ENCLAVES
-  if (pqueue_tag_peek(env->event_q) == NULL && !keepalive_specified) {
+  if (pqueue_tag_peek(env->event_q) == NULL && lf_timer_table_next_time(env->timer_table) == FOREVER &&
+      !keepalive_specified) {
     // There is no event on the event queue and keepalive is false.
     // No event in the queue
     // keepalive is not set so we should stop.
@@ -325,7 +473,7 @@ void _lf_next_locked(environment_t* env) {
     wait_until_time = lf_wait_until_time(next_tag);
 #endif // FEDERATED_DECENTRALIZED
     LF_PRINT_LOG("Waiting until elapsed time " PRINTF_TIME ".", (wait_until_time - start_time));
-    if (wait_until(wait_until_time, &env->event_q_changed)) {
+    if (wait_until_locked(env, wait_until_time)) {
       // Waited the full time.
       break;
     }
@@ -415,6 +563,13 @@ bool lf_stop_requested = false;
 void lf_request_stop(void) {
   // If a requested stop is pending, return without doing anything.
   LF_PRINT_LOG("lf_request_stop() has been called.");
+#ifdef LF_PIPELINED_TAGS
+  // As with scheduling a logical action, only these reactions are sure to execute at the newest tag.
+  if (_lf_worker_in_reaction() && !_lf_worker_may_schedule_actions()) {
+    lf_print_error_and_exit("With pipelined tags, a reaction that requests to stop must be one of the "
+                            "scheduling_reactions in sched_params_t.");
+  }
+#endif
   LF_MUTEX_LOCK(&global_mutex);
   if (lf_stop_requested) {
     LF_MUTEX_UNLOCK(&global_mutex);
@@ -431,8 +586,10 @@ void lf_request_stop(void) {
   int num_environments = _lf_get_environments(&env);
   for (int i = 0; i < num_environments; i++) {
     LF_MUTEX_LOCK(&env[i].mutex);
-    if (lf_tag_compare(env[i].current_tag, max_current_tag) > 0) {
-      max_current_tag = env[i].current_tag;
+    // With pipelined tags, the calling reaction may execute at an earlier tag than the current tag.
+    tag_t current_tag = lf_tag(&env[i]);
+    if (lf_tag_compare(current_tag, max_current_tag) > 0) {
+      max_current_tag = current_tag;
     }
     // Set a barrier to prevent the enclave from advancing past the so-far maximum current tag.
     _lf_increment_tag_barrier_locked(&env[i], max_current_tag);
@@ -461,10 +618,10 @@ void lf_request_stop(void) {
     // Release the barrier on tag advancement.
     _lf_decrement_tag_barrier_locked(&env[i]);
 
-    // We signal instead of broadcast under the assumption that only
-    // one worker thread can call wait_until at a given time because
-    // the call to wait_until is protected by a mutex lock
-    lf_cond_signal(&env->event_q_changed);
+    // Only one worker thread can call wait_until at a given time because
+    // the call to wait_until is protected by a mutex lock, but that worker
+    // may be spinning with the mutex released, so notify it through the flag too.
+    lf_notify_of_event(&env[i]);
     LF_MUTEX_UNLOCK(&env[i].mutex);
   }
 #endif
@@ -494,8 +651,9 @@ void _lf_trigger_reaction(environment_t* env, reaction_t* reaction, int worker_n
  *
  * This assumes the mutex lock is held by the caller.
  * @param env Environment within which we are executing.
+ * @param phase_start Start time of the current phase for `--startup-profile`.
  */
-static void _lf_initialize_start_tag(environment_t* env) {
+static void _lf_initialize_start_tag(environment_t* env, instant_t* phase_start) {
   assert(env != GLOBAL_ENVIRONMENT);
 
   // Add reactions invoked at tag (0,0) (including startup reactions) to the reaction queue
@@ -512,6 +670,7 @@ static void _lf_initialize_start_tag(environment_t* env) {
 
     // Get a start_time from the RTI
     lf_synchronize_with_other_federates(); // Resets start_time in federated execution according to the RTI.
+    lf_startup_profile_phase(env, "synchronization with other federates", phase_start);
   }
 
   // The start time will likely have changed. Adjust the current tag and stop tag.
@@ -523,6 +682,7 @@ static void _lf_initialize_start_tag(environment_t* env) {
 
 #if defined FEDERATED_DECENTRALIZED
   bool timers_triggered_at_start = _lf_initialize_timers(env);
+  lf_startup_profile_phase(env, "startup reactions and timers", phase_start);
 
   // If we have a non-zero STA offset, then we need to allow messages to arrive
   // at the start time.  To avoid spurious STP violations, we temporarily
@@ -530,6 +690,7 @@ static void _lf_initialize_start_tag(environment_t* env) {
   env->current_tag.time -= 1;
 #else
   _lf_initialize_timers(env);
+  lf_startup_profile_phase(env, "startup reactions and timers", phase_start);
   // For other than federated decentralized execution, there is no lf_fed_STA_offset variable defined.
   // To use uniform code below, we define it here as a local variable.
   instant_t lf_fed_STA_offset = 0;
@@ -545,8 +706,9 @@ static void _lf_initialize_start_tag(environment_t* env) {
   // the required waiting time. Second, this call releases the mutex lock and allows
   // other threads (specifically, federate threads that handle incoming p2p messages
   // from other federates) to hold the lock and possibly raise a tag barrier.
-  while (!wait_until(start_time, &env->event_q_changed)) {
+  while (!wait_until_locked(env, start_time)) {
   };
+  lf_startup_profile_phase(env, "wait for start time", phase_start);
   LF_PRINT_DEBUG("Done waiting for start time + STA offset " PRINTF_TIME ".", start_time + lf_fed_STA_offset);
   LF_PRINT_DEBUG("Physical time is ahead of current time by " PRINTF_TIME ". This should be close to the STA offset.",
                  lf_time_physical() - start_time);
@@ -592,7 +754,7 @@ static void _lf_initialize_start_tag(environment_t* env) {
     // There are no startup reactions, so we can wait for the earliest event on the event queue.
     tag_t next_tag = get_next_event_tag(env);
     if (next_tag.time > start_time) {
-      while (!wait_until(next_tag.time, &env->event_q_changed)) {
+      while (!wait_until_locked(env, next_tag.time)) {
         // Did not wait the full time. Check for a new next_tag.
         next_tag = get_next_event_tag(env);
       }
@@ -613,6 +775,7 @@ static void _lf_initialize_start_tag(environment_t* env) {
 
 #else  // NOT FEDERATED
   _lf_initialize_timers(env);
+  lf_startup_profile_phase(env, "startup reactions and timers", phase_start);
 
   // If the stop_tag is (0,0), also insert the shutdown
   // reactions. This can only happen if the timeout time
@@ -635,6 +798,7 @@ static void _lf_initialize_start_tag(environment_t* env) {
   // guaranteed to be the case since the DNET optimization.
   LF_PRINT_LOG("Env %u: Received the first TAG: " PRINTF_TAG, env->id, tag_granted.time - start_time,
                tag_granted.microstep);
+  lf_startup_profile_phase(env, "wait for the first TAG", phase_start);
 #endif
 
   // Set the following boolean so that other thread(s), including federated threads,
@@ -671,7 +835,7 @@ static bool _lf_worker_handle_deadline_violation_for_reaction(environment_t* env
     // Get the current physical time.
     instant_t physical_time = lf_time_physical();
     // Check for deadline violation.
-    if (reaction->deadline == 0 || physical_time > lf_time_add(env->current_tag.time, reaction->deadline)) {
+    if (reaction->deadline == 0 || physical_time > lf_time_add(lf_time_logical(env), reaction->deadline)) {
       // Deadline violation has occurred.
       tracepoint_reaction_deadline_missed(env, reaction, worker_number);
       violation_occurred = true;
@@ -867,6 +1031,9 @@ static void* worker(void* arg) {
   int worker_number = env->worker_thread_count++;
   LF_PRINT_LOG("Env %u: Worker thread %d started.", env->id, worker_number);
 
+  // Pin the worker and set its scheduling policy, if requested.
+  lf_worker_placement_apply(env, worker_number);
+
   // Release mutex and start working.
   LF_MUTEX_UNLOCK(&env->mutex);
   _lf_worker_do_work(env, worker_number);
@@ -889,7 +1056,7 @@ static void* worker(void* arg) {
 #endif
   }
 
-  lf_cond_signal(&env->event_q_changed);
+  lf_notify_of_event(env);
 
   LF_PRINT_DEBUG("Worker %d: Stop requested. Exiting.", worker_number);
   LF_MUTEX_UNLOCK(&env->mutex);
@@ -957,9 +1124,11 @@ static void determine_number_of_workers(void) {
  */
 static void* initialize_environments(void* arg) {
   environment_t* env = (environment_t*)arg;
+  instant_t phase_start = lf_time_physical();
 
   // Initialize the watchdogs on this environment.
   _lf_initialize_watchdogs(env);
+  lf_startup_profile_phase(env, "watchdogs", &phase_start);
 
   // Initialize the start and stop tags of the environment
   environment_init_tags(env, start_time, duration);
@@ -967,13 +1136,14 @@ static void* initialize_environments(void* arg) {
   // Set up modal infrastructure
   _lf_initialize_modes(env);
 #endif
+  lf_startup_profile_phase(env, "tags and modes", &phase_start);
 
   // Lock mutex and spawn threads. This must be done before `_lf_initialize_start_tag` since it is using
   //  a cond var
   LF_MUTEX_LOCK(&env->mutex);
 
   // Initialize start tag
-  _lf_initialize_start_tag(env);
+  _lf_initialize_start_tag(env, &phase_start);
 
   LF_PRINT_LOG("Env %u: ---- Spawning %d workers.", env->id, env->num_workers);
 
@@ -991,6 +1161,8 @@ static void* initialize_environments(void* arg) {
     }
   }
 
+  lf_startup_profile_phase(env, "spawning workers", &phase_start);
+
   // Unlock mutex and allow threads to proceed
   LF_MUTEX_UNLOCK(&env->mutex);
 
@@ -1010,6 +1182,13 @@ static void* initialize_environments(void* arg) {
       ret = worker_exit_status;
     }
   }
+  report_wait_lag(env);
+#ifdef LF_SCHEDULE_INBOX
+  // Requests pushed after the last tag are discarded along with the rest of the event queue at termination.
+  LF_MUTEX_LOCK(&env->mutex);
+  lf_schedule_inbox_drain_locked(env);
+  LF_MUTEX_UNLOCK(&env->mutex);
+#endif
   return ret;
 }
 
@@ -1096,7 +1275,9 @@ int lf_reactor_c_main(int argc, const char* argv[]) {
 #endif // MINIMAL_STDLIB
 
   // Create and initialize the environments for each enclave
+  instant_t phase_start = lf_time_physical();
   lf_create_environments();
+  lf_startup_profile_phase(NULL, "environments", &phase_start);
 
   // Initialize the one global mutex
   LF_MUTEX_INIT(&global_mutex);
@@ -1108,10 +1289,15 @@ int lf_reactor_c_main(int argc, const char* argv[]) {
   environment_t* envs;
   int num_envs = _lf_get_environments(&envs);
 
+  phase_start = lf_time_physical();
 #if defined LF_ENCLAVES
   initialize_local_rti(envs, num_envs);
 #endif
 
+  // Decide which CPUs the workers of each environment run on, if requested.
+  lf_worker_placement_init(envs, num_envs);
+  lf_startup_profile_phase(NULL, "local RTI and worker placement", &phase_start);
+
   // Do environment-specific setup. Except for environment 0, this will be done
   // in a separate thread for each environment because it may block waiting for the
   // first TAG. Also, it will block waiting for its worker threads to exit.
@@ -1164,6 +1350,8 @@ int lf_reactor_c_main(int argc, const char* argv[]) {
 
 int lf_notify_of_event(environment_t* env) {
   assert(env != GLOBAL_ENVIRONMENT);
+  // Interrupt a wait that is spinning without the mutex.
+  lf_atomic_fetch_add(&env->event_q_notified, 1);
   return lf_cond_broadcast(&env->event_q_changed);
 }
 
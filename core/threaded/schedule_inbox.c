@@ -0,0 +1,127 @@
+/**
+ * @file
+ *
+ * @brief Lock-free inbox for scheduling physical actions without the environment mutex.
+ *
+ * The inbox is a linked stack of requests onto which producers push with a compare-and-swap.
+ * The consumer takes the whole stack at once by swapping in NULL and reverses it, so there
+ * is no ABA problem and each producer's requests are scheduled in the order it pushed them.
+ *
+ * A lost wakeup is prevented as follows. The waiting thread sets schedule_inbox_waiting and
+ * then checks that the inbox is empty, both while holding the mutex. A producer pushes and then
+ * reads schedule_inbox_waiting. Both the compare-and-swap and the atomic update of the flag are
+ * full barriers, so either the waiting thread sees the request or the producer sees the flag,
+ * in which case it notifies the environment while holding the mutex, which the waiting
+ * thread only releases inside the wait.
+ *
+ * See schedule_inbox.h for docs.
+ */
+#if !defined LF_SINGLE_THREADED
+
+#include <stdlib.h>
+
+#include "schedule_inbox.h"
+#include "api/schedule.h"
+#include "low_level_platform.h"
+#include "pqueue_base.h"
+#include "reactor.h"
+#include "util.h"
+
+// Global variable defined in reactor_common.c:
+extern bool _lf_termination_executed;
+
+/** A request in the inbox. */
+typedef struct lf_schedule_inbox_entry_t {
+  struct lf_schedule_inbox_entry_t* next;
+  trigger_t* trigger;
+  interval_t extra_delay;
+  lf_token_t* token;
+  instant_t physical_time;
+} lf_schedule_inbox_entry_t;
+
+bool lf_schedule_inbox_push(environment_t* env, trigger_t* trigger, interval_t extra_delay, lf_token_t* token) {
+#ifndef LF_SCHEDULE_INBOX
+  (void)env;
+  (void)trigger;
+  (void)extra_delay;
+  (void)token;
+  return false;
+#else
+  if (trigger == NULL || !trigger->is_physical || _lf_termination_executed) {
+    return false;
+  }
+  // Checking for a conflicting event when scheduling takes time proportional to the size of the event
+  // queue, so requests are only accepted while the event queue is short. The size of the event queue is
+  // read without holding the mutex, which is good enough for this heuristic.
+  size_t queued = pqueue_tag_size(env->event_q);
+  if (queued >= LF_SCHEDULE_INBOX_CAPACITY) {
+    return false;
+  }
+  if (lf_atomic_add_fetch(&env->schedule_inbox_size, 1) > LF_SCHEDULE_INBOX_CAPACITY - (int)queued) {
+    lf_atomic_fetch_add(&env->schedule_inbox_size, -1);
+    return false;
+  }
+  lf_schedule_inbox_entry_t* entry = (lf_schedule_inbox_entry_t*)malloc(sizeof(lf_schedule_inbox_entry_t));
+  LF_ASSERT_NON_NULL(entry);
+  entry->trigger = trigger;
+  entry->extra_delay = extra_delay;
+  entry->token = token;
+  entry->physical_time = lf_time_physical();
+
+  void* head;
+  do {
+    head = env->schedule_inbox;
+    entry->next = (lf_schedule_inbox_entry_t*)head;
+  } while (lf_atomic_val_compare_and_swap_ptr((void**)&env->schedule_inbox, head, entry) != head);
+
+  // Only acquire the mutex if the thread advancing the tag may be waiting for physical time to pass.
+  if (*(volatile int*)&env->schedule_inbox_waiting) {
+    LF_MUTEX_LOCK(&env->mutex);
+    lf_notify_of_event(env);
+    LF_MUTEX_UNLOCK(&env->mutex);
+  }
+  return true;
+#endif // LF_SCHEDULE_INBOX
+}
+
+void lf_schedule_inbox_drain_locked(environment_t* env) {
+  if (*(lf_schedule_inbox_entry_t* volatile*)&env->schedule_inbox == NULL) {
+    return;
+  }
+  void* head;
+  do {
+    head = env->schedule_inbox;
+  } while (lf_atomic_val_compare_and_swap_ptr((void**)&env->schedule_inbox, head, NULL) != head);
+
+  // Reverse the stack to get the requests in the order in which they were pushed.
+  lf_schedule_inbox_entry_t* reversed = NULL;
+  lf_schedule_inbox_entry_t* entry = (lf_schedule_inbox_entry_t*)head;
+  int count = 0;
+  while (entry != NULL) {
+    lf_schedule_inbox_entry_t* next = entry->next;
+    entry->next = reversed;
+    reversed = entry;
+    entry = next;
+    count++;
+  }
+  lf_atomic_fetch_add(&env->schedule_inbox_size, -count);
+  while (reversed != NULL) {
+    entry = reversed;
+    reversed = entry->next;
+    lf_schedule_trigger_at_physical_time(env, entry->trigger, entry->extra_delay, entry->token, entry->physical_time);
+    free(entry);
+  }
+}
+
+bool lf_schedule_inbox_begin_wait_locked(environment_t* env) {
+  lf_atomic_fetch_add(&env->schedule_inbox_waiting, 1);
+  if (*(lf_schedule_inbox_entry_t* volatile*)&env->schedule_inbox != NULL) {
+    lf_atomic_fetch_add(&env->schedule_inbox_waiting, -1);
+    return false;
+  }
+  return true;
+}
+
+void lf_schedule_inbox_end_wait_locked(environment_t* env) { lf_atomic_fetch_add(&env->schedule_inbox_waiting, -1); }
+
+#endif // !LF_SINGLE_THREADED
@@ -0,0 +1,347 @@
+/**
+ * @file
+ *
+ * @brief Global Earliest Deadline First (GEDF) non-preemptive scheduler with a relaxed
+ * concurrent priority queue for the threaded runtime of the C target of Lingua Franca.
+ *
+ * Like the GEDF_NP scheduler, this scheduler executes the reactions of each tag level by level
+ * and, within a level, prefers reactions with the smallest (inferred) deadline. Unlike GEDF_NP,
+ * it does not keep a single reaction queue protected by the environment mutex. Instead, each
+ * level has a MultiQueue: an array of small priority queues, each with its own mutex.
+ * A reaction is inserted into a randomly chosen queue. A worker pops from the better of two
+ * randomly chosen queues, comparing their heads without locking. The order in which reactions
+ * of a level are executed is therefore only approximately by deadline, but neither getting nor
+ * triggering a reaction acquires the environment mutex, which is only held to advance the tag.
+ *
+ * The number of reactions at each level is kept in the atomic `indexes` of the scheduler.
+ * A worker first claims one of the reactions of the current level by decrementing that count,
+ * and only then looks for it in the queues, so a claim always succeeds eventually.
+ * Advancing the level and the tag works as in the NP scheduler: the last worker to go idle
+ * does it and releases as many other workers as there are reactions at the new level.
+ */
+#include "lf_types.h"
+
+#if SCHEDULER == SCHED_GEDF_MQ
+
+#ifndef NUMBER_OF_WORKERS
+#define NUMBER_OF_WORKERS 1
+#endif // NUMBER_OF_WORKERS
+
+#include <assert.h>
+#include <limits.h>
+
+#include "low_level_platform.h"
+#include "environment.h"
+#include "lf_semaphore.h"
+#include "pqueue.h"
+#include "reactor_threaded.h"
+#include "scheduler_instance.h"
+#include "scheduler_sync_tag_advance.h"
+#include "scheduler.h"
+#include "tracepoint.h"
+#include "util.h"
+
+#ifdef FEDERATED
+#include "federate.h"
+#endif
+
+/** Number of queues per level for each worker thread. */
+#define QUEUES_PER_WORKER 2
+
+/** Head index of a queue that is empty. This is larger than the index of any reaction. */
+#define EMPTY_QUEUE ULLONG_MAX
+
+/** One of the queues of a level. */
+typedef struct mq_queue_t {
+  lf_mutex_t mutex;
+  pqueue_reaction_t* reactions;
+  /** The index of the reaction at the head, or EMPTY_QUEUE. This is read without holding the mutex. */
+  volatile pqueue_pri_t head;
+} mq_queue_t;
+
+// Data specific to the GEDF_MQ scheduler.
+typedef struct custom_scheduler_data_t {
+  mq_queue_t** queues; // queues[level] is an array of number_of_queues queues.
+  size_t number_of_queues;
+  volatile size_t current_level;
+  // State of the random number generator of each worker. Entry 0 is shared by
+  // callers that are not workers. A race on that entry only affects which queue is chosen.
+  unsigned int* random_state;
+  lf_semaphore_t* semaphore; // Signal the maximum number of worker threads that should
+                             // be executing work at the same time.
+} custom_scheduler_data_t;
+
+/////////////////// Scheduler Private API /////////////////////////
+
+/**
+ * @brief Return a pseudorandom queue number for the given worker.
+ * @param scheduler The scheduler.
+ * @param worker_number The number of the worker thread, or -1 if the caller is not a worker.
+ */
+static inline size_t random_queue(lf_scheduler_t* scheduler, int worker_number) {
+  unsigned int* state = &scheduler->custom_data->random_state[worker_number + 1];
+  // Xorshift32.
+  unsigned int x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x % scheduler->custom_data->number_of_queues;
+}
+
+/**
+ * @brief Insert a reaction into a random queue of its level and make it available to workers.
+ * @param scheduler The scheduler.
+ * @param reaction The reaction.
+ * @param worker_number The number of the worker thread, or -1 if the caller is not a worker.
+ */
+static void insert_reaction(lf_scheduler_t* scheduler, reaction_t* reaction, int worker_number) {
+  size_t level = (size_t)LF_LEVEL(reaction->index);
+  mq_queue_t* queue = &scheduler->custom_data->queues[level][random_queue(scheduler, worker_number)];
+  LF_MUTEX_LOCK(&queue->mutex);
+  pqueue_reaction_insert(queue->reactions, reaction);
+  queue->head = ((reaction_t*)pqueue_reaction_peek(queue->reactions))->index;
+  LF_MUTEX_UNLOCK(&queue->mutex);
+  // Only count the reaction once it is in a queue, so that every claim can be satisfied.
+  lf_atomic_fetch_add((int*)&scheduler->indexes[level], 1);
+}
+
+/**
+ * @brief Claim one of the reactions at the given level, if there is any.
+ * @return true if a reaction was claimed.
+ */
+static bool claim_reaction(lf_scheduler_t* scheduler, size_t level) {
+  int count;
+  while ((count = scheduler->indexes[level]) > 0) {
+    if (lf_atomic_bool_compare_and_swap((int*)&scheduler->indexes[level], count, count - 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Pop a reaction at the given level, which the caller has claimed.
+ * @param scheduler The scheduler.
+ * @param level The level.
+ * @param worker_number The number of the worker thread.
+ */
+static reaction_t* pop_claimed_reaction(lf_scheduler_t* scheduler, size_t level, int worker_number) {
+  mq_queue_t* queues = scheduler->custom_data->queues[level];
+  size_t number_of_queues = scheduler->custom_data->number_of_queues;
+  while (true) {
+    // Choose the better of two random queues by their heads.
+    size_t i = random_queue(scheduler, worker_number);
+    size_t j = random_queue(scheduler, worker_number);
+    if (queues[j].head < queues[i].head) {
+      i = j;
+    }
+    if (queues[i].head == EMPTY_QUEUE) {
+      // Both were empty. Look for any queue that is not.
+      for (i = 0; i < number_of_queues && queues[i].head == EMPTY_QUEUE; i++)
+        ;
+      if (i == number_of_queues) {
+        continue;
+      }
+    }
+    mq_queue_t* queue = &queues[i];
+    LF_MUTEX_LOCK(&queue->mutex);
+    reaction_t* reaction = (reaction_t*)pqueue_reaction_pop(queue->reactions);
+    reaction_t* head = (reaction_t*)pqueue_reaction_peek(queue->reactions);
+    queue->head = head == NULL ? EMPTY_QUEUE : head->index;
+    LF_MUTEX_UNLOCK(&queue->mutex);
+    if (reaction != NULL) {
+      return reaction;
+    }
+    // Another worker emptied the queue after we looked at its head.
+  }
+}
+
+/**
+ * @brief Signal all worker threads that it is time to stop.
+ */
+static void signal_stop(lf_scheduler_t* scheduler) {
+  scheduler->should_stop = true;
+  lf_semaphore_release(scheduler->custom_data->semaphore, (scheduler->number_of_workers - 1));
+}
+
+/**
+ * @brief Advance to the next level that has reactions, advancing the tag if necessary,
+ * and release as many idle workers as there are reactions at that level.
+ *
+ * This is called by the last worker to go idle, so no reactions are executing.
+ */
+static void try_advance_level_or_tag_and_distribute(lf_scheduler_t* scheduler) {
+  environment_t* env = scheduler->env;
+  while (true) {
+    size_t level = scheduler->custom_data->current_level;
+    while (level <= scheduler->max_reaction_level && scheduler->indexes[level] == 0) {
+      level++;
+    }
+    if (level <= scheduler->max_reaction_level) {
+#ifdef FEDERATED
+      lf_stall_advance_level_federation(env, level);
+#endif
+      LF_PRINT_DEBUG("Scheduler: Advancing to reaction level %zu.", level);
+      scheduler->custom_data->current_level = level;
+      size_t workers_to_awaken = LF_MIN(scheduler->number_of_idle_workers, (size_t)scheduler->indexes[level]);
+      scheduler->number_of_idle_workers -= workers_to_awaken;
+      if (workers_to_awaken > 1) {
+        // Notify all the workers except the worker thread that has called this function.
+        lf_semaphore_release(scheduler->custom_data->semaphore, (workers_to_awaken - 1));
+      }
+      return;
+    }
+    scheduler->custom_data->current_level = 0;
+    LF_MUTEX_LOCK(&env->mutex);
+    LF_PRINT_DEBUG("Scheduler: Advancing tag.");
+    if (_lf_sched_advance_tag_locked(scheduler)) {
+      LF_PRINT_DEBUG("Scheduler: Reached stop tag.");
+      signal_stop(scheduler);
+      LF_MUTEX_UNLOCK(&env->mutex);
+      return;
+    }
+    LF_MUTEX_UNLOCK(&env->mutex);
+  }
+}
+
+/**
+ * @brief Wait until the scheduler assigns work.
+ *
+ * If the calling worker thread is the last to become idle, it will advance the level or tag.
+ * Otherwise, it will wait on the semaphore.
+ * @param worker_number The number of the worker thread.
+ */
+static void wait_for_work(lf_scheduler_t* scheduler, int worker_number) {
+  if (lf_atomic_add_fetch((int*)&scheduler->number_of_idle_workers, 1) == (int)scheduler->number_of_workers) {
+    LF_PRINT_DEBUG("Scheduler: Worker %d is the last idle thread.", worker_number);
+    try_advance_level_or_tag_and_distribute(scheduler);
+  } else {
+    LF_PRINT_DEBUG("Scheduler: Worker %d is trying to acquire the scheduling semaphore.", worker_number);
+    lf_semaphore_acquire(scheduler->custom_data->semaphore);
+    LF_PRINT_DEBUG("Scheduler: Worker %d acquired the scheduling semaphore.", worker_number);
+  }
+}
+
+///////////////////// Scheduler Init and Destroy API /////////////////////////
+/**
+ * @brief Initialize the scheduler.
+ *
+ * This has to be called before other functions of the scheduler can be used.
+ * If the scheduler is already initialized, this will be a no-op.
+ *
+ * @param env Environment within which we are executing.
+ * @param number_of_workers Indicate how many workers this scheduler will be
+ *  managing.
+ * @param option Pointer to a `sched_params_t` struct containing additional
+ *  scheduler parameters.
+ */
+void lf_sched_init(environment_t* env, size_t number_of_workers, sched_params_t* params) {
+  assert(env != GLOBAL_ENVIRONMENT);
+
+  LF_PRINT_DEBUG("Env %u: Scheduler: Initializing with %zu workers", env->id, number_of_workers);
+  if (!init_sched_instance(env, &env->scheduler, number_of_workers, params)) {
+    // Already initialized
+    return;
+  }
+  lf_scheduler_t* scheduler = env->scheduler;
+  size_t number_of_levels = scheduler->max_reaction_level + 1;
+
+  scheduler->custom_data = (custom_scheduler_data_t*)calloc(1, sizeof(custom_scheduler_data_t));
+  LF_ASSERT_NON_NULL(scheduler->custom_data);
+  custom_scheduler_data_t* data = scheduler->custom_data;
+
+  data->number_of_queues = QUEUES_PER_WORKER * number_of_workers;
+  data->queues = (mq_queue_t**)calloc(number_of_levels, sizeof(mq_queue_t*));
+  LF_ASSERT_NON_NULL(data->queues);
+  for (size_t level = 0; level < number_of_levels; level++) {
+    size_t queue_size = INITIAL_REACT_QUEUE_SIZE;
+    if (params != NULL && params->num_reactions_per_level != NULL && level < params->num_reactions_per_level_size) {
+      queue_size = params->num_reactions_per_level[level] / data->number_of_queues + 1;
+    }
+    data->queues[level] = (mq_queue_t*)calloc(data->number_of_queues, sizeof(mq_queue_t));
+    LF_ASSERT_NON_NULL(data->queues[level]);
+    for (size_t i = 0; i < data->number_of_queues; i++) {
+      mq_queue_t* queue = &data->queues[level][i];
+      LF_MUTEX_INIT(&queue->mutex);
+      queue->reactions = pqueue_reaction_init(queue_size);
+      queue->head = EMPTY_QUEUE;
+    }
+  }
+
+  data->random_state = (unsigned int*)calloc(number_of_workers + 1, sizeof(unsigned int));
+  LF_ASSERT_NON_NULL(data->random_state);
+  for (size_t i = 0; i <= number_of_workers; i++) {
+    // Xorshift needs a nonzero seed.
+    data->random_state[i] = 2654435761u * (unsigned int)(i + 1);
+  }
+
+  data->semaphore = lf_semaphore_new(0);
+  data->current_level = 0;
+  scheduler->indexes = (volatile int*)calloc(number_of_levels, sizeof(volatile int));
+  LF_ASSERT_NON_NULL(scheduler->indexes);
+}
+
+/**
+ * @brief Free the memory used by the scheduler.
+ *
+ * This must be called when the scheduler is no longer needed.
+ */
+void lf_sched_free(lf_scheduler_t* scheduler) {
+  custom_scheduler_data_t* data = scheduler->custom_data;
+  if (data == NULL) {
+    return;
+  }
+  for (size_t level = 0; level <= scheduler->max_reaction_level; level++) {
+    for (size_t i = 0; i < data->number_of_queues; i++) {
+      pqueue_reaction_free(data->queues[level][i].reactions);
+    }
+    free(data->queues[level]);
+  }
+  free(data->queues);
+  free(data->random_state);
+  lf_semaphore_destroy(data->semaphore);
+  free(data);
+}
+
+///////////////////// Scheduler Worker API (public) /////////////////////////
+
+reaction_t* lf_sched_get_ready_reaction(lf_scheduler_t* scheduler, int worker_number) {
+  // Iterate until the stop tag is reached.
+  while (!scheduler->should_stop) {
+    // The current level only changes while all workers, including this one, are idle.
+    size_t current_level = scheduler->custom_data->current_level;
+    if (claim_reaction(scheduler, current_level)) {
+      reaction_t* reaction_to_return = pop_claimed_reaction(scheduler, current_level, worker_number);
+      LF_PRINT_DEBUG("Scheduler: Worker %d popped reaction %s at level %zu.", worker_number, reaction_to_return->name,
+                     current_level);
+      return reaction_to_return;
+    }
+
+    LF_PRINT_DEBUG("Worker %d is out of ready reactions.", worker_number);
+
+    // Ask the scheduler for more work and wait
+    tracepoint_worker_wait_starts(scheduler->env, worker_number);
+    wait_for_work(scheduler, worker_number);
+    tracepoint_worker_wait_ends(scheduler->env, worker_number);
+  }
+
+  // It's time for the worker thread to stop and exit.
+  return NULL;
+}
+
+void lf_sched_done_with_reaction(size_t worker_number, reaction_t* done_reaction) {
+  (void)worker_number; // Suppress unused parameter warning.
+  if (!lf_atomic_bool_compare_and_swap((int*)&done_reaction->status, queued, inactive)) {
+    lf_print_error_and_exit("Unexpected reaction status: %d. Expected %d.", done_reaction->status, queued);
+  }
+}
+
+void lf_scheduler_trigger_reaction(lf_scheduler_t* scheduler, reaction_t* reaction, int worker_number) {
+  if (reaction == NULL || !lf_atomic_bool_compare_and_swap((int*)&reaction->status, inactive, queued)) {
+    return;
+  }
+  LF_PRINT_DEBUG("Scheduler: Enqueueing reaction %s, which has level %lld.", reaction->name, LF_LEVEL(reaction->index));
+  insert_reaction(scheduler, reaction, worker_number);
+}
+#endif // SCHEDULER == SCHED_GEDF_MQ
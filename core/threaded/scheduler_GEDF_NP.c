@@ -41,7 +41,7 @@
 
 // Data specific to the GEDF scheduler.
 typedef struct custom_scheduler_data_t {
-  pqueue_t* reaction_q;
+  pqueue_reaction_t* reaction_q;
   lf_cond_t reaction_q_changed;
   size_t current_level;
   bool solo_holds_mutex; // Indicates sole thread holds the mutex.
@@ -132,9 +132,7 @@ void lf_sched_init(environment_t* env, size_t number_of_workers, sched_params_t*
 
   // Initialize the reaction queue.
   size_t queue_size = INITIAL_REACT_QUEUE_SIZE;
-  scheduler->custom_data->reaction_q =
-      pqueue_init(queue_size, in_reverse_order, get_reaction_index, get_reaction_position, set_reaction_position,
-                  reaction_matches, print_reaction);
+  scheduler->custom_data->reaction_q = pqueue_reaction_init(queue_size);
 
   LF_COND_INIT(&scheduler->custom_data->reaction_q_changed, &env->mutex);
 
@@ -147,7 +145,7 @@ void lf_sched_init(environment_t* env, size_t number_of_workers, sched_params_t*
  * This must be called when the scheduler is no longer needed.
  */
 void lf_sched_free(lf_scheduler_t* scheduler) {
-  pqueue_free((pqueue_t*)scheduler->custom_data->reaction_q);
+  pqueue_reaction_free(scheduler->custom_data->reaction_q);
   free(scheduler->custom_data);
 }
 
@@ -161,7 +159,7 @@ reaction_t* lf_sched_get_ready_reaction(lf_scheduler_t* scheduler, int worker_nu
 
   // Iterate until the stop_tag is reached or the event queue is empty.
   while (!scheduler->should_stop) {
-    reaction_t* reaction_to_return = (reaction_t*)pqueue_peek(scheduler->custom_data->reaction_q);
+    reaction_t* reaction_to_return = (reaction_t*)pqueue_reaction_peek(scheduler->custom_data->reaction_q);
     if (reaction_to_return != NULL) {
       // Found a reaction.  Check the level.  Notice that because of deadlines, the current level
       // may advance to the maximum and then back down to 0.
@@ -170,11 +168,11 @@ reaction_t* lf_sched_get_ready_reaction(lf_scheduler_t* scheduler, int worker_nu
         LF_PRINT_DEBUG("Scheduler: Worker %d found a reaction at level %zu.", worker_number,
                        scheduler->custom_data->current_level);
         // Remove the reaction from the queue.
-        pqueue_pop(scheduler->custom_data->reaction_q);
+        pqueue_reaction_pop(scheduler->custom_data->reaction_q);
 
         // If there is another reaction at the current level and an idle thread, then
         // notify an idle thread.
-        reaction_t* next_reaction = (reaction_t*)pqueue_peek(scheduler->custom_data->reaction_q);
+        reaction_t* next_reaction = (reaction_t*)pqueue_reaction_peek(scheduler->custom_data->reaction_q);
         if (next_reaction != NULL && LF_LEVEL(next_reaction->index) == scheduler->custom_data->current_level &&
             scheduler->number_of_idle_workers > 0) {
           // Notify an idle thread. Note that we could do a broadcast here, but it's probably not
@@ -245,14 +243,14 @@ void lf_scheduler_trigger_reaction(lf_scheduler_t* scheduler, reaction_t* reacti
     LF_MUTEX_LOCK(&scheduler->env->mutex);
     LF_PRINT_DEBUG("Scheduler: Locked mutex for environment.");
   }
-  pqueue_insert(scheduler->custom_data->reaction_q, (void*)reaction);
+  pqueue_reaction_insert(scheduler->custom_data->reaction_q, (void*)reaction);
   if (!scheduler->custom_data->solo_holds_mutex) {
     // If this is called from a reaction execution, then the triggered reaction
     // has one level higher than the current level. No need to notify idle threads.
     // But in federated execution, it could be called because of message arrival.
     // Also, in modal models, reset and startup reactions may be triggered.
 #if defined(FEDERATED) || (defined(MODAL) && !defined(LF_SINGLE_THREADED))
-    reaction_t* triggered_reaction = (reaction_t*)pqueue_peek(scheduler->custom_data->reaction_q);
+    reaction_t* triggered_reaction = (reaction_t*)pqueue_reaction_peek(scheduler->custom_data->reaction_q);
     if (LF_LEVEL(triggered_reaction->index) == scheduler->custom_data->current_level) {
       LF_COND_SIGNAL(&scheduler->custom_data->reaction_q_changed);
     }
@@ -13,11 +13,14 @@
 #endif // NUMBER_OF_WORKERS
 
 #include <assert.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "environment.h"
 #include "scheduler_sync_tag_advance.h"
 #include "scheduler.h"
 #include "environment.h"
+#include "reactor_threaded.h"
 #include "util.h"
 
 #ifdef FEDERATED
@@ -38,6 +41,8 @@ static void data_collection_start_level(lf_scheduler_t* scheduler, size_t level)
 static void data_collection_end_level(lf_scheduler_t* scheduler, size_t level, size_t num_workers);
 static void data_collection_end_tag(lf_scheduler_t* scheduler, size_t* num_workers_by_level,
                                     size_t* max_num_workers_by_level);
+static void profile_load(lf_scheduler_t* scheduler);
+static void profile_save(lf_scheduler_t* scheduler);
 /**
  * The level counter is a number that changes whenever the current level changes.
  *
@@ -86,6 +91,8 @@ typedef struct {
 typedef struct {
   interval_t* start_times_by_level;
   interval_t** execution_times_by_num_workers_by_level;
+  /** The weight of each execution time relative to a new measurement of it. */
+  size_t** execution_time_memories_by_num_workers_by_level;
   interval_t* execution_times_mins;
   size_t* execution_times_argmins;
   size_t data_collection_counter;
@@ -349,7 +356,8 @@ static void worker_states_lock(lf_scheduler_t* scheduler, size_t worker) {
   worker_states_t* worker_states = scheduler->custom_data->worker_states;
   worker_assignments_t* worker_assignments = scheduler->custom_data->worker_assignments;
   LF_ASSERT(worker_states->num_loose_threads > 0, "Sched: No loose threads");
-  LF_ASSERT(worker_states->num_loose_threads <= worker_assignments->max_num_workers, "Sched: Too many loose threads");
+  LF_ASSERT((size_t)worker_states->num_loose_threads <= worker_assignments->max_num_workers,
+            "Sched: Too many loose threads");
   size_t lt = worker_states->num_loose_threads;
   if (lt > 1 || !fast) { // FIXME: Lock should be partially optimized out even when !fast
     LF_MUTEX_LOCK(&scheduler->env->mutex);
@@ -381,7 +389,7 @@ static bool worker_states_finished_with_level_locked(lf_scheduler_t* scheduler,
   assert(((int64_t)worker_assignments->num_reactions_by_worker[worker]) <= 0);
   // Why use an atomic operation when we are supposed to be "as good as locked"? Because I took a
   // shortcut, and the shortcut was imperfect.
-  size_t ret = lf_atomic_add_fetch(&worker_states->num_loose_threads, -1);
+  size_t ret = lf_atomic_add_fetch((int*)&worker_states->num_loose_threads, -1);
   assert(ret <= worker_assignments->max_num_workers); // Check for underflow
   return !ret;
 }
@@ -400,7 +408,8 @@ static void worker_states_sleep_and_unlock(lf_scheduler_t* scheduler, size_t wor
   worker_states_t* worker_states = scheduler->custom_data->worker_states;
   worker_assignments_t* worker_assignments = scheduler->custom_data->worker_assignments;
   LF_ASSERT(worker < worker_assignments->max_num_workers, "Sched: Invalid worker");
-  LF_ASSERT(worker_states->num_loose_threads <= worker_assignments->max_num_workers, "Sched: Too many loose threads");
+  LF_ASSERT((size_t)worker_states->num_loose_threads <= worker_assignments->max_num_workers,
+            "Sched: Too many loose threads");
   if (!worker_states->mutex_held[worker]) {
     LF_MUTEX_LOCK(&scheduler->env->mutex);
   }
@@ -467,6 +476,8 @@ static void advance_level_and_unlock(lf_scheduler_t* scheduler, size_t worker) {
 #define START_EXPERIMENTS 8
 #define SLOW_EXPERIMENTS 256
 #define EXECUTION_TIME_MEMORY 15
+/** The weight of an execution time loaded from a profile relative to a new measurement of it. */
+#define PROFILE_MEMORY 3
 
 /** @brief Initialize the possible_nums_workers array. */
 static void possible_nums_workers_init(lf_scheduler_t* scheduler) {
@@ -538,11 +549,18 @@ static void data_collection_init(lf_scheduler_t* scheduler, sched_params_t* para
       (interval_t**)calloc(data_collection->num_levels, sizeof(interval_t*));
   data_collection->execution_times_mins = (interval_t*)calloc(data_collection->num_levels, sizeof(interval_t));
   data_collection->execution_times_argmins = (size_t*)calloc(data_collection->num_levels, sizeof(size_t));
+  data_collection->execution_time_memories_by_num_workers_by_level =
+      (size_t**)calloc(data_collection->num_levels, sizeof(size_t*));
   for (size_t i = 0; i < data_collection->num_levels; i++) {
     data_collection->execution_times_argmins[i] = worker_assignments->max_num_workers;
     data_collection->execution_times_by_num_workers_by_level[i] =
         (interval_t*)calloc(worker_assignments->max_num_workers + 1, // Add 1 for 1-based indexing
                             sizeof(interval_t));
+    data_collection->execution_time_memories_by_num_workers_by_level[i] =
+        (size_t*)malloc((worker_assignments->max_num_workers + 1) * sizeof(size_t));
+    for (size_t j = 0; j <= worker_assignments->max_num_workers; j++) {
+      data_collection->execution_time_memories_by_num_workers_by_level[i][j] = EXECUTION_TIME_MEMORY;
+    }
   }
   possible_nums_workers_init(scheduler);
 }
@@ -553,8 +571,12 @@ static void data_collection_free(lf_scheduler_t* scheduler) {
   free(data_collection->start_times_by_level);
   for (size_t i = 0; i < data_collection->num_levels; i++) {
     free(data_collection->execution_times_by_num_workers_by_level[i]);
+    free(data_collection->execution_time_memories_by_num_workers_by_level[i]);
   }
   free(data_collection->execution_times_by_num_workers_by_level);
+  free(data_collection->execution_time_memories_by_num_workers_by_level);
+  free(data_collection->execution_times_mins);
+  free(data_collection->execution_times_argmins);
   free(data_collection->possible_nums_workers);
 }
 
@@ -577,7 +599,12 @@ static void data_collection_end_level(lf_scheduler_t* scheduler, size_t level, s
                   ->execution_times_by_num_workers_by_level[level][data_collection->execution_times_argmins[level]]);
     }
     interval_t* prior_et = &data_collection->execution_times_by_num_workers_by_level[level][num_workers];
-    *prior_et = (*prior_et * EXECUTION_TIME_MEMORY + dt) / (EXECUTION_TIME_MEMORY + 1);
+    size_t* memory = &data_collection->execution_time_memories_by_num_workers_by_level[level][num_workers];
+    *prior_et = (*prior_et * (interval_t)*memory + dt) / (interval_t)(*memory + 1);
+    // An execution time loaded from a profile counts for less until it has been measured again.
+    if (*memory < EXECUTION_TIME_MEMORY) {
+      (*memory)++;
+    }
   }
 }
 
@@ -660,6 +687,174 @@ static void data_collection_end_tag(lf_scheduler_t* scheduler, size_t* num_worke
   }
 }
 
+///////////////////////// Private Profile Functions ///////////////////////////
+
+/*
+ * A profile file holds a section for each environment that uses this scheduler. A section is a
+ * header line "env <name> <number of levels> <maximum number of workers>" followed by a line for
+ * each level that gives the number of workers that was found to be best for the level and then
+ * the execution time of the level for each number of workers from 1 to the maximum, with 0 for
+ * execution times that were never measured.
+ */
+
+/** The longest environment name that a profile can tell apart. */
+#define PROFILE_NAME_LENGTH 255
+
+/**
+ * @brief Read the header of the next section of a profile.
+ * @return true if a header was read, false at the end of the file or on a malformed header.
+ */
+static bool profile_read_header(FILE* file, char* name, size_t* num_levels, size_t* max_num_workers) {
+  char keyword[4];
+  return fscanf(file, "%3s %255s %zu %zu", keyword, name, num_levels, max_num_workers) == 4 &&
+         strcmp(keyword, "env") == 0;
+}
+
+/**
+ * @brief Load the execution times and numbers of workers of the environment of the scheduler from
+ * the file given by `--sched-profile`, if there is one.
+ *
+ * The adaptation then continues from the loaded state instead of starting to experiment from
+ * scratch. To follow drift, the loaded execution times count as PROFILE_MEMORY measurements, so
+ * new measurements quickly replace them.
+ */
+static void profile_load(lf_scheduler_t* scheduler) {
+  if (lf_sched_profile == NULL) {
+    return;
+  }
+  worker_assignments_t* worker_assignments = scheduler->custom_data->worker_assignments;
+  data_collection_t* data_collection = scheduler->custom_data->data_collection;
+  FILE* file = fopen(lf_sched_profile, "r");
+  if (file == NULL) {
+    LF_PRINT_LOG("No scheduler profile %s yet. Learning from scratch.", lf_sched_profile);
+    return;
+  }
+  char name[PROFILE_NAME_LENGTH + 1];
+  size_t num_levels;
+  size_t max_num_workers;
+  bool found = false;
+  while (!found && profile_read_header(file, name, &num_levels, &max_num_workers)) {
+    found = strcmp(name, scheduler->env->name) == 0;
+    if (found &&
+        (num_levels != data_collection->num_levels || max_num_workers != worker_assignments->max_num_workers)) {
+      lf_print_warning("Ignoring scheduler profile %s, which is for %zu levels and %zu workers, not %zu and %zu.",
+                       lf_sched_profile, num_levels, max_num_workers, data_collection->num_levels,
+                       worker_assignments->max_num_workers);
+      fclose(file);
+      return;
+    }
+    // Read the section, into the scheduler if it is the one for this environment.
+    for (size_t level = 0; level < num_levels; level++) {
+      size_t argmin;
+      if (fscanf(file, "%zu", &argmin) != 1 || (found && (argmin < 1 || argmin > max_num_workers))) {
+        lf_print_warning("Ignoring malformed scheduler profile %s.", lf_sched_profile);
+        fclose(file);
+        return;
+      }
+      for (size_t num_workers = 1; num_workers <= max_num_workers; num_workers++) {
+        long long execution_time;
+        if (fscanf(file, "%lld", &execution_time) != 1 || execution_time < 0) {
+          lf_print_warning("Ignoring malformed scheduler profile %s.", lf_sched_profile);
+          fclose(file);
+          return;
+        }
+        if (found) {
+          data_collection->execution_times_by_num_workers_by_level[level][num_workers] = (interval_t)execution_time;
+          if (execution_time > 0) {
+            data_collection->execution_time_memories_by_num_workers_by_level[level][num_workers] = PROFILE_MEMORY;
+          }
+        }
+      }
+      if (found) {
+        data_collection->execution_times_argmins[level] = argmin;
+      }
+    }
+  }
+  fclose(file);
+  if (!found) {
+    LF_PRINT_LOG("Scheduler profile %s has nothing for environment %s. Learning from scratch.", lf_sched_profile,
+                 scheduler->env->name);
+    return;
+  }
+  for (size_t level = 0; level < data_collection->num_levels; level++) {
+    size_t argmin = data_collection->execution_times_argmins[level];
+    data_collection->execution_times_mins[level] =
+        data_collection->execution_times_by_num_workers_by_level[level][argmin];
+    worker_assignments->num_workers_by_level[level] =
+        restrict_to_range(1, worker_assignments->max_num_workers_by_level[level], argmin);
+  }
+  set_level(scheduler, 0);
+  // Skip the initial experiments, which a profile makes unnecessary.
+  data_collection->data_collection_counter = SLOW_EXPERIMENTS;
+  LF_PRINT_LOG("Loaded scheduler profile %s for environment %s.", lf_sched_profile, scheduler->env->name);
+}
+
+/**
+ * @brief Save the execution times and numbers of workers of the environment of the scheduler to the
+ * file given by `--sched-profile`, if there is one, keeping the sections of other environments.
+ *
+ * The file is written under a temporary name and then renamed, so that a program that is stopped
+ * while saving does not leave a truncated profile behind.
+ */
+static void profile_save(lf_scheduler_t* scheduler) {
+  worker_assignments_t* worker_assignments = scheduler->custom_data->worker_assignments;
+  data_collection_t* data_collection = scheduler->custom_data->data_collection;
+  if (lf_sched_profile == NULL || data_collection->data_collection_counter == 0) {
+    return;
+  }
+  size_t path_length = strlen(lf_sched_profile) + 5;
+  char* temporary_path = (char*)malloc(path_length);
+  LF_ASSERT_NON_NULL(temporary_path);
+  snprintf(temporary_path, path_length, "%s.tmp", lf_sched_profile);
+  FILE* file = fopen(temporary_path, "w");
+  if (file == NULL) {
+    lf_print_warning("Cannot write scheduler profile %s.", temporary_path);
+    free(temporary_path);
+    return;
+  }
+  // Copy the sections of the other environments.
+  FILE* old_file = fopen(lf_sched_profile, "r");
+  if (old_file != NULL) {
+    char name[PROFILE_NAME_LENGTH + 1];
+    size_t num_levels;
+    size_t max_num_workers;
+    long long value;
+    while (profile_read_header(old_file, name, &num_levels, &max_num_workers)) {
+      bool copy = strcmp(name, scheduler->env->name) != 0;
+      if (copy) {
+        fprintf(file, "env %s %zu %zu\n", name, num_levels, max_num_workers);
+      }
+      for (size_t level = 0; level < num_levels; level++) {
+        for (size_t i = 0; i <= max_num_workers && fscanf(old_file, "%lld", &value) == 1; i++) {
+          if (copy) {
+            fprintf(file, i < max_num_workers ? "%lld " : "%lld\n", value);
+          }
+        }
+      }
+    }
+    fclose(old_file);
+  }
+  fprintf(file, "env %s %zu %zu\n", scheduler->env->name, data_collection->num_levels,
+          worker_assignments->max_num_workers);
+  for (size_t level = 0; level < data_collection->num_levels; level++) {
+    fprintf(file, "%zu", data_collection->execution_times_argmins[level]);
+    for (size_t num_workers = 1; num_workers <= worker_assignments->max_num_workers; num_workers++) {
+      fprintf(file, " %lld", (long long)data_collection->execution_times_by_num_workers_by_level[level][num_workers]);
+    }
+    fprintf(file, "\n");
+  }
+  bool written = fclose(file) == 0;
+  // Some platforms do not let rename() replace an existing file.
+  if (written && rename(temporary_path, lf_sched_profile) != 0) {
+    remove(lf_sched_profile);
+    written = rename(temporary_path, lf_sched_profile) == 0;
+  }
+  if (!written) {
+    lf_print_warning("Cannot write scheduler profile %s.", lf_sched_profile);
+  }
+  free(temporary_path);
+}
+
 ///////////////////// Scheduler Init and Destroy API /////////////////////////
 void lf_sched_init(environment_t* env, size_t number_of_workers, sched_params_t* params) {
   assert(env != GLOBAL_ENVIRONMENT);
@@ -685,9 +880,11 @@ void lf_sched_init(environment_t* env, size_t number_of_workers, sched_params_t*
   worker_assignments_init(scheduler, number_of_workers, params);
 
   data_collection_init(scheduler, params);
+  profile_load(scheduler);
 }
 
 void lf_sched_free(lf_scheduler_t* scheduler) {
+  profile_save(scheduler);
   worker_states_free(scheduler);
   worker_assignments_free(scheduler);
   data_collection_free(scheduler);
@@ -0,0 +1,1087 @@
+/**
+ * @file
+ *
+ * @brief Dataflow scheduler for the threaded runtime of the C target of Lingua Franca.
+ *
+ * The other schedulers execute the reactions of a tag level by level, so one slow reaction
+ * at a level holds back every reaction at the next level, even those that do not depend on it.
+ * This scheduler instead starts each reaction as soon as every reaction that it depends on
+ * is either done or known not to be triggered at the current tag.
+ *
+ * The dependency graph is built once, when the scheduler is initialized, from the reactions
+ * given in `sched_params_t`. Reaction u precedes reaction v if an output of u triggers v,
+ * if u and v belong to the same reactor and u comes first, or if the pair is listed in the
+ * `reaction_dependencies` of `sched_params_t`. If the reactions are not given, as in code
+ * generated for the other schedulers, there is no graph, and the scheduler instead executes
+ * the reactions of each tag in the order of their levels, like the other schedulers.
+ *
+ * At the start of each tag, every reaction gets a count of the reactions that precede it.
+ * A reaction whose count is zero is resolved: if it has been triggered, it goes to the ready
+ * queue, and otherwise it is settled right away. When a reaction is settled, either because
+ * it is done or because it was not triggered, the count of each reaction that follows it is
+ * decremented, and those that reach zero are resolved in turn. Each tag thus visits every
+ * reaction of the graph once, which costs more than a level-based scheduler when only a few
+ * reactions are triggered per tag, but lets independent branches of the graph run ahead.
+ * The tag advances once every reaction is settled.
+ *
+ * With `LF_PIPELINED_TAGS`, the tag advances as soon as the reactions triggered by the events
+ * of the current tag are done, and each reaction keeps its own count of the tags it has settled.
+ * A reaction then starts the next tag once it has settled the current one, the reactions that
+ * precede it have settled the next one, and the reactions that read its outputs, or the outputs
+ * of an earlier reaction of its reactor, have settled the current one. The last condition is
+ * what makes this safe: ports hold a single value, so a reactor can only overwrite its outputs
+ * once they have been read. Successive stages of a pipeline thus work on successive tags at the
+ * same time, and every reaction still sees exactly the inputs that it would see otherwise.
+ * The first reaction of each reactor marks the outputs of the reactor absent when it starts a
+ * tag, and each worker sees the tag of the reaction that it executes through lf_tag().
+ * The reactions that may schedule logical actions or request to stop are listed in `sched_params_t`,
+ * and the tag advances only once they have settled the newest tag, so they always execute at the
+ * newest tag and their events are never at a tag that has already started. Any other reaction
+ * that schedules a logical action or requests to stop is an error.
+ */
+#include "lf_types.h"
+
+#if SCHEDULER == SCHED_DATAFLOW
+
+#ifdef FEDERATED
+#error "The dataflow scheduler does not support federated execution."
+#endif
+
+#if defined(LF_PIPELINED_TAGS) && (defined(LF_ENCLAVES) || defined(MODAL_REACTORS))
+#error "Pipelined tags are not supported with enclaves or modal reactors."
+#endif
+
+#ifndef NUMBER_OF_WORKERS
+#define NUMBER_OF_WORKERS 1
+#endif // NUMBER_OF_WORKERS
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "low_level_platform.h"
+#include "environment.h"
+#include "lf_semaphore.h"
+#include "lf_token.h"
+#include "reactor_threaded.h"
+#include "scheduler_instance.h"
+#include "scheduler_sync_tag_advance.h"
+#include "scheduler.h"
+#include "tracepoint.h"
+#include "util.h"
+
+/** The reactions triggered at one level when there is no graph. */
+typedef struct {
+  reaction_t** reactions;
+  size_t size;
+  size_t capacity;
+} level_bucket_t;
+
+#ifdef LF_PIPELINED_TAGS
+/** Token copies made for mutable inputs up to a tag, which are freed once every reaction has settled that tag. */
+typedef struct token_generation_t {
+  int step;
+  lf_token_t* tokens;
+  struct token_generation_t* next;
+} token_generation_t;
+#endif // LF_PIPELINED_TAGS
+
+// Data specific to the dataflow scheduler.
+typedef struct custom_scheduler_data_t {
+  /** The reactions of the graph. The `pos` field of each reaction holds its index in this array. */
+  reaction_t** reactions;
+  size_t number_of_reactions;
+  /** The reactions that follow reaction i are at indices first_successor[i] to first_successor[i + 1] - 1. */
+  size_t* first_successor;
+  size_t* successors;
+  /** The number of reactions that precede each reaction. */
+  int* predecessors;
+  /** The number of conditions of each reaction that are not met yet at the tag that it is working on. */
+  volatile int* remaining;
+  /** Reactions with no predecessors. */
+  size_t* sources;
+  size_t number_of_sources;
+  /** The number of reactions that have not settled the newest tag. */
+  volatile int behind;
+  /** True once the first tag has been started, protected by `mutex`. */
+  bool started;
+  /** True while a worker advances the tag, protected by `mutex`. */
+  bool advancing;
+  /** True once the stop tag has been reached, protected by `mutex`. */
+  bool stopping;
+  /** For each worker, and for callers that are not workers, room for the reactions being settled. */
+  size_t** worklists;
+
+  /** The reactions that are ready to execute, in the order in which they became ready, protected by `mutex`. */
+  lf_mutex_t mutex;
+  reaction_t** ready;
+  size_t ready_head;
+  size_t ready_count;
+  /** The number of workers waiting on `semaphore`, protected by `mutex`. */
+  size_t waiting;
+  lf_semaphore_t* semaphore;
+
+  /** True if there is no graph and reactions execute in the order of their levels. */
+  bool by_level;
+  /** The reactions triggered at each level and not yet executing, protected by `mutex`. */
+  level_bucket_t* levels;
+  size_t number_of_levels;
+  /** The level whose reactions are executing, protected by `mutex`. */
+  size_t current_level;
+  /** The number of reactions executing, protected by `mutex`. */
+  size_t executing;
+
+#ifdef LF_PIPELINED_TAGS
+  /** The reactions that wait for reaction i to settle a tag before starting the next are at indices first_waiter[i]
+   * to first_waiter[i + 1] - 1 of waiters. */
+  size_t* first_waiter;
+  size_t* waiters;
+  /** The number of reactions that each reaction waits for before starting the next tag. */
+  int* waited_on;
+  /** The is_present fields that reaction i marks absent when it starts a tag are at indices first_output[i] to
+   * first_output[i + 1] - 1 of outputs. */
+  size_t* first_output;
+  bool** outputs;
+  /** The number of the tag that each reaction is working on, counting from 0 for the start tag. */
+  volatile int* step;
+  /** The number of the tag at which an event triggered each reaction, or -1. */
+  volatile int* event_step;
+  /** The number of reactions that events of the newest tag triggered and that are not done yet. */
+  volatile int outstanding_events;
+  /** The largest value of `behind` at which the tag may advance, which bounds the number of tags in flight. */
+  int max_behind;
+  /** Whether each reaction may schedule logical actions, which holds back the tag until it settles the newest tag. */
+  bool* schedules;
+  size_t number_scheduling;
+  /** The number of reactions that may schedule logical actions and have not settled the newest tag. */
+  volatile int scheduling_behind;
+  /** The number of the newest tag whose events have been taken from the event queue, protected by `mutex`. */
+  int newest;
+  /** The number of the tag whose events are being taken from the event queue. */
+  int popping;
+  /** Reactions waiting for the events of the tag after the newest to be known, protected by `mutex`. */
+  size_t* parked;
+  size_t number_parked;
+  /** Room for the reactions released when the tag advances. */
+  size_t* released;
+  /** The tag of each reaction, protected by `mutex`. */
+  tag_t* node_tags;
+  /** The tags of the tags in flight, indexed by their number modulo the capacity, protected by `mutex`. */
+  tag_t* tags;
+  size_t tags_capacity;
+  /** Token copies that reactions of tags in flight may still use, oldest first. */
+  token_generation_t* generations;
+#endif // LF_PIPELINED_TAGS
+} custom_scheduler_data_t;
+
+/////////////////// Scheduler Private API /////////////////////////
+
+/**
+ * @brief Return the index of the given reaction in the graph, or exit if it is not in the graph.
+ */
+static inline size_t node_of(custom_scheduler_data_t* data, reaction_t* reaction) {
+  size_t node = reaction->pos;
+  if (node >= data->number_of_reactions || data->reactions[node] != reaction) {
+    lf_print_error_and_exit("Reaction %s is not in the reaction graph given to the dataflow scheduler.",
+                            reaction->name);
+  }
+  return node;
+}
+
+/**
+ * @brief Put a reaction on the ready queue and wake up a waiting worker, if there is one.
+ */
+static void push_ready(custom_scheduler_data_t* data, reaction_t* reaction) {
+  LF_MUTEX_LOCK(&data->mutex);
+  data->ready[(data->ready_head + data->ready_count++) % data->number_of_reactions] = reaction;
+  bool wake = data->waiting > 0;
+  if (wake) {
+    data->waiting--;
+  }
+  LF_MUTEX_UNLOCK(&data->mutex);
+  if (wake) {
+    lf_semaphore_release(data->semaphore, 1);
+  }
+}
+
+/**
+ * @brief Handle a reaction whose conditions are all met for the tag that it is working on.
+ *
+ * If the reaction is triggered, it goes to the ready queue, and otherwise to the worklist to be settled.
+ */
+static inline void resolve(custom_scheduler_data_t* data, size_t node, size_t* worklist, size_t* count) {
+  reaction_t* reaction = data->reactions[node];
+#ifdef LF_PIPELINED_TAGS
+  // Every reaction that reads the outputs of the reactor has settled the previous tag.
+  for (size_t i = data->first_output[node]; i < data->first_output[node + 1]; i++) {
+    *data->outputs[i] = false;
+  }
+  if (data->event_step[node] == data->step[node]) {
+    lf_atomic_bool_compare_and_swap((int*)&reaction->status, inactive, queued);
+  }
+#endif
+  if (reaction->status == queued) {
+    push_ready(data, reaction);
+  } else {
+    worklist[(*count)++] = node;
+  }
+}
+
+#ifdef LF_PIPELINED_TAGS
+/**
+ * @brief Move a reaction that has settled a tag to the next tag and count the conditions for starting it.
+ *
+ * If the events of the next tag are not known yet, the reaction waits for them as well.
+ */
+static void next_step(custom_scheduler_data_t* data, size_t node, size_t* worklist, size_t* count) {
+  int step = data->step[node] + 1;
+  int remaining = data->predecessors[node] + data->waited_on[node];
+  LF_MUTEX_LOCK(&data->mutex);
+  data->step[node] = step;
+  if (step > data->newest) {
+    data->parked[data->number_parked++] = node;
+    remaining++;
+  } else {
+    data->node_tags[node] = data->tags[step % data->tags_capacity];
+  }
+  // This is set before the reactions that wait for this one are notified, and only they can change it.
+  data->remaining[node] = remaining;
+  LF_MUTEX_UNLOCK(&data->mutex);
+  if (remaining == 0) {
+    resolve(data, node, worklist, count);
+  }
+}
+#endif // LF_PIPELINED_TAGS
+
+/**
+ * @brief Settle the reactions on the worklist and the reactions that this makes resolvable.
+ *
+ * @param worklist Room for the indices of all reactions.
+ * @param count The number of reactions on the worklist.
+ */
+static void settle_all(custom_scheduler_data_t* data, size_t* worklist, size_t count) {
+  while (count > 0) {
+    size_t settled = worklist[--count];
+    lf_atomic_add_fetch((int*)&data->behind, -1);
+#ifdef LF_PIPELINED_TAGS
+    if (data->schedules[settled]) {
+      lf_atomic_add_fetch((int*)&data->scheduling_behind, -1);
+    }
+    next_step(data, settled, worklist, &count);
+    for (size_t i = data->first_waiter[settled]; i < data->first_waiter[settled + 1]; i++) {
+      if (lf_atomic_add_fetch((int*)&data->remaining[data->waiters[i]], -1) == 0) {
+        resolve(data, data->waiters[i], worklist, &count);
+      }
+    }
+#endif
+    for (size_t i = data->first_successor[settled]; i < data->first_successor[settled + 1]; i++) {
+      // The atomic decrement orders the triggering of the successor by a preceding reaction
+      // before the read of its status when it is resolved.
+      if (lf_atomic_add_fetch((int*)&data->remaining[data->successors[i]], -1) == 0) {
+        resolve(data, data->successors[i], worklist, &count);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Settle the given reaction at the tag that it is working on.
+ */
+static void settle(custom_scheduler_data_t* data, size_t node, size_t* worklist) {
+  worklist[0] = node;
+  settle_all(data, worklist, 1);
+}
+
+/**
+ * @brief Signal all worker threads that it is time to stop.
+ */
+static void signal_stop(lf_scheduler_t* scheduler) {
+  scheduler->should_stop = true;
+  lf_semaphore_release(scheduler->custom_data->semaphore, (scheduler->number_of_workers - 1));
+}
+
+#ifdef LF_PIPELINED_TAGS
+/**
+ * @brief Return the number of the oldest tag that a reaction is working on. The caller must hold `mutex`.
+ */
+static int oldest_step(custom_scheduler_data_t* data) {
+  int oldest = data->newest + 1;
+  for (size_t i = 0; i < data->number_of_reactions; i++) {
+    if (data->step[i] < oldest) {
+      oldest = data->step[i];
+    }
+  }
+  return oldest;
+}
+
+/**
+ * @brief Keep the token copies made so far until every reaction has settled the newest tag, and free
+ * those of earlier tags that every reaction has settled.
+ */
+static void release_token_copies(custom_scheduler_data_t* data, int oldest) {
+  lf_token_t* tokens = _lf_take_token_copies();
+  if (tokens != NULL) {
+    token_generation_t* generation = (token_generation_t*)malloc(sizeof(token_generation_t));
+    LF_ASSERT_NON_NULL(generation);
+    generation->step = data->newest;
+    generation->tokens = tokens;
+    generation->next = NULL;
+    token_generation_t** last = &data->generations;
+    while (*last != NULL) {
+      last = &(*last)->next;
+    }
+    *last = generation;
+  }
+  while (data->generations != NULL && data->generations->step < oldest) {
+    token_generation_t* generation = data->generations;
+    data->generations = generation->next;
+    _lf_free_token_list(generation->tokens);
+    free(generation);
+  }
+}
+
+/**
+ * @brief Record the tag of the newest tag, making room for it if needed. The caller must hold `mutex`.
+ */
+static void record_tag(custom_scheduler_data_t* data, int oldest, tag_t tag) {
+  size_t needed = (size_t)(data->newest - oldest + 1);
+  if (needed > data->tags_capacity) {
+    size_t capacity = data->tags_capacity * 2 > needed ? data->tags_capacity * 2 : needed;
+    tag_t* tags = (tag_t*)calloc(capacity, sizeof(tag_t));
+    LF_ASSERT_NON_NULL(tags);
+    for (int step = oldest; step < data->newest; step++) {
+      tags[(size_t)step % capacity] = data->tags[(size_t)step % data->tags_capacity];
+    }
+    free(data->tags);
+    data->tags = tags;
+    data->tags_capacity = capacity;
+  }
+  data->tags[(size_t)data->newest % data->tags_capacity] = tag;
+}
+#endif // LF_PIPELINED_TAGS
+
+/**
+ * @brief Reset the counts of all reactions for a new tag and resolve the reactions with no predecessors.
+ *
+ * Without pipelined tags, this is called once every reaction has settled the previous tag.
+ */
+static void start_tag(lf_scheduler_t* scheduler, size_t* worklist) {
+  custom_scheduler_data_t* data = scheduler->custom_data;
+  size_t count = 0;
+#ifdef LF_PIPELINED_TAGS
+  LF_MUTEX_LOCK(&data->mutex);
+  int oldest = oldest_step(data);
+  data->newest = data->popping;
+  record_tag(data, oldest, scheduler->env->current_tag);
+  lf_atomic_add_fetch((int*)&data->scheduling_behind, (int)data->number_scheduling);
+  lf_atomic_add_fetch((int*)&data->behind, (int)data->number_of_reactions);
+  size_t number_released = data->number_parked;
+  for (size_t i = 0; i < number_released; i++) {
+    data->released[i] = data->parked[i];
+    data->node_tags[data->parked[i]] = scheduler->env->current_tag;
+  }
+  data->number_parked = 0;
+  LF_MUTEX_UNLOCK(&data->mutex);
+  for (size_t i = 0; i < number_released; i++) {
+    if (lf_atomic_add_fetch((int*)&data->remaining[data->released[i]], -1) == 0) {
+      resolve(data, data->released[i], worklist, &count);
+    }
+  }
+#else
+  for (size_t i = 0; i < data->number_of_reactions; i++) {
+    data->remaining[i] = data->predecessors[i];
+  }
+  // Publish the counts before any reaction is settled. The atomic operation is a full barrier.
+  lf_atomic_add_fetch((int*)&data->behind, (int)data->number_of_reactions);
+  for (size_t i = 0; i < data->number_of_sources; i++) {
+    resolve(data, data->sources[i], worklist, &count);
+  }
+#endif
+  settle_all(data, worklist, count);
+}
+
+/**
+ * @brief Advance the tag, unless the first tag has yet to start, and start the new tag.
+ *
+ * This is called by one worker at a time, with `advancing` set.
+ */
+static void advance_and_start_tag(lf_scheduler_t* scheduler, int worker_number) {
+  custom_scheduler_data_t* data = scheduler->custom_data;
+  environment_t* env = scheduler->env;
+  if (data->started) {
+#ifdef LF_PIPELINED_TAGS
+    LF_MUTEX_LOCK(&data->mutex);
+    int oldest = oldest_step(data);
+    LF_MUTEX_UNLOCK(&data->mutex);
+    release_token_copies(data, oldest);
+    data->popping = data->newest + 1;
+#endif
+    LF_MUTEX_LOCK(&env->mutex);
+    LF_PRINT_DEBUG("Scheduler: Advancing tag.");
+    bool stop = _lf_sched_advance_tag_locked(scheduler);
+    LF_MUTEX_UNLOCK(&env->mutex);
+    if (stop) {
+      LF_PRINT_DEBUG("Scheduler: Reached stop tag.");
+      LF_MUTEX_LOCK(&data->mutex);
+      data->stopping = true;
+      data->advancing = false;
+      LF_MUTEX_UNLOCK(&data->mutex);
+      return;
+    }
+  }
+  start_tag(scheduler, data->worklists[worker_number]);
+  LF_MUTEX_LOCK(&data->mutex);
+  data->started = true;
+  data->advancing = false;
+  LF_MUTEX_UNLOCK(&data->mutex);
+}
+
+/**
+ * @brief Return true if the tag can advance. The caller must hold `mutex`.
+ */
+static inline bool can_advance(custom_scheduler_data_t* data) {
+  if (data->advancing || data->stopping) {
+    return false;
+  }
+#ifdef LF_PIPELINED_TAGS
+  // The events of the next tag overwrite the values of actions, so the reactions that
+  // the events of the newest tag triggered must be done. The reactions that may schedule
+  // logical actions must have settled the newest tag, or their events could be too late.
+  return !data->started ||
+         (data->outstanding_events == 0 && data->scheduling_behind == 0 && data->behind <= data->max_behind);
+#else
+  return data->behind == 0;
+#endif
+}
+
+/**
+ * @brief Put a triggered reaction in the bucket of its level when there is no graph. The caller must hold `mutex`.
+ */
+static void push_by_level(custom_scheduler_data_t* data, reaction_t* reaction) {
+  size_t level = (size_t)LF_LEVEL(reaction->index);
+  if (level >= data->number_of_levels) {
+    size_t number_of_levels = 2 * data->number_of_levels > level ? 2 * data->number_of_levels : level + 1;
+    data->levels = (level_bucket_t*)realloc(data->levels, number_of_levels * sizeof(level_bucket_t));
+    LF_ASSERT_NON_NULL(data->levels);
+    memset(&data->levels[data->number_of_levels], 0,
+           (number_of_levels - data->number_of_levels) * sizeof(level_bucket_t));
+    data->number_of_levels = number_of_levels;
+  }
+  level_bucket_t* bucket = &data->levels[level];
+  if (bucket->size == bucket->capacity) {
+    bucket->capacity = bucket->capacity > 0 ? 2 * bucket->capacity : 4;
+    bucket->reactions = (reaction_t**)realloc(bucket->reactions, bucket->capacity * sizeof(reaction_t*));
+    LF_ASSERT_NON_NULL(bucket->reactions);
+  }
+  bucket->reactions[bucket->size++] = reaction;
+  if (level < data->current_level) {
+    data->current_level = level;
+  }
+}
+
+/**
+ * @brief Return a reaction at the lowest level with triggered reactions when there is no graph, advancing the
+ * tag once every reaction of the current tag is done, or return NULL once the stop tag has been reached.
+ *
+ * A reaction is only returned once every reaction at lower levels is done. The tag is advanced by one worker,
+ * and the reactions triggered by its events are held back until all of them are known.
+ */
+static reaction_t* get_ready_by_level(lf_scheduler_t* scheduler, int worker_number) {
+  custom_scheduler_data_t* data = scheduler->custom_data;
+  while (!scheduler->should_stop) {
+    LF_MUTEX_LOCK(&data->mutex);
+    if (data->executing == 0) {
+      while (data->current_level < data->number_of_levels && data->levels[data->current_level].size == 0) {
+        data->current_level++;
+      }
+    }
+    if (!data->advancing && data->current_level < data->number_of_levels &&
+        data->levels[data->current_level].size > 0) {
+      level_bucket_t* bucket = &data->levels[data->current_level];
+      reaction_t* reaction_to_return = bucket->reactions[--bucket->size];
+      data->executing++;
+      bool wake = bucket->size > 0 && data->waiting > 0;
+      if (wake) {
+        data->waiting--;
+      }
+      LF_MUTEX_UNLOCK(&data->mutex);
+      if (wake) {
+        lf_semaphore_release(data->semaphore, 1);
+      }
+      LF_PRINT_DEBUG("Scheduler: Worker %d popped reaction %s at level %zu.", worker_number, reaction_to_return->name,
+                     (size_t)LF_LEVEL(reaction_to_return->index));
+      return reaction_to_return;
+    }
+    if (!data->advancing && data->executing == 0) {
+      data->advancing = true;
+      LF_MUTEX_UNLOCK(&data->mutex);
+      LF_PRINT_DEBUG("Scheduler: Worker %d is advancing the tag.", worker_number);
+      LF_MUTEX_LOCK(&scheduler->env->mutex);
+      bool stop = _lf_sched_advance_tag_locked(scheduler);
+      LF_MUTEX_UNLOCK(&scheduler->env->mutex);
+      LF_MUTEX_LOCK(&data->mutex);
+      data->current_level = 0;
+      data->advancing = false;
+      LF_MUTEX_UNLOCK(&data->mutex);
+      if (stop) {
+        LF_PRINT_DEBUG("Scheduler: Reached stop tag.");
+        signal_stop(scheduler);
+        break;
+      }
+      continue;
+    }
+    data->waiting++;
+    LF_MUTEX_UNLOCK(&data->mutex);
+
+    tracepoint_worker_wait_starts(scheduler->env, worker_number);
+    lf_semaphore_acquire(data->semaphore);
+    tracepoint_worker_wait_ends(scheduler->env, worker_number);
+  }
+  return NULL;
+}
+
+/**
+ * @brief Count the reactions that precede each reaction and list the reactions that follow it.
+ *
+ * @param edges Pairs of reaction indices, each an upstream reaction followed by a downstream one.
+ * @param number_of_edges The number of pairs.
+ */
+static void build_graph(custom_scheduler_data_t* data, size_t* edges, size_t number_of_edges) {
+  size_t n = data->number_of_reactions;
+  data->first_successor = (size_t*)calloc(n + 1, sizeof(size_t));
+  data->successors = (size_t*)calloc(number_of_edges + 1, sizeof(size_t));
+  data->predecessors = (int*)calloc(n, sizeof(int));
+  LF_ASSERT_NON_NULL(data->first_successor);
+  LF_ASSERT_NON_NULL(data->successors);
+  LF_ASSERT_NON_NULL(data->predecessors);
+  for (size_t e = 0; e < number_of_edges; e++) {
+    data->first_successor[edges[2 * e] + 1]++;
+    data->predecessors[edges[2 * e + 1]]++;
+  }
+  for (size_t i = 0; i < n; i++) {
+    data->first_successor[i + 1] += data->first_successor[i];
+  }
+  size_t* next = (size_t*)malloc(n * sizeof(size_t));
+  LF_ASSERT_NON_NULL(next);
+  for (size_t i = 0; i < n; i++) {
+    next[i] = data->first_successor[i];
+  }
+  for (size_t e = 0; e < number_of_edges; e++) {
+    data->successors[next[edges[2 * e]]++] = edges[2 * e + 1];
+  }
+  free(next);
+
+  data->sources = (size_t*)malloc(n * sizeof(size_t));
+  LF_ASSERT_NON_NULL(data->sources);
+  data->number_of_sources = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (data->predecessors[i] == 0) {
+      data->sources[data->number_of_sources++] = i;
+    }
+#ifdef LF_PIPELINED_TAGS
+    // A reaction executed immediately by the worker of the reaction that enables it would skip
+    // the other conditions for starting a tag.
+    data->reactions[i]->last_enabling_reaction = NULL;
+#else
+    // Executing a reaction immediately in the thread of the reaction that enables it is only safe
+    // if no other reaction precedes it.
+    if (data->predecessors[i] > 1) {
+      data->reactions[i]->last_enabling_reaction = NULL;
+    }
+#endif
+  }
+}
+
+/**
+ * @brief Exit with an error if the graph has a cycle, which would leave some reactions unresolved forever.
+ *
+ * @return The number of reactions on the longest path through the graph.
+ */
+static int check_acyclic(custom_scheduler_data_t* data) {
+  // Kahn's algorithm: settle the graph once and check that every reaction was reached.
+  size_t n = data->number_of_reactions;
+  int* remaining = (int*)malloc(n * sizeof(int));
+  int* length = (int*)calloc(n, sizeof(int));
+  size_t* stack = (size_t*)malloc(n * sizeof(size_t));
+  LF_ASSERT_NON_NULL(remaining);
+  LF_ASSERT_NON_NULL(length);
+  LF_ASSERT_NON_NULL(stack);
+  size_t count = 0, reached = 0;
+  int depth = 0;
+  for (size_t i = 0; i < n; i++) {
+    remaining[i] = data->predecessors[i];
+  }
+  for (size_t i = 0; i < data->number_of_sources; i++) {
+    stack[count++] = data->sources[i];
+  }
+  while (count > 0) {
+    size_t node = stack[--count];
+    reached++;
+    length[node]++;
+    if (length[node] > depth) {
+      depth = length[node];
+    }
+    for (size_t i = data->first_successor[node]; i < data->first_successor[node + 1]; i++) {
+      size_t successor = data->successors[i];
+      if (length[node] > length[successor]) {
+        length[successor] = length[node];
+      }
+      if (--remaining[successor] == 0) {
+        stack[count++] = successor;
+      }
+    }
+  }
+  free(stack);
+  free(length);
+  free(remaining);
+  if (reached != n) {
+    lf_print_error_and_exit("The dependencies between reactions given to the dataflow scheduler form a cycle.");
+  }
+  return depth;
+}
+
+/** Order reaction indices by reactor and then by the number of the reaction within its reactor. */
+static reaction_t** _lf_sched_sort_reactions = NULL;
+static int compare_by_reactor(const void* a, const void* b) {
+  reaction_t* ra = _lf_sched_sort_reactions[*(const size_t*)a];
+  reaction_t* rb = _lf_sched_sort_reactions[*(const size_t*)b];
+  if (ra->self != rb->self) {
+    return (uintptr_t)ra->self < (uintptr_t)rb->self ? -1 : 1;
+  }
+  return (ra->number > rb->number) - (ra->number < rb->number);
+}
+
+#ifdef LF_PIPELINED_TAGS
+/** Order pairs of reaction indices lexicographically. */
+static int compare_pairs(const void* a, const void* b) {
+  const size_t* pa = (const size_t*)a;
+  const size_t* pb = (const size_t*)b;
+  if (pa[0] != pb[0]) {
+    return pa[0] < pb[0] ? -1 : 1;
+  }
+  return (pa[1] > pb[1]) - (pa[1] < pb[1]);
+}
+
+/**
+ * @brief List the reactions that wait for each reaction before starting the next tag, and the
+ * is_present fields that the first reaction of each reactor marks absent.
+ *
+ * A reaction waits for the reactions that follow it and, if it is the first reaction of its reactor,
+ * for the reactions that follow any reaction of its reactor, because it marks all their outputs absent.
+ * @param edges Pairs of reaction indices, each an upstream reaction followed by a downstream one.
+ * @param number_of_edges The number of pairs.
+ * @param first The index of the first reaction of the reactor of each reaction.
+ */
+static void build_pipeline(custom_scheduler_data_t* data, size_t* edges, size_t number_of_edges, size_t* first) {
+  size_t n = data->number_of_reactions;
+  // Pairs of a downstream reaction followed by a reaction that waits for it.
+  size_t* pairs = (size_t*)malloc((4 * number_of_edges + 1) * sizeof(size_t));
+  LF_ASSERT_NON_NULL(pairs);
+  size_t number_of_pairs = 0;
+  for (size_t e = 0; e < number_of_edges; e++) {
+    size_t upstream = edges[2 * e], downstream = edges[2 * e + 1];
+    pairs[2 * number_of_pairs] = downstream;
+    pairs[2 * number_of_pairs + 1] = upstream;
+    number_of_pairs++;
+    if (first[upstream] != upstream && first[upstream] != downstream) {
+      pairs[2 * number_of_pairs] = downstream;
+      pairs[2 * number_of_pairs + 1] = first[upstream];
+      number_of_pairs++;
+    }
+  }
+  qsort(pairs, number_of_pairs, 2 * sizeof(size_t), compare_pairs);
+  data->first_waiter = (size_t*)calloc(n + 1, sizeof(size_t));
+  data->waiters = (size_t*)calloc(number_of_pairs + 1, sizeof(size_t));
+  data->waited_on = (int*)calloc(n, sizeof(int));
+  LF_ASSERT_NON_NULL(data->first_waiter);
+  LF_ASSERT_NON_NULL(data->waiters);
+  LF_ASSERT_NON_NULL(data->waited_on);
+  size_t number_of_waiters = 0;
+  for (size_t p = 0; p < number_of_pairs; p++) {
+    if (p > 0 && compare_pairs(&pairs[2 * p], &pairs[2 * (p - 1)]) == 0) {
+      continue;
+    }
+    data->first_waiter[pairs[2 * p] + 1]++;
+    data->waiters[number_of_waiters++] = pairs[2 * p + 1];
+    data->waited_on[pairs[2 * p + 1]]++;
+  }
+  for (size_t i = 0; i < n; i++) {
+    data->first_waiter[i + 1] += data->first_waiter[i];
+  }
+  free(pairs);
+
+  size_t number_of_outputs = 0;
+  for (size_t i = 0; i < n; i++) {
+    number_of_outputs += data->reactions[i]->num_outputs;
+  }
+  data->first_output = (size_t*)calloc(n + 1, sizeof(size_t));
+  data->outputs = (bool**)calloc(number_of_outputs + 1, sizeof(bool*));
+  LF_ASSERT_NON_NULL(data->first_output);
+  LF_ASSERT_NON_NULL(data->outputs);
+  for (size_t i = 0; i < n; i++) {
+    data->first_output[first[i] + 1] += data->reactions[i]->num_outputs;
+  }
+  for (size_t i = 0; i < n; i++) {
+    data->first_output[i + 1] += data->first_output[i];
+  }
+  size_t* next = (size_t*)malloc(n * sizeof(size_t));
+  LF_ASSERT_NON_NULL(next);
+  for (size_t i = 0; i < n; i++) {
+    next[i] = data->first_output[i];
+  }
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < data->reactions[i]->num_outputs; j++) {
+      data->outputs[next[first[i]]++] = data->reactions[i]->output_produced[j];
+    }
+  }
+  free(next);
+
+  data->step = (volatile int*)calloc(n, sizeof(int));
+  data->event_step = (volatile int*)malloc(n * sizeof(int));
+  data->parked = (size_t*)malloc(n * sizeof(size_t));
+  data->released = (size_t*)malloc(n * sizeof(size_t));
+  data->node_tags = (tag_t*)calloc(n, sizeof(tag_t));
+  data->tags_capacity = 4;
+  data->tags = (tag_t*)calloc(data->tags_capacity, sizeof(tag_t));
+  LF_ASSERT_NON_NULL(data->step);
+  LF_ASSERT_NON_NULL(data->event_step);
+  LF_ASSERT_NON_NULL(data->parked);
+  LF_ASSERT_NON_NULL(data->released);
+  LF_ASSERT_NON_NULL(data->node_tags);
+  LF_ASSERT_NON_NULL(data->tags);
+  // Every reaction waits for the events of the start tag.
+  data->newest = -1;
+  data->popping = 0;
+  for (size_t i = 0; i < n; i++) {
+    data->event_step[i] = -1;
+    data->remaining[i] = data->predecessors[i] + 1;
+    data->parked[i] = i;
+  }
+  data->number_parked = n;
+}
+#endif // LF_PIPELINED_TAGS
+
+///////////////////// Scheduler Init and Destroy API /////////////////////////
+/**
+ * @brief Initialize the scheduler.
+ *
+ * This has to be called before other functions of the scheduler can be used.
+ * If the scheduler is already initialized, this will be a no-op.
+ *
+ * @param env Environment within which we are executing.
+ * @param number_of_workers Indicate how many workers this scheduler will be
+ *  managing.
+ * @param option Pointer to a `sched_params_t` struct containing additional
+ *  scheduler parameters. Without the reactions of the environment, reactions
+ *  execute in the order of their levels.
+ */
+void lf_sched_init(environment_t* env, size_t number_of_workers, sched_params_t* params) {
+  assert(env != GLOBAL_ENVIRONMENT);
+
+  LF_PRINT_DEBUG("Env %u: Scheduler: Initializing with %zu workers", env->id, number_of_workers);
+  if (!init_sched_instance(env, &env->scheduler, number_of_workers, params)) {
+    // Already initialized
+    return;
+  }
+  lf_scheduler_t* scheduler = env->scheduler;
+  scheduler->custom_data = (custom_scheduler_data_t*)calloc(1, sizeof(custom_scheduler_data_t));
+  LF_ASSERT_NON_NULL(scheduler->custom_data);
+  custom_scheduler_data_t* data = scheduler->custom_data;
+  LF_MUTEX_INIT(&data->mutex);
+  data->semaphore = lf_semaphore_new(0);
+
+  if (params == NULL || params->reactions == NULL || params->num_reactions == 0) {
+#ifdef LF_PIPELINED_TAGS
+    lf_print_error_and_exit("Pipelined tags need the reactions of each environment in sched_params_t.");
+#endif
+    LF_PRINT_LOG("Env %u: Scheduler: No reactions given. Executing reactions in the order of their levels.",
+                 env->id);
+    data->by_level = true;
+    data->number_of_levels = scheduler->max_reaction_level + 1;
+    data->levels = (level_bucket_t*)calloc(data->number_of_levels, sizeof(level_bucket_t));
+    LF_ASSERT_NON_NULL(data->levels);
+    return;
+  }
+
+  size_t n = params->num_reactions;
+  data->number_of_reactions = n;
+  data->reactions = (reaction_t**)malloc(n * sizeof(reaction_t*));
+  LF_ASSERT_NON_NULL(data->reactions);
+  for (size_t i = 0; i < n; i++) {
+    data->reactions[i] = params->reactions[i];
+    data->reactions[i]->pos = i;
+  }
+
+  // Collect the edges, first from the output ports of each reaction.
+  size_t capacity = n + params->num_reaction_dependencies + 1;
+  size_t number_of_edges = 0;
+  size_t* edges = (size_t*)malloc(2 * capacity * sizeof(size_t));
+  LF_ASSERT_NON_NULL(edges);
+  for (size_t u = 0; u < n; u++) {
+    reaction_t* reaction = data->reactions[u];
+    for (size_t i = 0; i < reaction->num_outputs; i++) {
+      for (int j = 0; j < reaction->triggered_sizes[i]; j++) {
+        trigger_t* trigger = reaction->triggers[i][j];
+        for (int k = 0; trigger != NULL && k < trigger->number_of_reactions; k++) {
+          if (trigger->reactions[k] == NULL) {
+            continue;
+          }
+          if (number_of_edges == capacity) {
+            capacity *= 2;
+            edges = (size_t*)realloc(edges, 2 * capacity * sizeof(size_t));
+            LF_ASSERT_NON_NULL(edges);
+          }
+          edges[2 * number_of_edges] = u;
+          edges[2 * number_of_edges + 1] = node_of(data, trigger->reactions[k]);
+          number_of_edges++;
+        }
+      }
+    }
+  }
+  // Then from the order of reactions within each reactor. There is room for these.
+  size_t* order = (size_t*)malloc(n * sizeof(size_t));
+  size_t* first = (size_t*)malloc(n * sizeof(size_t));
+  LF_ASSERT_NON_NULL(order);
+  LF_ASSERT_NON_NULL(first);
+  for (size_t i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  _lf_sched_sort_reactions = data->reactions;
+  qsort(order, n, sizeof(size_t), compare_by_reactor);
+  _lf_sched_sort_reactions = NULL;
+  if (number_of_edges + n + params->num_reaction_dependencies > capacity) {
+    capacity = number_of_edges + n + params->num_reaction_dependencies;
+    edges = (size_t*)realloc(edges, 2 * capacity * sizeof(size_t));
+    LF_ASSERT_NON_NULL(edges);
+  }
+  first[order[0]] = order[0];
+  for (size_t i = 1; i < n; i++) {
+    if (data->reactions[order[i - 1]]->self == data->reactions[order[i]]->self) {
+      edges[2 * number_of_edges] = order[i - 1];
+      edges[2 * number_of_edges + 1] = order[i];
+      number_of_edges++;
+      first[order[i]] = first[order[i - 1]];
+    } else {
+      first[order[i]] = order[i];
+    }
+  }
+  free(order);
+  // Finally, from the dependencies given explicitly.
+  for (size_t i = 0; i < params->num_reaction_dependencies; i++) {
+    edges[2 * number_of_edges] = node_of(data, params->reaction_dependencies[2 * i]);
+    edges[2 * number_of_edges + 1] = node_of(data, params->reaction_dependencies[2 * i + 1]);
+    number_of_edges++;
+  }
+  build_graph(data, edges, number_of_edges);
+  int depth = check_acyclic(data);
+  LF_PRINT_DEBUG("Scheduler: Graph has %zu reactions, %zu dependencies, and %zu sources.", n, number_of_edges,
+                 data->number_of_sources);
+
+  data->remaining = (volatile int*)calloc(n, sizeof(int));
+  data->ready = (reaction_t**)calloc(n, sizeof(reaction_t*));
+  data->worklists = (size_t**)calloc(number_of_workers + 1, sizeof(size_t*));
+  LF_ASSERT_NON_NULL(data->remaining);
+  LF_ASSERT_NON_NULL(data->ready);
+  LF_ASSERT_NON_NULL(data->worklists);
+  for (size_t i = 0; i <= number_of_workers; i++) {
+    data->worklists[i] = (size_t*)malloc(n * sizeof(size_t));
+    LF_ASSERT_NON_NULL(data->worklists[i]);
+  }
+#ifdef LF_PIPELINED_TAGS
+  build_pipeline(data, edges, number_of_edges, first);
+  // With single-buffered ports, a reaction at the end of the longest path lags the newest tag by
+  // about twice the length of the path, so this leaves room for the pipeline to fill.
+  data->max_behind = 2 * depth * (int)n;
+  data->schedules = (bool*)calloc(n, sizeof(bool));
+  LF_ASSERT_NON_NULL(data->schedules);
+  for (size_t i = 0; i < params->num_scheduling_reactions; i++) {
+    size_t node = node_of(data, params->scheduling_reactions[i]);
+    if (!data->schedules[node]) {
+      data->schedules[node] = true;
+      data->number_scheduling++;
+    }
+  }
+#else
+  (void)depth;
+#endif
+  free(edges);
+  free(first);
+}
+
+/**
+ * @brief Free the memory used by the scheduler.
+ *
+ * This must be called when the scheduler is no longer needed.
+ */
+void lf_sched_free(lf_scheduler_t* scheduler) {
+  custom_scheduler_data_t* data = scheduler->custom_data;
+  for (size_t i = 0; i < data->number_of_levels; i++) {
+    free(data->levels[i].reactions);
+  }
+  free(data->levels);
+  if (data->worklists != NULL) {
+    for (size_t i = 0; i <= scheduler->number_of_workers; i++) {
+      free(data->worklists[i]);
+    }
+  }
+  free(data->worklists);
+  free(data->reactions);
+  free(data->first_successor);
+  free(data->successors);
+  free(data->predecessors);
+  free((void*)data->remaining);
+  free(data->sources);
+  free(data->ready);
+#ifdef LF_PIPELINED_TAGS
+  release_token_copies(data, data->newest + 1);
+  free(data->first_waiter);
+  free(data->waiters);
+  free(data->waited_on);
+  free(data->first_output);
+  free(data->outputs);
+  free((void*)data->step);
+  free((void*)data->event_step);
+  free(data->parked);
+  free(data->released);
+  free(data->node_tags);
+  free(data->tags);
+  free(data->schedules);
+#endif
+  lf_semaphore_destroy(data->semaphore);
+  free(data);
+}
+
+///////////////////// Scheduler Worker API (public) /////////////////////////
+
+reaction_t* lf_sched_get_ready_reaction(lf_scheduler_t* scheduler, int worker_number) {
+  custom_scheduler_data_t* data = scheduler->custom_data;
+  if (data->by_level) {
+    return get_ready_by_level(scheduler, worker_number);
+  }
+#ifdef LF_PIPELINED_TAGS
+  _lf_set_worker_tag(NEVER_TAG, false);
+#endif
+  // Iterate until the stop tag is reached.
+  while (!scheduler->should_stop) {
+    LF_MUTEX_LOCK(&data->mutex);
+    if (data->ready_count > 0) {
+      reaction_t* reaction_to_return = data->ready[data->ready_head];
+      data->ready_head = (data->ready_head + 1) % data->number_of_reactions;
+      data->ready_count--;
+#ifdef LF_PIPELINED_TAGS
+      _lf_set_worker_tag(data->node_tags[reaction_to_return->pos], data->schedules[reaction_to_return->pos]);
+#endif
+      LF_MUTEX_UNLOCK(&data->mutex);
+      LF_PRINT_DEBUG("Scheduler: Worker %d popped reaction %s.", worker_number, reaction_to_return->name);
+      return reaction_to_return;
+    }
+    if (data->stopping && data->behind == 0) {
+#ifdef LF_PIPELINED_TAGS
+      release_token_copies(data, data->newest + 1);
+#endif
+      LF_MUTEX_UNLOCK(&data->mutex);
+      signal_stop(scheduler);
+      break;
+    }
+    if (can_advance(data)) {
+      data->advancing = true;
+      LF_MUTEX_UNLOCK(&data->mutex);
+      LF_PRINT_DEBUG("Scheduler: Worker %d is advancing the tag.", worker_number);
+      advance_and_start_tag(scheduler, worker_number);
+      continue;
+    }
+    data->waiting++;
+    LF_MUTEX_UNLOCK(&data->mutex);
+
+    LF_PRINT_DEBUG("Worker %d is out of ready reactions.", worker_number);
+    tracepoint_worker_wait_starts(scheduler->env, worker_number);
+    LF_PRINT_DEBUG("Scheduler: Worker %d is trying to acquire the scheduling semaphore.", worker_number);
+    lf_semaphore_acquire(data->semaphore);
+    LF_PRINT_DEBUG("Scheduler: Worker %d acquired the scheduling semaphore.", worker_number);
+    tracepoint_worker_wait_ends(scheduler->env, worker_number);
+  }
+
+  // It's time for the worker thread to stop and exit.
+  return NULL;
+}
+
+void lf_sched_done_with_reaction(size_t worker_number, reaction_t* done_reaction) {
+  if (!lf_atomic_bool_compare_and_swap((int*)&done_reaction->status, queued, inactive)) {
+    lf_print_error_and_exit("Unexpected reaction status: %d. Expected %d.", done_reaction->status, queued);
+  }
+  custom_scheduler_data_t* data = ((self_base_t*)done_reaction->self)->environment->scheduler->custom_data;
+  if (data->by_level) {
+    LF_MUTEX_LOCK(&data->mutex);
+    data->executing--;
+    // The last reaction at a level to finish lets a waiting worker move on to the next level.
+    bool wake = data->executing == 0 && data->waiting > 0;
+    if (wake) {
+      data->waiting--;
+    }
+    LF_MUTEX_UNLOCK(&data->mutex);
+    if (wake) {
+      lf_semaphore_release(data->semaphore, 1);
+    }
+    return;
+  }
+  size_t node = node_of(data, done_reaction);
+#ifdef LF_PIPELINED_TAGS
+  if (data->event_step[node] == data->step[node]) {
+    data->event_step[node] = -1;
+    lf_atomic_add_fetch((int*)&data->outstanding_events, -1);
+  }
+#endif
+  settle(data, node, data->worklists[worker_number]);
+}
+
+void lf_scheduler_trigger_reaction(lf_scheduler_t* scheduler, reaction_t* reaction, int worker_number) {
+  if (reaction == NULL) {
+    return;
+  }
+  custom_scheduler_data_t* data = scheduler->custom_data;
+  if (data->by_level) {
+    if (!lf_atomic_bool_compare_and_swap((int*)&reaction->status, inactive, queued)) {
+      return;
+    }
+    LF_PRINT_DEBUG("Scheduler: Triggering reaction %s at level %zu.", reaction->name,
+                   (size_t)LF_LEVEL(reaction->index));
+    LF_MUTEX_LOCK(&data->mutex);
+    push_by_level(data, reaction);
+    // Only a reaction triggered outside of a reaction and of a tag advance can find every worker waiting.
+    bool wake = data->executing == 0 && !data->advancing && data->waiting > 0;
+    if (wake) {
+      data->waiting--;
+    }
+    LF_MUTEX_UNLOCK(&data->mutex);
+    if (wake) {
+      lf_semaphore_release(data->semaphore, 1);
+    }
+    return;
+  }
+#ifdef LF_PIPELINED_TAGS
+  if (worker_number < 0) {
+    // An event at the tag being started. The reaction may still be working on an earlier tag,
+    // so remember the tag, which the reaction handles when it gets there.
+    size_t node = node_of(data, reaction);
+    if (data->event_step[node] != data->popping) {
+      LF_PRINT_DEBUG("Scheduler: Event triggers reaction %s.", reaction->name);
+      data->event_step[node] = data->popping;
+      lf_atomic_add_fetch((int*)&data->outstanding_events, 1);
+    }
+    return;
+  }
+#endif
+  if (!lf_atomic_bool_compare_and_swap((int*)&reaction->status, inactive, queued)) {
+    return;
+  }
+  size_t node = node_of(data, reaction);
+  LF_PRINT_DEBUG("Scheduler: Triggering reaction %s.", reaction->name);
+  // Events trigger reactions before they are resolved. During a tag, only a reaction
+  // that precedes a reaction can trigger it, and that reaction is not settled yet.
+  if (worker_number >= 0 && data->remaining[node] == 0) {
+    lf_print_error_and_exit("Reaction %s was triggered after the dataflow scheduler found that no reaction that "
+                            "precedes it triggered it. A dependency is missing from the reaction graph.",
+                            reaction->name);
+  }
+}
+#endif // SCHEDULER == SCHED_DATAFLOW
@@ -5,6 +5,19 @@
  * @author Erling Jellum
  *
  * @brief Definitions for watchdogs.
+ *
+ * The watchdogs of an environment are served by a single thread, which keeps the running
+ * watchdogs in a hierarchical timer wheel. Each level of the wheel has WHEEL_SLOTS slots,
+ * and a slot of level `l` covers WHEEL_SLOTS^l ticks of LF_WATCHDOG_WHEEL_RESOLUTION.
+ * A watchdog is put in the lowest level whose range covers its expiration, and the
+ * watchdogs of a slot of a higher level are moved down when the wheel reaches the slot.
+ * Watchdogs that expire within the current tick are kept in the due list, from which
+ * they are dispatched once their exact expiration time has been reached.
+ *
+ * Starting and stopping a watchdog only link it into or unlink it from a list, which
+ * takes constant time. The lock order is the reactor mutex of a watchdog followed by
+ * the mutex of the wheel, so the watchdog thread releases the latter before invoking
+ * a handler while holding the reactor mutex.
  */
 
 #include <assert.h>
@@ -13,158 +26,347 @@
 #include "util.h"
 #include "clock.h"
 
+/** The number of bits of a tick that index the slots of one level of the wheel. */
+#define WHEEL_SLOT_BITS 6
+/** The number of slots of one level of the wheel. */
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+/** The number of levels of the wheel. */
+#define WHEEL_LEVELS 4
+/** The largest number of ticks from now that a watchdog can be put in the wheel for. */
+#define WHEEL_MAX_TICKS ((1ULL << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) - 1)
+
+/** The timer wheel of an environment and the state of the thread that serves it. */
+typedef struct lf_watchdog_wheel_t {
+  /** Mutex protecting the wheel, which is never held while acquiring a reactor mutex. */
+  lf_mutex_t mutex;
+  /** Condition variable on which the watchdog thread waits for the next expiration. */
+  lf_cond_t cond;
+  /** The watchdog thread. */
+  lf_thread_t thread_id;
+  /** The physical time of tick 0. */
+  instant_t epoch;
+  /** The last tick that the wheel has been advanced to. */
+  uint64_t current;
+  /** The slots of each level. */
+  watchdog_t* slots[WHEEL_LEVELS][WHEEL_SLOTS];
+  /** Watchdogs that expire no later than the end of the current tick. */
+  watchdog_t* due;
+  /** The time until which the watchdog thread is waiting, or FOREVER. */
+  instant_t next_wakeup;
+  /** Whether the watchdog thread should exit. */
+  bool terminate;
+} lf_watchdog_wheel_t;
+
 // Forward declarations
-static void _lf_watchdog_terminate(watchdog_t* watchdog);
 static void* watchdog_thread_main(void* arg);
 
+/**
+ * @brief Insert a watchdog at the front of a list of the wheel.
+ * @param list The head of the list.
+ * @param watchdog The watchdog, which is not in the wheel.
+ */
+static void wheel_link(watchdog_t** list, watchdog_t* watchdog) {
+  watchdog->wheel_next = *list;
+  if (*list != NULL) {
+    (*list)->wheel_prev = &watchdog->wheel_next;
+  }
+  *list = watchdog;
+  watchdog->wheel_prev = list;
+}
+
+/**
+ * @brief Remove a watchdog from the list of the wheel it is in, if any.
+ * @param watchdog The watchdog.
+ */
+static void wheel_unlink(watchdog_t* watchdog) {
+  if (watchdog->wheel_prev == NULL) {
+    return;
+  }
+  *watchdog->wheel_prev = watchdog->wheel_next;
+  if (watchdog->wheel_next != NULL) {
+    watchdog->wheel_next->wheel_prev = watchdog->wheel_prev;
+  }
+  watchdog->wheel_next = NULL;
+  watchdog->wheel_prev = NULL;
+}
+
+/**
+ * @brief Return the tick during which the specified time falls.
+ * @param wheel The wheel.
+ * @param time The time.
+ */
+static uint64_t wheel_tick(lf_watchdog_wheel_t* wheel, instant_t time) {
+  if (time <= wheel->epoch) {
+    return 0;
+  }
+  return (uint64_t)((time - wheel->epoch) / LF_WATCHDOG_WHEEL_RESOLUTION);
+}
+
+/**
+ * @brief Put a watchdog that is not in the wheel into the slot or due list for its expiration.
+ * @param wheel The wheel, whose mutex is held.
+ * @param watchdog The watchdog.
+ */
+static void wheel_insert(lf_watchdog_wheel_t* wheel, watchdog_t* watchdog) {
+  uint64_t tick = wheel_tick(wheel, watchdog->expiration);
+  if (tick <= wheel->current) {
+    wheel_link(&wheel->due, watchdog);
+    return;
+  }
+  uint64_t delta = tick - wheel->current;
+  if (delta > WHEEL_MAX_TICKS) {
+    // Too far in the future. The watchdog is put back into the wheel when its slot is reached.
+    tick = wheel->current + WHEEL_MAX_TICKS;
+    delta = WHEEL_MAX_TICKS;
+  }
+  int level = 0;
+  while (delta >= (1ULL << (WHEEL_SLOT_BITS * (level + 1)))) {
+    level++;
+  }
+  size_t slot = (size_t)(tick >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1);
+  wheel_link(&wheel->slots[level][slot], watchdog);
+}
+
+/**
+ * @brief Move all watchdogs of a slot to their new position in the wheel.
+ * @param wheel The wheel, whose mutex is held.
+ * @param list The head of the list of the slot.
+ */
+static void wheel_cascade(lf_watchdog_wheel_t* wheel, watchdog_t** list) {
+  watchdog_t* watchdog = *list;
+  *list = NULL;
+  while (watchdog != NULL) {
+    watchdog_t* next = watchdog->wheel_next;
+    watchdog->wheel_next = NULL;
+    watchdog->wheel_prev = NULL;
+    wheel_insert(wheel, watchdog);
+    watchdog = next;
+  }
+}
+
+/**
+ * @brief Return true if there are no watchdogs in the slots of the wheel, not counting the due list.
+ * @param wheel The wheel, whose mutex is held.
+ */
+static bool wheel_is_empty(lf_watchdog_wheel_t* wheel) {
+  for (int level = 0; level < WHEEL_LEVELS; level++) {
+    for (int slot = 0; slot < WHEEL_SLOTS; slot++) {
+      if (wheel->slots[level][slot] != NULL) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Advance the wheel to the tick of the specified time, moving expiring watchdogs to the due list.
+ * @param wheel The wheel, whose mutex is held.
+ * @param now The current physical time.
+ */
+static void wheel_advance(lf_watchdog_wheel_t* wheel, instant_t now) {
+  uint64_t target = wheel_tick(wheel, now);
+  if (target > wheel->current && wheel_is_empty(wheel)) {
+    wheel->current = target;
+    return;
+  }
+  while (wheel->current < target) {
+    uint64_t tick = ++wheel->current;
+    for (int level = 1; level < WHEEL_LEVELS; level++) {
+      if ((tick & ((1ULL << (WHEEL_SLOT_BITS * level)) - 1)) != 0) {
+        break;
+      }
+      wheel_cascade(wheel, &wheel->slots[level][(tick >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1)]);
+    }
+    wheel_cascade(wheel, &wheel->slots[0][tick & (WHEEL_SLOTS - 1)]);
+  }
+}
+
+/**
+ * @brief Return the time at which the watchdog thread next has to look at the wheel.
+ * @param wheel The wheel, whose mutex is held.
+ */
+static instant_t wheel_next_wakeup(lf_watchdog_wheel_t* wheel) {
+  instant_t result = FOREVER;
+  for (watchdog_t* watchdog = wheel->due; watchdog != NULL; watchdog = watchdog->wheel_next) {
+    if (watchdog->expiration < result) {
+      result = watchdog->expiration;
+    }
+  }
+  // For each level, find the first nonempty slot after the current one.
+  for (int level = 0; level < WHEEL_LEVELS; level++) {
+    int shift = WHEEL_SLOT_BITS * level;
+    uint64_t base = wheel->current >> shift;
+    for (uint64_t k = 1; k <= WHEEL_SLOTS; k++) {
+      if (wheel->slots[level][(base + k) & (WHEEL_SLOTS - 1)] != NULL) {
+        instant_t time = wheel->epoch + (instant_t)(((base + k) << shift) * LF_WATCHDOG_WHEEL_RESOLUTION);
+        if (time < result) {
+          result = time;
+        }
+        break;
+      }
+    }
+  }
+  return result;
+}
+
 /**
  * @brief Initialize watchdog mutexes.
  * For any reactor with one or more watchdogs, the self struct should have a non-NULL
  * `reactor_mutex` field which points to an instance of `lf_mutex_t`.
- * This function initializes those mutexes. It also initializes the condition
- * variable which enables the safe termination of a running watchdog.
- * Finally it starts of a non-termminating thread for each watchdog.
+ * This function initializes those mutexes. It also initializes the timer wheel
+ * of the environment and starts the thread that serves the watchdogs.
  */
 void _lf_initialize_watchdogs(environment_t* env) {
+  if (env->watchdogs_size <= 0) {
+    return;
+  }
   for (int i = 0; i < env->watchdogs_size; i++) {
     watchdog_t* watchdog = env->watchdogs[i];
     if (watchdog->base->reactor_mutex != NULL) {
       LF_MUTEX_INIT((lf_mutex_t*)(watchdog->base->reactor_mutex));
     }
-    LF_COND_INIT(&watchdog->cond, watchdog->base->reactor_mutex);
-
-    int ret = lf_thread_create(&watchdog->thread_id, watchdog_thread_main, (void*)watchdog);
-    LF_ASSERTN(ret, "Could not create watchdog thread");
+    watchdog->wheel_next = NULL;
+    watchdog->wheel_prev = NULL;
   }
+  lf_watchdog_wheel_t* wheel = (lf_watchdog_wheel_t*)calloc(1, sizeof(lf_watchdog_wheel_t));
+  LF_ASSERT_NON_NULL(wheel);
+  LF_MUTEX_INIT(&wheel->mutex);
+  LF_COND_INIT(&wheel->cond, &wheel->mutex);
+  wheel->epoch = lf_time_physical();
+  wheel->next_wakeup = FOREVER;
+  env->watchdog_wheel = wheel;
+
+  int ret = lf_thread_create(&wheel->thread_id, watchdog_thread_main, (void*)wheel);
+  LF_ASSERTN(ret, "Could not create watchdog thread");
 }
 
 /**
- * @brief Terminate all watchdog threads.
+ * @brief Terminate all watchdogs and the watchdog thread.
  */
 void _lf_watchdog_terminate_all(environment_t* env) {
-  void* thread_ret;
+  lf_watchdog_wheel_t* wheel = env->watchdog_wheel;
+  if (wheel == NULL) {
+    return;
+  }
   for (int i = 0; i < env->watchdogs_size; i++) {
     watchdog_t* watchdog = env->watchdogs[i];
     LF_MUTEX_LOCK(watchdog->base->reactor_mutex);
-    _lf_watchdog_terminate(watchdog);
+    watchdog->terminate = true;
+    watchdog->expiration = NEVER;
+    watchdog->active = false;
+    LF_MUTEX_LOCK(&wheel->mutex);
+    wheel_unlink(watchdog);
+    LF_MUTEX_UNLOCK(&wheel->mutex);
     LF_MUTEX_UNLOCK(watchdog->base->reactor_mutex);
-    lf_thread_join(watchdog->thread_id, &thread_ret);
   }
+  LF_MUTEX_LOCK(&wheel->mutex);
+  wheel->terminate = true;
+  LF_COND_SIGNAL(&wheel->cond);
+  LF_MUTEX_UNLOCK(&wheel->mutex);
+  void* thread_ret;
+  lf_thread_join(wheel->thread_id, &thread_ret);
+  free(wheel);
+  env->watchdog_wheel = NULL;
 }
 
-void watchdog_wait(watchdog_t* watchdog) {
-  watchdog->active = true;
-  instant_t physical_time = lf_time_physical();
-  while (watchdog->expiration != NEVER && physical_time < watchdog->expiration && !watchdog->terminate) {
-    // Wait for expiration, or a signal to stop or terminate.
-    LF_PRINT_DEBUG("Watchdog %p sleeps until " PRINTF_TIME, (void*)watchdog, watchdog->expiration);
-    lf_clock_cond_timedwait(&watchdog->cond, watchdog->expiration);
-    physical_time = lf_time_physical();
-    LF_PRINT_DEBUG("Watchdog %p woke up at " PRINTF_TIME " expires at " PRINTF_TIME, (void*)watchdog, physical_time,
-                   watchdog->expiration);
-  }
-  LF_PRINT_DEBUG("Watchdog %p returns with expired=%d terminated=%d", (void*)watchdog,
-                 physical_time >= watchdog->expiration, watchdog->terminate);
+/**
+ * @brief Invoke the handler of a watchdog taken from the due list if it is still expired.
+ * The watchdog may have been stopped or restarted after it was taken from the due list.
+ * @param wheel The wheel, whose mutex is not held.
+ * @param watchdog The watchdog, which is not in the wheel when it is taken from the due list.
+ */
+static void watchdog_dispatch(lf_watchdog_wheel_t* wheel, watchdog_t* watchdog) {
+  self_base_t* base = watchdog->base;
+  LF_MUTEX_LOCK((lf_mutex_t*)(base->reactor_mutex));
+  if (!watchdog->terminate && watchdog->expiration != NEVER && watchdog->expiration <= lf_time_physical()) {
+    LF_PRINT_DEBUG("Watchdog %p timed out", (void*)watchdog);
+    watchdog_function_t watchdog_func = watchdog->watchdog_function;
+    (*watchdog_func)(base);
+    watchdog->expiration = NEVER;
+    watchdog->active = false;
+    // The handler may have restarted the watchdog, which, as before, has no effect.
+    LF_MUTEX_LOCK(&wheel->mutex);
+    wheel_unlink(watchdog);
+    LF_MUTEX_UNLOCK(&wheel->mutex);
+  }
+  LF_MUTEX_UNLOCK((lf_mutex_t*)(base->reactor_mutex));
 }
 
 /**
- * @brief Thread function for a watchdog.
- *
- * Each watchdog has a thread which sleeps until one out of two scenarios:
- * 1) The watchdog timeout expires and there has not been a renewal of the
- *    watchdog budget.
- * 2) The watchdog is signaled to wake up and stop or terminate.
+ * @brief Thread function that serves the watchdogs of an environment.
  *
- * In normal usage, the expiration time is incremented while the thread is
- * sleeping, so when the thread wakes up, it can go back to sleep again. If the
- * watchdog does expire. It will execute the watchdog handler and wait for next
- * start. To stop a running watchdog, the expiration field is set to NEVER.
- * The watchdog thread can also be terminated, this should only be done at the
- * end of execution as it cannot be restarted after termination.
+ * The thread sleeps until the earliest expiration of a watchdog in the due list or
+ * until the wheel reaches the next nonempty slot, whichever comes first, or until
+ * a watchdog is started that expires before that.
+ * It then advances the wheel and invokes the handlers of the expired watchdogs.
+ * A running watchdog is stopped by setting its expiration to NEVER and removing it from the wheel.
  *
- * @param arg A pointer to the watchdog struct
+ * @param arg A pointer to the timer wheel.
  * @return NULL
  */
 static void* watchdog_thread_main(void* arg) {
   initialize_lf_thread_id();
-  watchdog_t* watchdog = (watchdog_t*)arg;
-  self_base_t* base = watchdog->base;
-  LF_PRINT_DEBUG("Starting Watchdog %p", (void*)watchdog);
-  LF_ASSERT(base->reactor_mutex, "reactor-mutex not alloc'ed but has watchdogs.");
+  lf_watchdog_wheel_t* wheel = (lf_watchdog_wheel_t*)arg;
+  LF_PRINT_DEBUG("Starting watchdog thread %p", (void*)wheel);
 
-  // Grab reactor-mutex and start infinite loop.
-  LF_MUTEX_LOCK((lf_mutex_t*)(base->reactor_mutex));
-  while (!watchdog->terminate) {
-
-    // Step 1: Wait for a timeout to start watching for.
-    if (watchdog->expiration == NEVER) {
-      LF_PRINT_DEBUG("Watchdog %p waiting on cond var to be started", (void*)watchdog);
-      // Watchdog has been stopped.
-      // Let the runtime know that we are in an inactive/stopped state.
-      watchdog->active = false;
-      // Wait here until the watchdog is started and we can enter the active state.
-      LF_COND_WAIT(&watchdog->cond);
-      LF_PRINT_DEBUG("Watchdog %p woke up from cond var", (void*)watchdog);
-      continue;
-    } else {
-      // Watchdog has been started.
-      LF_PRINT_DEBUG("Watchdog %p started", (void*)watchdog);
-      watchdog_wait(watchdog);
-
-      // At this point we have returned from the watchdog wait. But it could
-      // be that it was to terminate the watchdog.
-      if (watchdog->terminate) {
-        LF_PRINT_DEBUG("Watchdog %p was terminated", (void*)watchdog);
-        break;
-      }
+  LF_MUTEX_LOCK(&wheel->mutex);
+  while (!wheel->terminate) {
+    instant_t now = lf_time_physical();
+    wheel_advance(wheel, now);
 
-      // It could also be that the watchdog was stopped
-      if (watchdog->expiration == NEVER) {
-        LF_PRINT_DEBUG("Watchdog %p was stopped", (void*)watchdog);
-        continue;
-      }
+    // Find an expired watchdog in the due list.
+    watchdog_t* expired = wheel->due;
+    while (expired != NULL && expired->expiration > now) {
+      expired = expired->wheel_next;
+    }
+    if (expired != NULL) {
+      wheel_unlink(expired);
+      LF_MUTEX_UNLOCK(&wheel->mutex);
+      watchdog_dispatch(wheel, expired);
+      LF_MUTEX_LOCK(&wheel->mutex);
+      continue;
+    }
 
-      // If we reach here, the watchdog actually timed out. Handle it.
-      LF_PRINT_DEBUG("Watchdog %p timed out", (void*)watchdog);
-      watchdog_function_t watchdog_func = watchdog->watchdog_function;
-      (*watchdog_func)(base);
-      watchdog->expiration = NEVER;
+    wheel->next_wakeup = wheel_next_wakeup(wheel);
+    if (wheel->next_wakeup == FOREVER) {
+      LF_PRINT_DEBUG("Watchdog thread %p waiting for a watchdog to be started", (void*)wheel);
+      LF_COND_WAIT(&wheel->cond);
+    } else {
+      LF_PRINT_DEBUG("Watchdog thread %p sleeps until " PRINTF_TIME, (void*)wheel, wheel->next_wakeup);
+      lf_clock_cond_timedwait(&wheel->cond, wheel->next_wakeup);
     }
+    wheel->next_wakeup = FOREVER;
   }
-
-  // Here the thread terminates.
-  watchdog->active = false;
-  LF_MUTEX_UNLOCK(base->reactor_mutex);
+  LF_MUTEX_UNLOCK(&wheel->mutex);
   return NULL;
 }
 
 void lf_watchdog_start(watchdog_t* watchdog, interval_t additional_timeout) {
   // Assumes reactor mutex is already held.
   self_base_t* base = watchdog->base;
+  lf_watchdog_wheel_t* wheel = base->environment->watchdog_wheel;
   watchdog->terminate = false;
+  watchdog->active = true;
   watchdog->expiration = base->environment->current_tag.time + watchdog->min_expiration + additional_timeout;
 
-  // If the watchdog is inactive, signal it to start waiting.
-  if (!watchdog->active) {
-    LF_COND_SIGNAL(&watchdog->cond);
+  LF_MUTEX_LOCK(&wheel->mutex);
+  wheel_unlink(watchdog);
+  wheel_insert(wheel, watchdog);
+  // Only wake up the watchdog thread if it would otherwise sleep past the new expiration.
+  if (watchdog->expiration < wheel->next_wakeup) {
+    LF_COND_SIGNAL(&wheel->cond);
   }
+  LF_MUTEX_UNLOCK(&wheel->mutex);
 }
 
 void lf_watchdog_stop(watchdog_t* watchdog) {
   // Assumes reactor mutex is already held.
+  lf_watchdog_wheel_t* wheel = watchdog->base->environment->watchdog_wheel;
   watchdog->expiration = NEVER;
+  watchdog->active = false;
 
-  // If lf_watchdog_stop is called very close to lf_watchdog_start, it might
-  // not have had the time to wake up and start sleeping.
-  if (!watchdog->active) {
-    return;
-  }
-
-  LF_COND_SIGNAL(&watchdog->cond);
-}
-
-static void _lf_watchdog_terminate(watchdog_t* watchdog) {
-  watchdog->terminate = true;
-  watchdog->expiration = NEVER;
-  LF_COND_SIGNAL(&watchdog->cond);
+  LF_MUTEX_LOCK(&wheel->mutex);
+  wheel_unlink(watchdog);
+  LF_MUTEX_UNLOCK(&wheel->mutex);
 }
@@ -0,0 +1,160 @@
+/**
+ * @file
+ *
+ * @brief CPU pinning, NUMA placement, and real-time priority of worker threads.
+ *
+ * See worker_placement.h for docs.
+ */
+#if !defined LF_SINGLE_THREADED
+
+#include <stdlib.h>
+
+#include "worker_placement.h"
+#include "low_level_platform.h"
+#include "platform/lf_platform_util.h"
+#include "util.h"
+
+// Only some platforms implement the thread-placement part of the platform API.
+#if defined(PLATFORM_Linux) || defined(PLATFORM_Darwin) || defined(PLATFORM_Windows) || defined(PLATFORM_ZEPHYR) ||   \
+    defined(PLATFORM_Zephyr)
+#define LF_WORKER_PLACEMENT_SUPPORTED
+#endif
+
+/** Upper bound on the number of CPUs that can be used for placement. */
+#define MAX_PLACEMENT_CPUS 1024
+
+bool lf_pin_workers = LF_PIN_WORKERS;
+int lf_numa_node = LF_NUMA_NODE;
+int lf_rt_priority = LF_RT_PRIORITY;
+
+/** The CPUs given with --cpu-list or LF_CPU_LIST. */
+static size_t cpu_list[MAX_PLACEMENT_CPUS];
+
+/** The number of CPUs in cpu_list, or -1 if no CPU list has been given. */
+static int cpu_list_size = -1;
+
+bool lf_worker_placement_set_cpu_list(const char* spec) {
+  int size = lf_parse_cpu_list(spec, cpu_list, MAX_PLACEMENT_CPUS);
+  if (size <= 0) {
+    return false;
+  }
+  cpu_list_size = size;
+  return true;
+}
+
+/**
+ * @brief Collect the CPUs that workers may be pinned to.
+ * If both a CPU list and a NUMA node are given, the result is their intersection.
+ * @param cpus The array into which to write the CPUs, with capacity MAX_PLACEMENT_CPUS.
+ * @return The number of CPUs.
+ */
+static int collect_cpus(size_t* cpus) {
+#ifdef LF_CPU_LIST
+  if (cpu_list_size < 0 && !lf_worker_placement_set_cpu_list(LF_CPU_LIST)) {
+    lf_print_error_and_exit("Invalid LF_CPU_LIST: %s", LF_CPU_LIST);
+  }
+#endif
+  int count = 0;
+  if (cpu_list_size > 0) {
+    for (int i = 0; i < cpu_list_size; i++) {
+      cpus[count++] = cpu_list[i];
+    }
+  } else {
+    int cores = lf_available_cores();
+    for (int i = 0; i < cores && count < MAX_PLACEMENT_CPUS; i++) {
+      cpus[count++] = (size_t)i;
+    }
+  }
+  if (lf_numa_node >= 0) {
+    size_t* node_cpus = (size_t*)calloc(MAX_PLACEMENT_CPUS, sizeof(size_t));
+    LF_ASSERT_NON_NULL(node_cpus);
+    int node_count = lf_numa_node_cpus(lf_numa_node, node_cpus, MAX_PLACEMENT_CPUS);
+    if (node_count <= 0) {
+      lf_print_warning("No CPUs found for NUMA node %d. Ignoring the NUMA node.", lf_numa_node);
+    } else {
+      int kept = 0;
+      for (int i = 0; i < count; i++) {
+        for (int j = 0; j < node_count; j++) {
+          if (cpus[i] == node_cpus[j]) {
+            cpus[kept++] = cpus[i];
+            break;
+          }
+        }
+      }
+      count = kept;
+    }
+    free(node_cpus);
+  }
+  return count;
+}
+
+void lf_worker_placement_init(environment_t* envs, int num_envs) {
+#ifdef LF_CPU_LIST
+  bool cpu_list_given = true;
+#else
+  bool cpu_list_given = cpu_list_size > 0;
+#endif
+  if (!lf_pin_workers && !cpu_list_given && lf_numa_node < 0) {
+    return;
+  }
+#ifndef LF_WORKER_PLACEMENT_SUPPORTED
+  (void)envs;
+  (void)num_envs;
+  lf_print_warning("Pinning worker threads is not supported on this platform.");
+#else
+  size_t* cpus = (size_t*)calloc(MAX_PLACEMENT_CPUS, sizeof(size_t));
+  LF_ASSERT_NON_NULL(cpus);
+  int num_cpus = collect_cpus(cpus);
+  if (num_cpus == 0) {
+    lf_print_warning("No CPUs available for pinning worker threads. Workers will not be pinned.");
+    free(cpus);
+    return;
+  }
+
+  // Hand out the CPUs to the workers of each environment in turn, so that
+  // environments get disjoint CPU sets whenever there are enough CPUs.
+  int total_workers = 0;
+  int next = 0;
+  for (int i = 0; i < num_envs; i++) {
+    environment_t* env = &envs[i];
+    env->worker_cpus = (size_t*)calloc(env->num_workers, sizeof(size_t));
+    LF_ASSERT_NON_NULL(env->worker_cpus);
+    for (int j = 0; j < env->num_workers; j++) {
+      env->worker_cpus[j] = cpus[next];
+      next = (next + 1) % num_cpus;
+    }
+    total_workers += env->num_workers;
+  }
+  if (total_workers > num_cpus) {
+    lf_print_warning("%d workers share %d CPUs. Some workers are pinned to the same CPU.", total_workers, num_cpus);
+  }
+  free(cpus);
+#endif // LF_WORKER_PLACEMENT_SUPPORTED
+}
+
+void lf_worker_placement_apply(environment_t* env, int worker_number) {
+#ifndef LF_WORKER_PLACEMENT_SUPPORTED
+  (void)env;
+  (void)worker_number;
+#else
+  if (env->worker_cpus != NULL && worker_number < env->num_workers) {
+    size_t cpu = env->worker_cpus[worker_number];
+    int result = lf_thread_set_cpu(lf_thread_self(), cpu);
+    if (result != 0) {
+      lf_print_warning("Env %u: Failed to pin worker %d to CPU %zu. Error code %d.", env->id, worker_number, cpu,
+                       result);
+    } else {
+      LF_PRINT_LOG("Env %u: Pinned worker %d to CPU %zu.", env->id, worker_number, cpu);
+    }
+  }
+  if (lf_rt_priority >= 0) {
+    lf_scheduling_policy_t policy = {.policy = LF_SCHED_PRIORITY, .priority = lf_rt_priority, .time_slice = 0};
+    int result = lf_thread_set_scheduling_policy(lf_thread_self(), &policy);
+    if (result != 0) {
+      lf_print_warning("Env %u: Failed to give worker %d real-time priority %d. Error code %d.", env->id,
+                       worker_number, lf_rt_priority, result);
+    }
+  }
+#endif // LF_WORKER_PLACEMENT_SUPPORTED
+}
+#endif // !LF_SINGLE_THREADED
@@ -0,0 +1,217 @@
+/**
+ * @file timer_table.c
+ * @brief Table of periodic timers that is kept apart from the event queue.
+ *
+ * See timer_table.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "timer_table.h"
+#include "util.h"
+
+/** The initial number of blocks that the table has room for. */
+#define INITIAL_TIMER_TABLE_CAPACITY 4
+
+/** Return a negative number, zero, or a positive number if the group fires before, with, or after the other. */
+static inline int compare(lf_timer_group_t* group, lf_timer_group_t* other) {
+  if (group->time != other->time) {
+    return group->time < other->time ? -1 : 1;
+  }
+  if (group->period != other->period) {
+    return group->period < other->period ? -1 : 1;
+  }
+  return 0;
+}
+
+/** Return the group at the given position in the block. */
+static inline lf_timer_group_t** group_at(lf_timer_block_t* block, size_t i) {
+  return &block->groups[block->first + i];
+}
+
+/** Return the position of the last block whose first group does not fire after the group, or 0 if there is none. */
+static size_t find_block(lf_timer_table_t* table, lf_timer_group_t* group) {
+  size_t low = 0;
+  size_t high = table->number_of_blocks;
+  while (high - low > 1) {
+    size_t middle = low + (high - low) / 2;
+    if (compare(*group_at(table->blocks[middle], 0), group) <= 0) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/** Return the number of groups in the block that fire before the group. */
+static size_t find_in_block(lf_timer_block_t* block, lf_timer_group_t* group) {
+  size_t low = 0;
+  size_t high = block->number_of_groups;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (compare(*group_at(block, middle), group) < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/** Return an empty block, reusing the spare block of the table if there is one. */
+static lf_timer_block_t* new_block(lf_timer_table_t* table) {
+  lf_timer_block_t* block = table->spare;
+  table->spare = NULL;
+  if (block == NULL) {
+    block = (lf_timer_block_t*)malloc(sizeof(lf_timer_block_t));
+    LF_ASSERT_NON_NULL(block);
+  }
+  block->first = 0;
+  block->number_of_groups = 0;
+  return block;
+}
+
+/** Insert a block at the given position of the blocks array, growing it if needed. */
+static void insert_block(lf_timer_table_t* table, size_t i, lf_timer_block_t* block) {
+  if (table->number_of_blocks == table->capacity) {
+    table->capacity *= 2;
+    table->blocks = (lf_timer_block_t**)realloc(table->blocks, table->capacity * sizeof(lf_timer_block_t*));
+    LF_ASSERT_NON_NULL(table->blocks);
+  }
+  memmove(&table->blocks[i + 1], &table->blocks[i], (table->number_of_blocks - i) * sizeof(lf_timer_block_t*));
+  table->blocks[i] = block;
+  table->number_of_blocks++;
+}
+
+/** Move the later half of the groups of a full block to a new block after it. */
+static void split(lf_timer_table_t* table, size_t i) {
+  lf_timer_block_t* block = table->blocks[i];
+  lf_timer_block_t* later = new_block(table);
+  size_t half = block->number_of_groups / 2;
+  later->number_of_groups = block->number_of_groups - half;
+  memcpy(later->groups, group_at(block, half), later->number_of_groups * sizeof(lf_timer_group_t*));
+  block->number_of_groups = half;
+  insert_block(table, i + 1, later);
+}
+
+/** Insert a group at the given position of a block that is not full, moving the fewest groups. */
+static void insert_in_block(lf_timer_block_t* block, size_t i, lf_timer_group_t* group) {
+  size_t n = block->number_of_groups;
+  if (block->first > 0 && (i < n / 2 || block->first + n == LF_TIMER_BLOCK_SIZE)) {
+    memmove(group_at(block, -1), group_at(block, 0), i * sizeof(lf_timer_group_t*));
+    block->first--;
+  } else {
+    memmove(group_at(block, i + 1), group_at(block, i), (n - i) * sizeof(lf_timer_group_t*));
+  }
+  *group_at(block, i) = group;
+  block->number_of_groups++;
+}
+
+/** Append the timers of a group to another and free the first group. */
+static void merge(lf_timer_group_t* into, lf_timer_group_t* group) {
+  if (into->number_of_timers + group->number_of_timers > into->capacity) {
+    into->capacity = (into->number_of_timers + group->number_of_timers) * 2;
+    into->timers = (trigger_t**)realloc(into->timers, into->capacity * sizeof(trigger_t*));
+    LF_ASSERT_NON_NULL(into->timers);
+  }
+  memcpy(&into->timers[into->number_of_timers], group->timers, group->number_of_timers * sizeof(trigger_t*));
+  into->number_of_timers += group->number_of_timers;
+  lf_timer_table_free_group(group);
+}
+
+lf_timer_table_t* lf_timer_table_new(void) {
+  lf_timer_table_t* table = (lf_timer_table_t*)calloc(1, sizeof(lf_timer_table_t));
+  LF_ASSERT_NON_NULL(table);
+  table->capacity = INITIAL_TIMER_TABLE_CAPACITY;
+  table->blocks = (lf_timer_block_t**)calloc(table->capacity, sizeof(lf_timer_block_t*));
+  LF_ASSERT_NON_NULL(table->blocks);
+  return table;
+}
+
+void lf_timer_table_free(lf_timer_table_t* table) {
+  if (table == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < table->number_of_blocks; i++) {
+    lf_timer_block_t* block = table->blocks[i];
+    for (size_t j = 0; j < block->number_of_groups; j++) {
+      lf_timer_table_free_group(*group_at(block, j));
+    }
+    free(block);
+  }
+  free(table->spare);
+  free(table->blocks);
+  free(table);
+}
+
+void lf_timer_table_add(lf_timer_table_t* table, trigger_t* timer, instant_t time) {
+  lf_timer_group_t* group = (lf_timer_group_t*)calloc(1, sizeof(lf_timer_group_t));
+  LF_ASSERT_NON_NULL(group);
+  group->time = time;
+  group->period = timer->period;
+  group->capacity = 1;
+  group->timers = (trigger_t**)malloc(sizeof(trigger_t*));
+  LF_ASSERT_NON_NULL(group->timers);
+  group->timers[0] = timer;
+  group->number_of_timers = 1;
+  lf_timer_table_push(table, group);
+}
+
+instant_t lf_timer_table_next_time(lf_timer_table_t* table) {
+  if (table == NULL || table->number_of_groups == 0) {
+    return FOREVER;
+  }
+  return (*group_at(table->blocks[0], 0))->time;
+}
+
+lf_timer_group_t* lf_timer_table_pop(lf_timer_table_t* table, instant_t time) {
+  if (table == NULL || table->number_of_groups == 0 || (*group_at(table->blocks[0], 0))->time != time) {
+    return NULL;
+  }
+  lf_timer_block_t* block = table->blocks[0];
+  lf_timer_group_t* group = *group_at(block, 0);
+  block->first++;
+  block->number_of_groups--;
+  table->number_of_groups--;
+  if (block->number_of_groups == 0) {
+    table->number_of_blocks--;
+    memmove(&table->blocks[0], &table->blocks[1], table->number_of_blocks * sizeof(lf_timer_block_t*));
+    // Keep one block for the next split, since the groups that were fired are usually put back.
+    if (table->spare == NULL) {
+      table->spare = block;
+    } else {
+      free(block);
+    }
+  }
+  return group;
+}
+
+void lf_timer_table_push(lf_timer_table_t* table, lf_timer_group_t* group) {
+  if (table->number_of_blocks == 0) {
+    insert_block(table, 0, new_block(table));
+  }
+  // The first group of the next block fires after the group, so a group to merge with can only be in this block.
+  size_t i = find_block(table, group);
+  lf_timer_block_t* block = table->blocks[i];
+  size_t j = find_in_block(block, group);
+  if (j < block->number_of_groups && compare(*group_at(block, j), group) == 0) {
+    merge(*group_at(block, j), group);
+    return;
+  }
+  if (block->number_of_groups == LF_TIMER_BLOCK_SIZE) {
+    split(table, i);
+    if (j > block->number_of_groups) {
+      j -= block->number_of_groups;
+      block = table->blocks[i + 1];
+    }
+  }
+  insert_in_block(block, j, group);
+  table->number_of_groups++;
+}
+
+void lf_timer_table_free_group(lf_timer_group_t* group) {
+  free(group->timers);
+  free(group);
+}
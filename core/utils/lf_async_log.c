@@ -0,0 +1,265 @@
+/**
+ * @file
+ *
+ * @brief Asynchronous backend for the lf_print functions.
+ *
+ * Every thread that prints a message gets a single-producer, single-consumer ring of
+ * fixed-size slots the first time it prints. Rings are linked into a lock-free list and
+ * freed when the backend stops. Each start begins a new generation, and a thread whose ring
+ * is from an earlier generation gets a new one. The background thread is the only consumer.
+ * It repeatedly takes the oldest message at the head of any ring, which keeps the output of
+ * different threads in timestamp order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lf_async_log.h"
+#include "logging.h"
+#include "util.h"
+
+/** A formatted message in a ring. */
+typedef struct {
+  instant_t time;
+  int length;
+  char text[LF_ASYNC_LOG_MESSAGE_SIZE];
+} lf_async_log_record_t;
+
+/** The ring of one printing thread. */
+typedef struct lf_async_log_ring_t {
+  /** Number of records taken by the background thread. Written only by the background thread. */
+  int64_t head;
+  char head_padding[64 - sizeof(int64_t)];
+  /** Number of records added by the owning thread. Written only by the owning thread. */
+  int64_t tail;
+  /** Number of messages the owning thread dropped. Written only by the owning thread. */
+  int64_t dropped;
+  char tail_padding[64 - 2 * sizeof(int64_t)];
+  /** Value of tail when the background thread last looked at it. */
+  int64_t available;
+  /** Number of dropped messages already reported by the background thread. */
+  int64_t reported;
+  struct lf_async_log_ring_t* next;
+  lf_async_log_record_t records[LF_ASYNC_LOG_SLOTS];
+} lf_async_log_ring_t;
+
+// Defined in util.c.
+extern print_message_function_t* print_message_function;
+extern int print_message_level;
+
+/** List of the rings of all threads that have printed a message. */
+static lf_async_log_ring_t* _lf_async_log_rings = NULL;
+
+/** The ring of the calling thread, or NULL if it has not printed yet. */
+static thread_local lf_async_log_ring_t* _lf_async_log_ring = NULL;
+
+/** The generation of the ring of the calling thread, and the current generation. */
+static thread_local int _lf_async_log_ring_generation = 0;
+static int _lf_async_log_generation = 0;
+
+/** The number of threads inside lf_async_log_print(), which lf_async_log_stop() waits for. */
+static volatile int _lf_async_log_printing = 0;
+
+/** Messages dropped by rings that have been freed. */
+static int64_t _lf_async_log_freed_dropped = 0;
+
+static lf_thread_t _lf_async_log_thread;
+static bool _lf_async_log_running = false;
+static bool _lf_async_log_stopping = false;
+static bool _lf_async_log_exit_registered = false;
+static lf_async_log_overflow_t _lf_async_log_overflow = LF_ASYNC_LOG_DROP;
+static print_message_function_t* _lf_async_log_previous_function = NULL;
+static int _lf_async_log_previous_level = -1;
+
+/** Return the ring of the calling thread, creating it on first use. */
+static lf_async_log_ring_t* lf_async_log_get_ring(void) {
+  lf_async_log_ring_t* ring = _lf_async_log_ring;
+  if (ring == NULL || _lf_async_log_ring_generation != _lf_async_log_generation) {
+    ring = (lf_async_log_ring_t*)calloc(1, sizeof(lf_async_log_ring_t));
+    if (ring == NULL) {
+      return NULL;
+    }
+    lf_async_log_ring_t* head;
+    do {
+      head = *(lf_async_log_ring_t* volatile*)&_lf_async_log_rings;
+      ring->next = head;
+    } while (lf_atomic_val_compare_and_swap_ptr((void**)&_lf_async_log_rings, head, ring) != head);
+    _lf_async_log_ring = ring;
+    _lf_async_log_ring_generation = _lf_async_log_generation;
+  }
+  return ring;
+}
+
+/**
+ * The print function registered with lf_register_print_function().
+ * Format the message into the calling thread's ring.
+ */
+static void lf_async_log_print(const char* format, va_list args) ATTRIBUTE_FORMAT_PRINTF(1, 0);
+static void lf_async_log_print(const char* format, va_list args) {
+  // The atomic operation is a full barrier, so either lf_async_log_stop() waits for this thread,
+  // or this thread sees that the backend is stopping and does not touch the rings.
+  lf_atomic_fetch_add((int*)&_lf_async_log_printing, 1);
+  lf_async_log_ring_t* ring = *(volatile bool*)&_lf_async_log_running ? lf_async_log_get_ring() : NULL;
+  if (ring == NULL) {
+    lf_atomic_fetch_add((int*)&_lf_async_log_printing, -1);
+    vfprintf(stdout, format, args);
+    return;
+  }
+  int64_t tail = ring->tail;
+  while (tail - *(volatile int64_t*)&ring->head >= LF_ASYNC_LOG_SLOTS) {
+    if (_lf_async_log_overflow == LF_ASYNC_LOG_DROP || !*(volatile bool*)&_lf_async_log_running) {
+      ring->dropped++;
+      lf_atomic_fetch_add((int*)&_lf_async_log_printing, -1);
+      return;
+    }
+    lf_sleep(USEC(10));
+  }
+  lf_async_log_record_t* record = &ring->records[tail % LF_ASYNC_LOG_SLOTS];
+  record->time = lf_time_physical();
+  int length = vsnprintf(record->text, LF_ASYNC_LOG_MESSAGE_SIZE, format, args);
+  if (length >= 0) {
+    if (length >= LF_ASYNC_LOG_MESSAGE_SIZE) {
+      // Truncated. Mark it and keep the newline.
+      length = LF_ASYNC_LOG_MESSAGE_SIZE - 1;
+      memcpy(&record->text[length - 4], "...\n", 4);
+    }
+    record->length = length;
+    // Publish the record. The atomic operation is a full barrier.
+    lf_atomic_fetch_add64(&ring->tail, 1);
+  }
+  lf_atomic_fetch_add((int*)&_lf_async_log_printing, -1);
+}
+
+/**
+ * Write out all messages that are currently buffered, oldest first.
+ * @return The number of messages written.
+ */
+static int lf_async_log_drain(void) {
+  int written = 0;
+  bool more = true;
+  while (more) {
+    // Take a snapshot of how far each ring is filled. The atomic read is a full barrier, so the
+    // records up to the snapshot are visible. Reading the tails once per pass rather than once per
+    // record keeps the background thread off the cache lines that the printing threads write.
+    more = false;
+    for (lf_async_log_ring_t* ring = *(lf_async_log_ring_t* volatile*)&_lf_async_log_rings; ring != NULL;
+         ring = ring->next) {
+      ring->available = lf_atomic_add_fetch64(&ring->tail, 0);
+    }
+    while (true) {
+      lf_async_log_ring_t* oldest = NULL;
+      for (lf_async_log_ring_t* ring = *(lf_async_log_ring_t* volatile*)&_lf_async_log_rings; ring != NULL;
+           ring = ring->next) {
+        if (ring->available != ring->head) {
+          if (oldest == NULL || ring->records[ring->head % LF_ASYNC_LOG_SLOTS].time <
+                                    oldest->records[oldest->head % LF_ASYNC_LOG_SLOTS].time) {
+            oldest = ring;
+          }
+        }
+      }
+      if (oldest == NULL) {
+        break;
+      }
+      lf_async_log_record_t* record = &oldest->records[oldest->head % LF_ASYNC_LOG_SLOTS];
+      fwrite(record->text, 1, (size_t)record->length, stdout);
+      // Hand the slot back to the owning thread.
+      lf_atomic_fetch_add64(&oldest->head, 1);
+      written++;
+      more = true;
+    }
+  }
+  for (lf_async_log_ring_t* ring = *(lf_async_log_ring_t* volatile*)&_lf_async_log_rings; ring != NULL;
+       ring = ring->next) {
+    int64_t dropped = *(volatile int64_t*)&ring->dropped;
+    if (dropped != ring->reported) {
+      // Not printed with lf_print_warning() to avoid logging into the rings from this thread.
+      fprintf(stdout, "WARNING: %lld log messages were dropped because a log buffer was full.\n",
+              (long long)(dropped - ring->reported));
+      ring->reported = dropped;
+      written++;
+    }
+  }
+  if (written > 0) {
+    fflush(stdout);
+  }
+  return written;
+}
+
+/** Body of the background thread. */
+static void* lf_async_log_worker(void* arg) {
+  (void)arg;
+  // Back off exponentially while idle so that bursts are drained quickly and quiet periods cost little.
+  interval_t idle_sleep = USEC(10);
+  while (true) {
+    // Read the flag before draining so that the last drain happens after the request to stop.
+    bool stopping = *(volatile bool*)&_lf_async_log_stopping;
+    int written = lf_async_log_drain();
+    if (stopping) {
+      break;
+    }
+    if (written == 0) {
+      lf_sleep(idle_sleep);
+      if (idle_sleep < LF_ASYNC_LOG_POLL_INTERVAL) {
+        idle_sleep *= 2;
+      }
+    } else {
+      idle_sleep = USEC(10);
+    }
+  }
+  return NULL;
+}
+
+int lf_async_log_start(int log_level, lf_async_log_overflow_t overflow) {
+  if (_lf_async_log_running) {
+    return 0;
+  }
+  _lf_async_log_overflow = overflow;
+  _lf_async_log_stopping = false;
+  _lf_async_log_generation++;
+  if (lf_thread_create(&_lf_async_log_thread, lf_async_log_worker, NULL) != 0) {
+    lf_print_warning("Could not create the asynchronous logging thread. Logging synchronously.");
+    return 1;
+  }
+  _lf_async_log_running = true;
+  if (!_lf_async_log_exit_registered) {
+    if (atexit(lf_async_log_stop) != 0) {
+      lf_print_warning("Failed to register the function that flushes asynchronous log messages at exit.");
+    }
+    _lf_async_log_exit_registered = true;
+  }
+  _lf_async_log_previous_function = print_message_function;
+  _lf_async_log_previous_level = print_message_level;
+  lf_register_print_function(lf_async_log_print, log_level);
+  return 0;
+}
+
+void lf_async_log_stop(void) {
+  if (!_lf_async_log_running) {
+    return;
+  }
+  lf_register_print_function(_lf_async_log_previous_function, _lf_async_log_previous_level);
+  _lf_async_log_running = false;
+  // The atomic read is a full barrier between clearing the flag and reading the number of printing threads.
+  while (lf_atomic_fetch_add((int*)&_lf_async_log_printing, 0) > 0) {
+    lf_sleep(USEC(10));
+  }
+  _lf_async_log_stopping = true;
+  lf_thread_join(_lf_async_log_thread, NULL);
+  // Every buffered message has been written, and no thread uses the rings anymore.
+  while (_lf_async_log_rings != NULL) {
+    lf_async_log_ring_t* ring = _lf_async_log_rings;
+    _lf_async_log_rings = ring->next;
+    _lf_async_log_freed_dropped += ring->dropped;
+    free(ring);
+  }
+}
+
+int64_t lf_async_log_dropped(void) {
+  int64_t dropped = _lf_async_log_freed_dropped;
+  for (lf_async_log_ring_t* ring = *(lf_async_log_ring_t* volatile*)&_lf_async_log_rings; ring != NULL;
+       ring = ring->next) {
+    dropped += *(volatile int64_t*)&ring->dropped;
+  }
+  return dropped;
+}
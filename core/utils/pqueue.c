@@ -14,6 +14,9 @@
 #include "pqueue.h"
 #include "util.h"
 #include "lf_types.h"
+#if defined(LF_INLINE_KEY_QUEUES)
+#include "impl/reaction_heap.h"
+#endif
 
 int in_reverse_order(pqueue_pri_t thiz, pqueue_pri_t that) { return (thiz > that) ? 1 : (thiz < that) ? -1 : 0; }
 
@@ -35,3 +38,66 @@ void print_reaction(void* reaction) {
   reaction_t* r = (reaction_t*)reaction;
   LF_PRINT_DEBUG("%s: index: %llx, reaction: %p", r->name, r->index, reaction);
 }
+
+#if defined(LF_INLINE_KEY_QUEUES)
+
+/**
+ * @brief A queue of reactions that is implemented with an inline-key heap.
+ */
+struct pqueue_reaction_t {
+  /** The heap, which holds a copy of the index of each reaction. */
+  reaction_heap_t heap;
+};
+
+pqueue_reaction_t* pqueue_reaction_init(size_t initial_size) {
+  pqueue_reaction_t* q = (pqueue_reaction_t*)malloc(sizeof(pqueue_reaction_t));
+  if (!q)
+    return NULL;
+  if (reaction_heap_initialize(&q->heap, initial_size)) {
+    free(q);
+    return NULL;
+  }
+  return q;
+}
+
+void pqueue_reaction_free(pqueue_reaction_t* q) {
+  reaction_heap_free(&q->heap);
+  free(q);
+}
+
+size_t pqueue_reaction_size(pqueue_reaction_t* q) { return reaction_heap_size(&q->heap); }
+
+int pqueue_reaction_insert(pqueue_reaction_t* q, void* reaction) {
+  return reaction_heap_insert(&q->heap, ((reaction_t*)reaction)->index, (reaction_t*)reaction);
+}
+
+void* pqueue_reaction_peek(pqueue_reaction_t* q) { return reaction_heap_peek(&q->heap); }
+
+void* pqueue_reaction_pop(pqueue_reaction_t* q) { return reaction_heap_pop(&q->heap); }
+
+void pqueue_reaction_dump(pqueue_reaction_t* q) {
+  for (size_t i = 0; i < reaction_heap_size(&q->heap); i++) {
+    print_reaction(reaction_heap_at(&q->heap, i));
+  }
+}
+
+#else // LF_INLINE_KEY_QUEUES
+
+pqueue_reaction_t* pqueue_reaction_init(size_t initial_size) {
+  return pqueue_init(initial_size, in_reverse_order, get_reaction_index, get_reaction_position, set_reaction_position,
+                     reaction_matches, print_reaction);
+}
+
+void pqueue_reaction_free(pqueue_reaction_t* q) { pqueue_free(q); }
+
+size_t pqueue_reaction_size(pqueue_reaction_t* q) { return pqueue_size(q); }
+
+int pqueue_reaction_insert(pqueue_reaction_t* q, void* reaction) { return pqueue_insert(q, reaction); }
+
+void* pqueue_reaction_peek(pqueue_reaction_t* q) { return pqueue_peek(q); }
+
+void* pqueue_reaction_pop(pqueue_reaction_t* q) { return pqueue_pop(q); }
+
+void pqueue_reaction_dump(pqueue_reaction_t* q) { pqueue_dump(q, print_reaction); }
+
+#endif // LF_INLINE_KEY_QUEUES
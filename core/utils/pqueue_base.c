@@ -232,6 +232,39 @@ int pqueue_insert(pqueue_t* q, void* d) {
   return 0;
 }
 
+int pqueue_insert_all(pqueue_t* q, void** d, size_t n) {
+  void** tmp;
+  size_t newsize;
+
+  if (!q)
+    return 1;
+
+  /* allocate more memory if necessary */
+  if (q->size + n > q->avail) {
+    newsize = q->size + n + q->step;
+    if (!(tmp = (void**)realloc(q->d, sizeof(void*) * newsize)))
+      return 1;
+    q->d = tmp;
+    q->avail = newsize;
+  }
+  size_t first = q->size;
+  for (size_t i = 0; i < n; i++) {
+    q->d[q->size] = d[i];
+    q->setpos(d[i], q->size);
+    q->size++;
+  }
+  /* Bubbling up each new item costs O(n log size), rebuilding the whole heap O(size). */
+  if (n * 8 >= q->size) {
+    for (size_t i = (q->size - 1) / 2; i >= 1; i--)
+      percolate_down(q, i);
+  } else {
+    for (size_t i = first; i < q->size; i++)
+      bubble_up(q, i);
+  }
+
+  return 0;
+}
+
 int pqueue_remove(pqueue_t* q, void* d) {
   if (q->size == 1)
     return 0; // Nothing to remove
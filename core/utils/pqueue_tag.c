@@ -12,10 +12,63 @@
 #include "pqueue_tag.h"
 #include "util.h"               // For lf_print
 #include "low_level_platform.h" // For PRINTF_TAG
+#include "tag_inline.h"
+#if defined(LF_INLINE_KEY_QUEUES)
+#include "pqueue.h" // For in_no_particular_order
+#include "impl/tag_heap.h"
+#endif
 
 //////////////////
 // Local functions, not intended for use outside this file.
 
+/**
+ * @brief Callback function to determine whether two elements are equivalent.
+ * Return 1 if the tags contained by given elements are identical, 0 otherwise.
+ * This function is of type pqueue_eq_elem_f.
+ * @param element1 A pointer to a pqueue_tag_element_t, cast to void*.
+ * @param element2 A pointer to a pqueue_tag_element_t, cast to void*.
+ */
+static int pqueue_tag_matches(void* element1, void* element2) {
+  return lf_tag_compare_inline(((pqueue_tag_element_t*)element1)->tag, ((pqueue_tag_element_t*)element2)->tag) == 0;
+}
+
+/**
+ * @brief Callback function to print information about an element.
+ * This is a function of type pqueue_print_entry_f.
+ * @param element A pointer to a pqueue_tag_element_t, cast to void*.
+ */
+static void pqueue_tag_print_element(void* element) {
+  tag_t tag = ((pqueue_tag_element_t*)element)->tag;
+  lf_print("Element with tag " PRINTF_TAG ".", tag.time, tag.microstep);
+}
+
+#if defined(LF_INLINE_KEY_QUEUES)
+
+/**
+ * @brief A priority queue sorted by tags that is implemented with an inline-key heap.
+ */
+struct pqueue_tag_t {
+  /** The heap, which holds a copy of the tag of each element. */
+  tag_heap_t heap;
+  /** False if all elements are given the same key because the queue is in no particular order. */
+  bool ordered;
+  /** The callback function to check equivalence of elements with the same tag. */
+  pqueue_eq_elem_f eqelem;
+  /** The callback function to print elements. */
+  pqueue_print_entry_f prt;
+};
+
+/**
+ * @brief Return the key under which the given element is stored in the given queue.
+ * @param q The queue.
+ * @param element The element.
+ */
+static inline tag_t pqueue_tag_key(pqueue_tag_t* q, pqueue_tag_element_t* element) {
+  return q->ordered ? element->tag : NEVER_TAG;
+}
+
+#else // LF_INLINE_KEY_QUEUES
+
 /**
  * @brief Callback function to get the priority of an element.
  * Return the pointer argument cast to pqueue_pri_t because the
@@ -27,17 +80,6 @@ static pqueue_pri_t pqueue_tag_get_priority(void* element) {
   return (pqueue_pri_t)(uintptr_t)element;
 }
 
-/**
- * @brief Callback function to determine whether two elements are equivalent.
- * Return 1 if the tags contained by given elements are identical, 0 otherwise.
- * This function is of type pqueue_eq_elem_f.
- * @param element1 A pointer to a pqueue_tag_element_t, cast to void*.
- * @param element2 A pointer to a pqueue_tag_element_t, cast to void*.
- */
-static int pqueue_tag_matches(void* element1, void* element2) {
-  return lf_tag_compare(((pqueue_tag_element_t*)element1)->tag, ((pqueue_tag_element_t*)element2)->tag) == 0;
-}
-
 /**
  * @brief Callback function to return the position of an element.
  * This function is of type pqueue_get_pos_f.
@@ -53,25 +95,101 @@ static size_t pqueue_tag_get_position(void* element) { return ((pqueue_tag_eleme
  */
 static void pqueue_tag_set_position(void* element, size_t pos) { ((pqueue_tag_element_t*)element)->pos = pos; }
 
-/**
- * @brief Callback function to print information about an element.
- * This is a function of type pqueue_print_entry_f.
- * @param element A pointer to a pqueue_tag_element_t, cast to void*.
- */
-static void pqueue_tag_print_element(void* element) {
-  tag_t tag = ((pqueue_tag_element_t*)element)->tag;
-  lf_print("Element with tag " PRINTF_TAG ".", tag.time, tag.microstep);
-}
+#endif // LF_INLINE_KEY_QUEUES
 
 //////////////////
 // Functions defined in pqueue_tag.h.
 
 int pqueue_tag_compare(pqueue_pri_t priority1, pqueue_pri_t priority2) {
   // Suppress "error: cast from pointer to integer of different size" by casting to uintptr_t first.
-  return (lf_tag_compare(((pqueue_tag_element_t*)(uintptr_t)priority1)->tag,
-                         ((pqueue_tag_element_t*)(uintptr_t)priority2)->tag));
+  return (lf_tag_compare_inline(((pqueue_tag_element_t*)(uintptr_t)priority1)->tag,
+                                ((pqueue_tag_element_t*)(uintptr_t)priority2)->tag));
 }
 
+#if defined(LF_INLINE_KEY_QUEUES)
+
+pqueue_tag_t* pqueue_tag_init(size_t initial_size) {
+  return pqueue_tag_init_customize(initial_size, pqueue_tag_compare, pqueue_tag_matches, pqueue_tag_print_element);
+}
+
+pqueue_tag_t* pqueue_tag_init_customize(size_t initial_size, pqueue_cmp_pri_f cmppri, pqueue_eq_elem_f eqelem,
+                                        pqueue_print_entry_f prt) {
+  if (cmppri != pqueue_tag_compare && cmppri != in_no_particular_order) {
+    lf_print_error_and_exit("Queues with inline keys can only be ordered by tag or in no particular order.");
+  }
+  pqueue_tag_t* q = (pqueue_tag_t*)malloc(sizeof(pqueue_tag_t));
+  if (!q)
+    return NULL;
+  if (tag_heap_initialize(&q->heap, initial_size)) {
+    free(q);
+    return NULL;
+  }
+  q->ordered = cmppri == pqueue_tag_compare;
+  q->eqelem = eqelem;
+  q->prt = prt;
+  return q;
+}
+
+void pqueue_tag_free(pqueue_tag_t* q) {
+  for (size_t i = 0; i < q->heap.size; i++) {
+    if (q->heap.entries[i].element->is_dynamic) {
+      free(q->heap.entries[i].element);
+    }
+  }
+  tag_heap_free(&q->heap);
+  free(q);
+}
+
+size_t pqueue_tag_size(pqueue_tag_t* q) { return q ? tag_heap_size(&q->heap) : 0; }
+
+int pqueue_tag_insert(pqueue_tag_t* q, pqueue_tag_element_t* d) {
+  if (!q)
+    return 1;
+  return tag_heap_insert(&q->heap, pqueue_tag_key(q, d), d);
+}
+
+int pqueue_tag_insert_all(pqueue_tag_t* q, pqueue_tag_element_t** d, size_t n) {
+  if (!q)
+    return 1;
+  size_t first = q->heap.size;
+  int result = 0;
+  for (size_t i = 0; i < n && result == 0; i++) {
+    result = tag_heap_append(&q->heap, pqueue_tag_key(q, d[i]), d[i]);
+  }
+  tag_heap_restore(&q->heap, first);
+  return result;
+}
+
+pqueue_tag_element_t* pqueue_tag_find_with_tag(pqueue_tag_t* q, tag_t t) {
+  return tag_heap_find(&q->heap, t, NULL, NULL);
+}
+
+pqueue_tag_element_t* pqueue_tag_find_equal_same_tag(pqueue_tag_t* q, pqueue_tag_element_t* e) {
+  return tag_heap_find(&q->heap, e->tag, q->eqelem, e);
+}
+
+pqueue_tag_element_t* pqueue_tag_element_at(pqueue_tag_t* q, size_t i) { return tag_heap_at(&q->heap, i); }
+
+pqueue_tag_element_t* pqueue_tag_peek(pqueue_tag_t* q) { return q ? tag_heap_peek(&q->heap) : NULL; }
+
+pqueue_tag_element_t* pqueue_tag_pop(pqueue_tag_t* q) { return q ? tag_heap_pop(&q->heap) : NULL; }
+
+void pqueue_tag_remove(pqueue_tag_t* q, pqueue_tag_element_t* e) {
+  if (q->heap.size == 0)
+    return; // Nothing to remove
+  tag_heap_remove_at(&q->heap, e->pos);
+}
+
+void pqueue_tag_dump(pqueue_tag_t* q) {
+  LF_PRINT_DEBUG("posn\tparent\t...");
+  for (size_t i = 0; i < q->heap.size; i++) {
+    LF_PRINT_DEBUG("%zu\t%zu\t", i, i > 0 ? (i - 1) / HEAP_ARITY : 0);
+    q->prt(q->heap.entries[i].element);
+  }
+}
+
+#else // LF_INLINE_KEY_QUEUES
+
 pqueue_tag_t* pqueue_tag_init(size_t initial_size) {
   return (pqueue_tag_t*)pqueue_init(initial_size, pqueue_tag_compare, pqueue_tag_get_priority, pqueue_tag_get_position,
                                     pqueue_tag_set_position, pqueue_tag_matches, pqueue_tag_print_element);
@@ -96,11 +214,8 @@ size_t pqueue_tag_size(pqueue_tag_t* q) { return pqueue_size((pqueue_t*)q); }
 
 int pqueue_tag_insert(pqueue_tag_t* q, pqueue_tag_element_t* d) { return pqueue_insert((pqueue_t*)q, (void*)d); }
 
-int pqueue_tag_insert_tag(pqueue_tag_t* q, tag_t t) {
-  pqueue_tag_element_t* d = (pqueue_tag_element_t*)malloc(sizeof(pqueue_tag_element_t));
-  d->is_dynamic = 1;
-  d->tag = t;
-  return pqueue_tag_insert(q, d);
+int pqueue_tag_insert_all(pqueue_tag_t* q, pqueue_tag_element_t** d, size_t n) {
+  return pqueue_insert_all((pqueue_t*)q, (void**)d, n);
 }
 
 pqueue_tag_element_t* pqueue_tag_find_with_tag(pqueue_tag_t* q, tag_t t) {
@@ -114,6 +229,27 @@ pqueue_tag_element_t* pqueue_tag_find_equal_same_tag(pqueue_tag_t* q, pqueue_tag
   return pqueue_find_equal_same_priority((pqueue_t*)q, (void*)e);
 }
 
+pqueue_tag_element_t* pqueue_tag_element_at(pqueue_tag_t* q, size_t i) {
+  return (pqueue_tag_element_t*)q->d[i + 1]; // The underlying queue does not use index 0.
+}
+
+pqueue_tag_element_t* pqueue_tag_peek(pqueue_tag_t* q) { return (pqueue_tag_element_t*)pqueue_peek((pqueue_t*)q); }
+
+pqueue_tag_element_t* pqueue_tag_pop(pqueue_tag_t* q) { return (pqueue_tag_element_t*)pqueue_pop((pqueue_t*)q); }
+
+void pqueue_tag_remove(pqueue_tag_t* q, pqueue_tag_element_t* e) { pqueue_remove((pqueue_t*)q, (void*)e); }
+
+void pqueue_tag_dump(pqueue_tag_t* q) { pqueue_dump((pqueue_t*)q, pqueue_tag_print_element); }
+
+#endif // LF_INLINE_KEY_QUEUES
+
+int pqueue_tag_insert_tag(pqueue_tag_t* q, tag_t t) {
+  pqueue_tag_element_t* d = (pqueue_tag_element_t*)malloc(sizeof(pqueue_tag_element_t));
+  d->is_dynamic = 1;
+  d->tag = t;
+  return pqueue_tag_insert(q, d);
+}
+
 int pqueue_tag_insert_if_no_match(pqueue_tag_t* q, tag_t t) {
   if (pqueue_tag_find_with_tag(q, t) == NULL) {
     return pqueue_tag_insert_tag(q, t);
@@ -122,8 +258,6 @@ int pqueue_tag_insert_if_no_match(pqueue_tag_t* q, tag_t t) {
   }
 }
 
-pqueue_tag_element_t* pqueue_tag_peek(pqueue_tag_t* q) { return (pqueue_tag_element_t*)pqueue_peek((pqueue_t*)q); }
-
 tag_t pqueue_tag_peek_tag(pqueue_tag_t* q) {
   pqueue_tag_element_t* element = (pqueue_tag_element_t*)pqueue_tag_peek(q);
   if (element == NULL)
@@ -132,8 +266,6 @@ tag_t pqueue_tag_peek_tag(pqueue_tag_t* q) {
     return element->tag;
 }
 
-pqueue_tag_element_t* pqueue_tag_pop(pqueue_tag_t* q) { return (pqueue_tag_element_t*)pqueue_pop((pqueue_t*)q); }
-
 tag_t pqueue_tag_pop_tag(pqueue_tag_t* q) {
   pqueue_tag_element_t* element = (pqueue_tag_element_t*)pqueue_tag_pop(q);
   if (element == NULL)
@@ -146,14 +278,10 @@ tag_t pqueue_tag_pop_tag(pqueue_tag_t* q) {
   }
 }
 
-void pqueue_tag_remove(pqueue_tag_t* q, pqueue_tag_element_t* e) { pqueue_remove((pqueue_t*)q, (void*)e); }
-
 void pqueue_tag_remove_up_to(pqueue_tag_t* q, tag_t t) {
   tag_t head = pqueue_tag_peek_tag(q);
-  while (lf_tag_compare(head, FOREVER_TAG) < 0 && lf_tag_compare(head, t) <= 0) {
+  while (lf_tag_compare_inline(head, FOREVER_TAG) < 0 && lf_tag_compare_inline(head, t) <= 0) {
     pqueue_tag_pop_tag(q);
     head = pqueue_tag_peek_tag(q);
   }
 }
-
-void pqueue_tag_dump(pqueue_tag_t* q) { pqueue_dump((pqueue_t*)q, pqueue_tag_print_element); }
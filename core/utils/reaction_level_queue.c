@@ -0,0 +1,184 @@
+/**
+ * @file reaction_level_queue.c
+ *
+ * @brief Queue of reactions for the single-threaded runtime that keeps a bucket for each level.
+ *
+ * See reaction_level_queue.h.
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "reaction_level_queue.h"
+#include "util.h"
+
+/** The least index of a reaction with no deadline, whose deadline bits are all ones. */
+#define NO_DEADLINE_INDEX ((ULLONG_MAX >> 16) << 16)
+
+/** The number of levels that an index can hold. */
+#define MAX_LEVELS (1 << 16)
+
+/** The reactions at one level, popped last in, first out. */
+typedef struct {
+  reaction_t** reactions;
+  size_t size;
+  size_t capacity;
+} reaction_bucket_t;
+
+struct reaction_level_queue_t {
+  /** Reactions with a deadline, which precede all reactions in the buckets. */
+  pqueue_reaction_t* deadlines;
+  /** A bucket for each level that the queue has room for. */
+  reaction_bucket_t* buckets;
+  /** The number of levels that the queue has room for, a multiple of 64. */
+  size_t number_of_levels;
+  /** Bit l % 64 of levels[l / 64] is set if bucket l is not empty. */
+  uint64_t* levels;
+  /** Bit w % 64 of words[w / 64] is set if levels[w] is not zero. */
+  uint64_t* words;
+  /** The number of reactions in the buckets. */
+  size_t size;
+  /** The room for reactions of a bucket when it is first used. */
+  size_t initial_size;
+};
+
+/** Return the position of the least significant set bit of a nonzero word. */
+static inline size_t lowest_bit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (size_t)__builtin_ctzll((unsigned long long)word);
+#else
+  size_t bit = 0;
+  while (!(word & 1)) {
+    word >>= 1;
+    bit++;
+  }
+  return bit;
+#endif
+}
+
+/** Make room for buckets up to the given level. Return 0 on success. */
+static int reserve_levels(reaction_level_queue_t* q, size_t level) {
+  size_t number_of_levels = q->number_of_levels > 0 ? q->number_of_levels * 2 : 64;
+  while (number_of_levels <= level) {
+    number_of_levels *= 2;
+  }
+  if (number_of_levels > MAX_LEVELS) {
+    number_of_levels = MAX_LEVELS;
+  }
+  size_t number_of_words = number_of_levels / 64;
+  size_t old_number_of_words = q->number_of_levels / 64;
+  reaction_bucket_t* buckets = (reaction_bucket_t*)realloc(q->buckets, number_of_levels * sizeof(reaction_bucket_t));
+  if (buckets == NULL) {
+    return -1;
+  }
+  q->buckets = buckets;
+  memset(&buckets[q->number_of_levels], 0, (number_of_levels - q->number_of_levels) * sizeof(reaction_bucket_t));
+  uint64_t* levels = (uint64_t*)realloc(q->levels, number_of_words * sizeof(uint64_t));
+  if (levels == NULL) {
+    return -1;
+  }
+  q->levels = levels;
+  memset(&levels[old_number_of_words], 0, (number_of_words - old_number_of_words) * sizeof(uint64_t));
+  size_t summary_size = (number_of_words + 63) / 64;
+  size_t old_summary_size = (old_number_of_words + 63) / 64;
+  uint64_t* words = (uint64_t*)realloc(q->words, summary_size * sizeof(uint64_t));
+  if (words == NULL) {
+    return -1;
+  }
+  q->words = words;
+  memset(&words[old_summary_size], 0, (summary_size - old_summary_size) * sizeof(uint64_t));
+  q->number_of_levels = number_of_levels;
+  return 0;
+}
+
+reaction_level_queue_t* reaction_level_queue_init(size_t initial_size) {
+  reaction_level_queue_t* q = (reaction_level_queue_t*)calloc(1, sizeof(reaction_level_queue_t));
+  if (q == NULL) {
+    return NULL;
+  }
+  q->initial_size = initial_size > 0 ? initial_size : 1;
+  q->deadlines = pqueue_reaction_init(initial_size);
+  if (q->deadlines == NULL || reserve_levels(q, 0) != 0) {
+    reaction_level_queue_free(q);
+    return NULL;
+  }
+  return q;
+}
+
+void reaction_level_queue_free(reaction_level_queue_t* q) {
+  if (q->deadlines != NULL) {
+    pqueue_reaction_free(q->deadlines);
+  }
+  if (q->buckets != NULL) {
+    for (size_t i = 0; i < q->number_of_levels; i++) {
+      free(q->buckets[i].reactions);
+    }
+  }
+  free(q->buckets);
+  free(q->levels);
+  free(q->words);
+  free(q);
+}
+
+size_t reaction_level_queue_size(reaction_level_queue_t* q) { return q->size + pqueue_reaction_size(q->deadlines); }
+
+int reaction_level_queue_insert(reaction_level_queue_t* q, reaction_t* reaction) {
+  if (reaction->index < NO_DEADLINE_INDEX) {
+    return pqueue_reaction_insert(q->deadlines, reaction);
+  }
+  size_t level = (size_t)LF_LEVEL(reaction->index);
+  if (level >= q->number_of_levels && reserve_levels(q, level) != 0) {
+    return -1;
+  }
+  reaction_bucket_t* bucket = &q->buckets[level];
+  if (bucket->size == bucket->capacity) {
+    size_t capacity = bucket->capacity > 0 ? bucket->capacity * 2 : q->initial_size;
+    reaction_t** reactions = (reaction_t**)realloc(bucket->reactions, capacity * sizeof(reaction_t*));
+    if (reactions == NULL) {
+      return -1;
+    }
+    bucket->reactions = reactions;
+    bucket->capacity = capacity;
+  }
+  bucket->reactions[bucket->size++] = reaction;
+  q->levels[level / 64] |= 1ULL << (level % 64);
+  q->words[level / 4096] |= 1ULL << ((level / 64) % 64);
+  q->size++;
+  return 0;
+}
+
+reaction_t* reaction_level_queue_pop(reaction_level_queue_t* q) {
+  if (pqueue_reaction_size(q->deadlines) > 0) {
+    return (reaction_t*)pqueue_reaction_pop(q->deadlines);
+  }
+  if (q->size == 0) {
+    return NULL;
+  }
+  size_t summary = 0;
+  while (q->words[summary] == 0) {
+    summary++;
+  }
+  size_t word = summary * 64 + lowest_bit(q->words[summary]);
+  size_t level = word * 64 + lowest_bit(q->levels[word]);
+  reaction_bucket_t* bucket = &q->buckets[level];
+  reaction_t* reaction = bucket->reactions[--bucket->size];
+  if (bucket->size == 0) {
+    q->levels[word] &= ~(1ULL << (level % 64));
+    if (q->levels[word] == 0) {
+      q->words[summary] &= ~(1ULL << (word % 64));
+    }
+  }
+  q->size--;
+  return reaction;
+}
+
+void reaction_level_queue_dump(reaction_level_queue_t* q) {
+  pqueue_reaction_dump(q->deadlines);
+  for (size_t level = 0; level < q->number_of_levels; level++) {
+    for (size_t i = 0; i < q->buckets[level].size; i++) {
+      print_reaction(q->buckets[level].reactions[i]);
+    }
+  }
+}
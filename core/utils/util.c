@@ -13,6 +13,8 @@
 
 #include <stdio.h>
 
+#include "low_level_platform.h"
+
 #ifndef STANDALONE_RTI
 #include "environment.h"
 #endif
@@ -46,6 +48,9 @@
 #define NUMBER_OF_FEDERATES 1
 #endif
 
+/** Size of the stack buffer used to build the format string of a message. Longer formats are allocated. */
+#define MESSAGE_FORMAT_BUFFER_SIZE 256
+
 /** Number of nanoseconds to sleep before retrying a socket read. */
 #define SOCKET_READ_RETRY_INTERVAL 1000000
 
@@ -127,7 +132,9 @@ void _lf_message_print(const char* color, const char* prefix, const char* format
     // If we make multiple calls to printf(), then the results could be
     // interleaved between threads.
     // vprintf() is a version that takes an arg list rather than multiple args.
-    char* message;
+    // The prefixed format is built on the stack unless it is unusually long.
+    char buffer[MESSAGE_FORMAT_BUFFER_SIZE];
+    char* message = buffer;
     const char* active_color = "";
     const char* active_reset = "";
     if (print_message_function == NULL && lf_stdout_supports_ansi_color() && color != NULL && color[0] != '\0') {
@@ -136,12 +143,14 @@ void _lf_message_print(const char* color, const char* prefix, const char* format
     }
     if (_lf_my_fed_id == UINT16_MAX) {
       size_t length = strlen(active_color) + strlen(prefix) + strlen(format) + strlen(active_reset) + 32;
-      message = (char*)malloc(length + 1);
+      if (length + 1 > sizeof(buffer))
+        message = (char*)malloc(length + 1);
       snprintf(message, length + 1, "%s%s%s%s\n", active_color, prefix, format, active_reset);
     } else {
 #if defined STANDALONE_RTI
       size_t length = strlen(active_color) + strlen(prefix) + strlen(format) + strlen(active_reset) + 37;
-      message = (char*)malloc(length + 1);
+      if (length + 1 > sizeof(buffer))
+        message = (char*)malloc(length + 1);
       snprintf(message, length + 1, "%sRTI: %s%s%s\n", active_color, prefix, format, active_reset);
 #else
       // Get the federate name from the top-level environment, which by convention is the first.
@@ -149,7 +158,8 @@ void _lf_message_print(const char* color, const char* prefix, const char* format
       _lf_get_environments(&envs);
       char* name = envs->name;
       size_t length = strlen(active_color) + strlen(prefix) + strlen(format) + strlen(name) + strlen(active_reset) + 32;
-      message = (char*)malloc(length + 1);
+      if (length + 1 > sizeof(buffer))
+        message = (char*)malloc(length + 1);
       // If the name has prefix "federate__", strip that out.
       if (strncmp(name, "federate__", 10) == 0)
         name += 10;
@@ -164,7 +174,8 @@ void _lf_message_print(const char* color, const char* prefix, const char* format
     } else {
       (*print_message_function)(message, args);
     }
-    free(message);
+    if (message != buffer)
+      free(message);
   }
 }
 
@@ -252,6 +263,18 @@ void lf_print_error_system_failure(const char* format, ...) {
   exit(EXIT_FAILURE);
 }
 
+int64_t _lf_print_ratelimit(int64_t* count, int burst) {
+  int64_t n = lf_atomic_add_fetch64(count, 1);
+  if (n <= burst) {
+    return 0;
+  }
+  if ((n & (n - 1)) != 0) {
+    return -1;
+  }
+  int64_t previous = n / 2 > burst ? n / 2 : burst;
+  return n - previous - 1;
+}
+
 void lf_register_print_function(print_message_function_t* function, int log_level) {
   print_message_function = function;
   print_message_level = log_level;
@@ -201,6 +201,47 @@ trigger_handle_t lf_schedule_copy(void* action, interval_t offset, void* value,
  */
 trigger_handle_t lf_schedule_value(void* action, interval_t extra_delay, void* value, int length);
 
+/**
+ * @brief Schedule an action once for each of the specified tokens, acquiring the environment mutex only once.
+ * @ingroup API
+ *
+ * This has the same effect as calling @ref lf_schedule_token() for each token in turn,
+ * but it acquires the environment mutex and notifies the thread that advances the tag
+ * only once for the whole batch. This is intended for threads that inject bursts of
+ * samples into a program.
+ *
+ * If the action is physical, the physical time is read once for the whole batch, so
+ * the time of each event is that physical time plus its offset. Events of the batch
+ * with the same offset are separated by microsteps, unless the action has a minimum
+ * spacing, in which case its policy applies to each event in turn.
+ *
+ * @param action The action to be triggered (a pointer to an `lf_action_base_t`).
+ * @param tokens An array of n tokens to carry the payloads, or NULL for no payloads.
+ *  An entry of the array may also be NULL for no payload.
+ * @param n The number of events to schedule.
+ * @param offsets An array of n extra delays, or NULL for an extra delay of zero for all events.
+ * @return A handle to the last event, or 0 if it was not scheduled, or -1 for error.
+ */
+trigger_handle_t lf_schedule_token_batch(void* action, lf_token_t** tokens, size_t n, const interval_t* offsets);
+
+/**
+ * @brief Schedule an action once for each of the specified values, acquiring the environment mutex only once.
+ * @ingroup API
+ *
+ * Each value is copied into newly allocated memory under the assumption that its size is
+ * given by the element_size field of the action's token template. The copies are made
+ * before the environment mutex is acquired.
+ *
+ * See @ref lf_schedule_token_batch(), which this uses, for details.
+ *
+ * @param action The action to be triggered (a pointer to an `lf_action_base_t`).
+ * @param values An array of n values, each of the element size of the action, or NULL for no payloads.
+ * @param n The number of events to schedule.
+ * @param offsets An array of n extra delays, or NULL for an extra delay of zero for all events.
+ * @return A handle to the last event, or 0 if it was not scheduled, or -1 for error.
+ */
+trigger_handle_t lf_schedule_batch(void* action, const void* values, size_t n, const interval_t* offsets);
+
 /**
  * @brief Schedule the specified trigger to execute in the specified environment with given delay and token.
  * @ingroup Internal
@@ -238,6 +279,25 @@ trigger_handle_t lf_schedule_value(void* action, interval_t extra_delay, void* v
  */
 trigger_handle_t lf_schedule_trigger(environment_t* env, trigger_t* trigger, interval_t delay, lf_token_t* token);
 
+/**
+ * @brief Version of @ref lf_schedule_trigger that uses a given physical time for physical actions.
+ * @ingroup Internal
+ *
+ * This is used to schedule an event for a physical action when the physical time
+ * at which it was scheduled was read earlier, possibly without holding the environment mutex.
+ * If that time plus the delay is earlier than the current tag, the current physical time is used instead.
+ *
+ * @param env The environment in which to schedule the event.
+ * @param trigger The action or timer to be triggered.
+ * @param delay Offset of the event release.
+ * @param token The token payload.
+ * @param physical_time The physical time at which a physical action was scheduled, or NEVER to use the
+ * current physical time.
+ * @return A handle to the event, or 0 if no event was scheduled, or -1 for error.
+ */
+trigger_handle_t lf_schedule_trigger_at_physical_time(environment_t* env, trigger_t* trigger, interval_t delay,
+                                                      lf_token_t* token, instant_t physical_time);
+
 /**
  * @brief Check the deadline of the currently executing reaction against the
  * current physical time.
@@ -18,6 +18,7 @@
 #include "lf_types.h"
 #include "low_level_platform.h"
 #include "tracepoint.h"
+#include "utils/reaction_level_queue.h"
 
 // Forward declarations so that a pointers can appear in the environment struct.
 typedef struct lf_scheduler_t lf_scheduler_t;
@@ -124,6 +125,14 @@ typedef struct environment_t {
    */
   pqueue_tag_t* recycle_q;
 
+  /**
+   * @brief Table of periodic timers that do not use the event queue.
+   *
+   * NULL unless the runtime is built with `LF_TIMER_TABLE` and the
+   * environment has periodic timers that are not in a mode. See timer_table.h.
+   */
+  struct lf_timer_table_t* timer_table;
+
   /**
    * @brief Array of is_present fields for ports.
    *
@@ -162,6 +171,13 @@ typedef struct environment_t {
    */
   vector_t sparse_io_record_sizes;
 
+  /**
+   * @brief Storage for the bitmaps of all sparse I/O records.
+   *
+   * Allocated by _lf_initialize_sparse_io_records(). NULL if there are no sparse I/O records.
+   */
+  uint64_t* sparse_io_present_bits;
+
   /**
    * @brief Handle for the environment's trigger.
    *
@@ -253,6 +269,13 @@ typedef struct environment_t {
    */
   watchdog_t** watchdogs;
 
+  /**
+   * @brief Timer wheel of the thread that serves the watchdogs of this environment.
+   *
+   * NULL if the environment has no watchdogs. See watchdog.c.
+   */
+  struct lf_watchdog_wheel_t* watchdog_wheel;
+
   /**
    * @brief Number of worker threads in this environment.
    *
@@ -266,9 +289,9 @@ typedef struct environment_t {
    * @brief Priority queue for reactions in single-threaded mode.
    *
    * Used to schedule and execute reactions in order when
-   * running in single-threaded mode.
+   * running in single-threaded mode. See reaction_level_queue.h.
    */
-  pqueue_t* reaction_q;
+  reaction_level_queue_t* reaction_q;
 #else
   /**
    * @brief Number of worker threads.
@@ -286,6 +309,14 @@ typedef struct environment_t {
    */
   lf_thread_t* thread_ids;
 
+  /**
+   * @brief Array of CPUs to which the worker threads are pinned.
+   *
+   * Entry i is the CPU of worker i. This is NULL if the workers are not pinned.
+   * See worker_placement.h.
+   */
+  size_t* worker_cpus;
+
   /**
    * @brief Mutex for synchronizing access to the environment.
    *
@@ -302,6 +333,49 @@ typedef struct environment_t {
    */
   lf_cond_t event_q_changed;
 
+  /**
+   * @brief Margin before a target physical time at which waiting switches from sleeping to spinning.
+   *
+   * Zero, the default, disables spinning, so that waits rely entirely on the
+   * condition variable. See @ref lf_set_spin_wait_margin.
+   */
+  interval_t spin_wait_margin;
+
+  /**
+   * @brief Flag set by @ref lf_notify_of_event.
+   *
+   * This lets a spinning wait, which does not hold the mutex, notice
+   * that the event queue has changed.
+   */
+  int event_q_notified;
+
+  /**
+   * @brief Statistics on how late waits for physical time return.
+   *
+   * Only waits that reached their target time are counted.
+   */
+  size_t wait_lag_count;
+  interval_t wait_lag_sum;
+  interval_t wait_lag_max;
+
+  /**
+   * @brief Lock-free inbox of requests to schedule physical actions.
+   *
+   * This is only used if the runtime is compiled with `LF_SCHEDULE_INBOX`. See schedule_inbox.h.
+   */
+  struct lf_schedule_inbox_entry_t* schedule_inbox;
+
+  /** @brief The number of requests in the schedule inbox, bounded by LF_SCHEDULE_INBOX_CAPACITY. */
+  int schedule_inbox_size;
+
+  /**
+   * @brief Nonzero while a thread waits on event_q_changed for physical time to pass.
+   *
+   * Producers pushing onto the schedule inbox only acquire the mutex to notify
+   * the environment if this is set.
+   */
+  int schedule_inbox_waiting;
+
   /**
    * @brief Scheduler for managing worker threads.
    *
@@ -421,6 +495,18 @@ struct mode_environment_t {
    * reset behavior defined.
    */
   int state_resets_size;
+
+  /**
+   * @brief Modes in this environment that have allocated a vector of suspended events.
+   *
+   * Used to release all suspended events at termination.
+   */
+  vector_t suspended_modes;
+
+  /**
+   * @brief Total number of currently suspended events in this environment.
+   */
+  size_t suspended_events_size;
 };
 #endif
 
@@ -41,6 +41,7 @@
 
 #include <stdlib.h>  // Defines size_t
 #include <stdbool.h> // Defines bool type
+#include <stdint.h>  // Defines uint64_t
 
 // Forward declarations
 struct environment_t;
@@ -115,33 +116,48 @@ typedef struct lf_token_t {
  *
  * This struct is used to efficiently track which channels of a multiport
  * have present inputs, particularly useful for sparse I/O operations where
- * only a small subset of channels are active.
+ * only a small subset of channels are active. The present channels are
+ * kept in a bitmap, so they can be visited in order without sorting.
+ * The code generator allocates the record and sets the capacity, and the
+ * runtime allocates the bitmap (see _lf_initialize_sparse_io_records()).
  */
 typedef struct lf_sparse_io_record_t {
   /**
    * @brief Number of present channels or status indicator.
    *
-   * -1 indicates the record has overflowed (too many present channels),
+   * -1 indicates the record has overflowed (a channel is not in the bitmap),
    * 0 indicates no channels are present,
    * positive values indicate the number of present channels.
+   * This must be the first field, since the environment keeps pointers
+   * to it to find the record.
    */
   int size;
 
   /**
-   * @brief Maximum number of channels that can be tracked before overflow.
+   * @brief The width of the multiport divided by LF_SPARSE_CAPACITY_DIVIDER.
    *
-   * When the number of present channels exceeds this capacity,
-   * the record is considered overflowed and size is set to -1.
+   * The bitmap has room for at least the width of the multiport.
    */
   size_t capacity;
 
   /**
-   * @brief Array of channel indices that have present inputs.
+   * @brief Not used by the runtime, which keeps the present channels in present_bits.
    *
-   * Stores the indices of channels that have present inputs.
-   * Only valid when size > 0. The array size is determined by capacity.
+   * Kept for compatibility with generated code.
    */
   size_t* present_channels;
+
+  /**
+   * @brief Bitmap of the present channels.
+   *
+   * Bit c % 64 of present_bits[c / 64] is set if channel c is present.
+   */
+  uint64_t* present_bits;
+
+  /**
+   * @brief Number of words in the bitmap.
+   */
+  size_t number_of_words;
 } lf_sparse_io_record_t;
 
 /**
@@ -401,6 +417,21 @@ void _lf_initialize_template(token_template_t* tmplt, size_t element_size);
  */
 lf_token_t* _lf_initialize_token_with_value(token_template_t* tmplt, void* value, size_t length);
 
+/**
+ * @brief Return a new token storing the specified value, never reusing the token in the template.
+ * @ingroup Internal
+ *
+ * Unlike @ref _lf_initialize_token_with_value, this does not require the environment
+ * mutex to be held while the token is being used to schedule an event, because the
+ * token in the template may be reused by another call before the event is scheduled.
+ *
+ * @param tmplt A template for the token.
+ * @param value The value of the array.
+ * @param length The length of the array, or 1 if it is not an array.
+ * @return A new token with a reference count of 0.
+ */
+lf_token_t* _lf_new_token_with_value(token_template_t* tmplt, void* value, size_t length);
+
 /**
  * @brief Return a token for storing an array of the specified length
  * with new memory allocated (using calloc, so initialize to zero) for storing that array.
@@ -426,7 +457,7 @@ lf_token_t* _lf_initialize_token(token_template_t* tmplt, size_t length);
  * @brief Free all tokens.
  * @ingroup Internal
  *
- * Free tokens on the _lf_token_recycling_bin hashset and all template tokens.
+ * Free tokens on the _lf_token_recycling_bin set and all template tokens.
  */
 void _lf_free_all_tokens();
 
@@ -466,4 +497,20 @@ token_freed _lf_done_using(lf_token_t* token);
  */
 void _lf_free_token_copies(void);
 
+/**
+ * @brief Take the token copies made for mutable inputs so far, for freeing later with _lf_free_token_list().
+ * @ingroup Internal
+ *
+ * This is for schedulers that overlap time steps, which cannot free the copies at the beginning
+ * of each time step because reactions of earlier time steps may still be using them.
+ * @return The copies, linked through their `next` field, or NULL if there are none.
+ */
+lf_token_t* _lf_take_token_copies(void);
+
+/**
+ * @brief Free a list of token copies returned by _lf_take_token_copies().
+ * @ingroup Internal
+ */
+void _lf_free_token_list(lf_token_t* list);
+
 #endif /* LF_TOKEN_H */
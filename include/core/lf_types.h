@@ -62,6 +62,22 @@ typedef unsigned short int ushort;
  */
 #define SCHED_NP 3
 
+/**
+ * @brief Experimental GEDF-NP scheduler with a relaxed concurrent reaction queue.
+ * @ingroup Internal
+ */
+#define SCHED_GEDF_MQ 4
+
+/**
+ * @brief Experimental scheduler that starts each reaction as soon as the reactions it depends on are done.
+ * @ingroup Internal
+ */
+#define SCHED_DATAFLOW 5
+
+#if defined(LF_PIPELINED_TAGS) && (defined(LF_SINGLE_THREADED) || SCHEDULER != SCHED_DATAFLOW)
+#error "Pipelined tags (LF_PIPELINED_TAGS) require the threaded runtime with SCHEDULER=SCHED_DATAFLOW."
+#endif
+
 /**
  * @brief A struct representing a barrier in threaded LF programs.
  * @ingroup Internal
@@ -553,6 +569,14 @@ typedef struct self_base_t {
    */
   self_base_t* parent;
 
+#ifdef LF_REACTOR_ARENA
+  /**
+   * @brief Whether the self struct was allocated from the reactor arena.
+   * Such a self struct is freed with the arena by lf_free_all_reactors(), not by lf_free_reactor().
+   */
+  bool in_arena;
+#endif
+
 #if !defined(LF_SINGLE_THREADED)
   /**
    * @brief Mutex used to protect the reactor from concurrent access.
@@ -28,6 +28,7 @@
 
 #include "lf_types.h"
 #include "tag.h"
+#include "vector.h"
 
 typedef struct event_t event_t;
 typedef struct reaction_t reaction_t;
@@ -100,6 +101,12 @@ struct reactor_mode_t {
    * Used for internal bookkeeping (e.g., active, scheduled for activation, etc.).
    */
   uint8_t flags;
+  /**
+   * @brief Events of triggers in this mode that were suspended while the mode was inactive.
+   *
+   * Allocated on first use and registered with the environment, which frees it at termination.
+   */
+  vector_t suspended_events;
 };
 
 /**
@@ -237,12 +244,13 @@ void _lf_process_mode_changes(environment_t* env, reactor_mode_state_t* states[]
                               trigger_t* timer_triggers[], int timer_triggers_size);
 
 /**
- * @brief Add a suspended event to the list of suspended events.
+ * @brief Add a suspended event to the suspended events of the mode of its trigger.
  * @ingroup Modal
  *
+ * @param env The environment of the event.
  * @param event The event to add.
  */
-void _lf_add_suspended_event(event_t* event);
+void _lf_add_suspended_event(environment_t* env, event_t* event);
 
 /**
  * @brief Handle the mode startup reset reactions in the environment.
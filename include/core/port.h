@@ -81,11 +81,9 @@ typedef struct lf_multiport_iterator_t {
   int next;
 
   /**
-   * @brief Current position in the sparse record.
+   * @brief Position among the present channels of the channel last returned.
    *
-   * Tracks the current position in the sparse record array.
    * Set to -1 if lf_multiport_next() has not been called yet.
-   * Used internally to iterate through the present channels.
    */
   int idx;
 
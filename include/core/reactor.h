@@ -136,6 +136,13 @@ void lf_request_stop(void);
  * In a reaction body, you can access the head of the allocation records for the
  * current reactor with `&self->base.allocations`.
  *
+ * If the runtime is built with `LF_REACTOR_ARENA`, memory with a non-null `head` that is
+ * allocated during startup, until the trigger objects have been initialized, is instead carved
+ * out of large zeroed chunks in allocation order and nothing is recorded on `head`. Such memory
+ * is released all at once by @ref lf_free_all_reactors(), not by @ref lf_free() or
+ * @ref lf_free_reactor(). Memory allocated after startup is recorded and freed as usual.
+ * The chunk size defaults to 1 MiB and can be changed with `LF_REACTOR_ARENA_CHUNK_SIZE`.
+ *
  * @param count The number of items of size 'size' to accomodate.
  * @param size The size of each item.
  * @param head Pointer to the head of a list on which to record
@@ -154,6 +161,10 @@ void* lf_allocate(size_t count, size_t size, struct allocation_record_t** head);
  * {@link lf_allocate(size_t, size_t, allocation_record_t**)}
  * with a null last argument instead.
  *
+ * With `LF_REACTOR_ARENA`, self structs created during startup are placed next to
+ * each other in the order of instantiation. They are still recorded, so that
+ * @ref lf_free_all_reactors() frees what is allocated on them after startup.
+ *
  * @param size The size of the self struct, obtained with sizeof().
  */
 self_base_t* lf_new_reactor(size_t size);
@@ -169,7 +180,7 @@ void lf_free_all_reactors(void);
  * @ingroup Internal
  *
  * This will free the memory recorded on the allocations list of the specified reactor
- * and then free the specified self struct.
+ * and then free the specified self struct, unless it was allocated from the reactor arena.
  * @param self The self struct of the reactor.
  */
 void lf_free_reactor(self_base_t* self);
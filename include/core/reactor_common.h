@@ -91,6 +91,7 @@ extern const char** default_argv;
 extern instant_t duration;
 extern bool fast;
 extern bool keepalive_specified;
+extern bool lf_startup_profile;
 extern instant_t start_time_multiple;
 
 /**
@@ -109,6 +110,20 @@ extern instant_t start_time_multiple;
  */
 instant_t lf_align_to_start_time_multiple(instant_t time);
 
+/**
+ * @brief Report the physical time taken by a startup phase if `--startup-profile` was given.
+ * @ingroup Internal
+ *
+ * This prints the time elapsed since `*since` and since the first reported phase began,
+ * then sets `*since` to the current physical time, so consecutive phases can share one
+ * variable. It does nothing unless startup profiling was requested.
+ *
+ * @param env The environment whose phase ended, or NULL for a phase that is not specific to one.
+ * @param phase A short description of the phase.
+ * @param since Pointer to the physical time at which the phase began.
+ */
+void lf_startup_profile_phase(environment_t* env, const char* phase, instant_t* since);
+
 #ifdef FEDERATED_DECENTRALIZED
 extern interval_t lf_fed_STA_offset;
 #endif
@@ -148,6 +163,18 @@ void lf_create_environments(void);
  */
 void lf_free(struct allocation_record_t** head);
 
+#ifdef LF_REACTOR_ARENA
+/**
+ * @brief Stop taking memory recorded on reactors from the arena.
+ * @ingroup Internal
+ *
+ * This is called once the trigger objects have been initialized. From then on, @ref lf_allocate()
+ * records its allocations as without `LF_REACTOR_ARENA`, so that @ref lf_free() frees them and
+ * the arena does not grow while the program runs. @ref lf_free_all_reactors() opens the arena again.
+ */
+void _lf_close_reactor_arena(void);
+#endif
+
 /**
  * @brief Get a new event.
  * @ingroup Internal
@@ -184,6 +211,15 @@ void lf_replace_token(event_t* event, lf_token_t* token);
  */
 void lf_set_default_command_line_options(void);
 
+/**
+ * @brief Allocate the bitmaps of the sparse I/O records of the environment.
+ * @ingroup Internal
+ *
+ * This is called once the generated code has created the records.
+ * @param env The environment.
+ */
+void _lf_initialize_sparse_io_records(environment_t* env);
+
 /**
  * @brief Perform whatever is needed to start a time step.
  * @ingroup Internal
@@ -375,12 +411,21 @@ trigger_handle_t _lf_insert_reactions_for_trigger(environment_t* env, trigger_t*
  */
 void _lf_advance_tag(environment_t* env, tag_t next_tag);
 
+/**
+ * @brief Return the tag of the earliest event on the event queue or firing of a timer in the timer table.
+ * @ingroup Internal
+ *
+ * @param env The environment in which we are executing
+ * @return The tag, or FOREVER_TAG if there are no events or timers.
+ */
+tag_t _lf_earliest_event_tag(environment_t* env);
+
 /**
  * @brief Pop all events from event_q with tag equal to current tag.
  * @ingroup Internal
  *
  * This will extract all the reactions triggered by these events and stick them onto the
- * reaction queue.
+ * reaction queue. It also fires the timers of the timer table whose time has come.
  *
  * @param env The environment in which we are executing
  */
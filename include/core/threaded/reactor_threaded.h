@@ -12,6 +12,29 @@
 
 #include "lf_types.h"
 
+#ifndef LF_SPIN_WAIT_MARGIN
+/** Default margin, in nanoseconds, before a target physical time at which waiting switches to spinning. */
+#define LF_SPIN_WAIT_MARGIN 0
+#endif
+
+/**
+ * @brief The spin-wait margin given to each environment when it is created.
+ * @ingroup Internal
+ *
+ * This is set by the `--spin-wait` command-line option or the `LF_SPIN_WAIT_MARGIN`
+ * compile-time option. Zero disables spinning.
+ */
+extern interval_t lf_spin_wait_margin;
+
+/**
+ * @brief The file in which the adaptive scheduler keeps what it learns across runs.
+ * @ingroup Internal
+ *
+ * This is set by the `--sched-profile` command-line option. NULL, the default, disables profiles.
+ * Other schedulers ignore it.
+ */
+extern const char* lf_sched_profile;
+
 /**
  * @brief Raise a barrier to prevent the current tag for the specified environment from advancing
  * to or beyond the value of the future_tag argument, if possible.
@@ -131,6 +154,27 @@ int _lf_wait_on_tag_barrier(environment_t* env, tag_t proposed_tag);
  */
 bool wait_until(instant_t wait_until_time, lf_cond_t* condition);
 
+/**
+ * @brief Set the spin-wait margin of an environment, enabling or disabling its precision wait.
+ * @ingroup Internal
+ *
+ * When advancing to a tag, the environment normally sleeps on its event_q_changed
+ * condition variable until physical time reaches the time of the tag, so the tag is
+ * released late by the wakeup latency of the operating system (typically tens of
+ * microseconds). With a nonzero margin, the environment sleeps only until
+ * `margin` before the target time and then spins on the physical clock with its
+ * mutex released. A call to @ref lf_notify_of_event still interrupts the wait.
+ * This trades one busy core per environment for low release jitter. The margin
+ * should exceed the wakeup latency of the platform.
+ *
+ * The lag of each completed wait is measured and, for environments with a nonzero
+ * margin, reported at termination.
+ *
+ * @param env The environment.
+ * @param margin The margin, or 0 to wait on the condition variable only.
+ */
+void lf_set_spin_wait_margin(environment_t* env, interval_t margin);
+
 /**
  * @brief Return the tag of the next event on the event queue.
  * @ingroup Internal
@@ -185,4 +229,31 @@ tag_t send_next_event_tag(environment_t* env, tag_t tag, bool wait_for_reply);
  * @param env Environment within which we are executing.
  */
 void _lf_next_locked(environment_t* env);
+
+#ifdef LF_PIPELINED_TAGS
+/**
+ * @brief Set the tag that lf_tag() and lf_time_logical() return in the calling worker thread.
+ * @ingroup Internal
+ *
+ * With pipelined tags, a worker may execute a reaction at a tag earlier than the current tag
+ * of the environment. The scheduler calls this before returning each reaction, and with
+ * NEVER_TAG when the worker is not executing a reaction.
+ * @param tag The tag of the reaction.
+ * @param may_schedule Whether the reaction is one of the `scheduling_reactions` of `sched_params_t`.
+ */
+void _lf_set_worker_tag(tag_t tag, bool may_schedule);
+
+/**
+ * @brief Return true if the calling thread is a worker executing a reaction.
+ * @ingroup Internal
+ */
+bool _lf_worker_in_reaction(void);
+
+/**
+ * @brief Return true if the reaction that the calling worker executes may schedule logical actions
+ * and request to stop.
+ * @ingroup Internal
+ */
+bool _lf_worker_may_schedule_actions(void);
+#endif // LF_PIPELINED_TAGS
 #endif // REACTOR_THREADED_H
@@ -0,0 +1,86 @@
+/**
+ * @file schedule_inbox.h
+ *
+ * @brief Lock-free inbox for scheduling physical actions without the environment mutex.
+ * @ingroup Internal
+ *
+ * By default, every call to lf_schedule() and its variants acquires the mutex of the
+ * environment, which is the same mutex that the scheduler holds to advance the tag.
+ * When the runtime is compiled with `LF_SCHEDULE_INBOX`, calls that schedule a physical
+ * action instead push the request onto a lock-free multiple-producer, single-consumer
+ * inbox of the environment. The thread that advances the tag moves the requests onto the
+ * event queue when it looks for the next event. A producer only acquires the mutex to
+ * wake up that thread when it is waiting for physical time to pass.
+ *
+ * The physical time of a request is read when it is pushed. Its minimum spacing policy and
+ * the stop tag, however, are only applied when it is moved to the event queue. The functions
+ * that schedule through the inbox therefore return 1 rather than a handle of the event,
+ * even if it turns out later that the event is not scheduled.
+ */
+#ifndef SCHEDULE_INBOX_H
+#define SCHEDULE_INBOX_H
+
+#include <stdbool.h>
+#include "environment.h"
+#include "lf_types.h"
+
+/**
+ * @brief The maximum number of requests in the inbox of an environment plus events on its event queue.
+ *
+ * When the inbox is full, lf_schedule() acquires the mutex as usual, so that producers
+ * that schedule faster than the reactions can keep up are slowed down rather than
+ * filling the event queue.
+ */
+#ifndef LF_SCHEDULE_INBOX_CAPACITY
+#define LF_SCHEDULE_INBOX_CAPACITY 256
+#endif
+
+/**
+ * @brief Push a request to schedule a physical action onto the inbox of the environment.
+ * @ingroup Internal
+ *
+ * The request is not accepted, and the caller has to schedule the action while holding
+ * the mutex as usual, if the runtime was compiled without `LF_SCHEDULE_INBOX`, if the
+ * trigger is not a physical action, if the program is terminating, or if the inbox is full.
+ * The environment mutex must not be held by the caller.
+ *
+ * @param env The environment of the action.
+ * @param trigger The trigger of the action.
+ * @param extra_delay The extra delay passed to lf_schedule().
+ * @param token The token carrying the payload, or NULL. Its reference count is incremented
+ * when the request is moved to the event queue.
+ * @return true if the request was pushed.
+ */
+bool lf_schedule_inbox_push(environment_t* env, trigger_t* trigger, interval_t extra_delay, lf_token_t* token);
+
+/**
+ * @brief Move all requests in the inbox onto the event queue, in the order in which they were pushed
+ * by each producer.
+ * @ingroup Internal
+ *
+ * The caller must hold the environment mutex.
+ * @param env The environment.
+ */
+void lf_schedule_inbox_drain_locked(environment_t* env);
+
+/**
+ * @brief Announce that the calling thread is about to wait on event_q_changed for physical time to pass.
+ * @ingroup Internal
+ *
+ * After this, producers notify the environment when they push a request. If the inbox is not
+ * empty, the wait has to be skipped because the next event may have changed.
+ * The caller must hold the environment mutex and must call @ref lf_schedule_inbox_end_wait_locked
+ * after the wait.
+ * @param env The environment.
+ * @return false if the inbox is not empty.
+ */
+bool lf_schedule_inbox_begin_wait_locked(environment_t* env);
+
+/**
+ * @brief Announce that the calling thread has stopped waiting for physical time to pass.
+ * @ingroup Internal
+ * @param env The environment.
+ */
+void lf_schedule_inbox_end_wait_locked(environment_t* env);
+
+#endif // SCHEDULE_INBOX_H
@@ -105,6 +105,50 @@ typedef struct {
    * If not set, @ref DEFAULT_MAX_REACTION_LEVEL will be used.
    */
   size_t num_reactions_per_level_size;
+
+  /**
+   * @brief An array of all reactions of the environment. This element can be NULL.
+   *
+   * Schedulers that order reactions by their dependencies rather than by their levels,
+   * such as SCHED_DATAFLOW, derive the dependencies from the output ports of these reactions
+   * and from the order of the reactions within each reactor. Without them, SCHED_DATAFLOW
+   * executes reactions in the order of their levels.
+   */
+  struct reaction_t** reactions;
+
+  /**
+   * @brief The size of the `reactions` array.
+   */
+  size_t num_reactions;
+
+  /**
+   * @brief Dependencies that are not visible in the output ports of the reactions. This element can be NULL.
+   *
+   * This holds `num_reaction_dependencies` pairs of reactions, each an upstream reaction followed by
+   * a downstream reaction that must not execute before it at the same tag. A reaction that reads
+   * a port without being triggered by it depends on the reactions that set that port.
+   */
+  struct reaction_t** reaction_dependencies;
+
+  /**
+   * @brief The number of pairs in the `reaction_dependencies` array.
+   */
+  size_t num_reaction_dependencies;
+
+  /**
+   * @brief The reactions that may schedule logical actions or request to stop. This element can be NULL.
+   *
+   * With `LF_PIPELINED_TAGS`, SCHED_DATAFLOW advances the tag only once these reactions have settled
+   * the newest tag, so the events that they schedule are never at a tag that has already started.
+   * Any other reaction that schedules a logical action or requests to stop is an error.
+   * Other schedulers ignore this.
+   */
+  struct reaction_t** scheduling_reactions;
+
+  /**
+   * @brief The size of the `scheduling_reactions` array.
+   */
+  size_t num_scheduling_reactions;
 } sched_params_t;
 
 /**
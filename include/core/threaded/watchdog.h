@@ -12,12 +12,23 @@
 
 #include "lf_types.h"
 #include "environment.h"
-#include "platform.h" // For lf_thread_t.
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief The duration of a tick of the timer wheel that serves the watchdogs of an environment.
+ * @ingroup Internal
+ *
+ * Watchdogs that expire within the same tick are kept in a list that is checked at each
+ * expiration, so this does not limit the precision with which handlers are invoked.
+ * It only determines how often the wheel has to be advanced.
+ */
+#ifndef LF_WATCHDOG_WHEEL_RESOLUTION
+#define LF_WATCHDOG_WHEEL_RESOLUTION MSEC(1)
+#endif
+
 /**
  * @brief Watchdog function type.
  * @ingroup Internal
@@ -63,34 +74,16 @@ typedef struct watchdog_t {
   interval_t min_expiration;
 
   /**
-   * @brief The thread ID where the watchdog handler should run.
-   *
-   * Identifies the thread that should execute the watchdog's handler function
-   * when the watchdog expires.
-   */
-  lf_thread_t thread_id;
-
-  /**
-   * @brief Condition variable for thread synchronization.
+   * @brief Indicates whether the watchdog is running.
    *
-   * Used to coordinate the watchdog thread's sleep and wake operations,
-   * and to handle termination signals.
-   */
-  lf_cond_t cond;
-
-  /**
-   * @brief Indicates whether the watchdog thread is currently active.
-   *
-   * When true, the watchdog thread is running or waiting for expiration.
-   * When false, the watchdog thread is inactive (stopped or terminated).
+   * True from when the watchdog is started until it is stopped or its handler has been invoked.
    */
   bool active;
 
   /**
-   * @brief Indicates whether watchdog thread termination has been requested.
+   * @brief Indicates whether the watchdog has been terminated.
    *
-   * When true, the watchdog thread should terminate. Used to coordinate
-   * graceful shutdown of the watchdog thread.
+   * Once terminated at the end of execution, the handler of the watchdog is no longer invoked.
    */
   bool terminate;
 
@@ -101,6 +94,16 @@ typedef struct watchdog_t {
    * expires. The handler receives a pointer to the reactor's self struct.
    */
   watchdog_function_t watchdog_function;
+
+  /**
+   * @brief The next watchdog in the same list of the timer wheel of the environment.
+   */
+  struct watchdog_t* wheel_next;
+
+  /**
+   * @brief The pointer to this watchdog in the timer wheel, or NULL if it is not in the wheel.
+   */
+  struct watchdog_t** wheel_prev;
 } watchdog_t;
 
 /**
@@ -109,6 +112,8 @@ typedef struct watchdog_t {
  *
  * This function sets the expiration time of the watchdog to the current logical time
  * plus the minimum timeout of the watchdog plus the specified `additional_timeout`.
+ * This takes constant time and only wakes up the watchdog thread of the environment
+ * if the watchdog expires before any other watchdog of the environment.
  * This function assumes the reactor mutex is held when it is called; this assumption
  * is satisfied whenever this function is called from within a reaction that declares
  * the watchdog as an effect.
@@ -136,7 +141,8 @@ void lf_watchdog_stop(watchdog_t* watchdog);
  * @brief Function to initialize mutexes for watchdogs
  * @ingroup Internal
  *
- * This function is used to initialize the mutexes for the watchdogs.
+ * This function is used to initialize the mutexes for the watchdogs and,
+ * if there are any watchdogs, to start the thread that serves them.
  *
  * @param env The environment to initialize the watchdogs for.
  */
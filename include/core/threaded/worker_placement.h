@@ -0,0 +1,94 @@
+/**
+ * @file worker_placement.h
+ *
+ * @brief CPU pinning, NUMA placement, and real-time priority of worker threads.
+ * @ingroup Internal
+ *
+ * By default, worker threads are created with no placement at all and the
+ * operating system is free to migrate them between cores (and sockets).
+ * The options declared here, which can be given on the command line
+ * (`--pin-workers`, `--cpu-list`, `--numa-node`, and `--rt-priority`)
+ * or at compile time (`LF_PIN_WORKERS`, `LF_CPU_LIST`, `LF_NUMA_NODE`, and
+ * `LF_RT_PRIORITY`), restrict each worker to a single CPU and optionally
+ * give it a real-time scheduling policy.
+ *
+ * CPUs are handed out to the workers of the environments (scheduling enclaves)
+ * in order, so as long as there are enough CPUs, each enclave gets a CPU set
+ * that is disjoint from the CPU sets of the other enclaves.
+ */
+
+#ifndef WORKER_PLACEMENT_H
+#define WORKER_PLACEMENT_H
+
+#include <stdbool.h>
+#include "environment.h"
+
+#ifndef LF_PIN_WORKERS
+/** Default for whether to pin each worker thread to one CPU. */
+#define LF_PIN_WORKERS false
+#endif
+
+#ifndef LF_NUMA_NODE
+/** Default NUMA node to restrict worker threads to, or -1 for none. */
+#define LF_NUMA_NODE -1
+#endif
+
+#ifndef LF_RT_PRIORITY
+/** Default real-time (SCHED_FIFO) priority of worker threads, or -1 to leave the policy unchanged. */
+#define LF_RT_PRIORITY -1
+#endif
+
+/**
+ * @brief Whether to pin each worker thread to one CPU.
+ * @ingroup Internal
+ *
+ * This is implied by giving a CPU list or a NUMA node.
+ */
+extern bool lf_pin_workers;
+
+/**
+ * @brief The NUMA node whose CPUs the workers should run on, or -1 for no restriction.
+ * @ingroup Internal
+ */
+extern int lf_numa_node;
+
+/**
+ * @brief The real-time priority of worker threads, or -1 to leave the scheduling policy unchanged.
+ * @ingroup Internal
+ *
+ * Priorities range from @ref LF_SCHED_MIN_PRIORITY to @ref LF_SCHED_MAX_PRIORITY.
+ */
+extern int lf_rt_priority;
+
+/**
+ * @brief Set the list of CPUs to which worker threads may be pinned.
+ * @ingroup Internal
+ *
+ * @param spec A CPU list such as "0-3,8,10-11".
+ * @return true if the list was valid, false otherwise.
+ */
+bool lf_worker_placement_set_cpu_list(const char* spec);
+
+/**
+ * @brief Assign CPUs to the workers of all environments.
+ * @ingroup Internal
+ *
+ * This has to be called after the environments have been created and before
+ * any worker thread starts. If no pinning is requested, it does nothing.
+ * @param envs The array of environments.
+ * @param num_envs The number of environments.
+ */
+void lf_worker_placement_init(environment_t* envs, int num_envs);
+
+/**
+ * @brief Apply the placement computed by @ref lf_worker_placement_init to the calling worker thread.
+ * @ingroup Internal
+ *
+ * Failures (e.g., lacking the privilege to use a real-time policy) result in a
+ * warning only, since the program is still correct without placement.
+ * @param env The environment of the worker.
+ * @param worker_number The number of the worker within its environment.
+ */
+void lf_worker_placement_apply(environment_t* env, int worker_number);
+
+#endif // WORKER_PLACEMENT_H
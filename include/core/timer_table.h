@@ -0,0 +1,130 @@
+/**
+ * @file timer_table.h
+ * @brief Table of periodic timers that is kept apart from the event queue.
+ * @ingroup Internal
+ *
+ * Without this table, each firing of a periodic timer puts a new event on the event queue
+ * for the next firing, which costs an insertion into the heap per timer and per period.
+ * If the runtime is built with `LF_TIMER_TABLE`, periodic timers that are not in a mode are
+ * kept in this table instead. Timers with the same period that fire at the same time are
+ * kept in one group. The groups are sorted by the time of their next firing and then by period,
+ * and are kept in blocks of at most @ref LF_TIMER_BLOCK_SIZE groups. Putting a group back finds
+ * its block and its place in the block with binary searches, so it moves at most one block of
+ * groups and the array of blocks rather than every group, even when many groups have distinct
+ * phases. Firing a group triggers all of its timers in one pass and moves the group to its next
+ * firing. The earliest firing is merged with the head of the event queue when the runtime looks
+ * for the next tag (see _lf_earliest_event_tag()).
+ *
+ * Timers always fire at microstep 0, so a group is identified by a time rather than a tag.
+ */
+
+#ifndef TIMER_TABLE_H
+#define TIMER_TABLE_H
+
+#include "lf_types.h"
+
+/**
+ * @brief Timers with the same period that fire at the same time.
+ * @ingroup Internal
+ */
+typedef struct lf_timer_group_t {
+  /** The time of the next firing of the timers. */
+  instant_t time;
+  /** The period of the timers. */
+  interval_t period;
+  /** The timers. */
+  trigger_t** timers;
+  size_t number_of_timers;
+  size_t capacity;
+} lf_timer_group_t;
+
+/**
+ * @brief The maximum number of groups in a block of a timer table.
+ * @ingroup Internal
+ */
+#define LF_TIMER_BLOCK_SIZE 64
+
+/**
+ * @brief Groups of timers of a timer table that are next to each other in the order of their firing.
+ * @ingroup Internal
+ */
+typedef struct lf_timer_block_t {
+  /** The groups in order, from groups[first] to groups[first + number_of_groups - 1]. */
+  lf_timer_group_t* groups[LF_TIMER_BLOCK_SIZE];
+  size_t first;
+  size_t number_of_groups;
+} lf_timer_block_t;
+
+/**
+ * @brief Groups of timers sorted by the time of their next firing and then by period.
+ * @ingroup Internal
+ */
+typedef struct lf_timer_table_t {
+  /** The blocks in order, none of which is empty. */
+  lf_timer_block_t** blocks;
+  size_t number_of_blocks;
+  /** The size of the blocks array. */
+  size_t capacity;
+  /** The number of groups in all blocks. */
+  size_t number_of_groups;
+  /** A block that was emptied and is kept for the next split, or NULL. */
+  lf_timer_block_t* spare;
+} lf_timer_table_t;
+
+/**
+ * @brief Create an empty timer table.
+ * @ingroup Internal
+ * The caller should call lf_timer_table_free() when finished with the table.
+ */
+lf_timer_table_t* lf_timer_table_new(void);
+
+/**
+ * @brief Free the table and its groups, but not the timers.
+ * @ingroup Internal
+ * @param table The table, or NULL.
+ */
+void lf_timer_table_free(lf_timer_table_t* table);
+
+/**
+ * @brief Add a periodic timer that next fires at the given time.
+ * @ingroup Internal
+ * @param table The table.
+ * @param timer A timer with a positive period.
+ * @param time The time of the next firing.
+ */
+void lf_timer_table_add(lf_timer_table_t* table, trigger_t* timer, instant_t time);
+
+/**
+ * @brief Return the time of the earliest firing in the table, or FOREVER if the table is empty.
+ * @ingroup Internal
+ * @param table The table, or NULL.
+ */
+instant_t lf_timer_table_next_time(lf_timer_table_t* table);
+
+/**
+ * @brief Remove and return a group that fires at the given time, or return NULL if there is none.
+ * @ingroup Internal
+ *
+ * The caller should give the group back with lf_timer_table_push() once it has moved the time
+ * of the group to its next firing, or free it with lf_timer_table_free_group().
+ * @param table The table, or NULL.
+ * @param time The time.
+ */
+lf_timer_group_t* lf_timer_table_pop(lf_timer_table_t* table, instant_t time);
+
+/**
+ * @brief Put a group back in the table, merging it with a group of the same period and time, if any.
+ * @ingroup Internal
+ * @param table The table.
+ * @param group A group removed with lf_timer_table_pop().
+ */
+void lf_timer_table_push(lf_timer_table_t* table, lf_timer_group_t* group);
+
+/**
+ * @brief Free a group removed with lf_timer_table_pop(), but not its timers.
+ * @ingroup Internal
+ * @param group The group.
+ */
+void lf_timer_table_free_group(lf_timer_group_t* group);
+
+#endif // TIMER_TABLE_H
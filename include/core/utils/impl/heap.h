@@ -0,0 +1,333 @@
+/**
+ * @file heap.h
+ * @brief Defines a generic, growable d-ary min-heap that stores keys next to the elements.
+ * @ingroup Utilities
+ *
+ * Heaps are defined by redefining K, E, KEY_LESS, SET_POSITION, and HEAP, and including this file.
+ * A default heap type is defined here. See tag_heap.h for an example of a heap declaration.
+ * - K must be the type of the keys. The heap pops the least key first.
+ * - E must be the type of the elements. It must be a pointer type.
+ * - KEY_LESS(a, b) must be true if key a is strictly less than key b. It is expanded in place
+ *   wherever two keys are compared.
+ * - SET_POSITION(element, position) is invoked whenever an element moves within the heap. It lets
+ *   the element record its position, which is needed to remove it with HEAP(remove_at).
+ * - HEAP must be a function-like macro that prefixes tokens with the name of the heap. For
+ *   example, the name of the heap data type is given by evaluation of the macro HEAP(t) so
+ *   that it is "t" prefixed with the name of the heap. The function names associated with the
+ *   data type are similar.
+ *
+ * Unlike the heap in pqueue_base.h, which finds the priority of an element and compares two
+ * priorities through function pointers, this heap copies the key of an element into the heap
+ * array when the element is inserted. Restoring the heap property therefore only touches the
+ * heap array and never the elements. Each node has HEAP_ARITY (by default 4) children, which
+ * makes the tree half as deep as a binary tree, and the keys of siblings share cache lines.
+ *
+ * All functions are static, so the same heap type can be declared in several translation units.
+ */
+
+#ifndef K
+#define K unsigned long long
+#endif
+#ifndef E
+#define E void*
+#endif
+#ifndef KEY_LESS
+#define KEY_LESS(a, b) ((a) < (b))
+#endif
+#ifndef SET_POSITION
+#define SET_POSITION(element, position) ((void)0)
+#endif
+#ifndef HEAP
+#define HEAP(token) heap##_##token
+#endif
+#ifndef HEAP_ARITY
+#define HEAP_ARITY 4
+#endif
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <assert.h>
+
+////////////////////////// Type definitions ///////////////////////////
+
+/**
+ * @brief A heap entry: an element and a copy of its key.
+ * @ingroup Utilities
+ */
+typedef struct HEAP(entry_t) {
+  K key;
+  E element;
+} HEAP(entry_t);
+
+/**
+ * @brief A heap. The entry with the least key is at index 0, and the children of the entry
+ * at index i are at indices HEAP_ARITY * i + 1 through HEAP_ARITY * i + HEAP_ARITY.
+ * @ingroup Utilities
+ */
+typedef struct HEAP(t) {
+  HEAP(entry_t) * entries;
+  size_t size;
+  size_t capacity;
+} HEAP(t);
+
+/////////////////////////// Private helpers ///////////////////////////
+
+/**
+ * @brief Make room for at least `count` more entries.
+ * @return 0 on success, 1 if memory could not be allocated.
+ */
+static inline int HEAP(reserve)(HEAP(t) * heap, size_t count) {
+  if (heap->size + count <= heap->capacity)
+    return 0;
+  size_t capacity = heap->capacity * 2;
+  if (capacity < heap->size + count)
+    capacity = heap->size + count;
+  HEAP(entry_t)* entries = (HEAP(entry_t)*)realloc(heap->entries, capacity * sizeof(HEAP(entry_t)));
+  if (!entries)
+    return 1;
+  heap->entries = entries;
+  heap->capacity = capacity;
+  return 0;
+}
+
+/**
+ * @brief Put `moving` at index `i` or above, moving the entries with greater keys down.
+ * The entry at index `i` is treated as a hole.
+ */
+static inline void HEAP(sift_up)(HEAP(t) * heap, size_t i, HEAP(entry_t) moving) {
+  HEAP(entry_t)* entries = heap->entries;
+  while (i > 0) {
+    size_t parent = (i - 1) / HEAP_ARITY;
+    if (!KEY_LESS(moving.key, entries[parent].key))
+      break;
+    entries[i] = entries[parent];
+    SET_POSITION(entries[i].element, i);
+    i = parent;
+  }
+  entries[i] = moving;
+  SET_POSITION(moving.element, i);
+}
+
+/**
+ * @brief Put `moving` at index `i` or below, moving the entries with lesser keys up.
+ * The entry at index `i` is treated as a hole.
+ */
+static inline void HEAP(sift_down)(HEAP(t) * heap, size_t i, HEAP(entry_t) moving) {
+  HEAP(entry_t)* entries = heap->entries;
+  size_t size = heap->size;
+  while (1) {
+    size_t child = HEAP_ARITY * i + 1;
+    if (child >= size)
+      break;
+    size_t end = child + HEAP_ARITY < size ? child + HEAP_ARITY : size;
+    size_t least = child;
+    for (child++; child < end; child++) {
+      if (KEY_LESS(entries[child].key, entries[least].key))
+        least = child;
+    }
+    if (!KEY_LESS(entries[least].key, moving.key))
+      break;
+    entries[i] = entries[least];
+    SET_POSITION(entries[i].element, i);
+    i = least;
+  }
+  entries[i] = moving;
+  SET_POSITION(moving.element, i);
+}
+
+/**
+ * @brief Search the subtree rooted at index `i` for an element with the given key that `matches`.
+ */
+static inline E HEAP(find_from)(HEAP(t) * heap, size_t i, K key, int (*matches)(void*, void*), void* arg) {
+  // Stop once the keys in the subtree are all greater than the key we are looking for.
+  if (i >= heap->size || KEY_LESS(key, heap->entries[i].key))
+    return NULL;
+  if (!KEY_LESS(heap->entries[i].key, key) && (matches == NULL || matches(heap->entries[i].element, arg)))
+    return heap->entries[i].element;
+  for (size_t child = HEAP_ARITY * i + 1; child <= HEAP_ARITY * i + HEAP_ARITY; child++) {
+    E found = HEAP(find_from)(heap, child, key, matches, arg);
+    if (found)
+      return found;
+  }
+  return NULL;
+}
+
+//////////////////////// Function definitions /////////////////////////
+
+/**
+ * @brief Initialize an empty heap with room for `capacity` entries.
+ * @ingroup Utilities
+ * @return 0 on success, 1 if memory could not be allocated.
+ */
+static inline int HEAP(initialize)(HEAP(t) * heap, size_t capacity) {
+  if (capacity == 0)
+    capacity = 1;
+  heap->entries = (HEAP(entry_t)*)malloc(capacity * sizeof(HEAP(entry_t)));
+  heap->size = 0;
+  heap->capacity = heap->entries ? capacity : 0;
+  return heap->entries ? 0 : 1;
+}
+
+/**
+ * @brief Free the memory used by the heap, but not the heap struct itself or the elements.
+ * @ingroup Utilities
+ */
+static inline void HEAP(free)(HEAP(t) * heap) {
+  free(heap->entries);
+  heap->entries = NULL;
+  heap->size = 0;
+  heap->capacity = 0;
+}
+
+/**
+ * @brief Return the number of elements in the heap.
+ * @ingroup Utilities
+ */
+static inline size_t HEAP(size)(const HEAP(t) * heap) { return heap->size; }
+
+/**
+ * @brief Insert an element with the given key.
+ * @ingroup Utilities
+ * @return 0 on success, 1 if memory could not be allocated.
+ */
+static inline int HEAP(insert)(HEAP(t) * heap, K key, E element) {
+  if (HEAP(reserve)(heap, 1))
+    return 1;
+  HEAP(entry_t) moving = {key, element};
+  HEAP(sift_up)(heap, heap->size++, moving);
+  return 0;
+}
+
+/**
+ * @brief Append an element with the given key without restoring the heap property.
+ * @ingroup Utilities
+ *
+ * After appending one or more elements, call HEAP(restore) before using any other function.
+ * @return 0 on success, 1 if memory could not be allocated.
+ */
+static inline int HEAP(append)(HEAP(t) * heap, K key, E element) {
+  if (HEAP(reserve)(heap, 1))
+    return 1;
+  HEAP(entry_t) appended = {key, element};
+  heap->entries[heap->size] = appended;
+  SET_POSITION(element, heap->size);
+  heap->size++;
+  return 0;
+}
+
+/**
+ * @brief Restore the heap property after the elements at index `first` and beyond were appended.
+ * @ingroup Utilities
+ */
+static inline void HEAP(restore)(HEAP(t) * heap, size_t first) {
+  if (heap->size < 2)
+    return;
+  // Sifting up each new entry costs O(n log size), rebuilding the whole heap O(size).
+  if ((heap->size - first) * 8 >= heap->size) {
+    for (size_t i = (heap->size - 2) / HEAP_ARITY + 1; i-- > 0;)
+      HEAP(sift_down)(heap, i, heap->entries[i]);
+  } else {
+    for (size_t i = first; i < heap->size; i++)
+      HEAP(sift_up)(heap, i, heap->entries[i]);
+  }
+}
+
+/**
+ * @brief Return the element with the least key without removing it, or NULL if the heap is empty.
+ * @ingroup Utilities
+ */
+static inline E HEAP(peek)(const HEAP(t) * heap) { return heap->size ? heap->entries[0].element : NULL; }
+
+/**
+ * @brief Return the least key.
+ * @ingroup Utilities
+ *
+ * Precondition: The heap is not empty.
+ */
+static inline K HEAP(peek_key)(const HEAP(t) * heap) {
+  assert(heap->size > 0);
+  return heap->entries[0].key;
+}
+
+/**
+ * @brief Remove and return the element with the least key, or return NULL if the heap is empty.
+ * @ingroup Utilities
+ */
+static inline E HEAP(pop)(HEAP(t) * heap) {
+  if (heap->size == 0)
+    return NULL;
+  E head = heap->entries[0].element;
+  if (--heap->size > 0) {
+    // The last entry usually belongs near the bottom, so move the hole at the root down to a leaf
+    // along the least children without comparing them to the last entry, then sift that entry up.
+    HEAP(entry_t)* entries = heap->entries;
+    size_t size = heap->size;
+    size_t i = 0;
+    while (1) {
+      size_t child = HEAP_ARITY * i + 1;
+      if (child >= size)
+        break;
+      size_t end = child + HEAP_ARITY < size ? child + HEAP_ARITY : size;
+      size_t least = child;
+      for (child++; child < end; child++) {
+        if (KEY_LESS(entries[child].key, entries[least].key))
+          least = child;
+      }
+      entries[i] = entries[least];
+      SET_POSITION(entries[i].element, i);
+      i = least;
+    }
+    HEAP(sift_up)(heap, i, entries[size]);
+  }
+  return head;
+}
+
+/**
+ * @brief Remove the element at the given index, which is the last position passed to
+ * SET_POSITION for that element.
+ * @ingroup Utilities
+ */
+static inline void HEAP(remove_at)(HEAP(t) * heap, size_t position) {
+  assert(position < heap->size);
+  if (position == --heap->size)
+    return;
+  HEAP(entry_t) moving = heap->entries[heap->size];
+  if (position > 0 && KEY_LESS(moving.key, heap->entries[(position - 1) / HEAP_ARITY].key))
+    HEAP(sift_up)(heap, position, moving);
+  else
+    HEAP(sift_down)(heap, position, moving);
+}
+
+/**
+ * @brief Return the element at the given index. Indices below HEAP(size) cover all elements
+ * in no particular order.
+ * @ingroup Utilities
+ */
+static inline E HEAP(at)(const HEAP(t) * heap, size_t i) {
+  assert(i < heap->size);
+  return heap->entries[i].element;
+}
+
+/**
+ * @brief Return an element whose key is equal to `key` and for which `matches(element, arg)` is
+ * nonzero, or NULL if there is none.
+ * @ingroup Utilities
+ *
+ * Only subtrees whose root key is not greater than `key` are visited.
+ * @param matches Function to check an element with an equal key, or NULL to accept any such element.
+ */
+static inline E HEAP(find)(HEAP(t) * heap, K key, int (*matches)(void*, void*), void* arg) {
+  return HEAP(find_from)(heap, 0, key, matches, arg);
+}
+
+/**
+ * @brief Return 1 if no entry has a key less than the key of its parent, and 0 otherwise.
+ * @ingroup Utilities
+ */
+static inline int HEAP(is_valid)(const HEAP(t) * heap) {
+  for (size_t i = 1; i < heap->size; i++) {
+    if (KEY_LESS(heap->entries[i].key, heap->entries[(i - 1) / HEAP_ARITY].key))
+      return 0;
+  }
+  return 1;
+}
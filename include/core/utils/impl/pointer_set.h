@@ -0,0 +1,35 @@
+/**
+ * @file pointer_set.h
+ * @brief Defines a growable set of void pointers.
+ * @ingroup Utilities
+ *
+ * To use this:
+ * ```c
+ * #include "core/utils/impl/pointer_set.h"
+ * ```
+ * A zero-initialized `pointer_set_t` is an empty set. To add, test, and remove pointers:
+ * ```c
+ * pointer_set_add(&set, POINTER);      // Returns 1 if added, 0 if present, -1 if out of memory.
+ * pointer_set_contains(&set, POINTER);
+ * pointer_set_remove(&set, POINTER);   // Returns 1 if removed, 0 if absent.
+ * ```
+ * To visit all pointers:
+ * ```c
+ * pointer_set_iterator_t it = pointer_set_iterator(&set);
+ * void* pointer;
+ * while (pointer_set_iterator_next(&it, &pointer)) { ... }
+ * ```
+ * Finally, `pointer_set_free(&set)` releases the memory of the set.
+ *
+ * See @ref swiss_table.h for documentation on how to declare other table types.
+ */
+
+#define SWISS_TABLE(token) pointer_set##_##token
+#define K void*
+#define HASH_OF(key) swiss_table_hash_pointer(key)
+#define KEY_EQUAL(a, b) ((a) == (b))
+#include "swiss_table.h"
+#undef SWISS_TABLE
+#undef K
+#undef HASH_OF
+#undef KEY_EQUAL
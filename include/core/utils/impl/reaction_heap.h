@@ -0,0 +1,31 @@
+/**
+ * @file reaction_heap.h
+ * @brief Defines a heap type that orders pointers to reactions by their index.
+ * @ingroup Utilities
+ *
+ * To use this:
+ * ```c
+ * #include "core/utils/impl/reaction_heap.h"
+ * ```
+ * To insert a reaction, pass a copy of its index:
+ * ```c
+ * reaction_heap_insert(&heap, reaction->index, reaction);
+ * ```
+ * The heap keeps the `pos` field of each reaction up to date.
+ *
+ * See @ref heap.h for documentation on how to declare other heap types.
+ */
+
+#include "lf_types.h"
+
+#define HEAP(token) reaction_heap##_##token
+#define K index_t
+#define E reaction_t*
+#define KEY_LESS(a, b) ((a) < (b))
+#define SET_POSITION(element, position) ((element)->pos = (position))
+#include "heap.h"
+#undef HEAP
+#undef K
+#undef E
+#undef KEY_LESS
+#undef SET_POSITION
@@ -0,0 +1,471 @@
+/**
+ * @file swiss_table.h
+ * @brief Defines a generic, growable hash table that probes groups of slots at once.
+ * @ingroup Utilities
+ *
+ * Tables are defined by redefining K, HASH_OF, KEY_EQUAL, SWISS_TABLE, and optionally V, and
+ * including this file. A default table type is defined here. See pointer_set.h for an example
+ * of a table declaration.
+ * - K must be the type of the keys.
+ * - V must be the type of the values. If V is not defined, the table is a set of keys.
+ * - HASH_OF(key) must be a well-mixed hash of a key of type size_t. For pointers, use
+ *   swiss_table_hash_pointer().
+ * - KEY_EQUAL(a, b) must be true if the two keys are equal.
+ * - SWISS_TABLE must be a function-like macro that prefixes tokens with the name of the table.
+ *   For example, the name of the table data type is given by evaluation of the macro
+ *   SWISS_TABLE(t) so that it is "t" prefixed with the name of the table. The function names
+ *   associated with the data type are similar.
+ *
+ * The table uses open addressing in the style of Swiss tables. Next to the array of slots,
+ * it keeps one control byte per slot, which is either EMPTY, DELETED, or the low 7 bits of
+ * the hash of the key in the slot. Slots are divided into groups of SWISS_TABLE_GROUP_WIDTH,
+ * and a lookup compares the control bytes of a whole group to the hash with a single SSE2
+ * instruction (or a few 64-bit operations if SSE2 is not available). Keys are only compared
+ * in slots whose control byte matches. The groups are probed quadratically, starting at a
+ * group chosen by the remaining bits of the hash.
+ *
+ * Unlike hashmap.h, the table grows when it is 7/8 full, supports removal, and can be
+ * iterated with an iterator on the stack. Unlike hashset.h, any key value can be stored.
+ *
+ * All functions are static, so the same table type can be declared in several translation units.
+ */
+
+/////////////////// Definitions shared by all tables ///////////////////
+
+#ifndef SWISS_TABLE_SHARED_H
+#define SWISS_TABLE_SHARED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SWISS_TABLE_SSE2 1
+/** Number of slots whose control bytes are compared at once. */
+#define SWISS_TABLE_GROUP_WIDTH 16
+/** Log base 2 of the number of mask bits per slot. */
+#define SWISS_TABLE_MASK_SHIFT 0
+/** Bit mask with a bit set for each slot in a group that matches. */
+typedef uint32_t swiss_table_mask_t;
+#else
+#define SWISS_TABLE_GROUP_WIDTH 8
+#define SWISS_TABLE_MASK_SHIFT 3
+typedef uint64_t swiss_table_mask_t;
+#endif
+
+/** Control byte of a slot that has never been used since the table was last rebuilt. */
+#define SWISS_TABLE_EMPTY ((int8_t)-128)
+/** Control byte of a slot whose key was removed. */
+#define SWISS_TABLE_DELETED ((int8_t)-2)
+
+#if defined(SWISS_TABLE_SSE2)
+
+static inline __m128i swiss_table_load(const int8_t* group) { return _mm_loadu_si128((const __m128i*)group); }
+
+static inline swiss_table_mask_t swiss_table_match(const int8_t* group, int8_t h2) {
+  return (swiss_table_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), swiss_table_load(group)));
+}
+
+static inline swiss_table_mask_t swiss_table_match_empty(const int8_t* group) {
+  return swiss_table_match(group, SWISS_TABLE_EMPTY);
+}
+
+static inline swiss_table_mask_t swiss_table_match_empty_or_deleted(const int8_t* group) {
+  // Both EMPTY and DELETED are less than -1, while the hash bits are not negative.
+  return (swiss_table_mask_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), swiss_table_load(group)));
+}
+
+static inline swiss_table_mask_t swiss_table_match_full(const int8_t* group) {
+  return ~(swiss_table_mask_t)_mm_movemask_epi8(swiss_table_load(group)) & 0xFFFFu;
+}
+
+#else // SWISS_TABLE_SSE2
+
+#define SWISS_TABLE_LSBS 0x0101010101010101ULL
+#define SWISS_TABLE_MSBS 0x8080808080808080ULL
+
+static inline uint64_t swiss_table_load(const int8_t* group) {
+  uint64_t bytes;
+  memcpy(&bytes, group, sizeof(bytes));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  bytes = __builtin_bswap64(bytes);
+#endif
+  return bytes;
+}
+
+static inline swiss_table_mask_t swiss_table_match(const int8_t* group, int8_t h2) {
+  // This can report a byte next to a matching byte, but only if that byte also holds hash bits,
+  // so the caller may compare the key of an occupied slot for nothing, which is harmless.
+  uint64_t x = swiss_table_load(group) ^ (SWISS_TABLE_LSBS * (uint8_t)h2);
+  return (x - SWISS_TABLE_LSBS) & ~x & SWISS_TABLE_MSBS;
+}
+
+static inline swiss_table_mask_t swiss_table_match_empty(const int8_t* group) {
+  uint64_t x = swiss_table_load(group);
+  return x & ~(x << 6) & SWISS_TABLE_MSBS;
+}
+
+static inline swiss_table_mask_t swiss_table_match_empty_or_deleted(const int8_t* group) {
+  uint64_t x = swiss_table_load(group);
+  return x & ~(x << 7) & SWISS_TABLE_MSBS;
+}
+
+static inline swiss_table_mask_t swiss_table_match_full(const int8_t* group) {
+  return ~swiss_table_load(group) & SWISS_TABLE_MSBS;
+}
+
+#endif // SWISS_TABLE_SSE2
+
+/** Return the position in its group of the first slot in a nonzero mask. */
+static inline size_t swiss_table_lowest(swiss_table_mask_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (size_t)__builtin_ctzll((unsigned long long)mask) >> SWISS_TABLE_MASK_SHIFT;
+#else
+  size_t bit = 0;
+  while (!(mask & 1)) {
+    mask >>= 1;
+    bit++;
+  }
+  return bit >> SWISS_TABLE_MASK_SHIFT;
+#endif
+}
+
+/** Return a hash of a pointer in which all bits depend on all bits of the pointer. */
+static inline size_t swiss_table_hash_pointer(const void* pointer) {
+  uint64_t x = (uint64_t)(uintptr_t)pointer;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return (size_t)x;
+}
+
+#endif // SWISS_TABLE_SHARED_H
+
+///////////////////////// Template parameters //////////////////////////
+
+#ifndef K
+#define K void*
+#endif
+#ifndef HASH_OF
+#define HASH_OF(key) swiss_table_hash_pointer(key)
+#endif
+#ifndef KEY_EQUAL
+#define KEY_EQUAL(a, b) ((a) == (b))
+#endif
+#ifndef SWISS_TABLE
+#define SWISS_TABLE(token) swiss_table##_##token
+#endif
+
+////////////////////////// Type definitions ///////////////////////////
+
+/**
+ * @brief A slot of a table.
+ * @ingroup Utilities
+ */
+typedef struct SWISS_TABLE(slot_t) {
+  K key;
+#ifdef V
+  V value;
+#endif
+} SWISS_TABLE(slot_t);
+
+/**
+ * @brief A table. A zero-initialized table is a valid empty table.
+ * @ingroup Utilities
+ */
+typedef struct SWISS_TABLE(t) {
+  /** The slots, followed by one control byte per slot, in a single allocation. */
+  SWISS_TABLE(slot_t) * slots;
+  int8_t* control;
+  /** Zero or a power of two that is at least SWISS_TABLE_GROUP_WIDTH. */
+  size_t capacity;
+  size_t size;
+  /** Number of keys that can still be added to EMPTY slots before the table is rebuilt. */
+  size_t growth_left;
+} SWISS_TABLE(t);
+
+/**
+ * @brief An iterator over the keys of a table.
+ * @ingroup Utilities
+ *
+ * Removing the key that was returned last does not disturb the iteration. Adding keys does.
+ */
+typedef struct SWISS_TABLE(iterator_t) {
+  SWISS_TABLE(t) * table;
+  size_t index;
+} SWISS_TABLE(iterator_t);
+
+/////////////////////////// Private helpers ///////////////////////////
+
+/** Return the index of the slot that holds `key`, or SIZE_MAX if there is none. */
+static inline size_t SWISS_TABLE(find_index)(const SWISS_TABLE(t) * table, K key, size_t hash) {
+  if (table->capacity == 0)
+    return SIZE_MAX;
+  size_t last_group = table->capacity / SWISS_TABLE_GROUP_WIDTH - 1;
+  size_t group = (hash >> 7) & last_group;
+  int8_t h2 = (int8_t)(hash & 0x7F);
+  for (size_t step = 1;; step++) {
+    const int8_t* control = table->control + group * SWISS_TABLE_GROUP_WIDTH;
+    for (swiss_table_mask_t match = swiss_table_match(control, h2); match; match &= match - 1) {
+      size_t index = group * SWISS_TABLE_GROUP_WIDTH + swiss_table_lowest(match);
+      if (KEY_EQUAL(table->slots[index].key, key))
+        return index;
+    }
+    // A key is always stored in the first group of its probe sequence that had room.
+    if (swiss_table_match_empty(control))
+      return SIZE_MAX;
+    group = (group + step) & last_group;
+  }
+}
+
+/** Return the index of the first EMPTY or DELETED slot in the probe sequence of `hash`. */
+static inline size_t SWISS_TABLE(find_free)(const SWISS_TABLE(t) * table, size_t hash) {
+  size_t last_group = table->capacity / SWISS_TABLE_GROUP_WIDTH - 1;
+  size_t group = (hash >> 7) & last_group;
+  for (size_t step = 1;; step++) {
+    swiss_table_mask_t free_slots =
+        swiss_table_match_empty_or_deleted(table->control + group * SWISS_TABLE_GROUP_WIDTH);
+    if (free_slots)
+      return group * SWISS_TABLE_GROUP_WIDTH + swiss_table_lowest(free_slots);
+    group = (group + step) & last_group;
+  }
+}
+
+/**
+ * @brief Move all keys into new storage with the given capacity, dropping DELETED slots.
+ * @return 0 on success, 1 if memory could not be allocated.
+ */
+static inline int SWISS_TABLE(rebuild)(SWISS_TABLE(t) * table, size_t capacity) {
+  SWISS_TABLE(t) rebuilt;
+  rebuilt.slots = (SWISS_TABLE(slot_t)*)malloc(capacity * (sizeof(SWISS_TABLE(slot_t)) + 1));
+  if (!rebuilt.slots)
+    return 1;
+  rebuilt.control = (int8_t*)(rebuilt.slots + capacity);
+  memset(rebuilt.control, SWISS_TABLE_EMPTY, capacity);
+  rebuilt.capacity = capacity;
+  rebuilt.size = table->size;
+  rebuilt.growth_left = capacity - capacity / 8 - table->size;
+  for (size_t i = 0; i < table->capacity; i++) {
+    if (table->control[i] >= 0) {
+      size_t hash = HASH_OF(table->slots[i].key);
+      size_t index = SWISS_TABLE(find_free)(&rebuilt, hash);
+      rebuilt.control[index] = (int8_t)(hash & 0x7F);
+      rebuilt.slots[index] = table->slots[i];
+    }
+  }
+  free(table->slots);
+  *table = rebuilt;
+  return 0;
+}
+
+/**
+ * @brief Claim a slot for a key that is not in the table, growing the table if needed.
+ * @return The index of the slot, or SIZE_MAX if memory could not be allocated.
+ */
+static inline size_t SWISS_TABLE(claim)(SWISS_TABLE(t) * table, size_t hash) {
+  if (table->growth_left == 0) {
+    // Grow if more than 7/16 of the slots are in use. Otherwise, most of the slots that are
+    // not EMPTY are DELETED, and rebuilding at the same capacity reclaims them.
+    size_t capacity = table->capacity == 0 ? SWISS_TABLE_GROUP_WIDTH : table->capacity;
+    if (table->size > capacity / 16 * 7)
+      capacity *= 2;
+    if (SWISS_TABLE(rebuild)(table, capacity))
+      return SIZE_MAX;
+  }
+  size_t index = SWISS_TABLE(find_free)(table, hash);
+  if (table->control[index] == SWISS_TABLE_EMPTY)
+    table->growth_left--;
+  table->control[index] = (int8_t)(hash & 0x7F);
+  table->size++;
+  return index;
+}
+
+//////////////////////// Function definitions /////////////////////////
+
+/**
+ * @brief Initialize an empty table with room for `capacity` keys.
+ * @ingroup Utilities
+ * @return 0 on success, 1 if memory could not be allocated.
+ */
+static inline int SWISS_TABLE(initialize)(SWISS_TABLE(t) * table, size_t capacity) {
+  memset(table, 0, sizeof(*table));
+  if (capacity == 0)
+    return 0;
+  size_t slots = SWISS_TABLE_GROUP_WIDTH;
+  while (slots - slots / 8 < capacity)
+    slots *= 2;
+  return SWISS_TABLE(rebuild)(table, slots);
+}
+
+/**
+ * @brief Free the memory used by the table, but not the table struct itself.
+ * @ingroup Utilities
+ */
+static inline void SWISS_TABLE(free)(SWISS_TABLE(t) * table) {
+  free(table->slots);
+  memset(table, 0, sizeof(*table));
+}
+
+/**
+ * @brief Return the number of keys in the table.
+ * @ingroup Utilities
+ */
+static inline size_t SWISS_TABLE(size)(const SWISS_TABLE(t) * table) { return table->size; }
+
+/**
+ * @brief Return true if the key is in the table.
+ * @ingroup Utilities
+ */
+static inline bool SWISS_TABLE(contains)(const SWISS_TABLE(t) * table, K key) {
+  return SWISS_TABLE(find_index)(table, key, HASH_OF(key)) != SIZE_MAX;
+}
+
+#ifdef V
+
+/**
+ * @brief Associate a value with the given key.
+ * @ingroup Utilities
+ * @return 1 if the key was added, 0 if it was already in the table and its value was replaced,
+ * and -1 if memory could not be allocated.
+ */
+static inline int SWISS_TABLE(put)(SWISS_TABLE(t) * table, K key, V value) {
+  size_t hash = HASH_OF(key);
+  size_t index = SWISS_TABLE(find_index)(table, key, hash);
+  if (index != SIZE_MAX) {
+    table->slots[index].value = value;
+    return 0;
+  }
+  index = SWISS_TABLE(claim)(table, hash);
+  if (index == SIZE_MAX)
+    return -1;
+  table->slots[index].key = key;
+  table->slots[index].value = value;
+  return 1;
+}
+
+/**
+ * @brief Return a pointer to the value associated with the given key, or NULL if there is none.
+ * @ingroup Utilities
+ *
+ * The pointer is valid until a key is added to the table.
+ */
+static inline V* SWISS_TABLE(get)(SWISS_TABLE(t) * table, K key) {
+  size_t index = SWISS_TABLE(find_index)(table, key, HASH_OF(key));
+  return index == SIZE_MAX ? NULL : &table->slots[index].value;
+}
+
+#else // V
+
+/**
+ * @brief Add a key to the table.
+ * @ingroup Utilities
+ * @return 1 if the key was added, 0 if it was already in the table, and -1 if memory
+ * could not be allocated.
+ */
+static inline int SWISS_TABLE(add)(SWISS_TABLE(t) * table, K key) {
+  size_t hash = HASH_OF(key);
+  if (SWISS_TABLE(find_index)(table, key, hash) != SIZE_MAX)
+    return 0;
+  size_t index = SWISS_TABLE(claim)(table, hash);
+  if (index == SIZE_MAX)
+    return -1;
+  table->slots[index].key = key;
+  return 1;
+}
+
+#endif // V
+
+/**
+ * @brief Remove the key at the given slot index.
+ */
+static inline void SWISS_TABLE(remove_at)(SWISS_TABLE(t) * table, size_t index) {
+  // If the group still has an EMPTY slot, no probe sequence has ever continued past it,
+  // so the slot can become EMPTY again. Otherwise, lookups must skip over it.
+  if (swiss_table_match_empty(table->control + index / SWISS_TABLE_GROUP_WIDTH * SWISS_TABLE_GROUP_WIDTH)) {
+    table->control[index] = SWISS_TABLE_EMPTY;
+    table->growth_left++;
+  } else {
+    table->control[index] = SWISS_TABLE_DELETED;
+  }
+  table->size--;
+}
+
+/**
+ * @brief Remove a key from the table.
+ * @ingroup Utilities
+ * @return 1 if the key was removed and 0 if it was not in the table.
+ */
+static inline int SWISS_TABLE(remove)(SWISS_TABLE(t) * table, K key) {
+  size_t index = SWISS_TABLE(find_index)(table, key, HASH_OF(key));
+  if (index == SIZE_MAX)
+    return 0;
+  SWISS_TABLE(remove_at)(table, index);
+  return 1;
+}
+
+/**
+ * @brief Return an iterator positioned before the first key of the table.
+ * @ingroup Utilities
+ */
+static inline SWISS_TABLE(iterator_t) SWISS_TABLE(iterator)(SWISS_TABLE(t) * table) {
+  SWISS_TABLE(iterator_t) iterator = {table, 0};
+  return iterator;
+}
+
+/**
+ * @brief Advance the iterator to the next key and store it in `key`.
+ * @ingroup Utilities
+ *
+ * The keys are visited in no particular order. Whole groups of unused slots are skipped at once.
+ * @return false if there are no more keys.
+ */
+#ifdef V
+static inline bool SWISS_TABLE(iterator_next)(SWISS_TABLE(iterator_t) * iterator, K* key, V* value) {
+#else
+static inline bool SWISS_TABLE(iterator_next)(SWISS_TABLE(iterator_t) * iterator, K* key) {
+#endif
+  SWISS_TABLE(t)* table = iterator->table;
+  while (iterator->index < table->capacity) {
+    size_t group = iterator->index / SWISS_TABLE_GROUP_WIDTH * SWISS_TABLE_GROUP_WIDTH;
+    swiss_table_mask_t full = swiss_table_match_full(table->control + group);
+    // Ignore the slots of the group that were already visited.
+    full &= ~(swiss_table_mask_t)0 << ((iterator->index - group) << SWISS_TABLE_MASK_SHIFT);
+    if (full) {
+      size_t index = group + swiss_table_lowest(full);
+      iterator->index = index + 1;
+      *key = table->slots[index].key;
+#ifdef V
+      *value = table->slots[index].value;
+#endif
+      return true;
+    }
+    iterator->index = group + SWISS_TABLE_GROUP_WIDTH;
+  }
+  return false;
+}
+
+/**
+ * @brief Remove some key from the table and store it in `key`.
+ * @ingroup Utilities
+ *
+ * This is cheaper than finding the first key with an iterator and removing it by value.
+ * @return false if the table is empty.
+ */
+static inline bool SWISS_TABLE(remove_any)(SWISS_TABLE(t) * table, K* key) {
+  if (table->size == 0)
+    return false;
+  for (size_t group = 0;; group += SWISS_TABLE_GROUP_WIDTH) {
+    swiss_table_mask_t full = swiss_table_match_full(table->control + group);
+    if (full) {
+      size_t index = group + swiss_table_lowest(full);
+      *key = table->slots[index].key;
+      SWISS_TABLE(remove_at)(table, index);
+      return true;
+    }
+  }
+}
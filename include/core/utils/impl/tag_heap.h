@@ -0,0 +1,38 @@
+/**
+ * @file tag_heap.h
+ * @brief Defines a heap type that orders pointers to pqueue_tag_element_t by tag.
+ * @ingroup Utilities
+ *
+ * To use this:
+ * ```c
+ * #include "core/utils/impl/tag_heap.h"
+ * ```
+ * To create a new heap:
+ * ```c
+ * tag_heap_t heap;
+ * tag_heap_initialize(&heap, CAPACITY);
+ * ```
+ * To insert an element, pass a copy of its tag:
+ * ```c
+ * tag_heap_insert(&heap, element->tag, element);
+ * ```
+ * The heap keeps the `pos` field of each element up to date, so an element can be removed
+ * with `tag_heap_remove_at(&heap, element->pos)`.
+ *
+ * See @ref heap.h for documentation on how to declare other heap types.
+ */
+
+#include "pqueue_tag.h"
+#include "tag_inline.h"
+
+#define HEAP(token) tag_heap##_##token
+#define K tag_t
+#define E pqueue_tag_element_t*
+#define KEY_LESS(a, b) lf_tag_less(a, b)
+#define SET_POSITION(element, position) ((element)->pos = (position))
+#include "heap.h"
+#undef HEAP
+#undef K
+#undef E
+#undef KEY_LESS
+#undef SET_POSITION
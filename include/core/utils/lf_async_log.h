@@ -0,0 +1,86 @@
+/**
+ * @file lf_async_log.h
+ *
+ * @brief Asynchronous backend for the lf_print functions.
+ * @ingroup Utilities
+ *
+ * Once started, messages printed with lf_print(), lf_print_log(), and the like are no longer
+ * written to stdout by the thread that prints them. Instead, each thread formats its messages
+ * into a ring buffer of its own, without locking, and a background thread writes them out in
+ * the order of their timestamps. This keeps stdio locking and blocking writes off the workers.
+ *
+ * The backend plugs in through lf_register_print_function(). Messages longer than
+ * LF_ASYNC_LOG_MESSAGE_SIZE are truncated. Each thread buffers up to LF_ASYNC_LOG_SLOTS
+ * messages. When its buffer is full, a thread either drops the message or waits for the
+ * background thread, depending on the overflow policy given to lf_async_log_start().
+ *
+ * A program built with `LF_ASYNC_LOG` defined starts the backend before it initializes its
+ * reactors and stops it at termination. With `LF_ASYNC_LOG=1`, a thread whose buffer is full
+ * waits, and with `LF_ASYNC_LOG=2`, it drops the message. A program can also call
+ * lf_async_log_start() and lf_async_log_stop() itself.
+ */
+
+#ifndef LF_ASYNC_LOG_H
+#define LF_ASYNC_LOG_H
+
+#include <stdint.h>
+
+#include "low_level_platform.h"
+
+/** Number of messages that each thread can buffer. */
+#ifndef LF_ASYNC_LOG_SLOTS
+#define LF_ASYNC_LOG_SLOTS 128
+#endif
+
+/** Maximum length of a formatted message, including the terminating newline. */
+#ifndef LF_ASYNC_LOG_MESSAGE_SIZE
+#define LF_ASYNC_LOG_MESSAGE_SIZE 256
+#endif
+
+/** Longest interval at which the background thread looks for messages when it has nothing to write. */
+#ifndef LF_ASYNC_LOG_POLL_INTERVAL
+#define LF_ASYNC_LOG_POLL_INTERVAL MSEC(1)
+#endif
+
+/**
+ * @brief What a thread does with a message when its buffer is full.
+ * @ingroup Utilities
+ */
+typedef enum {
+  /** Discard the message and count it. The count is reported by the background thread. */
+  LF_ASYNC_LOG_DROP,
+  /** Wait until the background thread has made room. */
+  LF_ASYNC_LOG_BLOCK
+} lf_async_log_overflow_t;
+
+/**
+ * @brief Start writing messages asynchronously.
+ * @ingroup Utilities
+ *
+ * This starts the background thread and registers the asynchronous print function for
+ * messages up to the given level. The remaining messages are flushed at exit.
+ * Calling this while asynchronous logging is running has no effect.
+ *
+ * @param log_level The level of messages to print, as for lf_register_print_function().
+ * @param overflow What to do when a thread's buffer is full.
+ * @return 0 on success, or a nonzero value if the background thread could not be created.
+ */
+int lf_async_log_start(int log_level, lf_async_log_overflow_t overflow);
+
+/**
+ * @brief Write out all buffered messages, stop the background thread, and revert to
+ * the print function that was registered before lf_async_log_start().
+ * @ingroup Utilities
+ *
+ * This frees the buffers of all threads. Threads that print while this runs print directly.
+ */
+void lf_async_log_stop(void);
+
+/**
+ * @brief Return the number of messages dropped because a thread's buffer was full
+ * since the program started.
+ * @ingroup Utilities
+ */
+int64_t lf_async_log_dropped(void);
+
+#endif // LF_ASYNC_LOG_H
@@ -72,4 +72,71 @@ void set_reaction_position(void* reaction, size_t pos);
  */
 void print_reaction(void* reaction);
 
+/**
+ * @brief Type of a queue of reactions that is sorted by reaction index, least index first.
+ * @ingroup Internal
+ *
+ * If the runtime is built with `LF_INLINE_KEY_QUEUES`, this is an opaque 4-ary heap that
+ * stores a copy of each reaction's index next to the reaction pointer (see impl/reaction_heap.h).
+ * Otherwise, it is a pqueue_t that uses the callback functions declared above.
+ */
+#if defined(LF_INLINE_KEY_QUEUES)
+typedef struct pqueue_reaction_t pqueue_reaction_t;
+#else
+typedef pqueue_t pqueue_reaction_t;
+#endif
+
+/**
+ * @brief Create a queue of reactions sorted by index.
+ * @ingroup Internal
+ * The caller should call pqueue_reaction_free() when finished with the queue.
+ * @param initial_size The initial size of the queue.
+ * @return A dynamically allocated queue or NULL if memory allocation fails.
+ */
+pqueue_reaction_t* pqueue_reaction_init(size_t initial_size);
+
+/**
+ * @brief Free all memory used by the queue, but not the reactions.
+ * @ingroup Internal
+ * @param q The queue.
+ */
+void pqueue_reaction_free(pqueue_reaction_t* q);
+
+/**
+ * @brief Return the number of reactions in the queue.
+ * @ingroup Internal
+ * @param q The queue.
+ */
+size_t pqueue_reaction_size(pqueue_reaction_t* q);
+
+/**
+ * @brief Insert a reaction into the queue.
+ * @ingroup Internal
+ * @param q The queue.
+ * @param reaction A pointer to a reaction_t.
+ * @return 0 on success.
+ */
+int pqueue_reaction_insert(pqueue_reaction_t* q, void* reaction);
+
+/**
+ * @brief Return the reaction with the least index without removing it, or NULL if the queue is empty.
+ * @ingroup Internal
+ * @param q The queue.
+ */
+void* pqueue_reaction_peek(pqueue_reaction_t* q);
+
+/**
+ * @brief Remove and return the reaction with the least index, or return NULL if the queue is empty.
+ * @ingroup Internal
+ * @param q The queue.
+ */
+void* pqueue_reaction_pop(pqueue_reaction_t* q);
+
+/**
+ * @brief Print the queue's internal structure if logging is set to DEBUG.
+ * @ingroup Internal
+ * @param q The queue.
+ */
+void pqueue_reaction_dump(pqueue_reaction_t* q);
+
 #endif /* PQUEUE_H */
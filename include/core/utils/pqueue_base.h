@@ -194,6 +194,18 @@ size_t pqueue_size(pqueue_t* q);
  */
 int pqueue_insert(pqueue_t* q, void* d);
 
+/**
+ * @brief Insert several elements into the queue at once.
+ * @ingroup Internal
+ * Depending on how many elements are added relative to the size of the queue,
+ * this either bubbles up each new element or rebuilds the heap in linear time.
+ * @param q The queue
+ * @param d The array of data to insert
+ * @param n The number of elements in d
+ * @return 0 on success
+ */
+int pqueue_insert_all(pqueue_t* q, void** d, size_t n);
+
 /**
  * @brief Pop the highest-ranking item from the queue.
  * @ingroup Internal
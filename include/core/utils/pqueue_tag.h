@@ -85,8 +85,18 @@ typedef struct {
 /**
  * @brief Type of a priority queue sorted by tags.
  * @ingroup Internal
+ *
+ * If the runtime is built with `LF_INLINE_KEY_QUEUES`, this is instead an opaque 4-ary heap
+ * that stores a copy of each element's tag next to the element pointer (see impl/tag_heap.h),
+ * so that comparisons neither go through function pointers nor dereference the elements.
+ * In that case, the comparison function given to pqueue_tag_init_customize() must be either
+ * pqueue_tag_compare() or in_no_particular_order().
  */
+#if defined(LF_INLINE_KEY_QUEUES)
+typedef struct pqueue_tag_t pqueue_tag_t;
+#else
 typedef pqueue_t pqueue_tag_t;
+#endif
 
 /**
  * @brief Callback comparison function for the tag-based priority queue.
@@ -148,6 +158,18 @@ size_t pqueue_tag_size(pqueue_tag_t* q);
  */
 int pqueue_tag_insert(pqueue_tag_t* q, pqueue_tag_element_t* d);
 
+/**
+ * @brief Insert an array of elements into the queue.
+ * @ingroup Internal
+ * This is cheaper than inserting the elements one by one when their number
+ * is large compared to the size of the queue.
+ * @param q The queue.
+ * @param d The elements to insert.
+ * @param n The number of elements.
+ * @return 0 on success
+ */
+int pqueue_tag_insert_all(pqueue_tag_t* q, pqueue_tag_element_t** d, size_t n);
+
 /**
  * @brief Insert a tag into the queue.
  * @ingroup Internal
@@ -191,6 +213,17 @@ pqueue_tag_element_t* pqueue_tag_find_with_tag(pqueue_tag_t* q, tag_t t);
  */
 pqueue_tag_element_t* pqueue_tag_find_equal_same_tag(pqueue_tag_t* q, pqueue_tag_element_t* e);
 
+/**
+ * @brief Return the element at the given position in the queue's internal order.
+ * @ingroup Internal
+ * Positions from 0 up to, but not including, pqueue_tag_size() cover all elements
+ * in no particular order. Use this to inspect all elements without popping them.
+ * @param q The queue.
+ * @param i The position.
+ * @return The element at that position.
+ */
+pqueue_tag_element_t* pqueue_tag_element_at(pqueue_tag_t* q, size_t i);
+
 /**
  * @brief Return highest-ranking item (the one with the least tag) without removing it.
  * @ingroup Internal
@@ -0,0 +1,75 @@
+/**
+ * @file reaction_level_queue.h
+ *
+ * @brief Queue of reactions for the single-threaded runtime that keeps a bucket for each level.
+ * @ingroup Internal
+ *
+ * The index of a reaction holds its inferred deadline in the 48 most significant bits and its level
+ * in the 16 least significant bits (see lf_combine_deadline_and_level()), and reactions execute in
+ * the order of their index. Most reactions have no deadline, so their order only depends on their
+ * level, and this queue keeps them in one bucket per level, with a bitmap of the levels that are
+ * not empty. Inserting such a reaction and popping the reaction with the least level both take
+ * constant time. Reactions with a deadline precede all others and go to a pqueue_reaction_t.
+ *
+ * Reactions with the same index come out in no particular order, as with pqueue_reaction_t.
+ */
+
+#ifndef REACTION_LEVEL_QUEUE_H
+#define REACTION_LEVEL_QUEUE_H
+
+#include "lf_types.h"
+#include "pqueue.h"
+
+/**
+ * @brief Type of a queue of reactions that is sorted by reaction index, least index first.
+ * @ingroup Internal
+ */
+typedef struct reaction_level_queue_t reaction_level_queue_t;
+
+/**
+ * @brief Create a queue of reactions sorted by index.
+ * @ingroup Internal
+ * The caller should call reaction_level_queue_free() when finished with the queue.
+ * @param initial_size The initial number of reactions that the queue has room for at each level.
+ * @return A dynamically allocated queue or NULL if memory allocation fails.
+ */
+reaction_level_queue_t* reaction_level_queue_init(size_t initial_size);
+
+/**
+ * @brief Free all memory used by the queue, but not the reactions.
+ * @ingroup Internal
+ * @param q The queue.
+ */
+void reaction_level_queue_free(reaction_level_queue_t* q);
+
+/**
+ * @brief Return the number of reactions in the queue.
+ * @ingroup Internal
+ * @param q The queue.
+ */
+size_t reaction_level_queue_size(reaction_level_queue_t* q);
+
+/**
+ * @brief Insert a reaction into the queue.
+ * @ingroup Internal
+ * @param q The queue.
+ * @param reaction The reaction.
+ * @return 0 on success.
+ */
+int reaction_level_queue_insert(reaction_level_queue_t* q, reaction_t* reaction);
+
+/**
+ * @brief Remove and return the reaction with the least index, or return NULL if the queue is empty.
+ * @ingroup Internal
+ * @param q The queue.
+ */
+reaction_t* reaction_level_queue_pop(reaction_level_queue_t* q);
+
+/**
+ * @brief Print the reactions in the queue if logging is set to DEBUG.
+ * @ingroup Internal
+ * @param q The queue.
+ */
+void reaction_level_queue_dump(reaction_level_queue_t* q);
+
+#endif /* REACTION_LEVEL_QUEUE_H */
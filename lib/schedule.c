@@ -9,6 +9,9 @@
 #include "reactor.h"
 #include "reactor_common.h"
 #include "environment.h"
+#ifdef LF_PIPELINED_TAGS
+#include "reactor_threaded.h"
+#endif
 
 #include <assert.h>
 #include <string.h> // Defines memcpy.
@@ -53,6 +56,12 @@ trigger_handle_t lf_schedule_value(void* action, interval_t extra_delay, void* v
   } else {
     token_template_t* template = (token_template_t*)action;
     environment_t* env = ((lf_action_base_t*)action)->parent->environment;
+#if defined(LF_SCHEDULE_INBOX) && !defined(LF_SINGLE_THREADED)
+    if (((lf_action_base_t*)action)->trigger->is_physical && !_lf_termination_executed) {
+      // Use a new token so that the environment mutex is not needed.
+      return _lf_schedule_token(env, action, extra_delay, _lf_new_token_with_value(template, value, length));
+    }
+#endif
     LF_CRITICAL_SECTION_ENTER(env);
     if (_lf_termination_executed) {
       free(value);
@@ -68,6 +77,63 @@ trigger_handle_t lf_schedule_value(void* action, interval_t extra_delay, void* v
   return result;
 }
 
+trigger_handle_t lf_schedule_token_batch(void* action, lf_token_t** tokens, size_t n, const interval_t* offsets) {
+  environment_t* env = ((lf_action_base_t*)action)->parent->environment;
+  trigger_t* trigger = ((lf_action_base_t*)action)->trigger;
+  trigger_handle_t result = 0;
+  if (n == 0) {
+    return 0;
+  }
+  LF_CRITICAL_SECTION_ENTER(env);
+  if (_lf_termination_executed) {
+    // As in lf_schedule_value(), drop the events, freeing the tokens that nothing else references.
+    for (size_t i = 0; tokens != NULL && i < n; i++) {
+      _lf_free_token(tokens[i]);
+    }
+    LF_CRITICAL_SECTION_EXIT(env);
+    return 0;
+  }
+  // Read the physical time once so that the offsets determine the spacing of the events.
+  instant_t physical_time = trigger->is_physical ? lf_time_physical() : NEVER;
+  for (size_t i = 0; i < n; i++) {
+    lf_token_t* token = (tokens == NULL) ? NULL : tokens[i];
+    interval_t offset = (offsets == NULL) ? 0 : offsets[i];
+    result = lf_schedule_trigger_at_physical_time(env, trigger, offset, token, physical_time);
+  }
+  // Notify the main thread in case it is waiting for physical time to elapse.
+  lf_notify_of_event(env);
+  LF_CRITICAL_SECTION_EXIT(env);
+  return result;
+}
+
+trigger_handle_t lf_schedule_batch(void* action, const void* values, size_t n, const interval_t* offsets) {
+  if (values == NULL) {
+    return lf_schedule_token_batch(action, NULL, n, offsets);
+  }
+  token_template_t* template = (token_template_t*)action;
+  size_t element_size = template->type.element_size;
+  if (element_size == 0) {
+    lf_print_error("schedule_batch: Invalid element size.");
+    return -1;
+  }
+  if (n == 0) {
+    return 0;
+  }
+  // Copy the values into new tokens before acquiring the mutex. New tokens are used
+  // because the token in the template can only be reused while holding the mutex.
+  lf_token_t** tokens = (lf_token_t**)malloc(n * sizeof(lf_token_t*));
+  LF_ASSERT_NON_NULL(tokens);
+  for (size_t i = 0; i < n; i++) {
+    void* copy = malloc(element_size);
+    LF_ASSERT_NON_NULL(copy);
+    memcpy(copy, (const char*)values + i * element_size, element_size);
+    tokens[i] = _lf_new_token_with_value(template, copy, 1);
+  }
+  trigger_handle_t result = lf_schedule_token_batch(action, tokens, n, offsets);
+  free(tokens);
+  return result;
+}
+
 /**
  * Check the deadline of the currently executing reaction against the
  * current physical time. If the deadline has passed, invoke_deadline_handler parameter is set true,
@@ -101,17 +167,23 @@ void lf_update_deadline(void* self, interval_t updated_deadline) {
 
 trigger_handle_t lf_schedule_trigger(environment_t* env, trigger_t* trigger, interval_t extra_delay,
                                      lf_token_t* token) {
+  return lf_schedule_trigger_at_physical_time(env, trigger, extra_delay, token, NEVER);
+}
+
+trigger_handle_t lf_schedule_trigger_at_physical_time(environment_t* env, trigger_t* trigger, interval_t extra_delay,
+                                                      lf_token_t* token, instant_t physical_time) {
   assert(env != GLOBAL_ENVIRONMENT);
   if (lf_is_tag_after_stop_tag(env, env->current_tag)) {
     // If schedule is called after stop_tag
     // This is a critical condition.
     _lf_done_using(token);
-    lf_print_warning("lf_schedule() called after stop tag.");
+    LF_PRINT_WARNING_RATELIMITED("lf_schedule() called after stop tag.");
     return 0;
   }
 
   if (extra_delay < 0LL) {
-    lf_print_warning("schedule called with a negative extra_delay " PRINTF_TIME ". Replacing with zero.", extra_delay);
+    LF_PRINT_WARNING_RATELIMITED("schedule called with a negative extra_delay " PRINTF_TIME ". Replacing with zero.",
+                                 extra_delay);
     extra_delay = 0LL;
   }
 
@@ -141,7 +213,9 @@ trigger_handle_t lf_schedule_trigger(environment_t* env, trigger_t* trigger, int
   if (!trigger->is_timer) {
     delay += trigger->offset;
   }
-  tag_t intended_tag = lf_delay_tag(env->current_tag, delay);
+  // With pipelined tags, a reaction may execute at a tag earlier than the current tag of the environment.
+  tag_t reaction_tag = lf_tag(env);
+  tag_t intended_tag = lf_delay_tag(reaction_tag, delay);
 
   LF_PRINT_DEBUG("lf_schedule_trigger: env->current_tag = " PRINTF_TAG ". Total logical delay = " PRINTF_TIME "",
                  env->current_tag.time, env->current_tag.microstep, delay);
@@ -160,14 +234,29 @@ trigger_handle_t lf_schedule_trigger(environment_t* env, trigger_t* trigger, int
   // physical time is larger than the intended time and, if so,
   // modify the intended time.
   if (trigger->is_physical) {
-    // Get the current physical time and assign it as the intended time.
-    intended_tag.time = lf_time_physical() + delay;
+    // If the physical time at which the action was scheduled is given, use it unless
+    // the current tag has already passed it. In that case, the action is treated as if
+    // it had been scheduled now, which avoids piling up events in superdense time.
+    if (physical_time == NEVER || lf_time_add(physical_time, delay) < env->current_tag.time) {
+      // Get the current physical time and assign it as the intended time.
+      intended_tag.time = lf_time_physical() + delay;
+    } else {
+      intended_tag.time = physical_time + delay;
+    }
     if (intended_tag.time < env->start_tag.time) {
       // A physical action should never be assigned a time earlier than the start time.
       intended_tag.time = env->start_tag.time;
     }
     intended_tag.microstep = 0;
   } else {
+#ifdef LF_PIPELINED_TAGS
+    // Only the reactions that the scheduler holds the tag back for are sure to execute at the newest tag.
+    // Any other reaction may execute at an earlier tag, so its event could be at a tag that has already started.
+    if (!trigger->is_timer && _lf_worker_in_reaction() && !_lf_worker_may_schedule_actions()) {
+      lf_print_error_and_exit("With pipelined tags, a reaction that schedules a logical action must be one of the "
+                              "scheduling_reactions in sched_params_t.");
+    }
+#endif
 // FIXME: We need to verify that we are executing within a reaction?
 // See reactor_threaded.
 // If a logical action is scheduled asynchronously (which should never be
@@ -178,9 +267,9 @@ trigger_handle_t lf_schedule_trigger(environment_t* env, trigger_t* trigger, int
 // - we detect the asynchronous use of logical actions
 #ifndef NDEBUG
     if (intended_tag.time < env->current_tag.time) {
-      lf_print_warning("Attempting to schedule an event earlier than current time by " PRINTF_TIME " nsec! "
-                       "Revising to the current time " PRINTF_TIME ".",
-                       env->current_tag.time - intended_tag.time, env->current_tag.time);
+      LF_PRINT_WARNING_RATELIMITED("Attempting to schedule an event earlier than current time by " PRINTF_TIME " nsec! "
+                                   "Revising to the current time " PRINTF_TIME ".",
+                                   env->current_tag.time - intended_tag.time, env->current_tag.time);
       intended_tag.time = env->current_tag.time;
     }
 #endif
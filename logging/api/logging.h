@@ -14,6 +14,7 @@
 #define LOGGING_H
 
 #include <stdarg.h>
+#include <stdint.h>
 
 // To silence warnings about a function being a candidate for format checking
 // with gcc, add an attribute.
@@ -180,6 +181,21 @@ void lf_print_error_and_exit(const char* format, ...) ATTRIBUTE_FORMAT_PRINTF(1,
  */
 void lf_print_error_system_failure(const char* format, ...);
 
+/// \cond INTERNAL
+/**
+ * @brief Count an occurrence of a rate-limited message and decide whether to print it.
+ *
+ * This is used by LF_PRINT_WARNING_RATELIMITED. The first `burst` occurrences are printed.
+ * After that, an occurrence is printed only if its count is a power of two.
+ *
+ * @param count The occurrence counter of the call site, incremented atomically.
+ * @param burst The number of occurrences to print before thinning out.
+ * @return -1 if this occurrence should be suppressed, otherwise the number of occurrences
+ * suppressed since the last printed one.
+ */
+int64_t _lf_print_ratelimit(int64_t* count, int burst);
+/// \endcond
+
 /**
  * @brief Message print function type.
  * @ingroup API
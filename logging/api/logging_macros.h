@@ -12,6 +12,7 @@
 #define LOGGING_MACROS_H
 #include "logging.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /** Default log level. */
 #ifndef LOG_LEVEL
@@ -34,20 +35,21 @@ static const bool _lf_log_level_is_debug = LOG_LEVEL >= LOG_LEVEL_DEBUG;
  * The input to this macro is exactly like printf: (format, ...).
  * "LOG: " is prepended to the beginning of the message and a newline is appended to the end of the message.
  *
- * @note This macro is non-empty even if LOG_LEVEL is not defined in
- * user-code. This is to ensure that the compiler will still parse
- * the predicate inside (...) to prevent LF_PRINT_LOG statements
- * to fall out of sync with the rest of the code. This should have
- * a negligible impact on performance if compiler optimization
- * (e.g., -O2 for gcc) is used as long as the arguments passed to
- * it do not themselves incur significant overhead to evaluate.
+ * @note If LOG_LEVEL is below LOG_LEVEL_LOG, this macro generates no code at any optimization
+ * level and its arguments are not evaluated. The call is still compiled as the operand of
+ * `sizeof` so that LF_PRINT_LOG statements are type and format checked and do not fall out
+ * of sync with the rest of the code.
  */
+#if LOG_LEVEL >= LOG_LEVEL_LOG
 #define LF_PRINT_LOG(format, ...)                                                                                      \
   do {                                                                                                                 \
     if (_lf_log_level_is_log) {                                                                                        \
       lf_print_log(format, ##__VA_ARGS__);                                                                             \
     }                                                                                                                  \
   } while (0)
+#else
+#define LF_PRINT_LOG(format, ...) (void)sizeof((lf_print_log(format, ##__VA_ARGS__), 0))
+#endif
 
 /**
  * @brief A macro used to print useful debug information.
@@ -61,20 +63,51 @@ static const bool _lf_log_level_is_debug = LOG_LEVEL >= LOG_LEVEL_DEBUG;
  * "DEBUG: " is prepended to the beginning of the message
  * and a newline is appended to the end of the message.
  *
- * @note This macro is non-empty even if LOG_LEVEL is not defined in
- * user-code. This is to ensure that the compiler will still parse
- * the predicate inside (...) to prevent LF_PRINT_DEBUG statements
- * to fall out of sync with the rest of the code. This should have
- * a negligible impact on performance if compiler optimization
- * (e.g., -O2 for gcc) is used as long as the arguments passed to
- * it do not themselves incur significant overhead to evaluate.
+ * @note If LOG_LEVEL is below LOG_LEVEL_DEBUG, this macro generates no code at any optimization
+ * level and its arguments are not evaluated, as for @ref LF_PRINT_LOG.
  */
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
 #define LF_PRINT_DEBUG(format, ...)                                                                                    \
   do {                                                                                                                 \
     if (_lf_log_level_is_debug) {                                                                                      \
       lf_print_debug(format, ##__VA_ARGS__);                                                                           \
     }                                                                                                                  \
   } while (0)
+#else
+#define LF_PRINT_DEBUG(format, ...) (void)sizeof((lf_print_debug(format, ##__VA_ARGS__), 0))
+#endif
+
+/**
+ * @brief Number of times that a rate-limited message is printed before it is thinned out.
+ * @ingroup API
+ *
+ * @see LF_PRINT_WARNING_RATELIMITED
+ */
+#ifndef LF_PRINT_RATELIMIT_BURST
+#define LF_PRINT_RATELIMIT_BURST 10
+#endif
+
+/**
+ * @brief A macro used to print a warning that may be reported very often, for example in a loop.
+ * @ingroup API
+ *
+ * Each use of this macro keeps its own count of how often it has been reached.
+ * The first LF_PRINT_RATELIMIT_BURST occurrences are printed like @ref lf_print_warning.
+ * After that, only the occurrences whose count is a power of two are printed, and the
+ * number of occurrences suppressed since the last printed one is appended to the message.
+ * The arguments of suppressed occurrences are not evaluated.
+ * The input to this macro is exactly like printf: (format, ...).
+ */
+#define LF_PRINT_WARNING_RATELIMITED(format, ...)                                                                      \
+  do {                                                                                                                 \
+    static int64_t _lf_ratelimit_count = 0;                                                                            \
+    int64_t _lf_suppressed = _lf_print_ratelimit(&_lf_ratelimit_count, LF_PRINT_RATELIMIT_BURST);                      \
+    if (_lf_suppressed == 0) {                                                                                         \
+      lf_print_warning(format, ##__VA_ARGS__);                                                                         \
+    } else if (_lf_suppressed > 0) {                                                                                   \
+      lf_print_warning(format " (%lld similar warnings suppressed)", ##__VA_ARGS__, (long long)_lf_suppressed);        \
+    }                                                                                                                  \
+  } while (0)
 
 #if defined(NDEBUG)
 #define LF_ASSERT(condition, format, ...) (void)(condition)
@@ -194,6 +194,17 @@ typedef struct {
  */
 int lf_thread_set_cpu(lf_thread_t thread, size_t cpu_number);
 
+/**
+ * @brief Get the CPUs that belong to a NUMA node.
+ * @ingroup Platform
+ *
+ * @param node The NUMA node.
+ * @param cpus The array into which to write the CPU IDs.
+ * @param max_cpus The capacity of the array.
+ * @return The number of CPU IDs written, or -1 if NUMA information is not available.
+ */
+int lf_numa_node_cpus(int node, size_t* cpus, size_t max_cpus);
+
 /**
  * @brief Set the priority of a thread.
  * @ingroup Platform
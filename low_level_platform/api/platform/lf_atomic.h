@@ -35,6 +35,16 @@ int lf_atomic_fetch_add(int* ptr, int val);
  */
 int64_t lf_atomic_fetch_add64(int64_t* ptr, int64_t val);
 
+/**
+ * @brief Atomically fetch 64-bit unsigned integer from memory and bitwise or a value into it.
+ * Return the value that was previously in memory.
+ *
+ * @param ptr A pointer to the memory location.
+ * @param val The bits to be set.
+ * @return The value previously in memory.
+ */
+uint64_t lf_atomic_fetch_or64(uint64_t* ptr, uint64_t val);
+
 /**
  * @brief Atomically fetch an integer from memory and add a value to it.
  * Return the new value of the memory.
@@ -105,4 +115,16 @@ int lf_atomic_val_compare_and_swap(int* ptr, int oldval, int newval);
  */
 int64_t lf_atomic_val_compare_and_swap64(int64_t* ptr, int64_t oldval, int64_t newval);
 
+/**
+ * @brief Atomically perform a compare-and-swap operation on a pointer in
+ * memory. If the value in memory is equal to `oldval` replace it with `newval`.
+ * Return the content of the memory before the potential swap operation is
+ * performed.
+ * @param ptr A pointer to the memory location.
+ * @param oldval The value to compare with.
+ * @param newval The value to swap in.
+ * @return The value in memory prior to the swap.
+ */
+void* lf_atomic_val_compare_and_swap_ptr(void** ptr, void* oldval, void* newval);
+
 #endif
@@ -9,9 +9,23 @@
 #ifndef LF_PLATFORM_UTIL_H
 #define LF_PLATFORM_UTIL_H
 
+#include <stddef.h>
+
 /**
  * @brief Maps a priority into a destination priority range.
  */
 int map_priorities(int priority, int dest_min, int dest_max);
 
+/**
+ * @brief Parse a CPU list such as "0-3,8,10-11" into an array of CPU numbers.
+ *
+ * This is the format used by Linux in, e.g., /sys/devices/system/node/node0/cpulist
+ * and by `taskset -c`. CPUs beyond `max_cpus` are silently dropped.
+ * @param spec The CPU list.
+ * @param cpus The array into which to write the CPU numbers.
+ * @param max_cpus The capacity of the array.
+ * @return The number of CPU numbers written, or -1 if the list is malformed.
+ */
+int lf_parse_cpu_list(const char* spec, size_t* cpus, size_t max_cpus);
+
 #endif
\ No newline at end of file
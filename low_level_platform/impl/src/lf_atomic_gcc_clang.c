@@ -13,6 +13,7 @@
 
 int lf_atomic_fetch_add(int* ptr, int value) { return __sync_fetch_and_add(ptr, value); }
 int64_t lf_atomic_fetch_add64(int64_t* ptr, int64_t value) { return __sync_fetch_and_add(ptr, value); }
+uint64_t lf_atomic_fetch_or64(uint64_t* ptr, uint64_t value) { return __sync_fetch_and_or(ptr, value); }
 int lf_atomic_add_fetch(int* ptr, int value) { return __sync_add_and_fetch(ptr, value); }
 int64_t lf_atomic_add_fetch64(int64_t* ptr, int64_t value) { return __sync_add_and_fetch(ptr, value); }
 bool lf_atomic_bool_compare_and_swap(int* ptr, int oldval, int newval) {
@@ -27,6 +28,9 @@ int lf_atomic_val_compare_and_swap(int* ptr, int oldval, int newval) {
 int64_t lf_atomic_val_compare_and_swap64(int64_t* ptr, int64_t oldval, int64_t newval) {
   return __sync_val_compare_and_swap(ptr, oldval, newval);
 }
+void* lf_atomic_val_compare_and_swap_ptr(void** ptr, void* oldval, void* newval) {
+  return __sync_val_compare_and_swap(ptr, oldval, newval);
+}
 
 #endif
 #endif
@@ -34,6 +34,14 @@ int64_t lf_atomic_fetch_add64(int64_t* ptr, int64_t value) {
   return res;
 }
 
+uint64_t lf_atomic_fetch_or64(uint64_t* ptr, uint64_t value) {
+  lf_disable_interrupts_nested();
+  uint64_t res = *ptr;
+  *ptr |= value;
+  lf_enable_interrupts_nested();
+  return res;
+}
+
 int lf_atomic_add_fetch(int* ptr, int value) {
   lf_disable_interrupts_nested();
   int res = *ptr + value;
@@ -92,4 +100,14 @@ int64_t lf_atomic_val_compare_and_swap64(int64_t* ptr, int64_t oldval, int64_t n
   return res;
 }
 
+void* lf_atomic_val_compare_and_swap_ptr(void** ptr, void* oldval, void* newval) {
+  lf_disable_interrupts_nested();
+  void* res = *ptr;
+  if ((*ptr) == oldval) {
+    *ptr = newval;
+  }
+  lf_enable_interrupts_nested();
+  return res;
+}
+
 #endif
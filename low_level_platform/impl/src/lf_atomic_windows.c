@@ -11,6 +11,9 @@
 
 int lf_atomic_fetch_add(int* ptr, int value) { return InterlockedExchangeAdd((LONG*)ptr, (LONG)value); }
 int64_t lf_atomic_fetch_add64(int64_t* ptr, int64_t value) { return InterlockedExchangeAdd64(ptr, value); }
+uint64_t lf_atomic_fetch_or64(uint64_t* ptr, uint64_t value) {
+  return (uint64_t)InterlockedOr64((LONG64*)ptr, (LONG64)value);
+}
 int lf_atomic_add_fetch(int* ptr, int value) { return InterlockedAdd((LONG*)ptr, (LONG)value); }
 int64_t lf_atomic_add_fetch64(int64_t* ptr, int64_t value) { return InterlockedAdd64(ptr, value); }
 bool lf_atomic_bool_compare_and_swap(int* ptr, int oldval, int newval) {
@@ -25,4 +28,7 @@ int lf_atomic_val_compare_and_swap(int* ptr, int oldval, int newval) {
 int64_t lf_atomic_val_compare_and_swap64(int64_t* ptr, int64_t oldval, int64_t newval) {
   return InterlockedCompareExchange64(ptr, newval, oldval);
 }
+void* lf_atomic_val_compare_and_swap_ptr(void** ptr, void* oldval, void* newval) {
+  return InterlockedCompareExchangePointer(ptr, newval, oldval);
+}
 #endif
@@ -16,6 +16,7 @@
 #include "platform/lf_platform_util.h"
 #include "low_level_platform.h"
 
+#include <stdio.h>
 #include "platform/lf_unix_clock_support.h"
 
 #if defined LF_SINGLE_THREADED
@@ -32,6 +33,22 @@ int lf_thread_set_cpu(lf_thread_t thread, size_t cpu_number) {
   return pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set);
 }
 
+int lf_numa_node_cpus(int node, size_t* cpus, size_t max_cpus) {
+  char path[64];
+  char cpulist[1024];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    return -1;
+  }
+  char* line = fgets(cpulist, sizeof(cpulist), file);
+  fclose(file);
+  if (line == NULL) {
+    return -1;
+  }
+  return lf_parse_cpu_list(cpulist, cpus, max_cpus);
+}
+
 int lf_thread_set_priority(lf_thread_t thread, int priority) {
   int posix_policy, min_pri, max_pri, final_priority, res;
   struct sched_param schedparam;
@@ -23,6 +23,8 @@
  */
 int lf_thread_set_cpu(lf_thread_t thread, size_t cpu_number) { return -1; }
 
+int lf_numa_node_cpus(int node, size_t* cpus, size_t max_cpus) { return -1; }
+
 int lf_thread_set_priority(lf_thread_t thread, int priority) { return -1; }
 
 int lf_thread_set_scheduling_policy(lf_thread_t thread, lf_scheduling_policy_t* policy) { return -1; }
@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include "low_level_platform.h"
 #include "platform/lf_platform_util.h"
 
@@ -13,6 +14,40 @@ int map_priorities(int priority, int dest_min, int dest_max) {
                      (LF_SCHED_MAX_PRIORITY - LF_SCHED_MIN_PRIORITY));
 }
 
+int lf_parse_cpu_list(const char* spec, size_t* cpus, size_t max_cpus) {
+  if (spec == NULL) {
+    return -1;
+  }
+  size_t count = 0;
+  const char* p = spec;
+  while (*p != '\0' && *p != '\n') {
+    char* end;
+    unsigned long first = strtoul(p, &end, 10);
+    if (end == p) {
+      return -1;
+    }
+    unsigned long last = first;
+    p = end;
+    if (*p == '-') {
+      p++;
+      last = strtoul(p, &end, 10);
+      if (end == p || last < first) {
+        return -1;
+      }
+      p = end;
+    }
+    for (unsigned long cpu = first; cpu <= last && count < max_cpus; cpu++) {
+      cpus[count++] = (size_t)cpu;
+    }
+    if (*p == ',') {
+      p++;
+    } else if (*p != '\0' && *p != '\n') {
+      return -1;
+    }
+  }
+  return (int)count;
+}
+
 #if !defined(PLATFORM_ZEPHYR) && !defined(PLATFORM_PATMOS) // on Zephyr and PATMOS, this is handled separately
 #ifndef LF_SINGLE_THREADED
 static int _lf_worker_thread_count = 0;
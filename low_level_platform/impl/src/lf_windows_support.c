@@ -183,6 +183,13 @@ int lf_thread_set_cpu(lf_thread_t thread, size_t cpu_number) {
   return -1;
 }
 
+int lf_numa_node_cpus(int node, size_t* cpus, size_t max_cpus) {
+  (void)node;     // Suppress unused variable warning.
+  (void)cpus;     // Suppress unused variable warning.
+  (void)max_cpus; // Suppress unused variable warning.
+  return -1;
+}
+
 int lf_thread_set_priority(lf_thread_t thread, int priority) {
   (void)thread;   // Suppress unused variable warning.
   (void)priority; // Suppress unused variable warning.
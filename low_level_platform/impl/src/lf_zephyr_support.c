@@ -149,6 +149,11 @@ lf_thread_t lf_thread_self() { return k_current_get(); }
 
 int lf_thread_set_cpu(lf_thread_t thread, size_t cpu_number) { return k_thread_cpu_pin(thread, cpu_number); }
 
+/**
+ * NUMA is not supported on Zephyr.
+ */
+int lf_numa_node_cpus(int node, size_t* cpus, size_t max_cpus) { return -1; }
+
 /**
  * Real-time scheduling API
  */
@@ -10,6 +10,7 @@
  * This file defines the core time and tag types and operations used throughout
  * the Lingua Franca runtime. It provides functions for manipulating logical and
  * physical time, as well as the tag structure that combines time with microsteps.
+ * Inline versions of the tag arithmetic for hot paths are in tag_inline.h.
  */
 
 #ifndef TAG_H
@@ -22,11 +22,21 @@ endfunction()
 
 # Add the appropriate directories for the provided build parameters.
 add_test_dir(${TEST_DIR}/general)
+# The test util/X_test.c is built with util/X.c.
+add_test_dir(${TEST_DIR}/util)
 if(NUMBER_OF_WORKERS)
     if (${CMAKE_SYSTEM_NAME} STREQUAL "Linux")
       add_test_dir(${TEST_DIR}/scheduling)
     endif()
 endif(NUMBER_OF_WORKERS)
+# Tests of the dataflow scheduler need the runtime to be built with it.
+if(SCHEDULER STREQUAL "SCHED_DATAFLOW")
+    add_test_dir(${TEST_DIR}/dataflow)
+endif()
+# Tests of the adaptive scheduler need the runtime to be built with it.
+if(SCHEDULER STREQUAL "SCHED_ADAPTIVE")
+    add_test_dir(${TEST_DIR}/adaptive)
+endif()
 
 # Create executables for each test.
 foreach(FILE ${TEST_FILES})
@@ -41,6 +51,14 @@ foreach(FILE ${TEST_FILES})
         ${CoreLib} ${Lib}
     )
     target_include_directories(${NAME} PRIVATE ${TEST_DIR})
+    if(FILE MATCHES "^util/")
+        string(REGEX REPLACE "^util/(.*)_${TEST_SUFFIX}$" "\\1" UTIL ${FILE})
+        target_sources(${NAME} PRIVATE ${LF_ROOT}/util/${UTIL}.c)
+        # The utilities include headers of the runtime by their path in its source tree, as generated code does.
+        target_include_directories(${NAME} PRIVATE ${LF_ROOT}/util ${LF_ROOT})
+    endif()
     # Warnings as errors
     lf_enable_compiler_warnings(${NAME})
+    # Tests that check with assert() must check in release builds too.
+    target_compile_options(${NAME} PRIVATE -UNDEBUG)
 endforeach(FILE ${TEST_FILES})
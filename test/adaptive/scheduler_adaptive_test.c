@@ -0,0 +1,88 @@
+/**
+ * This tests the profile in which the adaptive scheduler keeps what it has learned across runs.
+ * The scheduler loads the section of its environment from the file given by `--sched-profile`
+ * when it is initialized and saves it when it is freed, keeping the sections of other
+ * environments, and it ignores profiles that are malformed or made for another program.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "environment.h"
+#include "reactor_threaded.h"
+#include "scheduler.h"
+#include "util.h"
+
+#if SCHEDULER != SCHED_ADAPTIVE
+#error scheduler_adaptive_test.c should only be compiled with SCHEDULER=SCHED_ADAPTIVE
+#endif
+
+#define PROFILE "scheduler_adaptive_test.profile"
+#define WORKERS 2
+#define LEVELS 2
+
+/** A section for another environment, with three levels and one worker. */
+#define OTHER_SECTION "env other 3 1\n1 7\n1 8\n1 0\n"
+/** A section for this environment, in the format in which the scheduler saves it. */
+#define MAIN_SECTION "env main 2 2\n1 500 0\n2 900 400\n"
+
+static void write_profile(const char* contents) {
+  FILE* file = fopen(PROFILE, "w");
+  LF_TEST(file != NULL, "Could not create the profile.");
+  fputs(contents, file);
+  fclose(file);
+}
+
+/** Return whether the profile holds exactly the given contents. */
+static bool profile_is(const char* contents) {
+  char buffer[1024];
+  FILE* file = fopen(PROFILE, "r");
+  LF_TEST(file != NULL, "The profile is missing.");
+  size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+  fclose(file);
+  buffer[length] = '\0';
+  return strcmp(buffer, contents) == 0;
+}
+
+/** Initialize a scheduler for an environment named main, which loads the profile, then free it, which saves it. */
+static void run_scheduler(void) {
+  // Each run needs a new environment, which gets a new scheduler.
+  environment_t env = {0};
+  environment_init(&env, "main", 0, WORKERS, 0, 0, 0, 0, 0, 0, 0, 0, NULL);
+  size_t reactions_per_level[LEVELS] = {1, 2};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level, .num_reactions_per_level_size = LEVELS};
+  lf_sched_init(&env, WORKERS, &params);
+  lf_sched_free(env.scheduler);
+}
+
+static void save_and_load(void) {
+  // The loaded section is saved unchanged since nothing was measured, after the section of the other environment.
+  write_profile(MAIN_SECTION OTHER_SECTION);
+  run_scheduler();
+  LF_TEST(profile_is(OTHER_SECTION MAIN_SECTION), "The profile was not saved as it was loaded.");
+  FILE* temporary = fopen(PROFILE ".tmp", "r");
+  LF_TEST(temporary == NULL, "The temporary profile was left behind.");
+  // What was saved is loaded and saved again the same way.
+  run_scheduler();
+  LF_TEST(profile_is(OTHER_SECTION MAIN_SECTION), "A saved profile was not loaded.");
+}
+
+static void profile_is_ignored(const char* contents, const char* message) {
+  // A scheduler that loads nothing and measures nothing does not save, so the file is left as it was.
+  write_profile(contents);
+  run_scheduler();
+  LF_TEST(profile_is(contents), "%s", message);
+}
+
+int main(void) {
+  lf_sched_profile = PROFILE;
+  save_and_load();
+  profile_is_ignored(OTHER_SECTION, "The section of another environment was loaded.");
+  profile_is_ignored("env main 3 2\n1 500 0\n2 900 400\n1 1 1\n", "A profile for other levels was loaded.");
+  profile_is_ignored("env main 2 4\n1 5 0 0 0\n2 9 4 0 0\n", "A profile for other workers was loaded.");
+  profile_is_ignored("env main 2 2\n1 500 0\n2 900 x\n", "A profile with a malformed time was loaded.");
+  profile_is_ignored("env main 2 2\n1 500 0\n3 900 400\n", "A profile with too many workers for a level was loaded.");
+  profile_is_ignored("env main 2 2\n1 500 -1\n2 900 400\n", "A profile with a negative time was loaded.");
+  profile_is_ignored(OTHER_SECTION "env main 2 2\n1 500\n", "A truncated profile was loaded.");
+  remove(PROFILE);
+  return 0;
+}
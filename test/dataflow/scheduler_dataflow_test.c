@@ -0,0 +1,154 @@
+/**
+ * This tests the order in which the dataflow scheduler returns reactions, with a reaction graph
+ * and, as with code generated for the other schedulers, without one.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "environment.h"
+#include "scheduler.h"
+#include "util.h"
+
+#if SCHEDULER != SCHED_DATAFLOW
+#error scheduler_dataflow_test.c should only be compiled with SCHEDULER=SCHED_DATAFLOW
+#endif
+
+#define NUMBER_OF_REACTIONS 4
+
+/** Reactions a, b, c and d of separate reactors, where a triggers b and c, which trigger d. */
+typedef struct {
+  self_base_t selves[NUMBER_OF_REACTIONS];
+  reaction_t reactions[NUMBER_OF_REACTIONS];
+  reaction_t* pointers[NUMBER_OF_REACTIONS];
+  trigger_t a_out, b_out, c_out;
+  reaction_t* a_out_reactions[2];
+  reaction_t* b_out_reactions[1];
+  reaction_t* c_out_reactions[1];
+  trigger_t* a_triggers[1];
+  trigger_t* b_triggers[1];
+  trigger_t* c_triggers[1];
+  trigger_t** a_outputs[1];
+  trigger_t** b_outputs[1];
+  trigger_t** c_outputs[1];
+  int triggered_sizes[1];
+  bool present[3];
+  bool* produced[3][1];
+} diamond_t;
+
+/** Set up the diamond with the levels that the code generator would give its reactions. */
+static void init_diamond(diamond_t* g, environment_t* env) {
+  const index_t levels[NUMBER_OF_REACTIONS] = {0, 1, 1, 2};
+  static const char* names[NUMBER_OF_REACTIONS] = {"a", "b", "c", "d"};
+  for (int i = 0; i < NUMBER_OF_REACTIONS; i++) {
+    g->selves[i].environment = env;
+    g->reactions[i].self = &g->selves[i];
+    g->reactions[i].name = (char*)names[i];
+    g->reactions[i].deadline = NEVER;
+    g->reactions[i].index = levels[i];
+    g->reactions[i].status = inactive;
+    g->pointers[i] = &g->reactions[i];
+  }
+  g->triggered_sizes[0] = 1;
+  g->a_out_reactions[0] = &g->reactions[1];
+  g->a_out_reactions[1] = &g->reactions[2];
+  g->b_out_reactions[0] = &g->reactions[3];
+  g->c_out_reactions[0] = &g->reactions[3];
+  trigger_t* outs[3] = {&g->a_out, &g->b_out, &g->c_out};
+  reaction_t** out_reactions[3] = {g->a_out_reactions, g->b_out_reactions, g->c_out_reactions};
+  trigger_t** triggers[3] = {g->a_triggers, g->b_triggers, g->c_triggers};
+  trigger_t*** outputs[3] = {g->a_outputs, g->b_outputs, g->c_outputs};
+  for (int i = 0; i < 3; i++) {
+    outs[i]->reactions = out_reactions[i];
+    outs[i]->number_of_reactions = i == 0 ? 2 : 1;
+    triggers[i][0] = outs[i];
+    outputs[i][0] = triggers[i];
+    g->produced[i][0] = &g->present[i];
+    g->reactions[i].num_outputs = 1;
+    g->reactions[i].output_produced = g->produced[i];
+    g->reactions[i].triggered_sizes = g->triggered_sizes;
+    g->reactions[i].triggers = outputs[i];
+  }
+}
+
+/** Take the next reaction from the scheduler, check that it is the expected one, and execute it. */
+static void expect(environment_t* env, diamond_t* g, int expected, int triggers) {
+  reaction_t* reaction = lf_sched_get_ready_reaction(env->scheduler, 0);
+  LF_TEST(reaction == &g->reactions[expected], "The scheduler returned reaction %s, not %s.",
+          reaction == NULL ? "NULL" : reaction->name, g->reactions[expected].name);
+  if (triggers >= 0) {
+    lf_scheduler_trigger_reaction(env->scheduler, &g->reactions[triggers], 0);
+  }
+  lf_sched_done_with_reaction(0, reaction);
+}
+
+/** Trigger a, which triggers b, which triggers d, and check that c is skipped and the tag then advances. */
+static void run_diamond(environment_t* env, diamond_t* g) {
+  lf_scheduler_trigger_reaction(env->scheduler, &g->reactions[0], -1);
+  expect(env, g, 0, 1);
+  expect(env, g, 1, 3);
+  expect(env, g, 3, -1);
+  // With no events left, the tag advances to the stop tag, after which there is nothing to do.
+  reaction_t* reaction = lf_sched_get_ready_reaction(env->scheduler, 0);
+  LF_TEST(reaction == NULL, "The scheduler returned reaction %s instead of stopping.", reaction->name);
+  LF_TEST(env->scheduler->should_stop, "The scheduler did not signal the workers to stop.");
+}
+
+static void with_graph(void) {
+  static environment_t env;
+  static diamond_t g;
+  environment_init(&env, "graph", 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, NULL);
+  init_diamond(&g, &env);
+  size_t reactions_per_level[3] = {1, 2, 1};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = 3,
+                           .reactions = g.pointers,
+                           .num_reactions = NUMBER_OF_REACTIONS};
+  lf_sched_init(&env, 1, &params);
+  run_diamond(&env, &g);
+  lf_sched_free(env.scheduler);
+}
+
+#ifndef LF_PIPELINED_TAGS
+// Without a graph, the scheduler executes by level, which pipelined tags do not support.
+static void by_level(void) {
+  static environment_t env;
+  static diamond_t g;
+  environment_init(&env, "level", 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, NULL);
+  init_diamond(&g, &env);
+  // As in generated code, only the number of reactions at each level is given.
+  size_t reactions_per_level[3] = {1, 2, 1};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level, .num_reactions_per_level_size = 3};
+  lf_sched_init(&env, 1, &params);
+  run_diamond(&env, &g);
+  lf_sched_free(env.scheduler);
+}
+
+static void by_level_without_params(void) {
+  // Reactions at levels beyond the default room for levels, triggered in reverse order.
+  static environment_t env;
+  static diamond_t g;
+  environment_init(&env, "none", 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, NULL);
+  init_diamond(&g, &env);
+  for (int i = 0; i < NUMBER_OF_REACTIONS; i++) {
+    g.reactions[i].index = (index_t)(1000 * i);
+  }
+  lf_sched_init(&env, 1, NULL);
+  for (int i = NUMBER_OF_REACTIONS - 1; i >= 0; i--) {
+    lf_scheduler_trigger_reaction(env.scheduler, &g.reactions[i], -1);
+  }
+  for (int i = 0; i < NUMBER_OF_REACTIONS; i++) {
+    expect(&env, &g, i, -1);
+  }
+  reaction_t* reaction = lf_sched_get_ready_reaction(env.scheduler, 0);
+  LF_TEST(reaction == NULL, "The scheduler returned reaction %s instead of stopping.", reaction->name);
+  lf_sched_free(env.scheduler);
+}
+#endif // LF_PIPELINED_TAGS
+
+int main(void) {
+  with_graph();
+#ifndef LF_PIPELINED_TAGS
+  by_level();
+  by_level_without_params();
+#endif
+  return 0;
+}
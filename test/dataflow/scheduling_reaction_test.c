@@ -0,0 +1,142 @@
+/**
+ * This tests that the dataflow scheduler does not advance the tag while a reaction that may
+ * schedule logical actions is behind, and that such a reaction schedules events and requests
+ * to stop relative to its own tag. With pipelined tags, the tag would otherwise advance while
+ * the reaction executes, and its events would be at a tag that has already started.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "api/schedule.h"
+#include "environment.h"
+#include "low_level_platform.h"
+#include "reactor.h"
+#include "scheduler.h"
+#include "util.h"
+
+#if SCHEDULER != SCHED_DATAFLOW
+#error scheduling_reaction_test.c should only be compiled with SCHEDULER=SCHED_DATAFLOW
+#endif
+
+// The environment that _lf_get_environments() in src_gen_stub.c returns, which lf_request_stop() uses.
+extern environment_t _env;
+
+/** Reaction s of one reactor, triggered by an action, sends to reaction r of another, which schedules the action. */
+static self_base_t selves[2];
+static reaction_t s, r;
+static reaction_t* reactions[2] = {&s, &r};
+static trigger_t action, s_out;
+static reaction_t* action_reactions[1] = {&s};
+static reaction_t* s_out_reactions[1] = {&r};
+static trigger_t* s_triggers[1] = {&s_out};
+static trigger_t** s_outputs[1] = {s_triggers};
+static int triggered_sizes[1] = {1};
+static bool s_present;
+static bool* s_produced[1] = {&s_present};
+
+static volatile bool second_worker_returned = false;
+static reaction_t* volatile second_worker_reaction = NULL;
+
+static void init_reactions(environment_t* env) {
+  static const char* names[2] = {"s", "r"};
+  for (int i = 0; i < 2; i++) {
+    selves[i].environment = env;
+    reactions[i]->self = &selves[i];
+    reactions[i]->name = (char*)names[i];
+    reactions[i]->deadline = NEVER;
+    reactions[i]->index = (index_t)i;
+    reactions[i]->status = inactive;
+  }
+  s.num_outputs = 1;
+  s.output_produced = s_produced;
+  s.triggered_sizes = triggered_sizes;
+  s.triggers = s_outputs;
+  s_out.reactions = s_out_reactions;
+  s_out.number_of_reactions = 1;
+  action.reactions = action_reactions;
+  action.number_of_reactions = 1;
+  // No minimum spacing.
+  action.period = -1;
+}
+
+/** Take the next reaction from worker 0 and check that it is the expected one at the expected tag. */
+static void expect(environment_t* env, reaction_t* expected, tag_t tag) {
+  reaction_t* reaction = lf_sched_get_ready_reaction(env->scheduler, 0);
+  LF_TEST(reaction == expected, "The scheduler returned reaction %s, not %s.",
+          reaction == NULL ? "NULL" : reaction->name, expected->name);
+  tag_t current = lf_tag(env);
+  instant_t start = lf_time_start();
+  LF_TEST(lf_tag_compare(current, tag) == 0, "Reaction %s executes at " PRINTF_TAG ", not " PRINTF_TAG ".",
+          expected->name, current.time - start, current.microstep, tag.time - start, tag.microstep);
+}
+
+static void* second_worker(void* arg) {
+  environment_t* env = (environment_t*)arg;
+  second_worker_reaction = lf_sched_get_ready_reaction(env->scheduler, 1);
+  second_worker_returned = true;
+  return NULL;
+}
+
+int main(void) {
+  environment_t* env = &_env;
+  environment_init(env, "main", 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, NULL);
+  init_reactions(env);
+  size_t reactions_per_level[2] = {1, 1};
+  sched_params_t params = {.num_reactions_per_level = reactions_per_level,
+                           .num_reactions_per_level_size = 2,
+                           .reactions = reactions,
+                           .num_reactions = 2,
+                           .scheduling_reactions = &reactions[1],
+                           .num_scheduling_reactions = 1};
+  lf_sched_init(env, 2, &params);
+  tag_t start = env->current_tag;
+  tag_t next = {.time = start.time, .microstep = 1};
+
+  // At the start tag, s sends to r, which schedules the action one microstep later.
+  lf_scheduler_trigger_reaction(env->scheduler, &s, -1);
+  expect(env, &s, start);
+  lf_scheduler_trigger_reaction(env->scheduler, &r, 0);
+  lf_sched_done_with_reaction(0, &s);
+  expect(env, &r, start);
+  LF_MUTEX_LOCK(&env->mutex);
+  lf_schedule_trigger(env, &action, 0, NULL);
+  LF_MUTEX_UNLOCK(&env->mutex);
+  lf_sched_done_with_reaction(0, &r);
+
+  // The action triggers s one microstep later, which again sends to r.
+  expect(env, &s, next);
+  lf_scheduler_trigger_reaction(env->scheduler, &r, 0);
+  lf_sched_done_with_reaction(0, &s);
+  expect(env, &r, next);
+
+  // While r executes, another worker finds nothing to do, but must not advance the tag.
+  lf_thread_t thread;
+  int result = lf_thread_create(&thread, second_worker, env);
+  LF_TEST(result == 0, "Could not create a thread. Got %d.", result);
+  lf_sleep(MSEC(50));
+  LF_MUTEX_LOCK(&env->mutex);
+  tag_t current = env->current_tag;
+  LF_MUTEX_UNLOCK(&env->mutex);
+  LF_TEST(lf_tag_compare(current, next) == 0,
+          "The tag advanced to " PRINTF_TAG " while a reaction that may schedule actions was executing.",
+          current.time - start.time, current.microstep);
+  LF_TEST(!second_worker_returned, "The second worker returned while r was executing.");
+
+  // The stop tag is one microstep after the tag of r.
+  lf_request_stop();
+  tag_t stop = env->stop_tag;
+  LF_TEST(lf_tag_compare(stop, (tag_t){.time = start.time, .microstep = 2}) == 0,
+          "The stop tag is " PRINTF_TAG ", not one microstep after the tag of the reaction that requested it.",
+          stop.time - start.time, stop.microstep);
+  lf_sched_done_with_reaction(0, &r);
+  reaction_t* reaction = lf_sched_get_ready_reaction(env->scheduler, 0);
+  LF_TEST(reaction == NULL, "The scheduler returned reaction %s instead of stopping.", reaction->name);
+  lf_thread_join(thread, NULL);
+  LF_TEST(second_worker_returned, "The second worker did not return.");
+  LF_TEST(second_worker_reaction == NULL, "The second worker returned reaction %s instead of stopping.",
+          second_worker_reaction->name);
+  current = env->current_tag;
+  LF_TEST(lf_tag_compare(current, stop) == 0, "The tag advanced to " PRINTF_TAG ", not to the stop tag.",
+          current.time - start.time, current.microstep);
+  lf_sched_free(env->scheduler);
+  return 0;
+}
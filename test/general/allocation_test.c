@@ -0,0 +1,73 @@
+/**
+ * This tests lf_allocate() and lf_free(). With LF_REACTOR_ARENA, memory allocated during startup
+ * comes from the arena, and memory allocated after startup is recorded and freed one record at a time.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "reactor.h"
+#include "reactor_common.h"
+#include "util.h"
+
+#define ALLOCATIONS 16
+#define SIZE 1024
+#define ROUNDS 1000
+
+// Defined in reactor_common.c.
+extern struct allocation_record_t* _lf_reactors_to_free;
+
+static int count_records(allocation_record_t* head) {
+  int count = 0;
+  for (; head != NULL; head = head->next) {
+    count++;
+  }
+  return count;
+}
+
+int main(void) {
+  self_base_t* self = lf_new_reactor(sizeof(self_base_t));
+  self->name = "self";
+  LF_TEST(_lf_reactors_to_free != NULL && _lf_reactors_to_free->allocated == self,
+          "A reactor created during startup is not on the list of reactors to free.");
+  int* startup = (int*)lf_allocate(4, sizeof(int), &self->allocations);
+  LF_TEST(startup[0] == 0 && startup[3] == 0, "Memory allocated during startup holds %d and %d.", startup[0],
+          startup[3]);
+#ifdef LF_REACTOR_ARENA
+  LF_TEST(self->allocations == NULL, "Memory allocated from the arena during startup was recorded %d times.",
+          count_records(self->allocations));
+  _lf_close_reactor_arena();
+#else
+  lf_free(&self->allocations);
+#endif
+
+  // After startup, lf_free() releases every allocation, so repeated allocations do not accumulate.
+  for (int round = 0; round < ROUNDS; round++) {
+    for (int i = 0; i < ALLOCATIONS; i++) {
+      char* mem = (char*)lf_allocate(SIZE, 1, &self->allocations);
+      LF_TEST(mem[0] == 0 && mem[SIZE - 1] == 0, "Memory allocated after startup in round %d holds %d and %d.", round,
+              mem[0], mem[SIZE - 1]);
+      memset(mem, round, SIZE);
+    }
+    int records = count_records(self->allocations);
+    LF_TEST(records == ALLOCATIONS, "%d allocations after startup were recorded %d times.", ALLOCATIONS, records);
+    lf_free(&self->allocations);
+    records = count_records(self->allocations);
+    LF_TEST(records == 0, "lf_free() left %d allocation records.", records);
+  }
+
+  // A reactor created after startup can be freed on its own.
+  self_base_t* late = (self_base_t*)lf_allocate(1, sizeof(self_base_t), NULL);
+  lf_allocate(SIZE, 1, &late->allocations);
+  lf_free_reactor(late);
+
+  // Memory allocated after startup on a reactor created during startup is freed at termination,
+  // even if the reactor itself lives in the arena.
+  lf_allocate(SIZE, 1, &self->allocations);
+  const char* name = lf_reactor_full_name(self);
+  LF_TEST(strcmp(name, "self") == 0, "The full name of a reactor is %s, not self.", name);
+  int records = count_records(self->allocations);
+  LF_TEST(records == 2, "2 allocations after startup were recorded %d times.", records);
+  lf_free_all_reactors();
+  records = count_records(_lf_reactors_to_free);
+  LF_TEST(records == 0, "lf_free_all_reactors() left %d reactors to free.", records);
+  return 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * This tests the iteration over the present channels of a sparse multiport. The multiport is set
+ * up as the code generator does it, and the runtime allocates the bitmap of its sparse record with
+ * _lf_initialize_sparse_io_records(), sets channels present with lf_set_present(), and clears them
+ * when a time step starts with _lf_start_time_step().
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "environment.h"
+#include "low_level_platform.h"
+#include "port.h"
+#include "rand_utils.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "util.h"
+#include "vector.h"
+
+// Width of the multiport.
+#define WIDTH 4096
+// Number of threads that set channels present at once.
+#define THREADS 4
+
+/** A reactor with a sparse input multiport. */
+typedef struct {
+  environment_t env;
+  self_base_t self;
+  lf_sparse_io_record_t record;
+  lf_port_base_t channels[WIDTH];
+  lf_port_base_t* ports[WIDTH];
+} multiport_t;
+
+static multiport_t* multiport_new(void) {
+  multiport_t* m = (multiport_t*)calloc(1, sizeof(multiport_t));
+  LF_ASSERT_NON_NULL(m);
+  environment_init(&m->env, "main", 0, 1, 0, 0, 0, 0, WIDTH, 0, 0, 0, NULL);
+  m->env.execution_started = true;
+  m->self.environment = &m->env;
+  // As in generated code, the environment knows the record and the presence of every channel.
+  m->record.capacity = WIDTH / LF_SPARSE_CAPACITY_DIVIDER;
+  m->env.sparse_io_record_sizes = vector_new(1);
+  vector_push(&m->env.sparse_io_record_sizes, &m->record.size);
+  for (int i = 0; i < WIDTH; i++) {
+    m->channels[i].sparse_record = &m->record;
+    m->channels[i].destination_channel = i;
+    m->channels[i].source_reactor = &m->self;
+    m->env.is_present_fields[i] = &m->channels[i].is_present;
+    m->ports[i] = &m->channels[i];
+  }
+  _lf_initialize_sparse_io_records(&m->env);
+  LF_TEST(m->record.present_bits != NULL && m->record.number_of_words * 64 >= WIDTH,
+          "The bitmap does not cover the multiport.");
+  return m;
+}
+
+static void multiport_free(multiport_t* m) {
+  environment_free(&m->env);
+  free(m);
+}
+
+/** Return the sum of the present channels, checking that they come in increasing order. */
+static long iterate(multiport_t* m) {
+  long sum = 0;
+  int last = -1;
+  lf_multiport_iterator_t i = _lf_multiport_iterator_impl(m->ports, WIDTH);
+  int channel = lf_multiport_next(&i);
+  while (channel >= 0) {
+    LF_TEST(channel > last && m->channels[channel].is_present, "The iterator returned a channel out of order.");
+    last = channel;
+    sum += channel;
+    channel = lf_multiport_next(&i);
+  }
+  return sum;
+}
+
+static void empty_and_edges(void) {
+  multiport_t* m = multiport_new();
+  LF_TEST(iterate(m) == 0, "The iterator returned a channel of an empty multiport.");
+  lf_multiport_iterator_t i = _lf_multiport_iterator_impl(m->ports, WIDTH);
+  LF_TEST(lf_multiport_next(&i) == -1, "The iterator returned a channel of an empty multiport.");
+  LF_TEST(lf_multiport_next(&i) == -1, "The iterator did not stay at the end.");
+  lf_set_present(&m->channels[0]);
+  lf_set_present(&m->channels[63]);
+  lf_set_present(&m->channels[64]);
+  lf_set_present(&m->channels[WIDTH - 1]);
+  lf_set_present(&m->channels[WIDTH - 1]);
+  LF_TEST(m->record.size == 4, "A channel made present twice was counted twice.");
+  i = _lf_multiport_iterator_impl(m->ports, WIDTH);
+  LF_TEST(lf_multiport_next(&i) == 0, "The iterator skipped the first channel.");
+  LF_TEST(lf_multiport_next(&i) == 63, "The iterator skipped the last channel of a word.");
+  LF_TEST(lf_multiport_next(&i) == 64, "The iterator skipped the first channel of a word.");
+  LF_TEST(lf_multiport_next(&i) == WIDTH - 1, "The iterator skipped the last channel.");
+  LF_TEST(lf_multiport_next(&i) == -1, "The iterator did not end after the last channel.");
+  multiport_free(m);
+}
+
+static void bitmap_matches_scan(void) {
+  // Iterate with the bitmap and with the fallback that scans every channel, at about 3% activity.
+  multiport_t* m = multiport_new();
+  long expected = 0;
+  uint32_t state = 1830;
+  for (int i = 0; i < WIDTH; i++) {
+    if (next_random(&state) % 32 == 0) {
+      lf_set_present(&m->channels[i]);
+      expected += i;
+    }
+  }
+  long by_bitmap = iterate(m);
+  m->record.size = -1;
+  long by_scan = iterate(m);
+  LF_TEST(by_bitmap == expected, "The bitmap did not visit the present channels.");
+  LF_TEST(by_scan == by_bitmap, "The scan did not visit the present channels.");
+  multiport_free(m);
+}
+
+#ifndef LF_PIPELINED_TAGS
+// With pipelined tags, sparse multiports are not supported.
+static void time_step_clears(void) {
+  multiport_t* m = multiport_new();
+  lf_set_present(&m->channels[3]);
+  lf_set_present(&m->channels[700]);
+  _lf_start_time_step(&m->env);
+  LF_TEST(m->record.size == 0, "The record still has present channels in the next time step.");
+  for (size_t w = 0; w < m->record.number_of_words; w++) {
+    LF_TEST(m->record.present_bits[w] == 0, "The bitmap still has present channels in the next time step.");
+  }
+  LF_TEST(!m->channels[3].is_present && !m->channels[700].is_present, "A channel is still present.");
+  LF_TEST(iterate(m) == 0, "The iterator returned a channel of the previous time step.");
+
+  // The record is used again in the next time step.
+  lf_set_present(&m->channels[700]);
+  LF_TEST(m->record.size == 1 && iterate(m) == 700, "The record does not work after it was cleared.");
+  multiport_free(m);
+}
+#endif // LF_PIPELINED_TAGS
+
+#if !defined(LF_SINGLE_THREADED)
+static multiport_t* shared;
+
+static void* set_every_third_channel(void* arg) {
+  (void)arg;
+  for (int i = 0; i < WIDTH; i += 3) {
+    lf_set_present(&shared->channels[i]);
+  }
+  return NULL;
+}
+
+static void concurrent_set_present(void) {
+  // Threads set the same channels present at once, and each channel is counted once.
+  shared = multiport_new();
+  lf_thread_t threads[THREADS];
+  for (int t = 0; t < THREADS; t++) {
+    LF_TEST(lf_thread_create(&threads[t], set_every_third_channel, NULL) == 0, "Could not create a thread.");
+  }
+  for (int t = 0; t < THREADS; t++) {
+    lf_thread_join(threads[t], NULL);
+  }
+  LF_TEST(shared->record.size == (WIDTH + 2) / 3, "A channel was counted more than once or not at all.");
+  long expected = 0;
+  for (int i = 0; i < WIDTH; i += 3) {
+    expected += i;
+  }
+  LF_TEST(iterate(shared) == expected, "The iterator did not visit every channel that was set present.");
+  multiport_free(shared);
+}
+#endif // LF_SINGLE_THREADED
+
+int main() {
+  empty_and_edges();
+  bitmap_matches_scan();
+#ifndef LF_PIPELINED_TAGS
+  time_step_clears();
+#endif
+#if !defined(LF_SINGLE_THREADED)
+  concurrent_set_present();
+#endif
+  return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * This tests the local RTI that coordinates enclaves. Enclave a is upstream of enclave b with a
+ * delay, and b must block in its request for a tag advance grant (TAG) until the next event tag
+ * (NET) or the latest tag complete (LTC) of a allows it to advance.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "environment.h"
+#include "low_level_platform.h"
+#include "util.h"
+
+#ifdef LF_ENCLAVES
+#include "rti_local.h"
+
+#define ENCLAVES 2
+#define DELAY MSEC(10)
+
+// Defined in tag.c.
+extern instant_t start_time;
+// Defined in src_gen_stub.c.
+extern int _lf_stub_num_enclaves;
+extern interval_t* _lf_stub_enclave_delays;
+
+static environment_t envs[ENCLAVES];
+static tag_t requested;
+static tag_t granted;
+static volatile bool returned;
+
+static tag_t at(interval_t offset, microstep_t microstep) {
+  return (tag_t){.time = start_time + offset, .microstep = microstep};
+}
+
+static tag_t request_next_event_tag(environment_t* env, tag_t tag) {
+  LF_MUTEX_LOCK(&env->mutex);
+  tag_t result = rti_next_event_tag_locked(env->enclave_info, tag);
+  LF_MUTEX_UNLOCK(&env->mutex);
+  return result;
+}
+
+static void complete_tag(environment_t* env, tag_t tag) {
+  LF_MUTEX_LOCK(&env->mutex);
+  rti_logical_tag_complete_locked(env->enclave_info, tag);
+  LF_MUTEX_UNLOCK(&env->mutex);
+}
+
+static void* request_tag(void* arg) {
+  (void)arg;
+  granted = request_next_event_tag(&envs[1], requested);
+  returned = true;
+  return NULL;
+}
+
+/** Have b request a TAG for the tag in a thread, and check that it blocks. */
+static void start_request(lf_thread_t* thread, tag_t tag) {
+  requested = tag;
+  returned = false;
+  int result = lf_thread_create(thread, request_tag, NULL);
+  LF_TEST(result == 0, "Could not create a thread. Got %d.", result);
+  lf_sleep(MSEC(50));
+  LF_TEST(!returned, "The downstream enclave was granted " PRINTF_TAG ", which its upstream could still send to.",
+          granted.time - start_time, granted.microstep);
+}
+
+int main(void) {
+  start_time = SEC(1);
+  interval_t delays[ENCLAVES * ENCLAVES] = {FOREVER, DELAY, FOREVER, FOREVER};
+  _lf_stub_num_enclaves = ENCLAVES;
+  _lf_stub_enclave_delays = delays;
+  environment_init(&envs[0], "a", 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, NULL);
+  environment_init(&envs[1], "b", 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, NULL);
+  initialize_local_rti(envs, ENCLAVES);
+
+  // Until a sends a NET, it may send an event at the start tag, which arrives at b after the delay.
+  lf_thread_t thread;
+  start_request(&thread, at(MSEC(20), 0));
+  // An LTC of a that leaves room for an event at the requested tag does not release b.
+  complete_tag(&envs[0], at(MSEC(5), 0));
+  lf_sleep(MSEC(50));
+  LF_TEST(!returned, "The downstream enclave was granted " PRINTF_TAG " after an LTC that does not allow it.",
+          granted.time - start_time, granted.microstep);
+  // Enclave a has no upstream, so it is granted any tag. Its NET releases b up to just before
+  // the earliest tag at which an event of a can arrive.
+  tag_t upstream = request_next_event_tag(&envs[0], at(MSEC(15), 0));
+  LF_TEST(lf_tag_compare(upstream, FOREVER_TAG) == 0,
+          "An enclave without upstream enclaves was granted " PRINTF_TAG ", not FOREVER.", upstream.time - start_time,
+          upstream.microstep);
+  lf_thread_join(thread, NULL);
+  tag_t expected = lf_tag_latest_earlier(at(MSEC(25), 0));
+  LF_TEST(lf_tag_compare(granted, expected) == 0,
+          "The TAG after a NET of the upstream enclave was " PRINTF_TAG ", not " PRINTF_TAG ".",
+          granted.time - start_time, granted.microstep, expected.time - start_time, expected.microstep);
+
+  // A request up to the last grant returns at once.
+  tag_t again = request_next_event_tag(&envs[1], at(MSEC(22), 0));
+  LF_TEST(lf_tag_compare(again, granted) == 0,
+          "A request below the last grant " PRINTF_TAG " returned " PRINTF_TAG ".", granted.time - start_time,
+          granted.microstep, again.time - start_time, again.microstep);
+
+  // An LTC of a releases b up to just before the LTC plus the delay.
+  start_request(&thread, at(MSEC(40), 0));
+  complete_tag(&envs[0], at(MSEC(35), 0));
+  lf_thread_join(thread, NULL);
+  expected = lf_tag_latest_earlier(at(MSEC(45), 0));
+  LF_TEST(lf_tag_compare(granted, expected) == 0,
+          "The TAG after an LTC of the upstream enclave was " PRINTF_TAG ", not " PRINTF_TAG ".",
+          granted.time - start_time, granted.microstep, expected.time - start_time, expected.microstep);
+  free_local_rti();
+  return 0;
+}
+#else
+int main(void) { return 0; }
+#endif // LF_ENCLAVES
@@ -0,0 +1,62 @@
+/**
+ * This tests lf_schedule_batch(), which schedules an action once for each of several values,
+ * by checking the tags and values of the events that it puts on the event queue.
+ */
+#include <stdlib.h>
+#include "api/schedule.h"
+#include "environment.h"
+#include "pqueue_tag.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "util.h"
+
+#define EVENTS 6
+
+// Defined in reactor_common.c.
+extern bool _lf_termination_executed;
+
+int main(void) {
+  static environment_t env;
+  static self_base_t self;
+  static trigger_t trigger;
+  static lf_action_base_t action;
+  environment_init(&env, "main", 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, NULL);
+  env.start_tag = (tag_t){.time = SEC(1), .microstep = 0};
+  env.current_tag = env.start_tag;
+  self.environment = &env;
+  // A logical action of type int with no minimum spacing.
+  trigger.period = -1;
+  _lf_initialize_template((token_template_t*)&action, sizeof(int));
+  action.trigger = &trigger;
+  action.parent = &self;
+
+  // Events with the same offset are separated by microsteps, and an offset of zero is one microstep later.
+  const int values[EVENTS] = {10, 11, 12, 13, 14, 15};
+  const interval_t offsets[EVENTS] = {MSEC(2), 0, MSEC(1), 0, MSEC(1), MSEC(5)};
+  const tag_t expected[EVENTS] = {{SEC(1), 1}, {SEC(1), 2}, {SEC(1) + MSEC(1), 0},
+                                  {SEC(1) + MSEC(1), 1}, {SEC(1) + MSEC(2), 0}, {SEC(1) + MSEC(5), 0}};
+  const int expected_values[EVENTS] = {11, 13, 12, 14, 10, 15};
+  trigger_handle_t handle = lf_schedule_batch(&action, values, EVENTS, offsets);
+  LF_TEST(handle > 0, "The batch was not scheduled. Got handle %d.", handle);
+  size_t size = pqueue_tag_size(env.event_q);
+  LF_TEST(size == EVENTS, "The batch of %d values scheduled %zu events.", EVENTS, size);
+  for (int i = 0; i < EVENTS; i++) {
+    event_t* event = (event_t*)pqueue_tag_pop(env.event_q);
+    tag_t tag = event->base.tag;
+    LF_TEST(lf_tag_compare(tag, expected[i]) == 0, "Event %d of the batch has tag " PRINTF_TAG ", not " PRINTF_TAG ".",
+            i, tag.time - SEC(1), tag.microstep, expected[i].time - SEC(1), expected[i].microstep);
+    LF_TEST(event->token != NULL, "Event %d of the batch has no value.", i);
+    int value = *(int*)event->token->value;
+    LF_TEST(value == expected_values[i], "Event %d of the batch has value %d, not %d.", i, value, expected_values[i]);
+    _lf_done_using(event->token);
+    lf_recycle_event(&env, event);
+  }
+
+  // After termination, a batch schedules nothing.
+  _lf_termination_executed = true;
+  handle = lf_schedule_batch(&action, values, EVENTS, offsets);
+  LF_TEST(handle == 0, "A batch was scheduled after termination. Got handle %d.", handle);
+  size = pqueue_tag_size(env.event_q);
+  LF_TEST(size == 0, "A batch put %zu events on the queue after termination.", size);
+  return 0;
+}
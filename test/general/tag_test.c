@@ -1,10 +1,90 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "lf_types.h"
+#include "tag_inline.h"
+#include "util.h"
+
+// Reference versions of the tag arithmetic, as written before tag_inline.h.
+
+static instant_t reference_time_add(instant_t a, interval_t b) {
+  if (a == NEVER || b == NEVER)
+    return NEVER;
+  if (a == FOREVER || b == FOREVER)
+    return FOREVER;
+  if (b > 0 && a > FOREVER - b)
+    return FOREVER;
+  if (b < 0 && a < NEVER - b)
+    return NEVER;
+  return a + b;
+}
+
+static int reference_tag_compare(tag_t tag1, tag_t tag2) {
+  if (tag1.time != tag2.time)
+    return tag1.time < tag2.time ? -1 : 1;
+  if (tag1.microstep != tag2.microstep)
+    return tag1.microstep < tag2.microstep ? -1 : 1;
+  return 0;
+}
+
+static tag_t reference_tag_add(tag_t a, tag_t b) {
+  instant_t res = reference_time_add(a.time, b.time);
+  if (res == FOREVER)
+    return FOREVER_TAG;
+  if (res == NEVER)
+    return NEVER_TAG;
+  if (b.time > 0)
+    a.microstep = 0;
+  tag_t result = {.time = res, .microstep = a.microstep + b.microstep};
+  if (result.microstep < a.microstep)
+    return FOREVER_TAG;
+  return result;
+}
+
+static tag_t reference_delay_tag(tag_t tag, interval_t interval) {
+  if (tag.time == NEVER || interval < 0LL)
+    return tag;
+  if (tag.time >= FOREVER - interval)
+    return FOREVER_TAG;
+  tag_t result = tag;
+  if (interval == 0LL) {
+    result.microstep++;
+  } else {
+    result.time += interval;
+    result.microstep = 0;
+  }
+  return result;
+}
+
+static void tag_inline_matches_reference(void) {
+  const instant_t times[] = {NEVER, NEVER + 1, -SEC(1), -1, 0, 1, MSEC(5), FOREVER - 1, FOREVER};
+  const microstep_t microsteps[] = {0, 1, 2, FOREVER_MICROSTEP - 1, FOREVER_MICROSTEP};
+  const size_t n_times = sizeof(times) / sizeof(times[0]);
+  const size_t n_microsteps = sizeof(microsteps) / sizeof(microsteps[0]);
+  for (size_t i = 0; i < n_times * n_microsteps; i++) {
+    tag_t a = {.time = times[i / n_microsteps], .microstep = microsteps[i % n_microsteps]};
+    for (size_t j = 0; j < n_times * n_microsteps; j++) {
+      tag_t b = {.time = times[j / n_microsteps], .microstep = microsteps[j % n_microsteps]};
+      int expected = reference_tag_compare(a, b);
+      LF_TEST(lf_tag_compare_inline(a, b) == expected, "lf_tag_compare_inline differs from the reference.");
+      LF_TEST(lf_tag_less(a, b) == (expected < 0), "lf_tag_less differs from the reference.");
+      LF_TEST(lf_tag_equal(a, b) == (expected == 0), "lf_tag_equal differs from the reference.");
+      LF_TEST(lf_tag_equal(lf_tag_add_inline(a, b), reference_tag_add(a, b)),
+              "lf_tag_add_inline differs from the reference.");
+      LF_TEST(lf_time_add_inline(a.time, b.time) == reference_time_add(a.time, b.time),
+              "lf_time_add_inline differs from the reference.");
+    }
+    for (size_t j = 0; j < n_times; j++) {
+      LF_TEST(lf_tag_equal(lf_delay_tag_inline(a, times[j]), reference_delay_tag(a, times[j])),
+              "lf_delay_tag_inline differs from the reference.");
+    }
+  }
+}
 
 int main() {
   char* buf = malloc(sizeof(char) * 128);
   lf_readable_time(buf, 0);
   printf("%s", buf);
+  free(buf);
+  tag_inline_matches_reference();
   return 0;
 }
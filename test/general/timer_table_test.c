@@ -0,0 +1,93 @@
+#include <stdlib.h>
+#include "timer_table.h"
+#include "util.h"
+
+static void empty_table(void) {
+  LF_TEST(lf_timer_table_next_time(NULL) == FOREVER, "A missing table has a next time.");
+  LF_TEST(lf_timer_table_pop(NULL, 0) == NULL, "A missing table has a group to pop.");
+  lf_timer_table_t* table = lf_timer_table_new();
+  LF_TEST(lf_timer_table_next_time(table) == FOREVER, "An empty table has a next time.");
+  LF_TEST(lf_timer_table_pop(table, 0) == NULL, "An empty table has a group to pop.");
+  lf_timer_table_free(table);
+  lf_timer_table_free(NULL);
+}
+
+static void groups_by_period_and_time(void) {
+  trigger_t timers[4] = {0};
+  timers[0].period = MSEC(2);
+  timers[1].period = MSEC(2);
+  timers[2].period = MSEC(3);
+  timers[3].period = MSEC(2);
+  lf_timer_table_t* table = lf_timer_table_new();
+  lf_timer_table_add(table, &timers[0], MSEC(2));
+  lf_timer_table_add(table, &timers[1], MSEC(2));
+  lf_timer_table_add(table, &timers[2], MSEC(2));
+  lf_timer_table_add(table, &timers[3], 0);
+  LF_TEST(table->number_of_groups == 3, "Timers with the same period and time are not grouped.");
+  LF_TEST(lf_timer_table_next_time(table) == 0, "The next time is not that of the earliest timer.");
+
+  // Timer 3 catches up with timers 0 and 1 once it has fired once.
+  lf_timer_group_t* group = lf_timer_table_pop(table, 0);
+  LF_TEST(group != NULL && group->number_of_timers == 1 && group->timers[0] == &timers[3],
+          "The earliest group is not the one of timer 3.");
+  LF_TEST(lf_timer_table_pop(table, 0) == NULL, "A group was popped before its time.");
+  group->time += group->period;
+  lf_timer_table_push(table, group);
+  LF_TEST(table->number_of_groups == 2, "A group that catches up with another is not merged into it.");
+
+  // The remaining groups fire at the same time but have different periods.
+  size_t fired = 0;
+  while ((group = lf_timer_table_pop(table, MSEC(2))) != NULL) {
+    fired += group->number_of_timers;
+    if (group->period == MSEC(2)) {
+      LF_TEST(group->number_of_timers == 3, "The merged group does not have all of its timers.");
+    }
+    lf_timer_table_free_group(group);
+  }
+  LF_TEST(fired == 4, "Not every timer fired.");
+  LF_TEST(lf_timer_table_next_time(table) == FOREVER, "The table is not empty after every group was popped.");
+  lf_timer_table_free(table);
+}
+
+static void order_is_kept(void) {
+  // Enough timers with distinct phases to fill many blocks, then fire them as the runtime does.
+  size_t n = 1000;
+  interval_t end = MSEC(20);
+  trigger_t* timers = (trigger_t*)calloc(n, sizeof(trigger_t));
+  size_t* firings = (size_t*)calloc(n, sizeof(size_t));
+  lf_timer_table_t* table = lf_timer_table_new();
+  for (size_t i = 0; i < n; i++) {
+    timers[i].period = MSEC(1) * (interval_t)(1 + i % 7);
+    timers[i].offset = (interval_t)((i * 37) % n) * USEC(1);
+    lf_timer_table_add(table, &timers[i], timers[i].offset);
+  }
+  instant_t last = 0;
+  instant_t time;
+  while ((time = lf_timer_table_next_time(table)) < end) {
+    LF_TEST(time >= last, "The next time went back.");
+    last = time;
+    lf_timer_group_t* group;
+    while ((group = lf_timer_table_pop(table, time)) != NULL) {
+      for (size_t i = 0; i < group->number_of_timers; i++) {
+        firings[group->timers[i] - timers]++;
+      }
+      group->time += group->period;
+      lf_timer_table_push(table, group);
+    }
+    LF_TEST(lf_timer_table_next_time(table) > time, "A group was left behind at a time that has been handled.");
+  }
+  for (size_t i = 0; i < n; i++) {
+    size_t expected = (size_t)((end - 1 - timers[i].offset) / timers[i].period) + 1;
+    LF_TEST(firings[i] == expected, "A timer did not fire once per period.");
+  }
+  lf_timer_table_free(table);
+  free(firings);
+  free(timers);
+}
+
+int main() {
+  empty_table();
+  groups_by_period_and_time();
+  order_is_kept();
+  return 0;
+}
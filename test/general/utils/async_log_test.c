@@ -0,0 +1,95 @@
+/**
+ * This tests the asynchronous backend for the lf_print functions. Several threads print numbered
+ * messages, and the output must contain every message of each thread exactly once and in order.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+
+#if !defined(LF_SINGLE_THREADED)
+#include "lf_async_log.h"
+#include "low_level_platform.h"
+
+#define THREADS 4
+#define MESSAGES 5000
+#define OUTPUT "async_log_test.out"
+
+/**
+ * The print function outside of the runs. stdout goes to the output file, so failures are
+ * reported on stderr.
+ */
+static void print_to_stderr(const char* format, va_list args) ATTRIBUTE_FORMAT_PRINTF(1, 0);
+static void print_to_stderr(const char* format, va_list args) { vfprintf(stderr, format, args); }
+
+static void* print_messages(void* arg) {
+  int thread = (int)(intptr_t)arg;
+  for (int i = 0; i < MESSAGES; i++) {
+    lf_print("thread %d message %d", thread, i);
+  }
+  return NULL;
+}
+
+/** Print from several threads at once, stop the backend, and return the number of messages written. */
+static int run(lf_async_log_overflow_t overflow) {
+  LF_TEST(freopen(OUTPUT, "w", stdout) != NULL, "Could not redirect stdout to %s.", OUTPUT);
+  int result = lf_async_log_start(-1, overflow);
+  LF_TEST(result == 0, "Could not start asynchronous logging. Got %d.", result);
+  lf_thread_t threads[THREADS];
+  int created[THREADS];
+  for (int t = 0; t < THREADS; t++) {
+    created[t] = lf_thread_create(&threads[t], print_messages, (void*)(intptr_t)t);
+  }
+  for (int t = 0; t < THREADS; t++) {
+    if (created[t] == 0) {
+      lf_thread_join(threads[t], NULL);
+    }
+  }
+  // Failures from here on are printed by print_to_stderr().
+  lf_async_log_stop();
+  fflush(stdout);
+  for (int t = 0; t < THREADS; t++) {
+    LF_TEST(created[t] == 0, "Could not create thread %d. Got %d.", t, created[t]);
+  }
+
+  // Each thread's messages must appear in the order in which it printed them.
+  FILE* file = fopen(OUTPUT, "r");
+  LF_TEST(file != NULL, "Could not read %s.", OUTPUT);
+  int next[THREADS] = {0};
+  int written = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file) != NULL) {
+    int thread, message;
+    if (sscanf(line, "thread %d message %d", &thread, &message) != 2) {
+      continue;
+    }
+    LF_TEST(thread >= 0 && thread < THREADS, "A message names thread %d, which does not exist.", thread);
+    LF_TEST(message >= next[thread], "Message %d of thread %d came after message %d.", message, thread,
+            next[thread] - 1);
+    LF_TEST(overflow == LF_ASYNC_LOG_DROP || message == next[thread], "Message %d of thread %d was dropped.",
+            next[thread], thread);
+    next[thread] = message + 1;
+    written++;
+  }
+  fclose(file);
+  remove(OUTPUT);
+  return written;
+}
+
+int main(void) {
+  lf_register_print_function(print_to_stderr, -1);
+  // With blocking, every message is written.
+  int written = run(LF_ASYNC_LOG_BLOCK);
+  LF_TEST(written == THREADS * MESSAGES, "%d of %d messages were written.", written, THREADS * MESSAGES);
+  int64_t dropped = lf_async_log_dropped();
+  LF_TEST(dropped == 0, "%lld messages were dropped while blocking.", (long long)dropped);
+  // A restart gets new buffers. Each message is either written or counted as dropped.
+  written = run(LF_ASYNC_LOG_DROP);
+  dropped = lf_async_log_dropped();
+  LF_TEST(written + dropped == THREADS * MESSAGES, "%d messages were written and %lld dropped, not %d in all.", written,
+          (long long)dropped, THREADS * MESSAGES);
+  return 0;
+}
+#else
+int main(void) { return 0; }
+#endif // LF_SINGLE_THREADED
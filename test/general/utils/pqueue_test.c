@@ -4,13 +4,17 @@
 #include <string.h>
 #include "pqueue_tag.h"
 #include "tag.h"
+#include "core/utils/impl/tag_heap.h"
+#include "rand_utils.h"
 
 static void trivial(void) {
   // Create an event queue.
   pqueue_tag_t* q = pqueue_tag_init(1);
   assert(q != NULL);
+#if !defined(LF_INLINE_KEY_QUEUES)
   assert(pqueue_is_valid((pqueue_t*)q));
   pqueue_print((pqueue_t*)q, NULL);
+#endif
   pqueue_tag_free(q);
 }
 
@@ -27,7 +31,9 @@ static void insert_on_queue(pqueue_tag_t* q) {
   assert(pqueue_tag_insert_if_no_match(q, t1));
   assert(pqueue_tag_insert_if_no_match(q, t4));
   printf("======== Contents of the queue:\n");
+#if !defined(LF_INLINE_KEY_QUEUES)
   pqueue_print((pqueue_t*)q, NULL);
+#endif
   assert(pqueue_tag_size(q) == 4);
 }
 
@@ -84,6 +90,81 @@ static void remove_from_queue(pqueue_tag_t* q, pqueue_tag_element_t* e1, pqueue_
   assert(pqueue_tag_size(q) == 1);
 }
 
+static void insert_all_into_queue(pqueue_tag_t* q, size_t existing, size_t added) {
+  pqueue_tag_element_t* elements = (pqueue_tag_element_t*)calloc(existing + added, sizeof(pqueue_tag_element_t));
+  pqueue_tag_element_t** batch = (pqueue_tag_element_t**)calloc(added, sizeof(pqueue_tag_element_t*));
+  for (size_t i = 0; i < existing + added; i++) {
+    // Scramble the tags so that neither half is already in order.
+    elements[i].tag = (tag_t){.time = USEC((i * 7919) % (existing + added)), .microstep = (microstep_t)(i % 3)};
+  }
+  for (size_t i = 0; i < existing; i++) {
+    assert(pqueue_tag_insert(q, &elements[i]) == 0);
+  }
+  for (size_t i = 0; i < added; i++) {
+    batch[i] = &elements[existing + i];
+  }
+  assert(pqueue_tag_insert_all(q, batch, added) == 0);
+#if !defined(LF_INLINE_KEY_QUEUES)
+  assert(pqueue_is_valid((pqueue_t*)q));
+#endif
+  assert(pqueue_tag_size(q) == existing + added);
+  tag_t previous = NEVER_TAG;
+  for (size_t i = 0; i < existing + added; i++) {
+    tag_t next = pqueue_tag_pop_tag(q);
+    assert(lf_tag_compare(previous, next) <= 0);
+    previous = next;
+  }
+  pop_empty(q);
+  free(batch);
+  free(elements);
+}
+
+static void tag_heap_matches_queue(void) {
+  // Apply the same random inserts, pops, and removals to a queue and to a heap.
+  size_t n = 2000;
+  pqueue_tag_element_t* in_queue = (pqueue_tag_element_t*)calloc(n, sizeof(pqueue_tag_element_t));
+  pqueue_tag_element_t* in_heap = (pqueue_tag_element_t*)calloc(n, sizeof(pqueue_tag_element_t));
+  bool* queued = (bool*)calloc(n, sizeof(bool));
+  pqueue_tag_t* q = pqueue_tag_init(4);
+  tag_heap_t h;
+  assert(tag_heap_initialize(&h, 4) == 0);
+  uint32_t state = 1830;
+  for (size_t i = 0; i < 20 * n; i++) {
+    size_t e = next_random(&state) % n;
+    uint32_t action = next_random(&state) % 3;
+    if (!queued[e]) {
+      in_queue[e].tag = in_heap[e].tag = (tag_t){.time = next_random(&state) % 100, .microstep = e % 2};
+      assert(pqueue_tag_insert(q, &in_queue[e]) == 0);
+      assert(tag_heap_insert(&h, in_heap[e].tag, &in_heap[e]) == 0);
+      queued[e] = true;
+    } else if (action == 0) {
+      pqueue_tag_remove(q, &in_queue[e]);
+      tag_heap_remove_at(&h, in_heap[e].pos);
+      queued[e] = false;
+    } else if (action == 1) {
+      pqueue_tag_element_t* from_queue = pqueue_tag_pop(q);
+      pqueue_tag_element_t* from_heap = tag_heap_pop(&h);
+      assert(lf_tag_compare(from_queue->tag, from_heap->tag) == 0);
+      queued[from_heap - in_heap] = false;
+      // Elements with equal tags may come out in a different order.
+      if (from_queue - in_queue != from_heap - in_heap) {
+        pqueue_tag_insert(q, from_queue);
+        pqueue_tag_remove(q, &in_queue[from_heap - in_heap]);
+      }
+    } else {
+      assert((pqueue_tag_find_with_tag(q, in_queue[e].tag) == NULL) ==
+             (tag_heap_find(&h, in_heap[e].tag, NULL, NULL) == NULL));
+    }
+    assert(tag_heap_is_valid(&h));
+    assert(pqueue_tag_size(q) == tag_heap_size(&h));
+  }
+  pqueue_tag_free(q);
+  tag_heap_free(&h);
+  free(queued);
+  free(in_heap);
+  free(in_queue);
+}
+
 int main() {
   trivial();
   // Create an event queue.
@@ -99,6 +180,13 @@ int main() {
   pqueue_tag_element_t e2 = {.tag = {.time = USEC(2), .microstep = 0}, .pos = 0, .is_dynamic = 0};
 
   remove_from_queue(q, &e1, &e2);
+  pqueue_tag_remove(q, &e2);
+
+  // Few elements added to a large queue, and many added to a small one.
+  insert_all_into_queue(q, 1000, 10);
+  insert_all_into_queue(q, 10, 1000);
 
   pqueue_tag_free(q);
+
+  tag_heap_matches_queue();
 }
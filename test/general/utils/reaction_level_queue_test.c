@@ -0,0 +1,82 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "reaction_level_queue.h"
+#include "pqueue.h"
+#include "rand_utils.h"
+#include "util.h"
+
+/** The index of a reaction with no deadline at the given level. */
+#define NO_DEADLINE(level) ((((ULLONG_MAX >> 16) << 16)) | (index_t)(level))
+
+static void pop_empty(void) {
+  reaction_level_queue_t* q = reaction_level_queue_init(1);
+  LF_TEST(q != NULL, "Could not create a queue.");
+  LF_TEST(reaction_level_queue_size(q) == 0, "A new queue is not empty.");
+  LF_TEST(reaction_level_queue_pop(q) == NULL, "An empty queue popped a reaction.");
+  reaction_level_queue_free(q);
+}
+
+static void deadlines_come_first(void) {
+  reaction_t r[4] = {0};
+  r[0].index = NO_DEADLINE(0);
+  r[1].index = NO_DEADLINE(3);
+  r[2].index = (MSEC(1) << 16) | 5;
+  r[3].index = (MSEC(2) << 16) | 1;
+  reaction_level_queue_t* q = reaction_level_queue_init(1);
+  for (int i = 0; i < 4; i++) {
+    LF_TEST(reaction_level_queue_insert(q, &r[i]) == 0, "Could not insert a reaction.");
+  }
+  LF_TEST(reaction_level_queue_size(q) == 4, "The queue does not hold every reaction.");
+  LF_TEST(reaction_level_queue_pop(q) == &r[2], "The earliest deadline does not come first.");
+  LF_TEST(reaction_level_queue_pop(q) == &r[3], "The later deadline does not come second.");
+  LF_TEST(reaction_level_queue_pop(q) == &r[0], "Reactions without deadlines are not by level.");
+  LF_TEST(reaction_level_queue_pop(q) == &r[1], "Reactions without deadlines are not by level.");
+  LF_TEST(reaction_level_queue_pop(q) == NULL, "The queue popped more reactions than it was given.");
+  reaction_level_queue_free(q);
+}
+
+static void level_queue_matches_pqueue(void) {
+  // Apply the same random inserts and pops to both queues, including levels that make the level queue grow.
+  // Each queue gets its own copy of each reaction, since reactions with equal indices may come out
+  // in a different order.
+  size_t n = 20000;
+  reaction_t* in_level_queue = (reaction_t*)calloc(n, sizeof(reaction_t));
+  reaction_t* in_pqueue = (reaction_t*)calloc(n, sizeof(reaction_t));
+  reaction_level_queue_t* q = reaction_level_queue_init(2);
+  pqueue_reaction_t* p = pqueue_reaction_init(2);
+  uint32_t state = 1830;
+  size_t inserted = 0;
+  while (inserted < n) {
+    uint32_t r = next_random(&state);
+    if (r % 3 != 0 || reaction_level_queue_size(q) == 0) {
+      index_t level = r % 8 == 0 ? next_random(&state) % 65536 : next_random(&state) % 100;
+      index_t index = r % 5 == 0 ? ((index_t)(next_random(&state) % 50) << 16) | level : NO_DEADLINE(level);
+      in_level_queue[inserted].index = in_pqueue[inserted].index = index;
+      LF_TEST(reaction_level_queue_insert(q, &in_level_queue[inserted]) == 0, "Could not insert a reaction.");
+      LF_TEST(pqueue_reaction_insert(p, &in_pqueue[inserted]) == 0, "Could not insert a reaction.");
+      inserted++;
+    } else {
+      reaction_t* from_level_queue = reaction_level_queue_pop(q);
+      reaction_t* from_pqueue = (reaction_t*)pqueue_reaction_pop(p);
+      LF_TEST(from_level_queue->index == from_pqueue->index, "The queues popped different indices.");
+    }
+    LF_TEST(reaction_level_queue_size(q) == pqueue_reaction_size(p), "The queues have different sizes.");
+  }
+  while (reaction_level_queue_size(q) > 0) {
+    LF_TEST(reaction_level_queue_pop(q)->index == ((reaction_t*)pqueue_reaction_pop(p))->index,
+            "The queues popped different indices.");
+  }
+  LF_TEST(pqueue_reaction_size(p) == 0, "The queues have different sizes.");
+  reaction_level_queue_free(q);
+  pqueue_reaction_free(p);
+  free(in_pqueue);
+  free(in_level_queue);
+}
+
+int main() {
+  pop_empty();
+  deadlines_come_first();
+  level_queue_matches_pqueue();
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "core/utils/impl/pointer_set.h"
+#include "core/utils/impl/pointer_hashmap.h"
+#include "core/utils/util.h"
+#include "rand_utils.h"
+
+// A map from pointers to integers.
+#define SWISS_TABLE(token) int_map##_##token
+#define K void*
+#define V int
+#define HASH_OF(key) swiss_table_hash_pointer(key)
+#define KEY_EQUAL(a, b) ((a) == (b))
+#include "core/utils/impl/swiss_table.h"
+#undef SWISS_TABLE
+#undef K
+#undef V
+#undef HASH_OF
+#undef KEY_EQUAL
+
+// A set whose hash has only a few distinct values, so that all keys share one probe sequence.
+#define SWISS_TABLE(token) colliding_set##_##token
+#define K size_t
+#define HASH_OF(key) ((key) % 3)
+#define KEY_EQUAL(a, b) ((a) == (b))
+#include "core/utils/impl/swiss_table.h"
+#undef SWISS_TABLE
+#undef K
+#undef HASH_OF
+#undef KEY_EQUAL
+
+// Number of distinct keys used by the randomized tests, and number of operations they perform.
+#define KEYS 1000
+#define STEPS 200000
+
+/** Return a distinct pointer for each index. Index 0 is NULL, which is a valid key. */
+static void* key_of(size_t i) { return (void*)(uintptr_t)(i * 16); }
+
+static void trivial(void) {
+  pointer_set_t set = {0};
+  LF_TEST(pointer_set_size(&set) == 0, "A new set is not empty.");
+  LF_TEST(!pointer_set_contains(&set, NULL), "A new set contains NULL.");
+  LF_TEST(pointer_set_remove(&set, NULL) == 0, "A new set removed NULL.");
+  void* key;
+  LF_TEST(!pointer_set_remove_any(&set, &key), "A new set removed a pointer.");
+
+  LF_TEST(pointer_set_add(&set, NULL) == 1, "Could not add NULL.");
+  LF_TEST(pointer_set_add(&set, (void*)1) == 1, "Could not add a pointer.");
+  LF_TEST(pointer_set_add(&set, (void*)1) == 0, "A pointer was added twice.");
+  LF_TEST(pointer_set_size(&set) == 2, "The set does not hold both pointers.");
+  LF_TEST(pointer_set_contains(&set, NULL), "The set does not contain NULL.");
+  LF_TEST(pointer_set_contains(&set, (void*)1), "The set does not contain a pointer that was added.");
+  LF_TEST(!pointer_set_contains(&set, (void*)2), "The set contains a pointer that was not added.");
+  LF_TEST(pointer_set_remove(&set, (void*)1) == 1, "Could not remove a pointer.");
+  LF_TEST(pointer_set_remove(&set, (void*)1) == 0, "A pointer was removed twice.");
+  LF_TEST(pointer_set_remove_any(&set, &key) && key == NULL, "The set did not give up its last pointer.");
+  LF_TEST(pointer_set_size(&set) == 0, "The set is not empty.");
+  pointer_set_free(&set);
+
+  int_map_t map;
+  LF_TEST(int_map_initialize(&map, 100) == 0, "Could not reserve capacity.");
+  size_t capacity = map.capacity;
+  for (int i = 0; i < 100; i++)
+    LF_TEST(int_map_put(&map, key_of(i), i) == 1, "Could not put a new key.");
+  // Reserved capacity is not exceeded.
+  LF_TEST(map.capacity == capacity, "The map grew beyond the reserved capacity.");
+  LF_TEST(int_map_put(&map, key_of(7), -7) == 0, "Putting an existing key added it again.");
+  LF_TEST(*int_map_get(&map, key_of(7)) == -7, "Putting an existing key did not replace its value.");
+  LF_TEST(int_map_get(&map, key_of(100)) == NULL, "The map has a key that was not put.");
+  int_map_free(&map);
+}
+
+static void randomized_against_model(void) {
+  // present[i] tells whether key_of(i) is in the map, and values[i] is its value.
+  static bool present[KEYS];
+  static int values[KEYS];
+  size_t size = 0;
+  int_map_t map = {0};
+  uint32_t state = 1830;
+  for (int step = 0; step < STEPS; step++) {
+    size_t i = next_random(&state) % KEYS;
+    uint32_t action = next_random(&state) % 8;
+    if (action < 3) {
+      int value = (int)next_random(&state);
+      LF_TEST(int_map_put(&map, key_of(i), value) == (present[i] ? 0 : 1),
+              "The map does not agree with the model on whether a key is new.");
+      size += !present[i];
+      present[i] = true;
+      values[i] = value;
+    } else if (action < 6) {
+      LF_TEST(int_map_remove(&map, key_of(i)) == (present[i] ? 1 : 0),
+              "The map does not agree with the model on whether a key is present.");
+      size -= present[i];
+      present[i] = false;
+    } else {
+      int* value = int_map_get(&map, key_of(i));
+      LF_TEST((value != NULL) == present[i], "The map does not agree with the model on whether a key is present.");
+      LF_TEST(value == NULL || *value == values[i], "The map does not agree with the model on a value.");
+    }
+    LF_TEST(int_map_size(&map) == size, "The map does not agree with the model on its size.");
+    if (step % 10000 == 0) {
+      // The iterator visits each key exactly once.
+      static bool visited[KEYS];
+      memset(visited, 0, sizeof(visited));
+      size_t count = 0;
+      int_map_iterator_t it = int_map_iterator(&map);
+      void* key;
+      int value;
+      while (int_map_iterator_next(&it, &key, &value)) {
+        size_t j = (uintptr_t)key / 16;
+        LF_TEST(j < KEYS && present[j] && !visited[j] && values[j] == value,
+                "The iterator visited a key that is not in the map.");
+        visited[j] = true;
+        count++;
+      }
+      LF_TEST(count == size, "The iterator did not visit every key.");
+    }
+  }
+  // Remove everything while iterating.
+  int_map_iterator_t it = int_map_iterator(&map);
+  void* key;
+  int value;
+  while (int_map_iterator_next(&it, &key, &value)) {
+    LF_TEST(int_map_remove(&map, key) == 1, "Could not remove a key while iterating.");
+    size--;
+  }
+  LF_TEST(size == 0 && int_map_size(&map) == 0, "The map is not empty after removing every key.");
+  int_map_free(&map);
+}
+
+static void colliding_keys(void) {
+  // Keys are added and removed repeatedly, so the single probe sequence fills with DELETED slots
+  // that must be skipped by lookups and reclaimed when the table is rebuilt.
+  colliding_set_t set = {0};
+  uint32_t state = 42;
+  static bool present[KEYS];
+  for (int step = 0; step < STEPS / 10; step++) {
+    size_t key = next_random(&state) % 200;
+    if (present[key]) {
+      LF_TEST(colliding_set_remove(&set, key) == 1, "Could not remove a colliding key.");
+    } else {
+      LF_TEST(colliding_set_add(&set, key) == 1, "Could not add a colliding key.");
+    }
+    present[key] = !present[key];
+    size_t probe = next_random(&state) % 200;
+    LF_TEST(colliding_set_contains(&set, probe) == present[probe],
+            "The set does not agree with the model on a colliding key.");
+  }
+  // The table has not grown beyond what 200 keys need.
+  LF_TEST(set.capacity <= 512, "The table grew although its deleted slots could be reclaimed.");
+  colliding_set_free(&set);
+}
+
+int main(void) {
+  trivial();
+  randomized_against_model();
+  colliding_keys();
+  return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * This tests the timer wheel that serves the watchdogs of an environment. Watchdogs are started
+ * with timeouts that put them in different slots and levels of the wheel, then stopped or
+ * restarted, and the test checks which handlers are invoked, in what order, and not too early.
+ */
+#include <stdlib.h>
+#include "environment.h"
+#include "low_level_platform.h"
+#include "util.h"
+
+#if !defined(LF_SINGLE_THREADED)
+#include "watchdog.h"
+
+#define WATCHDOGS 4
+
+/** A reactor with one watchdog that records when its handler is invoked. */
+typedef struct {
+  self_base_t base;
+  lf_mutex_t mutex;
+  watchdog_t watchdog;
+  int firings;
+  int order;
+  instant_t fired_at;
+} watched_t;
+
+static environment_t env;
+static watched_t reactors[WATCHDOGS];
+static int firings;
+
+static void handler(void* self) {
+  watched_t* reactor = (watched_t*)self;
+  reactor->firings++;
+  reactor->order = firings++;
+  reactor->fired_at = lf_time_physical();
+}
+
+/** Start or restart the watchdog of a reactor to expire the timeout after now. */
+static void start(int i, interval_t timeout) {
+  LF_MUTEX_LOCK(&reactors[i].mutex);
+  env.current_tag.time = lf_time_physical();
+  lf_watchdog_start(&reactors[i].watchdog, timeout);
+  LF_MUTEX_UNLOCK(&reactors[i].mutex);
+}
+
+static void stop(int i) {
+  LF_MUTEX_LOCK(&reactors[i].mutex);
+  lf_watchdog_stop(&reactors[i].watchdog);
+  LF_MUTEX_UNLOCK(&reactors[i].mutex);
+}
+
+static void reset(void) {
+  firings = 0;
+  for (int i = 0; i < WATCHDOGS; i++) {
+    LF_MUTEX_LOCK(&reactors[i].mutex);
+    reactors[i].firings = 0;
+    reactors[i].order = -1;
+    LF_MUTEX_UNLOCK(&reactors[i].mutex);
+  }
+}
+
+static void expiry_order(void) {
+  // Two watchdogs are in the first level of the wheel and two in the second.
+  reset();
+  const interval_t timeouts[WATCHDOGS] = {MSEC(150), MSEC(5), MSEC(90), MSEC(30)};
+  const int expected[WATCHDOGS] = {3, 0, 2, 1};
+  instant_t started[WATCHDOGS];
+  for (int i = 0; i < WATCHDOGS; i++) {
+    started[i] = lf_time_physical();
+    start(i, timeouts[i]);
+  }
+  lf_sleep(MSEC(300));
+  for (int i = 0; i < WATCHDOGS; i++) {
+    LF_TEST(reactors[i].firings == 1, "A watchdog did not expire exactly once.");
+    LF_TEST(reactors[i].order == expected[i], "The watchdogs did not expire in the order of their expirations.");
+    LF_TEST(reactors[i].fired_at >= started[i] + timeouts[i], "A watchdog expired too early.");
+    LF_TEST(!reactors[i].watchdog.active, "An expired watchdog is still active.");
+  }
+}
+
+static void stop_in_every_level(void) {
+  reset();
+  start(0, MSEC(10));
+  start(1, MSEC(100));
+  start(2, MSEC(10));
+  stop(0);
+  stop(1);
+  // Stopping a watchdog twice has no effect.
+  stop(1);
+  lf_sleep(MSEC(200));
+  LF_TEST(reactors[0].firings == 0 && reactors[1].firings == 0, "A stopped watchdog expired.");
+  LF_TEST(!reactors[0].watchdog.active && !reactors[1].watchdog.active, "A stopped watchdog is still active.");
+  LF_TEST(reactors[2].firings == 1, "A watchdog that was not stopped did not expire.");
+}
+
+static void restart_across_slots(void) {
+  reset();
+  // Restarting moves a watchdog from the second level of the wheel to the first and back.
+  start(0, MSEC(100));
+  start(0, MSEC(10));
+  instant_t restarted = lf_time_physical();
+  start(1, MSEC(10));
+  start(1, MSEC(120));
+  lf_sleep(MSEC(60));
+  LF_TEST(reactors[0].firings == 1, "A watchdog restarted with a shorter timeout did not expire.");
+  LF_TEST(reactors[0].fired_at < restarted + MSEC(100), "A restarted watchdog expired at its old expiration.");
+  LF_TEST(reactors[1].firings == 0, "A watchdog restarted with a longer timeout expired at its old expiration.");
+  lf_sleep(MSEC(150));
+  LF_TEST(reactors[0].firings == 1, "A restarted watchdog expired again at its old expiration.");
+  LF_TEST(reactors[1].firings == 1, "A watchdog restarted with a longer timeout did not expire.");
+}
+
+int main(void) {
+  environment_init(&env, "main", 0, 1, 0, 0, 0, 0, 0, 0, 0, WATCHDOGS, NULL);
+  for (int i = 0; i < WATCHDOGS; i++) {
+    reactors[i].base.environment = &env;
+    reactors[i].base.reactor_mutex = &reactors[i].mutex;
+    reactors[i].watchdog.base = &reactors[i].base;
+    reactors[i].watchdog.expiration = NEVER;
+    reactors[i].watchdog.watchdog_function = handler;
+    env.watchdogs[i] = &reactors[i].watchdog;
+  }
+  _lf_initialize_watchdogs(&env);
+  expiry_order();
+  stop_in_every_level();
+  restart_across_slots();
+  _lf_watchdog_terminate_all(&env);
+  LF_TEST(env.watchdog_wheel == NULL, "The watchdog thread was not terminated.");
+  return 0;
+}
+#else
+int main(void) { return 0; }
+#endif // LF_SINGLE_THREADED
@@ -19,3 +19,16 @@ void perturb(int* src, size_t size, int* out) {
     out[a + 1] = src[a + 1] - diff;
   }
 }
+
+/**
+ * @brief Return the next value of a xorshift generator. Unlike `rand`, this
+ * gives the same sequence on every platform, and each caller keeps its own state.
+ *
+ * @param state The state of the generator, which must not be 0. It is updated.
+ */
+uint32_t next_random(uint32_t* state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
@@ -1,4 +1,5 @@
 #include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief Ensures that the expectation of each entry of `out` is equal
@@ -10,3 +11,11 @@
  * @param out An array of integers of size `size`.
  */
 void perturb(int* src, size_t size, int* out);
+
+/**
+ * @brief Return the next value of a xorshift generator. Unlike `rand`, this
+ * gives the same sequence on every platform, and each caller keeps its own state.
+ *
+ * @param state The state of the generator, which must not be 0. It is updated.
+ */
+uint32_t next_random(uint32_t* state);
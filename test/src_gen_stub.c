@@ -1,4 +1,6 @@
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include "tag.h"
 #include "environment.h"
 
@@ -11,12 +13,49 @@
 
 environment_t _env;
 
+void lf_create_environments(void) {}
 void _lf_initialize_trigger_objects(void) {}
 void lf_terminate_execution(void) {}
 void lf_set_default_command_line_options(void) {}
-void _lf_initialize_watchdogs(environment_t** envs) { (void)envs; }
 void logical_tag_complete(tag_t tag_to_send) { (void)tag_to_send; }
 int _lf_get_environments(environment_t** envs) {
   *envs = &_env;
   return 1;
 }
+#ifdef LF_ENCLAVES
+// Generated for programs with enclaves. By default, the tests have no connections between enclaves.
+// A test connects them by pointing _lf_stub_enclave_delays at an n by n matrix, where entry i * n + j
+// is the delay of the connection from enclave i to enclave j, or FOREVER if there is none.
+int _lf_stub_num_enclaves = 0;
+interval_t* _lf_stub_enclave_delays = NULL;
+
+static int connected(int enclave_id, bool upstream, uint16_t** ids, interval_t** delays) {
+  int n = _lf_stub_num_enclaves;
+  int count = 0;
+  *ids = n > 0 ? (uint16_t*)calloc(n, sizeof(uint16_t)) : NULL;
+  if (delays != NULL) {
+    *delays = n > 0 ? (interval_t*)calloc(n, sizeof(interval_t)) : NULL;
+  }
+  for (int other = 0; other < n && _lf_stub_enclave_delays != NULL; other++) {
+    interval_t delay = upstream ? _lf_stub_enclave_delays[other * n + enclave_id]
+                                : _lf_stub_enclave_delays[enclave_id * n + other];
+    if (delay != FOREVER) {
+      (*ids)[count] = (uint16_t)other;
+      if (delays != NULL) {
+        (*delays)[count] = delay;
+      }
+      count++;
+    }
+  }
+  return count;
+}
+
+int lf_get_upstream_of(int enclave_id, uint16_t** result) { return connected(enclave_id, true, result, NULL); }
+int lf_get_downstream_of(int enclave_id, uint16_t** result) { return connected(enclave_id, false, result, NULL); }
+int lf_get_upstream_delay_of(int enclave_id, interval_t** result) {
+  uint16_t* ids;
+  int count = connected(enclave_id, true, &ids, result);
+  free(ids);
+  return count;
+}
+#endif
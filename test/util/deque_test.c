@@ -0,0 +1,156 @@
+/**
+ * This tests the double-ended queue, in particular where its values wrap around the end of the
+ * ring buffer: growth, pushing and popping several values at once, peeking, and iterating.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "util.h"
+#include "deque.h"
+
+/** Values are small integers, offset by one so that none of them is NULL. */
+#define VALUE(i) ((void*)(intptr_t)((i) + 1))
+#define INDEX(value) ((int)(intptr_t)(value) - 1)
+
+/** Check that the deque holds the values from first to last, in order, by iterating over it. */
+static void expect_values(deque_t* d, int first, int last) {
+  size_t size = deque_size(d);
+  LF_TEST(size == (size_t)(last - first + 1), "The deque holds %zu values, not %d.", size, last - first + 1);
+  deque_iterator_t iterator = deque_iterator(d);
+  void* value;
+  int expected = first;
+  while (deque_iterator_next(&iterator, &value)) {
+    LF_TEST(INDEX(value) == expected, "The iterator returned %d, not %d.", INDEX(value), expected);
+    expected++;
+  }
+  LF_TEST(expected == last + 1, "The iterator stopped at %d, not after %d.", expected, last);
+  LF_TEST(!deque_iterator_next(&iterator, &value), "The iterator went on after the back of the deque.");
+}
+
+static void empty_queue(void) {
+  deque_t d;
+  deque_initialize(&d);
+  LF_TEST(deque_is_empty(&d) && deque_size(&d) == 0, "A new deque holds %zu values.", deque_size(&d));
+  LF_TEST(deque_pop_front(&d) == NULL, "Popping the front of an empty deque returned a value.");
+  LF_TEST(deque_pop_back(&d) == NULL, "Popping the back of an empty deque returned a value.");
+  LF_TEST(deque_peek_front(&d) == NULL, "Peeking at the front of an empty deque returned a value.");
+  LF_TEST(deque_peek_back(&d) == NULL, "Peeking at the back of an empty deque returned a value.");
+  void* values[4];
+  size_t popped = deque_pop_front_n(&d, values, 4);
+  LF_TEST(popped == 0, "Popping from an empty deque returned %zu values.", popped);
+  deque_iterator_t iterator = deque_iterator(&d);
+  LF_TEST(!deque_iterator_next(&iterator, &values[0]), "Iterating over an empty deque returned a value.");
+  LF_TEST(deque_is_empty(NULL) && deque_pop_front(NULL) == NULL, "A NULL deque is not empty.");
+
+  // Once it has been emptied, the deque is empty again.
+  deque_push_back(&d, VALUE(0));
+  deque_pop_back(&d);
+  LF_TEST(deque_is_empty(&d) && deque_pop_front(&d) == NULL, "An emptied deque holds %zu values.", deque_size(&d));
+  deque_free(&d);
+}
+
+static void growth_while_wrapped(void) {
+  deque_t d;
+  deque_initialize(&d);
+  // Pushing to the front of an empty ring buffer wraps around its end at once.
+  for (int i = 3; i >= 0; i--) {
+    deque_push_front(&d, VALUE(i));
+  }
+  for (int i = 4; i < 8; i++) {
+    deque_push_back(&d, VALUE(i));
+  }
+  size_t capacity = d.capacity;
+  LF_TEST(d.front + d.size > d.capacity || d.size == d.capacity, "The values of the deque do not wrap around.");
+  // The ring buffer is full and wrapped, so the next value makes it grow.
+  for (int i = 8; i < 100; i++) {
+    deque_push_back(&d, VALUE(i));
+  }
+  LF_TEST(d.capacity > capacity, "The ring buffer did not grow from %zu slots.", capacity);
+  expect_values(&d, 0, 99);
+
+  // Values pushed to both ends while the ring buffer is wrapped.
+  for (int i = 0; i < 50; i++) {
+    LF_TEST(INDEX(deque_pop_front(&d)) == i, "Popping the front did not return %d.", i);
+  }
+  capacity = d.capacity;
+  for (int i = 49; i >= 0; i--) {
+    deque_push_front(&d, VALUE(i));
+  }
+  for (int i = 100; i < 200; i++) {
+    deque_push_back(&d, VALUE(i));
+  }
+  LF_TEST(d.capacity > capacity, "The ring buffer did not grow from %zu slots.", capacity);
+  expect_values(&d, 0, 199);
+  for (int i = 199; i >= 0; i--) {
+    LF_TEST(INDEX(deque_pop_back(&d)) == i, "Popping the back did not return %d.", i);
+  }
+  LF_TEST(deque_is_empty(&d), "The deque holds %zu values after popping all of them.", deque_size(&d));
+
+  // The ring buffer is kept, and deque_free() releases it.
+  LF_TEST(d.items != NULL, "Emptying the deque released its ring buffer.");
+  deque_free(&d);
+  LF_TEST(d.items == NULL && d.capacity == 0 && deque_is_empty(&d), "deque_free() did not empty the deque.");
+}
+
+static void peek_at_both_ends(void) {
+  deque_t d;
+  deque_initialize(&d);
+  deque_push_back(&d, VALUE(1));
+  LF_TEST(deque_peek_front(&d) == VALUE(1) && deque_peek_back(&d) == VALUE(1),
+          "Peeking at a deque of one value returned %d and %d.", INDEX(deque_peek_front(&d)),
+          INDEX(deque_peek_back(&d)));
+  deque_push_front(&d, VALUE(0));
+  deque_push_back(&d, VALUE(2));
+  LF_TEST(deque_peek_front(&d) == VALUE(0), "Peeking at the front returned %d.", INDEX(deque_peek_front(&d)));
+  LF_TEST(deque_peek_back(&d) == VALUE(2), "Peeking at the back returned %d.", INDEX(deque_peek_back(&d)));
+  expect_values(&d, 0, 2);
+  deque_free(&d);
+}
+
+static void several_values_across_the_end(void) {
+  deque_t d;
+  deque_initialize(&d);
+  void* values[64];
+  for (int i = 0; i < 64; i++) {
+    values[i] = VALUE(i);
+  }
+  // Fill half of the ring buffer and pop it, so that the next values start in the middle.
+  deque_push_back_n(&d, values, 8);
+  size_t capacity = d.capacity;
+  void* popped[64];
+  size_t count = deque_pop_front_n(&d, popped, 5);
+  LF_TEST(count == 5 && INDEX(popped[4]) == 4, "Popping 5 values returned %zu.", count);
+  // These values wrap around the end of the ring buffer without growing it.
+  deque_push_back_n(&d, values + 8, capacity - 3);
+  LF_TEST(d.capacity == capacity, "The ring buffer grew from %zu to %zu slots while it had room.", capacity,
+          d.capacity);
+  LF_TEST(d.front + d.size > d.capacity, "The values of the deque do not wrap around.");
+  LF_TEST(deque_peek_back(&d) == VALUE(capacity + 4), "The back of the deque is %d.", INDEX(deque_peek_back(&d)));
+  expect_values(&d, 5, (int)capacity + 4);
+  // Popping the values across the end returns them in order.
+  count = deque_pop_front_n(&d, popped, capacity - 1);
+  LF_TEST(count == capacity - 1, "Popping %zu values returned %zu.", capacity - 1, count);
+  for (size_t i = 0; i < count; i++) {
+    LF_TEST(INDEX(popped[i]) == (int)i + 5, "Value %zu popped is %d.", i, INDEX(popped[i]));
+  }
+  // Popping more values than there are returns the rest.
+  count = deque_pop_front_n(&d, popped, 64);
+  LF_TEST(count == 1 && INDEX(popped[0]) == (int)capacity + 4, "Popping the rest returned %zu values.", count);
+  LF_TEST(deque_is_empty(&d), "The deque holds %zu values after popping all of them.", deque_size(&d));
+
+  // Pushing nothing changes nothing, and pushing more than there is room for grows the ring buffer once.
+  deque_push_back_n(&d, values, 0);
+  LF_TEST(deque_is_empty(&d), "Pushing no values added %zu.", deque_size(&d));
+  deque_push_back(&d, VALUE(0));
+  deque_push_back_n(&d, values + 1, 63);
+  LF_TEST(d.capacity >= 64, "The ring buffer has %zu slots for 64 values.", d.capacity);
+  expect_values(&d, 0, 63);
+  deque_free(&d);
+}
+
+int main(void) {
+  empty_queue();
+  growth_while_wrapped();
+  peek_at_both_ends();
+  several_values_across_the_end();
+  return 0;
+}
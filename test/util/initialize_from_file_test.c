@@ -0,0 +1,120 @@
+/**
+ * This tests the loading of delimited files by lf_csv_table_open() and the table of each file that
+ * lf_initialize_double(), lf_initialize_int(), and _lf_initialize_string() load once and share.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "initialize_from_file.h"
+#include "low_level_platform.h"
+#include "util.h"
+
+#define FILE_NAME "initialize_from_file_test.csv"
+#define EMPTY_FILE_NAME "initialize_from_file_test_empty.csv"
+#define NEW_FILE_NAME "initialize_from_file_test_new.csv"
+
+#if !defined(LF_SINGLE_THREADED)
+// Defined in reactor_threaded.c and initialized by the runtime, which this test does not start.
+extern lf_mutex_t global_mutex;
+#endif
+
+static void write_file(const char* name, const char* contents) {
+  FILE* f = fopen(name, "wb");
+  LF_TEST(f != NULL, "Could not create a file.");
+  fputs(contents, f);
+  fclose(f);
+}
+
+static void table_rows(void) {
+  // A byte order mark, a header, Windows line ends, quoted strings, and a last row without a line end.
+  write_file(FILE_NAME, "\xEF\xBB\xBF"
+                        "x,y,name\r\n"
+                        "1.5, -2 ,\"first\"\r\n"
+                        "3e2,7,'second'\r\n"
+                        "0.125,12345678901234567,third");
+  lf_csv_table_t* table = lf_csv_table_open(FILE_NAME, ',');
+  LF_TEST(table != NULL, "Could not open the table.");
+  LF_TEST(lf_csv_table_rows(table) == 4, "The table does not have one row per line.");
+
+  double x, y;
+  LF_TEST(lf_csv_table_double(table, 1, &x, &y, NULL) == 2, "A row of doubles was not parsed.");
+  LF_TEST(x == 1.5 && y == -2.0, "A row of doubles has the wrong values.");
+  LF_TEST(lf_csv_table_double(table, 2, &x, NULL) == 1 && x == 300.0, "A double with an exponent is wrong.");
+  int a, b;
+  LF_TEST(lf_csv_table_int(table, 2, &a, &b, NULL) == -1, "A double was parsed as an integer.");
+  LF_TEST(lf_csv_table_int(table, 1, &a, &b, NULL) == -1, "A double was parsed as an integer.");
+  LF_TEST(lf_csv_table_double(table, 3, &x, &y, NULL) == 2 && x == 0.125 && y == 12345678901234567.0,
+          "The last row without a line end is wrong.");
+
+  char* first;
+  char* second;
+  char* third;
+  LF_TEST(_lf_csv_table_string(table, 0, NULL, &first, &second, &third, NULL) == 3,
+          "The header row was not parsed as strings.");
+  LF_TEST(strcmp(first, "x") == 0 && strcmp(third, "name") == 0, "The byte order mark or line end was kept.");
+  free(first);
+  free(second);
+  free(third);
+  LF_TEST(_lf_csv_table_string(table, 2, NULL, &first, &second, &third, NULL) == 3 && strcmp(third, "second") == 0,
+          "The quotes of a string were not stripped.");
+  free(first);
+  free(second);
+  free(third);
+  LF_TEST(lf_csv_table_double(table, 4, &x, NULL) == -1, "A row after the end was read.");
+  lf_csv_table_close(table);
+  lf_csv_table_close(NULL);
+  LF_TEST(lf_csv_table_open("initialize_from_file_test_missing.csv", ',') == NULL, "A missing file was opened.");
+}
+
+static void files_that_are_read(void) {
+  // An empty file has no contents to map.
+  write_file(EMPTY_FILE_NAME, "");
+  lf_csv_table_t* table = lf_csv_table_open(EMPTY_FILE_NAME, ',');
+  LF_TEST(table != NULL && lf_csv_table_rows(table) == 0, "An empty file does not give an empty table.");
+  lf_csv_table_close(table);
+  remove(EMPTY_FILE_NAME);
+#ifdef __linux__
+  // Files in /proc report a size of 0 but have contents.
+  table = lf_csv_table_open("/proc/self/status", ',');
+  LF_TEST(table != NULL && lf_csv_table_rows(table) > 1, "A file that reports no size was not read.");
+  char* name;
+  LF_TEST(_lf_csv_table_string(table, 0, NULL, &name, NULL) == 1 && strncmp(name, "Name:", 5) == 0,
+          "A file that reports no size has the wrong contents.");
+  free(name);
+  lf_csv_table_close(table);
+#endif
+}
+
+static void shared_tables(void) {
+  write_file(FILE_NAME, "a,b\n1,2\n3,4\n");
+  int a, b;
+  LF_TEST(lf_initialize_int(FILE_NAME, ',', 2, &a, &b, NULL) == 2 && a == 3 && b == 4, "A row was not read.");
+  // The file is loaded once, so a file that replaces it is not seen.
+  write_file(NEW_FILE_NAME, "a,b\n5,6\n");
+  LF_TEST(rename(NEW_FILE_NAME, FILE_NAME) == 0, "Could not replace the file.");
+  double x;
+  LF_TEST(lf_initialize_double(FILE_NAME, ',', 1, &x, NULL) == 1 && x == 1.0, "The file was loaded again.");
+  LF_TEST(lf_initialize_int(FILE_NAME, ',', 2, &a, NULL) == 1 && a == 3, "The file was loaded again.");
+  char* text;
+  LF_TEST(_lf_initialize_string(FILE_NAME, ',', 0, NULL, &text, NULL) == 1 && strcmp(text, "a") == 0,
+          "The shared table was not read as strings.");
+  free(text);
+  // Each call may use another delimiter for the same table.
+  LF_TEST(_lf_initialize_string(FILE_NAME, ';', 1, NULL, &text, NULL) == 1 && strcmp(text, "1,2") == 0,
+          "The delimiter of a call was not used.");
+  free(text);
+  LF_TEST(lf_initialize_int("initialize_from_file_test_missing.csv", ',', 0, &a, NULL) == -1,
+          "A missing file was read.");
+  LF_TEST(lf_initialize_int(FILE_NAME, ',', 3, &a, NULL) == -1, "A row after the end was read.");
+}
+
+int main(void) {
+#if !defined(LF_SINGLE_THREADED)
+  LF_MUTEX_INIT(&global_mutex);
+#endif
+  table_rows();
+  files_that_are_read();
+  shared_tables();
+  remove(FILE_NAME);
+  return 0;
+}
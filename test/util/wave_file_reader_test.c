@@ -0,0 +1,181 @@
+/**
+ * This tests the wave files that are mapped into memory and shared through reference-counted
+ * views, the token destructor and copy constructor for them, and the delivery of a file in chunks.
+ * The test writes its own small wave files with known samples.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+#include "wave_file_reader.h"
+
+#define FILE_NAME "wave_file_reader_test.wav"
+#define CHANNELS 2
+// Enough samples for the chunks of a stream to span several pages.
+#define SAMPLES 20000
+
+/** Write a stereo 16-bit wave file with the given samples, a junk chunk of the given size, and a data size. */
+static void write_wave(const char* name, uint32_t samples, uint32_t junk, uint32_t data_bytes) {
+  FILE* f = fopen(name, "wb");
+  LF_TEST(f != NULL, "Could not create %s.", name);
+  const uint32_t fmt_size = 16;
+  const uint16_t format = 1;
+  const uint16_t channels = CHANNELS;
+  const uint32_t rate = 44100;
+  const uint32_t byte_rate = rate * CHANNELS * 2;
+  const uint16_t align = CHANNELS * 2;
+  const uint16_t bits = 16;
+  uint32_t riff_size = 36 + (junk > 0 ? 8 + junk : 0) + data_bytes;
+  fwrite("RIFF", 1, 4, f);
+  fwrite(&riff_size, 4, 1, f);
+  fwrite("WAVEfmt ", 1, 8, f);
+  fwrite(&fmt_size, 4, 1, f);
+  fwrite(&format, 2, 1, f);
+  fwrite(&channels, 2, 1, f);
+  fwrite(&rate, 4, 1, f);
+  fwrite(&byte_rate, 4, 1, f);
+  fwrite(&align, 2, 1, f);
+  fwrite(&bits, 2, 1, f);
+  if (junk > 0) {
+    fwrite("LIST", 1, 4, f);
+    fwrite(&junk, 4, 1, f);
+    for (uint32_t i = 0; i < junk; i++) {
+      fputc(0, f);
+    }
+  }
+  fwrite("data", 1, 4, f);
+  fwrite(&data_bytes, 4, 1, f);
+  for (uint32_t i = 0; i < samples; i++) {
+    int16_t sample = (int16_t)(i % 30000);
+    fwrite(&sample, 2, 1, f);
+  }
+  fclose(f);
+}
+
+/** Return whether the waveform holds the samples of the test files from the given one on. */
+static bool holds_samples(lf_waveform_t* waveform, uint32_t start) {
+  for (uint32_t i = 0; i < waveform->length; i++) {
+    if (waveform->waveform[i] != (int16_t)((start + i) % 30000)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void map_and_views(uint32_t junk) {
+  write_wave(FILE_NAME, SAMPLES, junk, SAMPLES * 2);
+  lf_waveform_t* whole = lf_waveform_map(FILE_NAME);
+  LF_TEST(whole != NULL && whole->storage != NULL, "Could not map a wave file with a junk chunk of %u bytes.", junk);
+  LF_TEST(whole->length == SAMPLES && whole->num_channels == CHANNELS, "The mapped waveform has %u samples.",
+          whole->length);
+  LF_TEST(holds_samples(whole, 0), "The mapped waveform has the wrong samples.");
+
+  // Views are clipped at both ends of the waveform.
+  lf_waveform_t* inside = lf_waveform_view(whole, 100, 50);
+  LF_TEST(inside->length == 50 && holds_samples(inside, 100), "A view inside the waveform is wrong.");
+  lf_waveform_t* end = lf_waveform_view(whole, SAMPLES - 10, 100);
+  LF_TEST(end->length == 10 && holds_samples(end, SAMPLES - 10), "A view past the end has %u samples.", end->length);
+  lf_waveform_t* beyond = lf_waveform_view(whole, SAMPLES + 10, 100);
+  LF_TEST(beyond->length == 0, "A view that starts after the end has %u samples.", beyond->length);
+  lf_waveform_t* of_view = lf_waveform_view(inside, 40, 20);
+  LF_TEST(of_view->length == 10 && holds_samples(of_view, 140), "A view of a view is not clipped to it.");
+
+  // The copy constructor gives samples of their own, which outlive the original.
+  lf_waveform_t* copy = (lf_waveform_t*)lf_waveform_copy_constructor(inside);
+  LF_TEST(copy != NULL && copy->waveform != inside->waveform && copy->storage != inside->storage,
+          "The copy shares the samples of the original.");
+  copy->waveform[0] = -1;
+  LF_TEST(inside->waveform[0] == 100, "Changing the copy changed the original.");
+
+  // The views keep the storage after the waveform they were taken of has been freed.
+  lf_waveform_free(whole);
+  LF_TEST(holds_samples(end, SAMPLES - 10) && holds_samples(of_view, 140), "Freeing the waveform released its views.");
+  lf_waveform_free(beyond);
+  lf_waveform_free(of_view);
+  lf_waveform_destructor(end);
+  lf_waveform_destructor(inside);
+  LF_TEST(copy->waveform[0] == -1 && copy->waveform[49] == 149, "Freeing the original released the copy.");
+  lf_waveform_destructor(copy);
+  lf_waveform_free(NULL);
+}
+
+static void read_waveform(void) {
+  write_wave(FILE_NAME, SAMPLES, 0, SAMPLES * 2);
+  lf_waveform_t* read = read_wave_file(FILE_NAME);
+  LF_TEST(read != NULL && read->length == SAMPLES && holds_samples(read, 0), "The read waveform is wrong.");
+  LF_TEST(lf_waveform_view(read, 0, 10) == NULL, "A view was taken of a waveform that owns its samples.");
+  lf_waveform_free(read);
+}
+
+static void stream_chunks(void) {
+  write_wave(FILE_NAME, SAMPLES, 0, SAMPLES * 2);
+  // The chunk length is rounded down to whole frames of both channels.
+  const uint32_t chunk_length = 3001;
+  lf_wave_stream_t* stream = lf_wave_stream_open(FILE_NAME, chunk_length);
+  LF_TEST(stream != NULL, "Could not open a stream.");
+  uint32_t position = 0;
+  lf_waveform_t* chunk;
+  lf_waveform_t* last = NULL;
+  while ((chunk = lf_wave_stream_next(stream)) != NULL) {
+    uint32_t expected = SAMPLES - position < 3000 ? SAMPLES - position : 3000;
+    LF_TEST(chunk->length == expected, "A chunk at %u has %u samples, not %u.", position, chunk->length, expected);
+    LF_TEST(holds_samples(chunk, position), "The chunk at %u has the wrong samples.", position);
+    position += chunk->length;
+    // Freeing a chunk releases its pages, which are read again for the next chunks.
+    lf_waveform_free(last);
+    last = chunk;
+  }
+  LF_TEST(position == SAMPLES, "The stream delivered %u samples, not %u.", position, SAMPLES);
+  const uint32_t partial = SAMPLES % 3000;
+  LF_TEST(last->length == partial, "The last chunk has %u samples, not %u.", last->length, partial);
+  LF_TEST(lf_wave_stream_next(stream) == NULL, "The stream went on after its end.");
+  // A chunk stays valid after the stream is closed.
+  lf_wave_stream_close(stream);
+  LF_TEST(holds_samples(last, SAMPLES - partial), "A chunk did not outlive its stream.");
+  lf_waveform_free(last);
+  lf_wave_stream_close(NULL);
+}
+
+static void malformed_files(void) {
+  LF_TEST(lf_waveform_map("wave_file_reader_test_missing.wav") == NULL, "A missing file was mapped.");
+  LF_TEST(lf_wave_stream_open("wave_file_reader_test_missing.wav", 100) == NULL, "A missing file was streamed.");
+
+  // A file that ends in its header.
+  FILE* f = fopen(FILE_NAME, "wb");
+  LF_TEST(f != NULL, "Could not create %s.", FILE_NAME);
+  fwrite("RIFF\0\0\0\0WAVEfmt ", 1, 16, f);
+  fclose(f);
+  LF_TEST(lf_waveform_map(FILE_NAME) == NULL, "A truncated header was mapped.");
+  LF_TEST(lf_wave_stream_open(FILE_NAME, 100) == NULL, "A truncated header was streamed.");
+
+  // A file whose only chunk after the format is not a data chunk and runs past the end of the file.
+  write_wave(FILE_NAME, 10, 0, 20);
+  f = fopen(FILE_NAME, "r+b");
+  LF_TEST(f != NULL, "Could not open %s.", FILE_NAME);
+  fseek(f, 36, SEEK_SET);
+  fwrite("junk", 1, 4, f);
+  uint32_t size = 1000;
+  fwrite(&size, 4, 1, f);
+  fclose(f);
+  LF_TEST(lf_waveform_map(FILE_NAME) == NULL, "A file without a data chunk was mapped.");
+
+  // A data chunk that claims more samples than the file has is cut at the end of the file.
+  write_wave(FILE_NAME, 100, 0, 4000);
+  lf_waveform_t* truncated = lf_waveform_map(FILE_NAME);
+  LF_TEST(truncated != NULL && truncated->length == 100 && holds_samples(truncated, 0),
+          "A truncated data chunk was not cut at the end of the file.");
+  lf_waveform_free(truncated);
+}
+
+int main(void) {
+  // Without a junk chunk, the samples are used in place. After a junk chunk of an odd size, they are
+  // not aligned and are copied.
+  map_and_views(0);
+  map_and_views(6);
+  map_and_views(5);
+  read_waveform();
+  stream_chunks();
+  malformed_files();
+  remove(FILE_NAME);
+  return 0;
+}
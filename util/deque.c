@@ -5,7 +5,10 @@
  *
  * @brief Implementation of a double-ended queue.
  *
- * Each node contains a void* pointer.
+ * The values are void* pointers stored in a ring buffer whose capacity is a
+ * power of two. The buffer doubles when it is full and is never shrunk, so a
+ * deque that is used as a work buffer stops allocating once it has reached
+ * its working size. Call deque_free() to release the buffer.
  *
  * To use this, include the following in your target properties:
  * To use this, include the following in your target properties:
@@ -33,120 +36,167 @@
  * </pre>
  */
 
+#include <stdio.h>  // Defines fprintf
+#include <string.h> // Defines memcpy
+
 #include "deque.h"
 
+/** Capacity of the ring buffer when the first value is pushed. */
+#define DEQUE_INITIAL_CAPACITY 8
+
+/** Return the slot of the i-th value from the front. */
+static inline size_t _deque_slot(deque_t* d, size_t i) { return (d->front + i) & (d->capacity - 1); }
+
 /**
- * A node in the queue.
+ * Internal function to make room for at least the given number of values.
+ * The values are moved to the start of the new ring buffer.
+ * @param d The deque.
+ * @param needed The number of values the deque has to be able to hold.
  */
-typedef struct deque_node_t {
-  struct deque_node_t* next;
-  struct deque_node_t* prev;
-  void* value;
-} deque_node_t;
+static void _deque_reserve(deque_t* d, size_t needed) {
+  if (needed <= d->capacity) {
+    return;
+  }
+  size_t capacity = d->capacity == 0 ? DEQUE_INITIAL_CAPACITY : d->capacity;
+  while (capacity < needed) {
+    capacity *= 2;
+  }
+  void** items = (void**)malloc(capacity * sizeof(void*));
+  if (items == NULL) {
+    fprintf(stderr, "deque: Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  if (d->size > 0) {
+    // Copy the two parts of the ring so that the values start at index 0.
+    size_t first = d->capacity - d->front;
+    if (first > d->size) {
+      first = d->size;
+    }
+    memcpy(items, d->items + d->front, first * sizeof(void*));
+    memcpy(items + first, d->items, (d->size - first) * sizeof(void*));
+  }
+  free(d->items);
+  d->items = items;
+  d->capacity = capacity;
+  d->front = 0;
+}
 
 void deque_initialize(deque_t* d) {
   if (d != NULL) {
-    d->front = NULL;
-    d->back = NULL;
+    d->items = NULL;
+    d->capacity = 0;
+    d->front = 0;
     d->size = 0;
   }
 }
 
 bool deque_is_empty(deque_t* d) {
   if (d != NULL) {
-    return (d->front == NULL);
+    return (d->size == 0);
   }
   return true;
 }
 
 size_t deque_size(deque_t* d) { return d->size; }
 
-/**
- * Internal function to create a node to insert in the deque.
- * Users should not call this function. It is used internally
- * by deque_push_front and deque_push_back. It allocates memory
- * that is freed in popped using deque_pop_back and deque_pop_front.
- * @param value The payload of the node.
- */
-deque_node_t* _deque_create_node(void* value) {
-  deque_node_t* new_node = (deque_node_t*)calloc(1, sizeof(deque_node_t));
-  new_node->value = value;
-  return new_node;
-}
-
 void deque_push_front(deque_t* d, void* value) {
-  deque_node_t* n = _deque_create_node(value);
-  if (d->front == NULL) {
-    d->back = d->front = n;
-    d->size = 1;
-  } else {
-    d->front->prev = n;
-    n->next = d->front;
-    d->front = n;
-    d->size++;
-  }
+  _deque_reserve(d, d->size + 1);
+  d->front = (d->front - 1) & (d->capacity - 1);
+  d->items[d->front] = value;
+  d->size++;
 }
 
 void deque_push_back(deque_t* d, void* value) {
-  deque_node_t* n = _deque_create_node(value);
-  if (d->back == NULL) {
-    d->back = d->front = n;
-    d->size++;
-  } else {
-    d->back->next = n;
-    n->prev = d->back;
-    d->back = n;
-    d->size++;
-  }
+  _deque_reserve(d, d->size + 1);
+  d->items[_deque_slot(d, d->size)] = value;
+  d->size++;
 }
 
 void* deque_pop_front(deque_t* d) {
-  if (d == NULL || d->front == NULL) {
+  if (d == NULL || d->size == 0) {
     return NULL;
   }
-
-  void* value = d->front->value;
-  deque_node_t* temp = d->front; // temporary pointer for freeing up memory
-
-  if (d->front == d->back) {
-    // popping last element in deque
-    d->front = d->back = NULL;
-  } else {
-    d->front = d->front->next;
-  }
-  free(temp); // free memory for popped node
+  void* value = d->items[d->front];
+  d->front = _deque_slot(d, 1);
   d->size--;
   return value;
 }
 
 void* deque_pop_back(deque_t* d) {
-  if (d == NULL || d->back == NULL) {
+  if (d == NULL || d->size == 0) {
     return NULL;
   }
-
-  void* value = d->back->value;
-  deque_node_t* temp = d->back; // temporary pointer for freeing up memory
-  if (d->front == d->back) {
-    // popping last element in deque
-    d->front = d->back = NULL;
-  } else {
-    d->back = d->back->prev;
-  }
-  free(temp);
   d->size--;
-  return value;
+  return d->items[_deque_slot(d, d->size)];
 }
 
 void* deque_peek_back(deque_t* d) {
-  if (d == NULL || d->back == NULL) {
+  if (d == NULL || d->size == 0) {
     return NULL;
   }
-  return d->back->value;
+  return d->items[_deque_slot(d, d->size - 1)];
 }
 
 void* deque_peek_front(deque_t* d) {
-  if (d == NULL || d->front == NULL) {
+  if (d == NULL || d->size == 0) {
     return NULL;
   }
-  return d->front->value;
+  return d->items[d->front];
+}
+
+void deque_push_back_n(deque_t* d, void* const* values, size_t n) {
+  if (n == 0) {
+    return;
+  }
+  _deque_reserve(d, d->size + n);
+  size_t back = _deque_slot(d, d->size);
+  // The free slots may wrap around the end of the ring buffer.
+  size_t first = d->capacity - back;
+  if (first > n) {
+    first = n;
+  }
+  memcpy(d->items + back, values, first * sizeof(void*));
+  memcpy(d->items, values + first, (n - first) * sizeof(void*));
+  d->size += n;
+}
+
+size_t deque_pop_front_n(deque_t* d, void** values, size_t n) {
+  if (d == NULL || d->size == 0) {
+    return 0;
+  }
+  if (n > d->size) {
+    n = d->size;
+  }
+  // The values may wrap around the end of the ring buffer.
+  size_t first = d->capacity - d->front;
+  if (first > n) {
+    first = n;
+  }
+  memcpy(values, d->items + d->front, first * sizeof(void*));
+  memcpy(values + first, d->items, (n - first) * sizeof(void*));
+  d->front = _deque_slot(d, n);
+  d->size -= n;
+  return n;
+}
+
+deque_iterator_t deque_iterator(deque_t* d) {
+  deque_iterator_t iterator = {.deque = d, .index = 0};
+  return iterator;
+}
+
+bool deque_iterator_next(deque_iterator_t* iterator, void** value) {
+  deque_t* d = iterator->deque;
+  if (d == NULL || iterator->index >= d->size) {
+    return false;
+  }
+  *value = d->items[_deque_slot(d, iterator->index)];
+  iterator->index++;
+  return true;
+}
+
+void deque_free(deque_t* d) {
+  if (d != NULL) {
+    free(d->items);
+    deque_initialize(d);
+  }
 }
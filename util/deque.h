@@ -7,7 +7,7 @@
  * @ingroup Utilities
  *
  * This is the header file for an implementation of a double-ended queue.
- * Each node in the queue contains a void* pointer.
+ * The queue holds void* pointers in a ring buffer.
  *
  * To use this, include the following in your target properties:
  *
@@ -36,6 +36,9 @@
  *   deque my_deque;
  *   deque_initialize(&my_deque);
  * ```
+ * The values are stored in a ring buffer that grows as needed, so pushing
+ * and popping do not allocate memory once the deque has reached its working
+ * size. Call deque_free() to release the ring buffer when done with the deque.
  */
 
 #ifndef DEQUE_H
@@ -50,11 +53,27 @@
  * @ingroup Utilities
  */
 typedef struct deque_t {
-  struct deque_node_t* front;
-  struct deque_node_t* back;
+  /** The ring buffer, or NULL if nothing has been pushed yet. */
+  void** items;
+  /** The number of slots in the ring buffer. This is zero or a power of two. */
+  size_t capacity;
+  /** The index in the ring buffer of the value at the front. */
+  size_t front;
+  /** The number of values in the queue. */
   size_t size;
 } deque_t;
 
+/**
+ * @brief An iterator over the values of a deque, from front to back.
+ * @ingroup Utilities
+ *
+ * The iterator is invalidated by any change to the deque.
+ */
+typedef struct deque_iterator_t {
+  deque_t* deque;
+  size_t index;
+} deque_iterator_t;
+
 /**
  * @brief Initialize the specified deque to an empty deque.
  * @ingroup Utilities
@@ -117,21 +136,74 @@ void* deque_pop_front(deque_t* d);
 void* deque_pop_back(deque_t* d);
 
 /**
- * @brief Peek at the value on the front of the queue, leaving it on the queue.
+ * @brief Peek at the value on the back of the queue, leaving it on the queue.
  * @ingroup Utilities
  *
  * @param d The queue.
- * @return The value on the front of the queue or NULL if the queue is empty.
+ * @return The value on the back of the queue or NULL if the queue is empty.
  */
 void* deque_peek_back(deque_t* d);
 
 /**
- * @brief Peek at the value on the back of the queue, leaving it on the queue.
+ * @brief Peek at the value on the front of the queue, leaving it on the queue.
  * @ingroup Utilities
  *
  * @param d The queue.
- * @return The value on the back of the queue or NULL if the queue is empty.
+ * @return The value on the front of the queue or NULL if the queue is empty.
  */
 void* deque_peek_front(deque_t* d);
 
+/**
+ * @brief Push values to the back of the queue.
+ * @ingroup Utilities
+ *
+ * This is equivalent to pushing each value in turn with deque_push_back(),
+ * but grows the ring buffer at most once.
+ *
+ * @param d The queue.
+ * @param values The values to push. The first one ends up closest to the front.
+ * @param n The number of values to push.
+ */
+void deque_push_back_n(deque_t* d, void* const* values, size_t n);
+
+/**
+ * @brief Pop values from the front of the queue, removing them from the queue.
+ * @ingroup Utilities
+ *
+ * @param d The queue.
+ * @param values Array of at least n entries into which to write the popped values,
+ *  starting with the value at the front.
+ * @param n The maximum number of values to pop.
+ * @return The number of values popped, which is less than n if the queue had fewer values.
+ */
+size_t deque_pop_front_n(deque_t* d, void** values, size_t n);
+
+/**
+ * @brief Return an iterator positioned at the front of the queue.
+ * @ingroup Utilities
+ *
+ * @param d The queue.
+ */
+deque_iterator_t deque_iterator(deque_t* d);
+
+/**
+ * @brief Advance the iterator.
+ * @ingroup Utilities
+ *
+ * @param iterator The iterator.
+ * @param value Where to write the next value.
+ * @return True if a value was written to value, false if the iterator is past the back of the queue.
+ */
+bool deque_iterator_next(deque_iterator_t* iterator, void** value);
+
+/**
+ * @brief Remove all values and release the memory of the queue, leaving it empty.
+ * @ingroup Utilities
+ *
+ * The deque can be used again after this.
+ *
+ * @param d The queue.
+ */
+void deque_free(deque_t* d);
+
 #endif // DEQUE_H
@@ -3,152 +3,385 @@
 #include <string.h>
 #include <ctype.h>
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__unix__) || defined(__unix) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SC_CSV_USE_MMAP 1
+#else
+#define SC_CSV_USE_MMAP 0
+#endif
 
 #include "logging/api/logging.h"
 #include "reactor.h"
+#include "environment.h" // Defines GLOBAL_ENVIRONMENT
 #include "initialize_from_file.h"
 
 typedef enum { LF_TYPE_DOUBLE, LF_TYPE_INT, LF_TYPE_STRING } lf_field_type;
 
-/** Remove leading and trailing whitespace from the string. */
-static void sc_csv_trim(char* s) {
-  char* p = s;
-  while (*p && isspace((unsigned char)*p)) {
+/** A loaded CSV file. */
+struct lf_csv_table_t {
+  /** The contents of the file. This is not null terminated. */
+  const char* data;
+  /** The number of bytes in data. */
+  size_t length;
+  /** Whether data is mapped rather than allocated. */
+  bool mapped;
+  /** The delimiter given to lf_csv_table_open(). */
+  char delimiter;
+  /** The number of rows. */
+  size_t row_count;
+  /** The offset in data of the start of each row, followed by the end of the data. */
+  size_t* row_offsets;
+  /** The name of the file, used in error messages and to find a shared table. */
+  char* filename;
+  /** The next table in the list of shared tables. */
+  struct lf_csv_table_t* next;
+};
+
+/** Tables loaded by lf_initialize_double(), lf_initialize_int(), and _lf_initialize_string(). */
+static lf_csv_table_t* sc_csv_shared_tables = NULL;
+
+/** Read the contents of the file into an allocated buffer of the table. Return false if it could not be read. */
+static bool sc_csv_read(lf_csv_table_t* table, const char* filename) {
+  FILE* f = fopen(filename, "rb");
+  if (!f) {
+    return false;
+  }
+  size_t capacity = 4096;
+  char* data = (char*)malloc(capacity);
+  size_t length = 0;
+  size_t n;
+  while (data != NULL && (n = fread(data + length, 1, capacity - length, f)) > 0) {
+    length += n;
+    if (length == capacity) {
+      capacity *= 2;
+      char* grown = (char*)realloc(data, capacity);
+      if (grown == NULL) {
+        free(data);
+      }
+      data = grown;
+    }
+  }
+  fclose(f);
+  if (data == NULL) {
+    return false;
+  }
+  table->data = data;
+  table->length = length;
+  return true;
+}
+
+/** Load the contents of the file into the table. Return false if the file could not be read. */
+static bool sc_csv_load(lf_csv_table_t* table, const char* filename) {
+#if SC_CSV_USE_MMAP
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  // Pipes, devices, and files that report no size, such as those in /proc, cannot be mapped but can be read.
+  if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+    close(fd);
+    return sc_csv_read(table, filename);
+  }
+  void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return sc_csv_read(table, filename);
+  }
+  table->data = (const char*)data;
+  table->length = (size_t)st.st_size;
+  table->mapped = true;
+  return true;
+#else
+  return sc_csv_read(table, filename);
+#endif
+}
+
+/** Record the offset at which each row starts. Return false if out of memory. */
+static bool sc_csv_index_rows(lf_csv_table_t* table) {
+  const char* data = table->data;
+  size_t start = 0;
+  // Skip a UTF-8 byte order mark.
+  if (table->length >= 3 && (unsigned char)data[0] == 0xEF && (unsigned char)data[1] == 0xBB &&
+      (unsigned char)data[2] == 0xBF) {
+    start = 3;
+  }
+  // A file that holds nothing but a byte order mark has one empty row.
+  size_t count = start == table->length && start > 0 ? 1 : 0;
+  size_t offset = start;
+  while (offset < table->length) {
+    count++;
+    const char* newline = (const char*)memchr(data + offset, '\n', table->length - offset);
+    offset = newline == NULL ? table->length : (size_t)(newline - data) + 1;
+  }
+  table->row_offsets = (size_t*)malloc((count + 1) * sizeof(size_t));
+  if (table->row_offsets == NULL) {
+    return false;
+  }
+  size_t row = 0;
+  offset = start;
+  while (row < count) {
+    table->row_offsets[row++] = offset;
+    const char* newline = (const char*)memchr(data + offset, '\n', table->length - offset);
+    offset = newline == NULL ? table->length : (size_t)(newline - data) + 1;
+  }
+  table->row_offsets[row] = table->length;
+  table->row_count = count;
+  return true;
+}
+
+lf_csv_table_t* lf_csv_table_open(const char* filename, char delimiter) {
+  lf_csv_table_t* table = (lf_csv_table_t*)calloc(1, sizeof(lf_csv_table_t));
+  if (table == NULL) {
+    lf_print_error("Out of memory loading file \"%s\".", filename);
+    return NULL;
+  }
+  table->delimiter = delimiter;
+  table->filename = strdup(filename);
+  if (!sc_csv_load(table, filename)) {
+    lf_print_error("Could not open file \"%s\".", filename);
+    lf_csv_table_close(table);
+    return NULL;
+  }
+  if (table->filename == NULL || !sc_csv_index_rows(table)) {
+    lf_print_error("Out of memory loading file \"%s\".", filename);
+    lf_csv_table_close(table);
+    return NULL;
+  }
+  return table;
+}
+
+void lf_csv_table_close(lf_csv_table_t* table) {
+  if (table == NULL) {
+    return;
+  }
+#if SC_CSV_USE_MMAP
+  if (table->mapped) {
+    munmap((void*)table->data, table->length);
+  } else {
+    free((void*)table->data);
+  }
+#else
+  free((void*)table->data);
+#endif
+  free(table->row_offsets);
+  free(table->filename);
+  free(table);
+}
+
+size_t lf_csv_table_rows(const lf_csv_table_t* table) { return table->row_count; }
+
+/**
+ * Return the shared table for the given file, loading it on first use.
+ * Shared tables stay loaded until the program exits.
+ */
+static lf_csv_table_t* sc_csv_shared_table(const char* filename) {
+  // Bank members may initialize themselves in parallel.
+  LF_CRITICAL_SECTION_ENTER(GLOBAL_ENVIRONMENT);
+  lf_csv_table_t* table = sc_csv_shared_tables;
+  while (table != NULL && strcmp(table->filename, filename) != 0) {
+    table = table->next;
+  }
+  if (table == NULL) {
+    table = lf_csv_table_open(filename, ',');
+    if (table != NULL) {
+      table->next = sc_csv_shared_tables;
+      sc_csv_shared_tables = table;
+    }
+  }
+  LF_CRITICAL_SECTION_EXIT(GLOBAL_ENVIRONMENT);
+  return table;
+}
+
+/** Return true if the character is whitespace. */
+static bool sc_csv_is_space(char c) { return isspace((unsigned char)c) != 0; }
+
+/**
+ * Parse an integer in [start, end). Return false if the field is not entirely an integer.
+ * Values with up to 18 digits are parsed directly. Longer ones are left to strtol().
+ */
+static bool sc_csv_parse_int(const char* start, const char* end, int* out) {
+  const char* p = start;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
     p++;
   }
-  if (p != s) {
-    memmove(s, p, strlen(p) + 1);
+  if (p < end && end - p <= 18) {
+    long value = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+      value = value * 10 + (*p - '0');
+    }
+    if (p == end) {
+      *out = (int)(negative ? -value : value);
+      return true;
+    }
+  }
+  char buffer[SC_CSV_LINE_MAX];
+  size_t length = (size_t)(end - start);
+  if (length == 0 || length >= sizeof(buffer)) {
+    return false;
   }
-  size_t n = strlen(s);
-  while (n > 0 && isspace((unsigned char)s[n - 1])) {
-    s[--n] = '\0';
+  memcpy(buffer, start, length);
+  buffer[length] = '\0';
+  char* parsed_end = NULL;
+  long parsed = strtol(buffer, &parsed_end, 10);
+  if (parsed_end == buffer || *parsed_end != '\0') {
+    return false;
   }
+  *out = (int)parsed;
+  return true;
 }
 
-/** Replace the specified delimiter with a null character and return the number of fields. */
-static int sc_csv_split(char* line, char delimiter, char** fields, int max_fields) {
-  int n = 0;
-  char* cur = line;
-  while (n < max_fields) {
-    fields[n++] = cur;
-    char* sep = strchr(cur, delimiter);
-    if (!sep) {
+/**
+ * Parse a floating-point number in [start, end). Return false if the field is not entirely a number.
+ * Plain decimals with at most 15 digits are computed directly. Because both the digits and the
+ * power of ten are then exact doubles, one division gives the correctly rounded result, as strtod() does.
+ * Anything else, such as exponents, is left to strtod().
+ */
+static bool sc_csv_parse_double(const char* start, const char* end, double* out) {
+  static const double powers_of_ten[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                         1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+  const char* p = start;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    p++;
+  }
+  int64_t mantissa = 0;
+  int digits = 0;
+  int fraction_digits = 0;
+  bool in_fraction = false;
+  for (; p < end; p++) {
+    if (*p >= '0' && *p <= '9') {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits++;
+      fraction_digits += in_fraction;
+    } else if (*p == '.' && !in_fraction) {
+      in_fraction = true;
+    } else {
       break;
     }
-    *sep = '\0';
-    cur = sep + 1;
   }
-  return n;
+  if (p == end && digits > 0 && digits <= 15) {
+    double value = (double)mantissa / powers_of_ten[fraction_digits];
+    *out = negative ? -value : value;
+    return true;
+  }
+  char buffer[SC_CSV_LINE_MAX];
+  size_t length = (size_t)(end - start);
+  if (length == 0 || length >= sizeof(buffer)) {
+    return false;
+  }
+  memcpy(buffer, start, length);
+  buffer[length] = '\0';
+  char* parsed_end = NULL;
+  double parsed = strtod(buffer, &parsed_end);
+  if (parsed_end == buffer || *parsed_end != '\0') {
+    return false;
+  }
+  *out = parsed;
+  return true;
 }
 
 /**
- * Shared implementation for lf_initialize_double, lf_initialize_int, and _lf_initialize_string.
+ * Shared implementation for lf_initialize_double, lf_initialize_int, _lf_initialize_string, and
+ * the corresponding lf_csv_table functions.
  * The `type` parameter selects the expected va_arg pointer type (double*, int*, or char**).
  * The `allocations` parameter is used only for LF_TYPE_STRING to record allocated memory.
  */
-static int lf_initialize_fields(const char* filename, char delimiter, size_t row_number, lf_field_type type,
+static int lf_initialize_fields(lf_csv_table_t* table, char delimiter, size_t row_number, lf_field_type type,
                                 struct allocation_record_t** allocations, va_list ap) {
-  size_t pointer_count = 0;
-  FILE* f = fopen(filename, "r");
-  if (!f) {
-    lf_print_error("Could not open file \"%s\".", filename);
+  if (table == NULL) {
     return -1;
   }
+  if (row_number >= table->row_count) {
+    lf_print_error("Requested row %zu not found in file \"%s\".", row_number, table->filename);
+    return -1;
+  }
+  const char* row = table->data + table->row_offsets[row_number];
+  const char* row_end = table->data + table->row_offsets[row_number + 1];
+  // The row ends at the first line break.
+  for (const char* p = row; p < row_end; p++) {
+    if (*p == '\r' || *p == '\n') {
+      row_end = p;
+      break;
+    }
+  }
 
-  char line[SC_CSV_LINE_MAX];
-  size_t row_count = 0;
-  while (fgets(line, sizeof(line), f)) {
-    // Detect truncation: fgets didn't capture a newline and we're not at EOF.
-    size_t len = strlen(line);
-    int truncated = (len > 0 && line[len - 1] != '\n' && !feof(f));
-
-    if (row_count == row_number) {
-      if (truncated) {
-        lf_print_error("Row %zu exceeds maximum line length of %d in file \"%s\".", row_number, SC_CSV_LINE_MAX - 1,
-                       filename);
-        fclose(f);
+  size_t pointer_count = 0;
+  const char* field = row;
+  for (size_t i = 0; i < SC_CSV_MAX_COLS; i++) {
+    const char* field_end = (const char*)memchr(field, delimiter, (size_t)(row_end - field));
+    const char* next = field_end == NULL ? NULL : field_end + 1;
+    if (field_end == NULL) {
+      field_end = row_end;
+    }
+    // Trim whitespace.
+    const char* start = field;
+    const char* end = field_end;
+    while (start < end && sc_csv_is_space(*start)) {
+      start++;
+    }
+    while (end > start && sc_csv_is_space(end[-1])) {
+      end--;
+    }
+    if (type == LF_TYPE_DOUBLE) {
+      double* out = va_arg(ap, double*);
+      if (out == NULL)
+        break;
+      pointer_count++;
+      if (!sc_csv_parse_double(start, end, out)) {
+        lf_print_error("Failed to parse numeric value \"%.*s\" at row %zu, column %zu in \"%s\".", (int)(end - start),
+                       start, row_number, i, table->filename);
         return -1;
       }
-      char* row = &line[0];
-      if (len >= 3 && (unsigned char)row[0] == 0xEF && (unsigned char)row[1] == 0xBB && (unsigned char)row[2] == 0xBF) {
-        row += 3;
-      }
-      row[strcspn(row, "\r\n")] = '\0';
-
-      char* fields[SC_CSV_MAX_COLS];
-      int field_count = sc_csv_split(row, delimiter, fields, SC_CSV_MAX_COLS);
-      for (size_t i = 0; i < (size_t)field_count; i++) {
-        sc_csv_trim(fields[i]);
-        if (type == LF_TYPE_DOUBLE) {
-          double* out = va_arg(ap, double*);
-          if (out == NULL)
-            break;
-          pointer_count++;
-          char* end = NULL;
-          double parsed = strtod(fields[i], &end);
-          if (end != fields[i] && *end == '\0') {
-            *out = parsed;
-          } else {
-            lf_print_error("Failed to parse numeric value \"%s\" at row %zu, column %zu in \"%s\".", fields[i],
-                           row_number, i, filename);
-            fclose(f);
-            return -1;
-          }
-        } else if (type == LF_TYPE_INT) {
-          int* out = va_arg(ap, int*);
-          if (out == NULL)
-            break;
-          pointer_count++;
-          char* end = NULL;
-          long parsed = strtol(fields[i], &end, 10);
-          if (end != fields[i] && *end == '\0') {
-            *out = (int)parsed;
-          } else {
-            lf_print_error("Failed to parse integer value \"%s\" at row %zu, column %zu in \"%s\".", fields[i],
-                           row_number, i, filename);
-            fclose(f);
-            return -1;
-          }
-        } else {
-          char** out = va_arg(ap, char**);
-          if (out == NULL)
-            break;
-          pointer_count++;
-          char* field = fields[i];
-          size_t len = strlen(field);
-          if (len >= 2 &&
-              ((field[0] == '"' && field[len - 1] == '"') || (field[0] == '\'' && field[len - 1] == '\''))) {
-            field++;
-            len -= 2;
-          }
-          char* str = (char*)lf_allocate(len + 1, sizeof(char), allocations);
-          memcpy(str, field, len);
-          str[len] = '\0';
-          *out = str;
-        }
+    } else if (type == LF_TYPE_INT) {
+      int* out = va_arg(ap, int*);
+      if (out == NULL)
+        break;
+      pointer_count++;
+      if (!sc_csv_parse_int(start, end, out)) {
+        lf_print_error("Failed to parse integer value \"%.*s\" at row %zu, column %zu in \"%s\".", (int)(end - start),
+                       start, row_number, i, table->filename);
+        return -1;
       }
-      fclose(f);
-      return (int)pointer_count;
-    }
-    if (truncated) {
-      // Consume the rest of this over-long line so it counts as one row.
-      while (fgets(line, sizeof(line), f)) {
-        len = strlen(line);
-        if ((len > 0 && line[len - 1] == '\n') || feof(f))
-          break;
+    } else {
+      char** out = va_arg(ap, char**);
+      if (out == NULL)
+        break;
+      pointer_count++;
+      size_t len = (size_t)(end - start);
+      if (len >= 2 && ((start[0] == '"' && end[-1] == '"') || (start[0] == '\'' && end[-1] == '\''))) {
+        start++;
+        len -= 2;
       }
+      char* str = (char*)lf_allocate(len + 1, sizeof(char), allocations);
+      memcpy(str, start, len);
+      str[len] = '\0';
+      *out = str;
     }
-    row_count++;
+    if (next == NULL)
+      break;
+    field = next;
   }
-  lf_print_error("Requested row %zu not found in file \"%s\".", row_number, filename);
-  fclose(f);
-  return -1;
+  return (int)pointer_count;
 }
 
 int lf_initialize_double(const char* filename, char delimiter, size_t row_number, ...) {
   va_list ap;
   va_start(ap, row_number);
-  int result = lf_initialize_fields(filename, delimiter, row_number, LF_TYPE_DOUBLE, NULL, ap);
+  int result = lf_initialize_fields(sc_csv_shared_table(filename), delimiter, row_number, LF_TYPE_DOUBLE, NULL, ap);
   va_end(ap);
   return result;
 }
@@ -156,7 +389,7 @@ int lf_initialize_double(const char* filename, char delimiter, size_t row_number
 int lf_initialize_int(const char* filename, char delimiter, size_t row_number, ...) {
   va_list ap;
   va_start(ap, row_number);
-  int result = lf_initialize_fields(filename, delimiter, row_number, LF_TYPE_INT, NULL, ap);
+  int result = lf_initialize_fields(sc_csv_shared_table(filename), delimiter, row_number, LF_TYPE_INT, NULL, ap);
   va_end(ap);
   return result;
 }
@@ -165,7 +398,32 @@ int _lf_initialize_string(const char* filename, char delimiter, size_t row_numbe
                           struct allocation_record_t** allocations, ...) {
   va_list ap;
   va_start(ap, allocations);
-  int result = lf_initialize_fields(filename, delimiter, row_number, LF_TYPE_STRING, allocations, ap);
+  int result =
+      lf_initialize_fields(sc_csv_shared_table(filename), delimiter, row_number, LF_TYPE_STRING, allocations, ap);
+  va_end(ap);
+  return result;
+}
+
+int lf_csv_table_double(lf_csv_table_t* table, size_t row_number, ...) {
+  va_list ap;
+  va_start(ap, row_number);
+  int result = lf_initialize_fields(table, table->delimiter, row_number, LF_TYPE_DOUBLE, NULL, ap);
+  va_end(ap);
+  return result;
+}
+
+int lf_csv_table_int(lf_csv_table_t* table, size_t row_number, ...) {
+  va_list ap;
+  va_start(ap, row_number);
+  int result = lf_initialize_fields(table, table->delimiter, row_number, LF_TYPE_INT, NULL, ap);
+  va_end(ap);
+  return result;
+}
+
+int _lf_csv_table_string(lf_csv_table_t* table, size_t row_number, struct allocation_record_t** allocations, ...) {
+  va_list ap;
+  va_start(ap, allocations);
+  int result = lf_initialize_fields(table, table->delimiter, row_number, LF_TYPE_STRING, allocations, ap);
   va_end(ap);
   return result;
 }
@@ -301,6 +301,100 @@ int lf_initialize_int(const char* filename, char delimiter, size_t row_number, .
 int _lf_initialize_string(const char* filename, char delimiter, size_t row_number,
                           struct allocation_record_t** allocations, ...);
 
+/**
+ * @brief A delimited file loaded into memory with an index of its rows.
+ * @ingroup Utilities
+ *
+ * Use this instead of the functions above to read many rows of a large file. The file is mapped
+ * into memory once, or read if it cannot be mapped, and each row is then found in constant time.
+ * Numeric fields in plain decimal notation are parsed without calling strtod() or strtol().
+ * Rows are not limited to SC_CSV_LINE_MAX characters, but numeric fields that do not take the
+ * fast path are.
+ *
+ * lf_initialize_double(), lf_initialize_int(), and lf_initialize_string() load each file into such
+ * a table the first time they read it and keep it until the program exits, so initializing
+ * every member of a bank from its own row of one file reads the file only once.
+ * A file that is replaced after it has been loaded is not read again. Because the file may be
+ * mapped into memory, it must not be truncated or rewritten in place while it is loaded.
+ *
+ * For example:
+ * ```
+ *   lf_csv_table_t* table = lf_csv_table_open("params.csv", ',');
+ *   for (size_t row = 1; row < lf_csv_table_rows(table); row++) {
+ *     double a, b;
+ *     lf_csv_table_double(table, row, &a, &b, NULL);
+ *     ...
+ *   }
+ *   lf_csv_table_close(table);
+ * ```
+ */
+typedef struct lf_csv_table_t lf_csv_table_t;
+
+/**
+ * @brief Load a delimited file.
+ * @ingroup Utilities
+ *
+ * @param filename The name of the file to read.
+ * @param delimiter The delimiter character to use.
+ * @return The table, or NULL if the file could not be read, in which case an error is printed.
+ */
+lf_csv_table_t* lf_csv_table_open(const char* filename, char delimiter);
+
+/**
+ * @brief Release a table returned by lf_csv_table_open(). This does nothing if the table is NULL.
+ * @ingroup Utilities
+ *
+ * @param table The table.
+ */
+void lf_csv_table_close(lf_csv_table_t* table);
+
+/**
+ * @brief Return the number of rows in the table, including any header row.
+ * @ingroup Utilities
+ *
+ * @param table The table.
+ */
+size_t lf_csv_table_rows(const lf_csv_table_t* table);
+
+/**
+ * @brief Parse one row of the table as doubles, like lf_initialize_double().
+ * @ingroup Utilities
+ *
+ * @param table The table.
+ * @param row_number The row number in the file to read.
+ * @param ... The double* pointers to the variables to store the values in, terminated with NULL.
+ * @return The number of values parsed, or -1 if an error occurred.
+ */
+int lf_csv_table_double(lf_csv_table_t* table, size_t row_number, ...);
+
+/**
+ * @brief Parse one row of the table as integers, like lf_initialize_int().
+ * @ingroup Utilities
+ *
+ * @param table The table.
+ * @param row_number The row number in the file to read.
+ * @param ... The int* pointers to the variables to store the values in, terminated with NULL.
+ * @return The number of values parsed, or -1 if an error occurred.
+ */
+int lf_csv_table_int(lf_csv_table_t* table, size_t row_number, ...);
+
+/**
+ * @brief Parse one row of the table as strings, like lf_initialize_string().
+ * @ingroup Utilities
+ *
+ * This macro is meant to be called from a reaction. Elsewhere, use _lf_csv_table_string(),
+ * which takes the allocation list as an argument, as _lf_initialize_string() does.
+ *
+ * @param table The table.
+ * @param row_number The row number in the file to read.
+ * @param ... The char** pointers to the variables to store the values in, terminated with NULL.
+ * @return The number of values parsed, or -1 if an error occurred.
+ */
+#define lf_csv_table_string(table, row_number, ...)                                                                    \
+  _lf_csv_table_string(table, row_number, &((self_base_t*)self)->allocations, __VA_ARGS__)
+
+int _lf_csv_table_string(lf_csv_table_t* table, size_t row_number, struct allocation_record_t** allocations, ...);
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,12 +7,24 @@
  * See wave_file_reader.h for instructions.
  */
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include "low_level_platform.h" // Defines lf_atomic_add_fetch
 #include "wave_file_reader.h"
 
+#if defined(__unix__) || defined(__unix) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LF_WAV_USE_MMAP 1
+#else
+#define LF_WAV_USE_MMAP 0
+#endif
+
 #if _WIN32 || WIN32
 #define FILE_PATH_SEPARATOR '\\';
 #else
@@ -65,6 +77,51 @@ typedef struct {
   lf_wav_data_t data;
 } lf_wav_t;
 
+/**
+ * Sample data shared by views, either a mapped file or an allocated array.
+ */
+typedef struct lf_wave_storage_t {
+  void* base;
+  size_t size;
+  bool mapped;
+  /** Whether the pages of a view are released when the view is freed. */
+  bool streamed;
+  int ref_count;
+} lf_wave_storage_t;
+
+/**
+ * A wave file that is delivered in chunks.
+ */
+struct lf_wave_stream_t {
+  lf_waveform_t* whole;
+  uint32_t position;
+  uint32_t chunk_length;
+};
+
+/**
+ * Check that the header describes a supported format and print warnings if it does not.
+ */
+static void lf_wav_check_format(lf_wav_t* wav) {
+  lf_wav_format_t fmt = wav->fmt;
+  // Wave file format is described here:
+  // https://sites.google.com/site/musicgapi/technical-documents/wav-file-format
+  if (memcmp(wav->riff.chunk_id, "RIFF", 4) != 0 || memcmp(wav->riff.format, "WAVE", 4) != 0 ||
+      memcmp(fmt.subchunk_id, "fmt ", 4) != 0 || fmt.subchunk_size != 16 || fmt.audio_format != 1 ||
+      fmt.sample_rate != 44100 || fmt.bits_per_sample != 16) {
+    fprintf(stderr, "WARNING: Waveform sample not a supported format.\n");
+    fprintf(stderr, "Chunk ID was expected to be 'RIFF'. Got: '%c%c%c%c'.\n", wav->riff.chunk_id[0],
+            wav->riff.chunk_id[1], wav->riff.chunk_id[2], wav->riff.chunk_id[3]);
+    fprintf(stderr, "Format was expected to be 'WAVE'. Got: '%c%c%c%c'.\n", wav->riff.format[0], wav->riff.format[1],
+            wav->riff.format[2], wav->riff.format[3]);
+    fprintf(stderr, "Subchunk ID was expected to be 'fmt '. Got: '%c%c%c%c'.\n", fmt.subchunk_id[0], fmt.subchunk_id[1],
+            fmt.subchunk_id[2], fmt.subchunk_id[3]);
+    fprintf(stderr, "Subchunk size was expected to be 16. Got: '%d'.\n", fmt.subchunk_size);
+    fprintf(stderr, "Audio format was expected to be 1 (LPCM, no compression). Got: '%d'.\n", fmt.audio_format);
+    fprintf(stderr, "Sample rate was expected to be 44100). Got: '%d'.\n", fmt.sample_rate);
+    fprintf(stderr, "Bits per sample was expected to be 16. Got: '%d'.\n", fmt.bits_per_sample);
+  }
+}
+
 lf_waveform_t* read_wave_file(const char* path) {
   FILE* fp = NULL;
 
@@ -89,30 +146,10 @@ lf_waveform_t* read_wave_file(const char* path) {
   lf_wav_format_t fmt = wav.fmt;
   lf_wav_data_t data = wav.data;
 
-  // Wave file format is described here:
-  // https://sites.google.com/site/musicgapi/technical-documents/wav-file-format
-  uint32_t expected_chunk_id = (uint32_t)'FFIR';    // Little-endian version of RIFF.
-  uint32_t expected_format = (uint32_t)'EVAW';      // Little-endian version of WAVE.
-  uint32_t expected_subchunk_id = (uint32_t)' tmf'; // Little-endian version of 'fmt '.
-  if (*(uint32_t*)wav.riff.chunk_id != expected_chunk_id || *(uint32_t*)wav.riff.format != expected_format ||
-      *(uint32_t*)fmt.subchunk_id != expected_subchunk_id || fmt.subchunk_size != 16 || fmt.audio_format != 1 ||
-      fmt.sample_rate != 44100 || fmt.bits_per_sample != 16) {
-    fprintf(stderr, "WARNING: Waveform sample not a supported format.\n");
-    fprintf(stderr, "Chunk ID was expected to be 'RIFF'. Got: '%c%c%c%c'.\n", wav.riff.chunk_id[0],
-            wav.riff.chunk_id[1], wav.riff.chunk_id[2], wav.riff.chunk_id[3]);
-    fprintf(stderr, "Format was expected to be 'WAVE'. Got: '%c%c%c%c'.\n", wav.riff.format[0], wav.riff.format[1],
-            wav.riff.format[2], wav.riff.format[3]);
-    fprintf(stderr, "Subchunk ID was expected to be 'fmt '. Got: '%c%c%c%c'.\n", fmt.subchunk_id[0], fmt.subchunk_id[1],
-            fmt.subchunk_id[2], fmt.subchunk_id[3]);
-    fprintf(stderr, "Subchunk size was expected to be 16. Got: '%d'.\n", fmt.subchunk_size);
-    fprintf(stderr, "Audio format was expected to be 1 (LPCM, no compression). Got: '%d'.\n", fmt.audio_format);
-    fprintf(stderr, "Sample rate was expected to be 44100). Got: '%d'.\n", fmt.sample_rate);
-    fprintf(stderr, "Bits per sample was expected to be 16. Got: '%d'.\n", fmt.bits_per_sample);
-  }
+  lf_wav_check_format(&wav);
   // Ignore any intermediate chunks that are not 'data' chunks.
   // Apparently, Apple software sometimes inserts junk here.
-  uint32_t expected_data_id = (uint32_t)'atad'; // Little-endian version of 'data'.
-  while (*(uint32_t*)data.subchunk_id != expected_data_id) {
+  while (memcmp(data.subchunk_id, "data", 4) != 0) {
     char junk[data.subchunk_size];
     size_t bytes_read = fread(junk, 1, data.subchunk_size, fp);
     if (bytes_read != data.subchunk_size) {
@@ -140,6 +177,7 @@ lf_waveform_t* read_wave_file(const char* path) {
   result->length = data.subchunk_size / 2; // Subchunk size is in bytes, but length is number of samples.
   result->num_channels = num_channels;
   result->waveform = (int16_t*)calloc(data.subchunk_size / 2, sizeof(int16_t));
+  result->storage = NULL;
 
   size_t bytes_read = fread(result->waveform, sizeof(int16_t), data.subchunk_size / 2, fp);
   if (bytes_read != data.subchunk_size / 2) {
@@ -149,3 +187,277 @@ lf_waveform_t* read_wave_file(const char* path) {
   // printf("duration \t%f\n", (data.subchunk_size * 1.0) / fmt.byte_rate);
   return result;
 }
+
+/**
+ * Return storage that holds a reference for the caller.
+ */
+static lf_wave_storage_t* lf_wav_new_storage(void* base, size_t size, bool mapped) {
+  lf_wave_storage_t* storage = (lf_wave_storage_t*)calloc(1, sizeof(lf_wave_storage_t));
+  if (storage == NULL) {
+    return NULL;
+  }
+  storage->base = base;
+  storage->size = size;
+  storage->mapped = mapped;
+  storage->ref_count = 1;
+  return storage;
+}
+
+/**
+ * Release a reference to the storage and free it if it was the last one.
+ */
+static void lf_wav_release_storage(lf_wave_storage_t* storage) {
+  if (lf_atomic_add_fetch(&storage->ref_count, -1) > 0) {
+    return;
+  }
+#if LF_WAV_USE_MMAP
+  if (storage->mapped) {
+    munmap(storage->base, storage->size);
+  } else {
+    free(storage->base);
+  }
+#else
+  free(storage->base);
+#endif
+  free(storage);
+}
+
+/**
+ * Return a waveform over the given samples that holds a new reference to the storage.
+ */
+static lf_waveform_t* lf_wav_new_view(lf_wave_storage_t* storage, int16_t* samples, uint32_t length,
+                                      uint16_t num_channels) {
+  lf_waveform_t* result = (lf_waveform_t*)malloc(sizeof(lf_waveform_t));
+  if (result == NULL) {
+    return NULL;
+  }
+  lf_atomic_add_fetch(&storage->ref_count, 1);
+  result->length = length;
+  result->num_channels = num_channels;
+  result->waveform = samples;
+  result->storage = storage;
+  return result;
+}
+
+/**
+ * Return a waveform that holds a copy of the given samples in new storage.
+ * The samples need not be aligned.
+ */
+static lf_waveform_t* lf_wav_copy(const void* samples, uint32_t length, uint16_t num_channels) {
+  int16_t* copy = (int16_t*)malloc(length > 0 ? length * sizeof(int16_t) : 1);
+  if (copy == NULL) {
+    return NULL;
+  }
+  memcpy(copy, samples, length * sizeof(int16_t));
+  lf_wave_storage_t* storage = lf_wav_new_storage(copy, length * sizeof(int16_t), false);
+  if (storage == NULL) {
+    free(copy);
+    return NULL;
+  }
+  lf_waveform_t* result = lf_wav_new_view(storage, copy, length, num_channels);
+  // The view holds the only reference.
+  lf_wav_release_storage(storage);
+  return result;
+}
+
+#if LF_WAV_USE_MMAP
+/**
+ * Find the sample data in a wave file in memory, as read_wave_file() does.
+ * @return False if the file is too short to contain a 'data' chunk.
+ */
+static bool lf_wav_find_samples(const char* file, size_t size, const char* path, uint16_t* num_channels,
+                                size_t* offset, uint32_t* length) {
+  lf_wav_t wav;
+  if (size < sizeof(lf_wav_t)) {
+    fprintf(stderr, "WARNING: Waveform sample file %s is too short.\n", path);
+    return false;
+  }
+  memcpy(&wav, file, sizeof(lf_wav_t));
+  lf_wav_check_format(&wav);
+  // Ignore any intermediate chunks that are not 'data' chunks.
+  lf_wav_data_t data = wav.data;
+  size_t position = sizeof(lf_wav_t);
+  while (memcmp(data.subchunk_id, "data", 4) != 0) {
+    if (data.subchunk_size > size - position || size - position - data.subchunk_size < sizeof(lf_wav_data_t)) {
+      fprintf(stderr, "Missing 'data' chunk in file %s.\n", path);
+      return false;
+    }
+    position += data.subchunk_size;
+    memcpy(&data, file + position, sizeof(lf_wav_data_t));
+    position += sizeof(lf_wav_data_t);
+  }
+  uint32_t bytes = data.subchunk_size;
+  if (bytes > size - position) {
+    fprintf(stderr, "WARNING: Expected %d bytes, but got %zu.\n", data.subchunk_size, size - position);
+    bytes = (uint32_t)(size - position);
+  }
+  *num_channels = wav.fmt.num_channels;
+  *offset = position;
+  *length = bytes / 2;
+  return true;
+}
+
+/**
+ * Map the file, or the file in the src-gen directory, into memory.
+ * @return The address of the mapped file, or NULL if it can't be mapped.
+ */
+static void* lf_wav_map_file(const char* path, size_t* size) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    // Try prefixing the file name with "src-gen", as read_wave_file() does.
+    char alt_path[strlen(path) + 9];
+    strcpy(alt_path, "src-gen");
+    alt_path[7] = FILE_PATH_SEPARATOR;
+    strcpy(&(alt_path[8]), path);
+    fd = open(alt_path, O_RDONLY);
+    if (fd < 0) {
+      fprintf(stderr, "WARNING: Failed to open waveform sample file: %s\n", path);
+      return NULL;
+    }
+  }
+  struct stat st;
+  void* file = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    file = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (file == MAP_FAILED) {
+    fprintf(stderr, "WARNING: Failed to map waveform sample file: %s\n", path);
+    return NULL;
+  }
+  *size = (size_t)st.st_size;
+  return file;
+}
+#endif // LF_WAV_USE_MMAP
+
+lf_waveform_t* lf_waveform_map(const char* path) {
+#if LF_WAV_USE_MMAP
+  size_t size;
+  char* file = (char*)lf_wav_map_file(path, &size);
+  if (file == NULL) {
+    return NULL;
+  }
+  uint16_t num_channels;
+  size_t offset;
+  uint32_t length;
+  if (!lf_wav_find_samples(file, size, path, &num_channels, &offset, &length)) {
+    munmap(file, size);
+    return NULL;
+  }
+  if (offset % sizeof(int16_t) != 0) {
+    // The samples are not aligned, so they cannot be used in place.
+    lf_waveform_t* result = lf_wav_copy(file + offset, length, num_channels);
+    munmap(file, size);
+    return result;
+  }
+  lf_wave_storage_t* storage = lf_wav_new_storage(file, size, true);
+  if (storage == NULL) {
+    munmap(file, size);
+    return NULL;
+  }
+  lf_waveform_t* result = lf_wav_new_view(storage, (int16_t*)(void*)(file + offset), length, num_channels);
+  lf_wav_release_storage(storage);
+  return result;
+#else
+  // Read the file once. The views share the samples that were read.
+  lf_waveform_t* result = read_wave_file(path);
+  if (result == NULL) {
+    return NULL;
+  }
+  result->storage = lf_wav_new_storage(result->waveform, result->length * sizeof(int16_t), false);
+  if (result->storage == NULL) {
+    free(result->waveform);
+    free(result);
+    return NULL;
+  }
+  return result;
+#endif // LF_WAV_USE_MMAP
+}
+
+lf_waveform_t* lf_waveform_view(lf_waveform_t* waveform, uint32_t start, uint32_t length) {
+  if (waveform->storage == NULL) {
+    return NULL;
+  }
+  if (start > waveform->length) {
+    start = waveform->length;
+  }
+  if (length > waveform->length - start) {
+    length = waveform->length - start;
+  }
+  return lf_wav_new_view(waveform->storage, waveform->waveform + start, length, waveform->num_channels);
+}
+
+void lf_waveform_free(lf_waveform_t* waveform) {
+  if (waveform == NULL) {
+    return;
+  }
+  lf_wave_storage_t* storage = waveform->storage;
+  if (storage == NULL) {
+    free(waveform->waveform);
+  } else {
+#if LF_WAV_USE_MMAP
+    if (storage->streamed && waveform->length > 0) {
+      // Let the system drop the pages that lie entirely within this chunk. They are read again if needed.
+      uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+      uintptr_t first = ((uintptr_t)waveform->waveform + page - 1) & ~(page - 1);
+      uintptr_t last = ((uintptr_t)(waveform->waveform + waveform->length)) & ~(page - 1);
+      if (first < last) {
+        madvise((void*)first, last - first, MADV_DONTNEED);
+      }
+    }
+#endif
+    lf_wav_release_storage(storage);
+  }
+  free(waveform);
+}
+
+void lf_waveform_destructor(void* waveform) { lf_waveform_free((lf_waveform_t*)waveform); }
+
+void* lf_waveform_copy_constructor(void* waveform) {
+  lf_waveform_t* original = (lf_waveform_t*)waveform;
+  return lf_wav_copy(original->waveform, original->length, original->num_channels);
+}
+
+lf_wave_stream_t* lf_wave_stream_open(const char* path, uint32_t chunk_length) {
+  lf_waveform_t* whole = lf_waveform_map(path);
+  if (whole == NULL) {
+    return NULL;
+  }
+  lf_wave_stream_t* stream = (lf_wave_stream_t*)malloc(sizeof(lf_wave_stream_t));
+  if (stream == NULL) {
+    lf_waveform_free(whole);
+    return NULL;
+  }
+  uint16_t num_channels = whole->num_channels > 0 ? whole->num_channels : 1;
+  chunk_length -= chunk_length % num_channels;
+  stream->whole = whole;
+  stream->position = 0;
+  stream->chunk_length = chunk_length > 0 ? chunk_length : num_channels;
+#if LF_WAV_USE_MMAP
+  lf_wave_storage_t* storage = whole->storage;
+  if (storage->mapped) {
+    storage->streamed = true;
+    madvise(storage->base, storage->size, MADV_SEQUENTIAL);
+  }
+#endif
+  return stream;
+}
+
+lf_waveform_t* lf_wave_stream_next(lf_wave_stream_t* stream) {
+  if (stream->position >= stream->whole->length) {
+    return NULL;
+  }
+  lf_waveform_t* chunk = lf_waveform_view(stream->whole, stream->position, stream->chunk_length);
+  if (chunk != NULL) {
+    stream->position += chunk->length;
+  }
+  return chunk;
+}
+
+void lf_wave_stream_close(lf_wave_stream_t* stream) {
+  if (stream == NULL) {
+    return;
+  }
+  lf_waveform_free(stream->whole);
+  free(stream);
+}
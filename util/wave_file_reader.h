@@ -11,7 +11,31 @@
  * supported, returns an lf_waveform_t struct, which contains the raw
  * audio data in 16-bit linear PCM form.
  *
- * This code has few dependencies, so it should run on just about any platform.
+ * To avoid copying sample data, lf_waveform_map() instead maps the file into memory
+ * and returns a waveform whose samples point directly into the mapped file, and
+ * lf_wave_stream_open() and lf_wave_stream_next() deliver a file of any size in chunks
+ * that are views of the mapped file. Mapped waveforms are reference counted, so
+ * views of them can be sent through ports as tokens and shared by all downstream
+ * reactions. Set lf_waveform_destructor() and lf_waveform_copy_constructor()
+ * as the destructor and copy constructor of such ports:
+ *
+ * ```
+ * reactor Sampler {
+ *   output out: lf_waveform_t*;
+ *   state sample: lf_waveform_t* = {= NULL =};
+ *   reaction(startup) -> out {=
+ *     self->sample = lf_waveform_map("drum.wav");
+ *     lf_set_destructor(out, lf_waveform_destructor);
+ *     lf_set_copy_constructor(out, lf_waveform_copy_constructor);
+ *   =}
+ *   reaction(hit) -> out {=
+ *     lf_set(out, lf_waveform_view(self->sample, 0, self->sample->length));
+ *   =}
+ * }
+ * ```
+ *
+ * Memory mapping is used on POSIX platforms. Elsewhere, lf_waveform_map() reads the file
+ * into memory once and the views share that copy.
  *
  * To use this, include the following flags in your target properties:
  *
@@ -39,6 +63,8 @@
 #ifndef WAVE_FILE_READER_H
 #define WAVE_FILE_READER_H
 
+#include <stdint.h>
+
 /**
  * @brief Waveform in 16-bit linear-PCM format.
  * @ingroup Utilities
@@ -46,13 +72,23 @@
  * The waveform element is an array containing audio samples.
  * If there are two channels, then they are interleaved left and right channel.
  * The length is the total number of samples, a multiple of the number of channels.
+ * A waveform returned by read_wave_file() owns its sample array, and its storage is NULL.
+ * A waveform returned by any of the other functions below is a view of a sample array held
+ * by the reference-counted storage and must be released with lf_waveform_free().
  */
 typedef struct lf_waveform_t {
   uint32_t length;
   uint16_t num_channels;
   int16_t* waveform;
+  struct lf_wave_storage_t* storage;
 } lf_waveform_t;
 
+/**
+ * @brief A wave file that is delivered in chunks.
+ * @ingroup Utilities
+ */
+typedef struct lf_wave_stream_t lf_wave_stream_t;
+
 /**
  * @brief Open a wave file, check that the format is supported, allocate memory for the sample data,
  * and fill the memory with the sample data.
@@ -69,4 +105,95 @@ typedef struct lf_waveform_t {
  */
 lf_waveform_t* read_wave_file(const char* path);
 
+/**
+ * @brief Map a wave file into memory and return a waveform whose samples are the mapped sample data.
+ * @ingroup Utilities
+ *
+ * This checks the format like read_wave_file() but does not copy the samples.
+ * The file is unmapped when the returned waveform and all views of it have been freed
+ * with lf_waveform_free().
+ *
+ * @param path The path to the file.
+ * @return The waveform or NULL if the file can't be opened or has an unsupported format.
+ */
+lf_waveform_t* lf_waveform_map(const char* path);
+
+/**
+ * @brief Return a waveform that shares the samples of the given waveform, starting at sample
+ * start and containing length samples (both counted over all channels).
+ * @ingroup Utilities
+ *
+ * The range is clipped to the samples of the given waveform. Views can be taken of waveforms
+ * returned by any function here other than read_wave_file().
+ *
+ * @param waveform The waveform to take a view of.
+ * @param start The index of the first sample, a multiple of the number of channels.
+ * @param length The number of samples, a multiple of the number of channels.
+ * @return The view, to be freed with lf_waveform_free(), or NULL if the waveform does not support views.
+ */
+lf_waveform_t* lf_waveform_view(lf_waveform_t* waveform, uint32_t start, uint32_t length);
+
+/**
+ * @brief Free a waveform returned by any of the functions here, including read_wave_file().
+ * @ingroup Utilities
+ *
+ * For a view, this releases the view and, if it was the last one, the storage it shares.
+ *
+ * @param waveform The waveform or NULL.
+ */
+void lf_waveform_free(lf_waveform_t* waveform);
+
+/**
+ * @brief Token destructor for ports and actions that carry lf_waveform_t*.
+ * @ingroup Utilities
+ *
+ * @param waveform The waveform to free with lf_waveform_free().
+ */
+void lf_waveform_destructor(void* waveform);
+
+/**
+ * @brief Token copy constructor for ports and actions that carry lf_waveform_t*.
+ * @ingroup Utilities
+ *
+ * Mapped samples are read only, so a mutable input gets its own copy of the samples.
+ * The copy is freed with lf_waveform_free() like any other waveform.
+ *
+ * @param waveform The waveform to copy.
+ * @return The copy.
+ */
+void* lf_waveform_copy_constructor(void* waveform);
+
+/**
+ * @brief Open a wave file to be delivered in chunks of the given number of samples.
+ * @ingroup Utilities
+ *
+ * The file is mapped into memory rather than read, so it can be larger than the available memory.
+ * The pages of each chunk are released when the chunk is freed.
+ *
+ * @param path The path to the file.
+ * @param chunk_length The number of samples per chunk, counted over all channels.
+ *  This is rounded down to a multiple of the number of channels.
+ * @return The stream or NULL if the file can't be opened or has an unsupported format.
+ */
+lf_wave_stream_t* lf_wave_stream_open(const char* path, uint32_t chunk_length);
+
+/**
+ * @brief Return the next chunk of the stream, or NULL if all samples have been delivered.
+ * @ingroup Utilities
+ *
+ * The last chunk may be shorter than the chunk length. Each chunk is a view to be freed with
+ * lf_waveform_free(), and it stays valid after the stream is closed.
+ *
+ * @param stream The stream.
+ */
+lf_waveform_t* lf_wave_stream_next(lf_wave_stream_t* stream);
+
+/**
+ * @brief Close a stream returned by lf_wave_stream_open().
+ * @ingroup Utilities
+ *
+ * @param stream The stream or NULL.
+ */
+void lf_wave_stream_close(lf_wave_stream_t* stream);
+
 #endif // WAVE_FILE_READER_H
\ No newline at end of file